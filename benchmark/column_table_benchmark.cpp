@@ -0,0 +1,60 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <string>
+#include "column_table.hpp"
+
+namespace {
+struct Row {
+    std::int64_t id;
+    double price;
+    std::string city;
+    std::string note;
+};
+
+const char* const cities[] = {"Paris", "Oslo", "Berlin", "Rome", "Lima"};
+constexpr std::size_t rows = 1 << 20;
+} // namespace
+
+static void BM_row_vector_filter(benchmark::State& state) {
+    std::mt19937_64 gen(1);
+    algo::Vector<Row> table;
+    for (std::size_t i = 0; i < rows; ++i) {
+        table.push_back({std::int64_t(i), double(gen() % 1000),
+                         cities[gen() % 5], "a note too long for SSO"});
+    }
+    for (auto _ : state) {
+        std::size_t hits = 0;
+        for (const Row& r : table) {
+            hits += r.price < 100.0 && r.city == "Paris";
+        }
+        benchmark::DoNotOptimize(hits);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * rows);
+}
+BENCHMARK(BM_row_vector_filter);
+
+static void BM_algo_column_table_filter(benchmark::State& state) {
+    std::mt19937_64 gen(1);
+    algo::ColumnTable table;
+    auto& id = table.add_column<std::int64_t>("id");
+    auto& price = table.add_column<double>("price");
+    auto& city = table.add_string_column("city");
+    auto& note = table.add_string_column("note");
+    for (std::size_t i = 0; i < rows; ++i) {
+        id.push_back(std::int64_t(i));
+        price.push_back(double(gen() % 1000));
+        city.push_back(cities[gen() % 5]);
+        note.push_back("a note too long for SSO");
+    }
+    for (auto _ : state) {
+        algo::DynamicBitset hits =
+            table.filter<double>("price", algo::CompareOp::less, 100.0);
+        hits &= table.filter("city", algo::CompareOp::equal, "Paris");
+        benchmark::DoNotOptimize(hits.count());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * rows);
+}
+BENCHMARK(BM_algo_column_table_filter);
+
+BENCHMARK_MAIN();
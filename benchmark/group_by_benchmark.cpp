@@ -0,0 +1,55 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <unordered_map>
+#include "group_by.hpp"
+
+namespace {
+struct Input {
+    algo::Vector<std::uint64_t> keys;
+    algo::Vector<double> values;
+};
+
+Input makeInput(std::size_t groups) {
+    std::mt19937_64 gen(1);
+    Input in;
+    for (std::size_t i = 0; i < (1 << 22); ++i) {
+        in.keys.push_back(gen() % groups);
+        in.values.push_back(double(gen() % 1000));
+    }
+    return in;
+}
+
+struct State {
+    double sum = 0;
+    std::uint64_t count = 0;
+};
+} // namespace
+
+static void BM_unordered_map_group_by(benchmark::State& state) {
+    const Input in = makeInput(std::size_t(state.range(0)));
+    for (auto _ : state) {
+        std::unordered_map<std::uint64_t, State> groups;
+        for (std::size_t i = 0; i < in.keys.size(); ++i) {
+            State& s = groups[in.keys[i]];
+            s.sum += in.values[i];
+            ++s.count;
+        }
+        benchmark::DoNotOptimize(groups.size());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * (1 << 22));
+}
+BENCHMARK(BM_unordered_map_group_by)->Arg(100)->Arg(100000)->Arg(4000000);
+
+static void BM_algo_group_by(benchmark::State& state) {
+    const Input in = makeInput(std::size_t(state.range(0)));
+    for (auto _ : state) {
+        auto r = algo::group_by(in.keys, in.values,
+                                {algo::Aggregate::sum, algo::Aggregate::count});
+        benchmark::DoNotOptimize(r.keys.size());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * (1 << 22));
+}
+BENCHMARK(BM_algo_group_by)->Arg(100)->Arg(100000)->Arg(4000000);
+
+BENCHMARK_MAIN();
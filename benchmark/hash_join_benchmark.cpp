@@ -0,0 +1,59 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <unordered_map>
+#include "hash_join.hpp"
+
+namespace {
+struct Input {
+    algo::Vector<std::uint64_t> build;
+    algo::Vector<std::uint64_t> probe;
+};
+
+Input makeInput(std::size_t rows) {
+    std::mt19937_64 gen(1);
+    Input in;
+    for (std::size_t i = 0; i < rows; ++i) {
+        in.build.push_back(gen());
+    }
+    for (std::size_t i = 0; i < (1 << 22); ++i) {
+        in.probe.push_back(gen() % 2 ? in.build[gen() % rows] : gen());
+    }
+    return in;
+}
+} // namespace
+
+static void BM_unordered_multimap_join(benchmark::State& state) {
+    const Input in = makeInput(std::size_t(state.range(0)));
+    for (auto _ : state) {
+        std::unordered_multimap<std::uint64_t, std::uint32_t> table;
+        for (std::uint32_t i = 0; i < in.build.size(); ++i) {
+            table.emplace(in.build[i], i);
+        }
+        algo::HashJoinResult r;
+        for (std::uint32_t j = 0; j < in.probe.size(); ++j) {
+            const auto range = table.equal_range(in.probe[j]);
+            for (auto it = range.first; it != range.second; ++it) {
+                r.build.push_back(it->second);
+                r.probe.push_back(j);
+            }
+        }
+        benchmark::DoNotOptimize(r.build.size());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) *
+                            (state.range(0) + (1 << 22)));
+}
+BENCHMARK(BM_unordered_multimap_join)->Arg(10000)->Arg(1 << 22);
+
+static void BM_algo_hash_join(benchmark::State& state) {
+    const Input in = makeInput(std::size_t(state.range(0)));
+    for (auto _ : state) {
+        algo::HashJoinResult r = algo::hash_join(in.build, in.probe);
+        benchmark::DoNotOptimize(r.build.size());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) *
+                            (state.range(0) + (1 << 22)));
+}
+BENCHMARK(BM_algo_hash_join)->Arg(10000)->Arg(1 << 22);
+
+BENCHMARK_MAIN();
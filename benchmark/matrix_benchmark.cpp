@@ -0,0 +1,96 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include "matrix.hpp"
+
+using Nested = algo::Vector<algo::Vector<double>>;
+
+static Nested makeNested(std::size_t n) {
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<double> value(-1.0, 1.0);
+    Nested m;
+    for (std::size_t i = 0; i < n; ++i) {
+        algo::Vector<double> row;
+        for (std::size_t j = 0; j < n; ++j) {
+            row.push_back(value(gen));
+        }
+        m.push_back(row);
+    }
+    return m;
+}
+
+static algo::Matrix<double> makeMatrix(std::size_t n) {
+    const Nested nested = makeNested(n);
+    algo::Matrix<double> m(n, n);
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = 0; j < n; ++j) {
+            m(i, j) = nested[i][j];
+        }
+    }
+    return m;
+}
+
+static void BM_nested_vector_multiply(benchmark::State& state) {
+    const std::size_t n = std::size_t(state.range(0));
+    const Nested a = makeNested(n);
+    const Nested b = makeNested(n);
+    Nested c = makeNested(n);
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < n; ++i) {
+            for (std::size_t j = 0; j < n; ++j) {
+                double sum = 0;
+                for (std::size_t k = 0; k < n; ++k) {
+                    sum += a[i][k] * b[k][j];
+                }
+                c[i][j] = sum;
+            }
+        }
+        benchmark::DoNotOptimize(c[0][0]);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0) *
+                            state.range(0) * state.range(0));
+}
+BENCHMARK(BM_nested_vector_multiply)->Arg(64)->Arg(256);
+
+static void BM_algo_gemm(benchmark::State& state) {
+    const std::size_t n = std::size_t(state.range(0));
+    const algo::Matrix<double> a = makeMatrix(n);
+    const algo::Matrix<double> b = makeMatrix(n);
+    algo::Matrix<double> c(n, n);
+    for (auto _ : state) {
+        algo::gemm(1.0, a.view(), b.view(), 0.0, c.view());
+        benchmark::DoNotOptimize(c(0, 0));
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0) *
+                            state.range(0) * state.range(0));
+}
+BENCHMARK(BM_algo_gemm)->Arg(64)->Arg(256);
+
+static void BM_algo_gemv(benchmark::State& state) {
+    const std::size_t n = std::size_t(state.range(0));
+    const algo::Matrix<double> a = makeMatrix(n);
+    algo::Vector<double> x(n, 1.0);
+    algo::Vector<double> y(n, 0.0);
+    for (auto _ : state) {
+        algo::gemv(1.0, a.view(), x, 0.0, y);
+        benchmark::DoNotOptimize(y[0]);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0) *
+                            state.range(0));
+}
+BENCHMARK(BM_algo_gemv)->Arg(256)->Arg(1024);
+
+static void BM_algo_transpose(benchmark::State& state) {
+    const std::size_t n = std::size_t(state.range(0));
+    const algo::Matrix<double> a = makeMatrix(n);
+    algo::Matrix<double> t(n, n);
+    for (auto _ : state) {
+        algo::transpose(a.view(), t.view());
+        benchmark::DoNotOptimize(t(0, 0));
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0) *
+                            state.range(0) * int64_t(sizeof(double)));
+}
+BENCHMARK(BM_algo_transpose)->Arg(256)->Arg(1024);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,59 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <queue>
+#include <random>
+#include <utility>
+#include <vector>
+#include "merge.hpp"
+
+static algo::Vector<algo::Vector<std::uint64_t>> makeRuns(std::size_t count) {
+    std::mt19937_64 gen(1);
+    const std::size_t total = 1 << 20;
+    algo::Vector<algo::Vector<std::uint64_t>> runs(count);
+    for (auto& run : runs) {
+        for (std::size_t i = 0; i < total / count; ++i) {
+            run.push_back(gen());
+        }
+        std::sort(run.begin(), run.end());
+    }
+    return runs;
+}
+
+static void BM_priority_queue_merge(benchmark::State& state) {
+    const auto runs = makeRuns(std::size_t(state.range(0)));
+    using Cursor = std::pair<std::uint64_t, std::size_t>;
+    algo::Vector<std::uint64_t> out;
+    for (auto _ : state) {
+        out.clear();
+        std::vector<std::size_t> pos(runs.size(), 0);
+        std::priority_queue<Cursor, std::vector<Cursor>, std::greater<>> heap;
+        for (std::size_t r = 0; r < runs.size(); ++r) {
+            heap.push({runs[r][0], r});
+        }
+        while (!heap.empty()) {
+            const std::size_t r = heap.top().second;
+            out.push_back(heap.top().first);
+            heap.pop();
+            if (++pos[r] < runs[r].size()) {
+                heap.push({runs[r][pos[r]], r});
+            }
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * (1 << 20));
+}
+BENCHMARK(BM_priority_queue_merge)->Arg(2)->Arg(16)->Arg(256);
+
+static void BM_algo_kway_merge(benchmark::State& state) {
+    const auto runs = makeRuns(std::size_t(state.range(0)));
+    algo::Vector<std::uint64_t> out;
+    for (auto _ : state) {
+        algo::kway_merge(runs, out);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * (1 << 20));
+}
+BENCHMARK(BM_algo_kway_merge)->Arg(2)->Arg(16)->Arg(256);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,66 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <random>
+#include "selection.hpp"
+
+static algo::Vector<float> makeValues(std::size_t n) {
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+    algo::Vector<float> v;
+    for (std::size_t i = 0; i < n; ++i) {
+        v.push_back(value(gen));
+    }
+    return v;
+}
+
+static void BM_std_nth_element(benchmark::State& state) {
+    const algo::Vector<float> values = makeValues(std::size_t(state.range(0)));
+    algo::Vector<float> v;
+    for (auto _ : state) {
+        v = values;
+        std::nth_element(v.begin(), v.begin() + v.size() / 2, v.end());
+        benchmark::DoNotOptimize(v[v.size() / 2]);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_std_nth_element)->Arg(1 << 12)->Arg(1 << 20);
+
+static void BM_algo_nth_element(benchmark::State& state) {
+    const algo::Vector<float> values = makeValues(std::size_t(state.range(0)));
+    algo::Vector<float> v;
+    for (auto _ : state) {
+        v = values;
+        algo::nth_element(v.begin(), v.begin() + v.size() / 2, v.end());
+        benchmark::DoNotOptimize(v[v.size() / 2]);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_algo_nth_element)->Arg(1 << 12)->Arg(1 << 20);
+
+static void BM_std_partial_sort_top_k(benchmark::State& state) {
+    const algo::Vector<float> values = makeValues(1 << 20);
+    const std::size_t k = std::size_t(state.range(0));
+    algo::Vector<float> v;
+    for (auto _ : state) {
+        v = values;
+        std::partial_sort(v.begin(), v.begin() + k, v.end(),
+                          std::greater<>());
+        benchmark::DoNotOptimize(v[0]);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * (1 << 20));
+}
+BENCHMARK(BM_std_partial_sort_top_k)->Arg(10)->Arg(10000);
+
+static void BM_algo_top_k(benchmark::State& state) {
+    const algo::Vector<float> values = makeValues(1 << 20);
+    const std::size_t k = std::size_t(state.range(0));
+    for (auto _ : state) {
+        algo::Vector<float> top = algo::top_k(values, k);
+        benchmark::DoNotOptimize(top[0]);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * (1 << 20));
+}
+BENCHMARK(BM_algo_top_k)->Arg(10)->Arg(10000);
+
+BENCHMARK_MAIN();
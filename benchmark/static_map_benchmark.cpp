@@ -0,0 +1,129 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "static_map.hpp"
+
+namespace {
+constexpr std::size_t lookups = 1 << 16;
+
+// HTTP header names, and a stream of lookups of which one in eight misses.
+struct Keywords {
+    algo::Vector<std::string> names;
+    algo::Vector<int> ids;
+    algo::Vector<std::string_view> probes;
+};
+
+const Keywords& keywords() {
+    static const Keywords k = [] {
+        Keywords k;
+        for (const char* name :
+             {"accept", "accept-encoding", "accept-language", "age",
+              "authorization", "cache-control", "connection",
+              "content-encoding", "content-length", "content-type", "cookie",
+              "date", "etag", "expires", "host", "if-match",
+              "if-modified-since", "if-none-match", "last-modified",
+              "location", "origin", "pragma", "range", "referer", "server",
+              "set-cookie", "transfer-encoding", "upgrade", "user-agent",
+              "vary", "via", "www-authenticate"}) {
+            k.ids.push_back(int(k.names.size()));
+            k.names.push_back(name);
+        }
+        std::mt19937_64 gen(1);
+        for (std::size_t i = 0; i < lookups; ++i) {
+            k.probes.push_back(gen() % 8 == 0
+                                   ? std::string_view("x-forwarded-for")
+                                   : std::string_view(
+                                         k.names[gen() % k.names.size()]));
+        }
+        return k;
+    }();
+    return k;
+}
+
+// Lookups of random keys among `i * 0x9E3779B97F4A7C15` for `i < n`.
+algo::Vector<std::uint64_t> integerProbes(std::size_t n) {
+    std::mt19937_64 gen(2);
+    algo::Vector<std::uint64_t> probes;
+    for (std::size_t i = 0; i < lookups; ++i) {
+        probes.push_back(gen() % n * 0x9E3779B97F4A7C15ULL);
+    }
+    return probes;
+}
+} // namespace
+
+static void BM_unordered_map_keywords(benchmark::State& state) {
+    const Keywords& k = keywords();
+    std::unordered_map<std::string_view, int> map;
+    for (std::size_t i = 0; i < k.names.size(); ++i) {
+        map.emplace(k.names[i], k.ids[i]);
+    }
+    for (auto _ : state) {
+        int sum = 0;
+        for (std::string_view probe : k.probes) {
+            const auto it = map.find(probe);
+            sum += it != map.end() ? it->second : -1;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * lookups);
+}
+BENCHMARK(BM_unordered_map_keywords);
+
+static void BM_static_map_keywords(benchmark::State& state) {
+    const Keywords& k = keywords();
+    const algo::StaticMap<std::string, int> map(k.names, k.ids);
+    for (auto _ : state) {
+        int sum = 0;
+        for (std::string_view probe : k.probes) {
+            const int* id = map.find(probe);
+            sum += id != nullptr ? *id : -1;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * lookups);
+}
+BENCHMARK(BM_static_map_keywords);
+
+static void BM_unordered_map_integers(benchmark::State& state) {
+    const std::size_t n = std::size_t(state.range(0));
+    std::unordered_map<std::uint64_t, std::uint32_t> map;
+    for (std::uint64_t i = 0; i < n; ++i) {
+        map.emplace(i * 0x9E3779B97F4A7C15ULL, std::uint32_t(i));
+    }
+    const algo::Vector<std::uint64_t> probes = integerProbes(n);
+    for (auto _ : state) {
+        std::uint64_t sum = 0;
+        for (std::uint64_t probe : probes) {
+            sum += map.find(probe)->second;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * lookups);
+}
+BENCHMARK(BM_unordered_map_integers)->Arg(1000)->Arg(1 << 20);
+
+static void BM_static_map_integers(benchmark::State& state) {
+    const std::size_t n = std::size_t(state.range(0));
+    algo::Vector<std::uint64_t> keys;
+    algo::Vector<std::uint32_t> values;
+    for (std::uint64_t i = 0; i < n; ++i) {
+        keys.push_back(i * 0x9E3779B97F4A7C15ULL);
+        values.push_back(std::uint32_t(i));
+    }
+    const algo::StaticMap<std::uint64_t, std::uint32_t> map(keys, values);
+    const algo::Vector<std::uint64_t> probes = integerProbes(n);
+    for (auto _ : state) {
+        std::uint64_t sum = 0;
+        for (std::uint64_t probe : probes) {
+            sum += *map.find(probe);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * lookups);
+}
+BENCHMARK(BM_static_map_integers)->Arg(1000)->Arg(1 << 20);
+
+BENCHMARK_MAIN();
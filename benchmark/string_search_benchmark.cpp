@@ -0,0 +1,125 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "string_search.hpp"
+
+// A haystack of random lowercase words whose only occurrence of the needle is
+// at the very end.
+static std::string makeHaystack(std::size_t n, const std::string& needle) {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::uniform_int_distribution<int> word(1, 9);
+    std::string text;
+    text.reserve(n + needle.size());
+    while (text.size() < n) {
+        for (int i = word(gen); i > 0; --i) {
+            text.push_back(char(letter(gen)));
+        }
+        text.push_back(' ');
+    }
+    text.resize(n);
+    text += needle;
+    return text;
+}
+
+static const std::string needle = "connection refused";
+
+static void BM_std_string_find(benchmark::State& state) {
+    const std::string text = makeHaystack(std::size_t(state.range(0)), needle);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(text.find(needle));
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_std_string_find)->Arg(1 << 10)->Arg(1 << 20);
+
+static void BM_std_search(benchmark::State& state) {
+    const std::string text = makeHaystack(std::size_t(state.range(0)), needle);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(std::search(text.begin(), text.end(),
+                                             needle.begin(), needle.end()));
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_std_search)->Arg(1 << 10)->Arg(1 << 20);
+
+static void BM_algo_find_substring(benchmark::State& state) {
+    const std::string text = makeHaystack(std::size_t(state.range(0)), needle);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(algo::find_substring(text, needle));
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_algo_find_substring)->Arg(1 << 10)->Arg(1 << 20);
+
+// Multi-pattern matching of random words against log-like lines.
+static std::vector<std::string> makePatterns(std::size_t n) {
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::uniform_int_distribution<int> length(5, 12);
+    std::vector<std::string> patterns(n);
+    for (auto& p : patterns) {
+        p.resize(std::size_t(length(gen)));
+        for (char& c : p) {
+            c = char(letter(gen));
+        }
+    }
+    return patterns;
+}
+
+static algo::AhoCorasick makeMatcher(const std::vector<std::string>& patterns) {
+    algo::Vector<std::string_view> views;
+    for (const auto& p : patterns) {
+        views.push_back(p);
+    }
+    return algo::AhoCorasick(views);
+}
+
+static void BM_std_string_find_each_pattern(benchmark::State& state) {
+    const auto patterns = makePatterns(std::size_t(state.range(0)));
+    const std::string text = makeHaystack(1 << 16, "");
+    for (auto _ : state) {
+        std::size_t found = 0;
+        for (const auto& p : patterns) {
+            found += text.find(p) != std::string::npos;
+        }
+        benchmark::DoNotOptimize(found);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * (1 << 16));
+}
+BENCHMARK(BM_std_string_find_each_pattern)->Arg(16)->Arg(1000);
+
+static void BM_algo_aho_corasick(benchmark::State& state) {
+    const auto patterns = makePatterns(std::size_t(state.range(0)));
+    const algo::AhoCorasick ac = makeMatcher(patterns);
+    const std::string text = makeHaystack(1 << 16, "");
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ac.count_matches(text));
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * (1 << 16));
+}
+BENCHMARK(BM_algo_aho_corasick)->Arg(16)->Arg(1000);
+
+static void BM_algo_aho_corasick_batch(benchmark::State& state) {
+    const auto patterns = makePatterns(std::size_t(state.range(0)));
+    const algo::AhoCorasick ac = makeMatcher(patterns);
+    const std::string text = makeHaystack(1 << 16, "");
+    algo::Vector<std::string_view> lines;
+    for (std::size_t i = 0; i < text.size(); i += 128) {
+        lines.push_back(std::string_view(text).substr(i, 128));
+    }
+    for (auto _ : state) {
+        std::size_t n = 0;
+        ac.for_each_match(lines, [&n](std::size_t, std::uint32_t,
+                                      std::size_t) { ++n; });
+        benchmark::DoNotOptimize(n);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * (1 << 16));
+}
+BENCHMARK(BM_algo_aho_corasick_batch)->Arg(16)->Arg(1000);
+
+BENCHMARK_MAIN();
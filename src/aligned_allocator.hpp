@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+namespace algo {
+/// A stateless allocator returning `Alignment`-byte aligned storage.
+///
+/// `Matrix` uses it to start every row on a cache line, and direct I/O needs
+/// buffers aligned to the device block size.
+///
+/// # Example
+///
+/// ```cpp
+/// Vector<float, AlignedAllocator<float, 4096>> page_aligned(1024);
+/// assert(reinterpret_cast<std::uintptr_t>(page_aligned.data()) % 4096 == 0);
+/// ```
+template <typename T, std::size_t Alignment>
+struct AlignedAllocator {
+    static_assert((Alignment & (Alignment - 1)) == 0,
+                  "Alignment must be a power of two");
+
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() noexcept = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(
+            ::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    void deallocate(T* p, std::size_t) noexcept {
+        ::operator delete(p, std::align_val_t(Alignment));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept {
+        return false;
+    }
+};
+} // namespace algo
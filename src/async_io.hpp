@@ -0,0 +1,525 @@
+#pragma once
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "file_io.hpp"
+#include "thread_pool.hpp"
+#include "vector.hpp"
+
+namespace algo {
+namespace detail {
+struct IoCompletion {
+    std::uint32_t slot;
+    std::int64_t result;
+};
+
+// A minimal io_uring driven by raw system calls: the submission queue, the
+// completion queue and the submission entries are shared with the kernel
+// through `mmap()`.
+class IoUring {
+public:
+    // Sets up a ring of `entries` requests. Throws `std::system_error` if the
+    // kernel refuses or predates the plain read and write operations.
+    explicit IoUring(unsigned entries) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        fd_ = int(::syscall(__NR_io_uring_setup, entries, &params));
+        if (fd_ < 0) {
+            throw std::system_error(errno, std::generic_category(),
+                                    "io_uring_setup");
+        }
+        // Fast poll arrived in Linux 5.7, after IORING_OP_READ and _WRITE.
+        if (!(params.features & IORING_FEAT_FAST_POLL)) {
+            release();
+            throw std::system_error(ENOSYS, std::generic_category(),
+                                    "io_uring too old");
+        }
+
+        sq_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_size_ = params.cq_off.cqes +
+                   params.cq_entries * sizeof(io_uring_cqe);
+        const bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single) {
+            sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+        }
+        sq_ptr_ = map(sq_size_, IORING_OFF_SQ_RING);
+        cq_ptr_ = single ? sq_ptr_ : map(cq_size_, IORING_OFF_CQ_RING);
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(map(sqes_size_, IORING_OFF_SQES));
+
+        char* sq = static_cast<char*>(sq_ptr_);
+        sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        char* cq = static_cast<char*>(cq_ptr_);
+        cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    }
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    ~IoUring() noexcept {
+        release();
+    }
+
+    // Queues a request; the caller keeps fewer requests in flight than the
+    // ring has entries.
+    void push(std::uint8_t opcode, int fd, const void* buf, unsigned bytes,
+              std::uint64_t offset, std::uint64_t user_data) noexcept {
+        const unsigned tail = *sq_tail_;
+        const unsigned index = tail & sq_mask_;
+        io_uring_sqe& sqe = sqes_[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = opcode;
+        sqe.fd = fd;
+        sqe.addr = reinterpret_cast<std::uint64_t>(buf);
+        sqe.len = bytes;
+        sqe.off = offset;
+        sqe.user_data = user_data;
+        sq_array_[index] = index;
+        __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+        ++pending_;
+    }
+
+    // Submits the queued requests and, if `wait` is set, blocks until at
+    // least one request has completed.
+    void enter(bool wait) {
+        for (;;) {
+            const int r = int(::syscall(__NR_io_uring_enter, fd_, pending_,
+                                        wait ? 1u : 0u,
+                                        wait ? IORING_ENTER_GETEVENTS : 0u,
+                                        nullptr, 0));
+            if (r >= 0) {
+                pending_ -= unsigned(r);
+                return;
+            }
+            if (errno != EINTR) {
+                throw std::system_error(errno, std::generic_category(),
+                                        "io_uring_enter");
+            }
+        }
+    }
+
+    // Moves the finished requests to `out`.
+    void reap(Vector<IoCompletion>& out) {
+        unsigned head = *cq_head_;
+        const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head) {
+            const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+            out.push_back({std::uint32_t(cqe.user_data), cqe.res});
+        }
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    }
+
+private:
+    void* map(std::size_t size, off_t offset) {
+        void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, fd_, offset);
+        if (p == MAP_FAILED) {
+            const int error = errno;
+            release();
+            throw std::system_error(error, std::generic_category(),
+                                    "io_uring mmap");
+        }
+        return p;
+    }
+
+    void release() noexcept {
+        if (sqes_) {
+            ::munmap(sqes_, sqes_size_);
+        }
+        if (cq_ptr_ && cq_ptr_ != sq_ptr_) {
+            ::munmap(cq_ptr_, cq_size_);
+        }
+        if (sq_ptr_) {
+            ::munmap(sq_ptr_, sq_size_);
+        }
+        ::close(fd_);
+    }
+
+private:
+    int fd_ = -1;
+    unsigned pending_ = 0;
+    void* sq_ptr_ = nullptr;
+    void* cq_ptr_ = nullptr;
+    io_uring_sqe* sqes_ = nullptr;
+    std::size_t sq_size_ = 0;
+    std::size_t cq_size_ = 0;
+    std::size_t sqes_size_ = 0;
+    unsigned* sq_tail_ = nullptr;
+    unsigned* sq_array_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+};
+
+// Opens `path` for direct I/O if asked and the file system allows it.
+inline FileDescriptor openForIo(const std::string& path, int flags,
+                                bool direct) {
+    if (direct) {
+        try {
+            return FileDescriptor(path, flags | O_DIRECT);
+        } catch (const std::system_error& e) {
+            if (e.code() != std::errc::invalid_argument) {
+                throw;
+            }
+        }
+    }
+    return FileDescriptor(path, flags);
+}
+} // namespace detail
+
+/// Keeps many reads and writes in flight at once, to use the queue depth of
+/// fast storage from a single thread.
+///
+/// Requests go through an io_uring set up with raw system calls, which needs
+/// Linux 5.7. Where it is unavailable or not wanted, a pool of threads runs
+/// blocking `pread()` and `pwrite()` calls instead. Either way, the
+/// completion callbacks run on the thread calling `poll()` or `wait()`, or
+/// submitting while the queue is full, so they need no locking. The buffer of
+/// a request must stay valid until its callback has run.
+///
+/// `load()` and `store()` move whole `Vector`s in chunks of `chunk_bytes`,
+/// optionally with `O_DIRECT` to bypass the page cache.
+///
+/// # Example
+///
+/// ```cpp
+/// AsyncIo io(128);
+/// Vector<Vector<char>> blocks(16, Vector<char>(1 << 20));
+/// for (std::size_t i = 0; i < blocks.size(); ++i) {
+///     io.read(fd, blocks[i].data(), 1 << 20, i << 20,
+///             [](std::int64_t bytes) { assert(bytes >= 0); });
+/// }
+/// io.wait();
+/// ```
+class AsyncIo {
+public:
+    using SizeType = std::size_t;
+    /// Receives the number of bytes transferred, or `-errno` on failure.
+    using Callback = std::function<void(std::int64_t)>;
+
+    enum class Backend { io_uring, thread_pool };
+
+    /// The size of the requests `load()` and `store()` split buffers into.
+    static constexpr SizeType chunk_bytes = SizeType(1) << 20;
+    /// The alignment of buffers, offsets and sizes for direct I/O.
+    static constexpr SizeType direct_alignment = 4096;
+
+    /// Starts an engine keeping up to `queue_depth` requests in flight,
+    /// falling back to a thread pool if `preferred` is `Backend::io_uring`
+    /// but the kernel does not support it.
+    explicit AsyncIo(unsigned queue_depth = 64,
+                     Backend preferred = Backend::io_uring)
+        : depth_(std::max(queue_depth, 1u)), callbacks_(depth_) {
+        for (std::uint32_t slot = depth_; slot > 0; --slot) {
+            free_.push_back(slot - 1);
+        }
+        if (preferred == Backend::io_uring) {
+            try {
+                ring_.emplace(depth_);
+            } catch (const std::system_error&) {
+            }
+        }
+        if (!ring_) {
+            pool_.emplace(std::min(depth_, 16u));
+        }
+    }
+
+    AsyncIo(const AsyncIo&) = delete;
+    AsyncIo& operator=(const AsyncIo&) = delete;
+
+    /// Waits for the requests in flight, dropping their callbacks.
+    ~AsyncIo() noexcept {
+        try {
+            while (in_flight_ > 0) {
+                complete(true, false);
+            }
+        } catch (...) {
+        }
+    }
+
+    /// Returns the backend in use.
+    [[nodiscard]] Backend backend() const noexcept {
+        return ring_ ? Backend::io_uring : Backend::thread_pool;
+    }
+
+    /// Returns the number of requests whose callbacks have not run yet.
+    [[nodiscard]] SizeType in_flight() const noexcept {
+        return in_flight_;
+    }
+
+    /// Reads up to `bytes` bytes at `offset` of `fd` into `buf` and passes
+    /// the result to `done`. Like `pread()`, the read may be short.
+    ///
+    /// Throws `std::invalid_argument` if `bytes` exceeds 1 GiB.
+    void read(int fd, void* buf, SizeType bytes, std::uint64_t offset,
+              Callback done) {
+        submit(IORING_OP_READ, fd, buf, bytes, offset, std::move(done));
+    }
+
+    /// Writes up to `bytes` bytes of `buf` at `offset` of `fd` and passes the
+    /// result to `done`. Like `pwrite()`, the write may be short.
+    ///
+    /// Throws `std::invalid_argument` if `bytes` exceeds 1 GiB.
+    void write(int fd, const void* buf, SizeType bytes, std::uint64_t offset,
+               Callback done) {
+        submit(IORING_OP_WRITE, fd, const_cast<void*>(buf), bytes, offset,
+               std::move(done));
+    }
+
+    /// Runs the callbacks of the finished requests without blocking and
+    /// returns how many ran.
+    SizeType poll() {
+        return complete(false, true);
+    }
+
+    /// Runs callbacks until no request is in flight, including the requests
+    /// the callbacks submit.
+    ///
+    /// If callbacks throw, the first exception is rethrown after the other
+    /// callbacks of the same batch have run.
+    void wait() {
+        while (in_flight_ > 0) {
+            complete(true, true);
+        }
+    }
+
+    /// Replaces the contents of `v` with the raw values stored in the file at
+    /// `path`, reading all chunks in parallel.
+    ///
+    /// With `direct`, the file is read with `O_DIRECT` if its file system
+    /// allows it, which needs the storage of `v` to be aligned to
+    /// `direct_alignment`, e.g. with `AlignedAllocator`. `v` then gets room
+    /// for the last block in full.
+    ///
+    /// Throws `std::runtime_error` if the file size is not a multiple of
+    /// `sizeof(T)`, `std::invalid_argument` if `direct` is set and the
+    /// storage is misaligned, and `std::system_error` if I/O fails.
+    template <typename T, typename Alloc>
+    void load(const std::string& path, Vector<T, Alloc>& v,
+              bool direct = false) {
+        static_assert(std::is_trivially_copyable_v<T>,
+                      "AsyncIo::load needs trivially copyable values");
+        detail::FileDescriptor fd =
+            detail::openForIo(path, O_RDONLY, direct);
+        struct stat st;
+        if (::fstat(fd.get(), &st) != 0) {
+            throw std::system_error(errno, std::generic_category(),
+                                    "AsyncIo: stat " + path);
+        }
+        const SizeType bytes = SizeType(st.st_size);
+        if (bytes % sizeof(T) != 0) {
+            throw std::runtime_error(
+                "AsyncIo: file size is not a multiple of the value size");
+        }
+        const SizeType room = direct ? roundUp(bytes) : bytes;
+        v.clear();
+        v.resize_and_overwrite(
+            (room + sizeof(T) - 1) / sizeof(T), [&](T* p, SizeType) {
+                checkAlignment(p, bytes, direct);
+                transfer(IORING_OP_READ, fd.get(), reinterpret_cast<char*>(p),
+                         0, bytes, direct);
+                return bytes / sizeof(T);
+            });
+    }
+
+    /// Writes the values of `v` to the file at `path`, replacing its
+    /// contents, with all chunks in parallel.
+    ///
+    /// With `direct`, the file is written with `O_DIRECT` if its file system
+    /// allows it, which needs the storage of `v` to be aligned to
+    /// `direct_alignment`. The last partial block goes through the page
+    /// cache.
+    ///
+    /// Throws `std::invalid_argument` if `direct` is set and the storage is
+    /// misaligned, and `std::system_error` if I/O fails.
+    template <typename T, typename Alloc>
+    void store(const std::string& path, const Vector<T, Alloc>& v,
+               bool direct = false) {
+        static_assert(std::is_trivially_copyable_v<T>,
+                      "AsyncIo::store needs trivially copyable values");
+        const SizeType bytes = v.size() * sizeof(T);
+        const char* data = reinterpret_cast<const char*>(v.data());
+        checkAlignment(data, bytes, direct);
+        detail::FileDescriptor fd =
+            detail::openForIo(path, O_WRONLY | O_CREAT | O_TRUNC, direct);
+        const SizeType aligned =
+            direct ? bytes / direct_alignment * direct_alignment : bytes;
+        transfer(IORING_OP_WRITE, fd.get(), const_cast<char*>(data), 0,
+                 aligned, false);
+        if (aligned < bytes) {
+            detail::FileDescriptor tail(path, O_WRONLY);
+            transfer(IORING_OP_WRITE, tail.get(), const_cast<char*>(data),
+                     aligned, bytes, false);
+        }
+    }
+
+private:
+    static SizeType roundUp(SizeType bytes) noexcept {
+        return (bytes + direct_alignment - 1) / direct_alignment *
+               direct_alignment;
+    }
+
+    static void checkAlignment(const void* p, SizeType bytes, bool direct) {
+        if (direct && bytes > 0 &&
+            reinterpret_cast<std::uintptr_t>(p) % direct_alignment != 0) {
+            throw std::invalid_argument(
+                "AsyncIo: direct I/O needs aligned storage");
+        }
+    }
+
+    void submit(std::uint8_t opcode, int fd, void* buf, SizeType bytes,
+                std::uint64_t offset, Callback done) {
+        if (bytes > (SizeType(1) << 30)) {
+            throw std::invalid_argument("AsyncIo: request too large");
+        }
+        while (in_flight_ == depth_) {
+            complete(true, true);
+        }
+        const std::uint32_t slot = free_.back();
+        free_.pop_back();
+        callbacks_[slot] = std::move(done);
+        ++in_flight_;
+        if (ring_) {
+            ring_->push(opcode, fd, buf, unsigned(bytes), offset, slot);
+            ring_->enter(false);
+            return;
+        }
+        pool_->submit([this, opcode, fd, buf, bytes, offset, slot] {
+            ssize_t r;
+            do {
+                r = opcode == IORING_OP_READ
+                        ? ::pread(fd, buf, bytes, off_t(offset))
+                        : ::pwrite(fd, buf, bytes, off_t(offset));
+            } while (r < 0 && errno == EINTR);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                done_.push_back({slot, r < 0 ? -std::int64_t(errno) : r});
+            }
+            cv_.notify_one();
+        });
+    }
+
+    // Collects finished requests, waiting for one if `block` is set, frees
+    // their slots and then runs their callbacks if `run` is set.
+    SizeType complete(bool block, bool run) {
+        Vector<detail::IoCompletion> finished;
+        if (ring_) {
+            if (block) {
+                ring_->enter(true);
+            }
+            ring_->reap(finished);
+        } else {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (block) {
+                cv_.wait(lock, [this] { return !done_.empty(); });
+            }
+            for (const detail::IoCompletion& c : done_) {
+                finished.push_back(c);
+            }
+            done_.clear();
+        }
+
+        Vector<Callback> callbacks;
+        callbacks.reserve(finished.size());
+        for (const detail::IoCompletion& c : finished) {
+            callbacks.push_back(std::move(callbacks_[c.slot]));
+            free_.push_back(c.slot);
+            --in_flight_;
+        }
+        if (!run) {
+            return finished.size();
+        }
+        // Callbacks may submit requests, so they run after the bookkeeping.
+        std::exception_ptr error;
+        for (SizeType i = 0; i < finished.size(); ++i) {
+            try {
+                callbacks[i](finished[i].result);
+            } catch (...) {
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return finished.size();
+    }
+
+    // Transfers bytes `[first, last)` between `base` and the same offsets of
+    // `fd` in parallel chunks, resubmitting the rest of short transfers. A
+    // `padded` read asks for whole aligned blocks past `last`.
+    void transfer(std::uint8_t opcode, int fd, char* base, SizeType first,
+                  SizeType last, bool padded) {
+        int error = 0;
+        for (SizeType at = first; at < last; at += chunk_bytes) {
+            const SizeType end = std::min(at + chunk_bytes, last);
+            const SizeType len =
+                padded ? std::min(chunk_bytes, roundUp(last) - at) : end - at;
+            transferChunk(opcode, fd, base, at, len, end, error);
+        }
+        wait();
+        if (error != 0) {
+            throw std::system_error(error, std::generic_category(),
+                                    opcode == IORING_OP_READ
+                                        ? "AsyncIo: read"
+                                        : "AsyncIo: write");
+        }
+    }
+
+    void transferChunk(std::uint8_t opcode, int fd, char* base, SizeType at,
+                       SizeType len, SizeType end, int& error) {
+        auto done = [this, opcode, fd, base, at, len, end,
+                     &error](std::int64_t r) {
+            if (r < 0) {
+                error = error != 0 ? error : int(-r);
+            } else if (r == 0 && at < end) {
+                error = error != 0 ? error : EIO;
+            } else if (at + SizeType(r) < end) {
+                transferChunk(opcode, fd, base, at + SizeType(r),
+                              len - SizeType(r), end, error);
+            }
+        };
+        submit(opcode, fd, base + at, len, at, std::move(done));
+    }
+
+private:
+    std::uint32_t depth_;
+    std::vector<Callback> callbacks_;
+    Vector<std::uint32_t> free_;
+    SizeType in_flight_ = 0;
+    std::optional<detail::IoUring> ring_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<detail::IoCompletion> done_;
+    // Declared last, so that the workers are joined before the rest goes.
+    std::optional<ThreadPool> pool_;
+};
+} // namespace algo
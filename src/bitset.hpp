@@ -0,0 +1,938 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include "simd.hpp"
+#include "vector.hpp"
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace algo {
+namespace detail {
+// Word-wise set algebra over `n` words, `dst = op(dst, src)`, one AVX-512 or
+// AVX2 register at a time when the build enables them.
+struct AndWords {
+    static std::uint64_t apply(std::uint64_t a, std::uint64_t b) noexcept {
+        return a & b;
+    }
+#if defined(__AVX512F__)
+    static __m512i apply(__m512i a, __m512i b) noexcept {
+        return _mm512_and_si512(a, b);
+    }
+#endif
+#if defined(__AVX2__)
+    static __m256i apply(__m256i a, __m256i b) noexcept {
+        return _mm256_and_si256(a, b);
+    }
+#endif
+};
+
+struct OrWords {
+    static std::uint64_t apply(std::uint64_t a, std::uint64_t b) noexcept {
+        return a | b;
+    }
+#if defined(__AVX512F__)
+    static __m512i apply(__m512i a, __m512i b) noexcept {
+        return _mm512_or_si512(a, b);
+    }
+#endif
+#if defined(__AVX2__)
+    static __m256i apply(__m256i a, __m256i b) noexcept {
+        return _mm256_or_si256(a, b);
+    }
+#endif
+};
+
+struct XorWords {
+    static std::uint64_t apply(std::uint64_t a, std::uint64_t b) noexcept {
+        return a ^ b;
+    }
+#if defined(__AVX512F__)
+    static __m512i apply(__m512i a, __m512i b) noexcept {
+        return _mm512_xor_si512(a, b);
+    }
+#endif
+#if defined(__AVX2__)
+    static __m256i apply(__m256i a, __m256i b) noexcept {
+        return _mm256_xor_si256(a, b);
+    }
+#endif
+};
+
+struct AndNotWords {
+    static std::uint64_t apply(std::uint64_t a, std::uint64_t b) noexcept {
+        return a & ~b;
+    }
+#if defined(__AVX512F__)
+    static __m512i apply(__m512i a, __m512i b) noexcept {
+        return _mm512_andnot_si512(b, a);
+    }
+#endif
+#if defined(__AVX2__)
+    static __m256i apply(__m256i a, __m256i b) noexcept {
+        return _mm256_andnot_si256(b, a);
+    }
+#endif
+};
+
+template <typename Op>
+void applyWords(std::uint64_t* dst, const std::uint64_t* src,
+                std::size_t n) noexcept {
+    std::size_t i = 0;
+#if defined(__AVX512F__)
+    for (; i + 8 <= n; i += 8) {
+        const __m512i a = _mm512_loadu_si512(dst + i);
+        const __m512i b = _mm512_loadu_si512(src + i);
+        _mm512_storeu_si512(dst + i, Op::apply(a, b));
+    }
+#endif
+#if defined(__AVX2__)
+    for (; i + 4 <= n; i += 4) {
+        auto* d = reinterpret_cast<__m256i*>(dst + i);
+        const auto* s = reinterpret_cast<const __m256i*>(src + i);
+        _mm256_storeu_si256(
+            d, Op::apply(_mm256_loadu_si256(d), _mm256_loadu_si256(s)));
+    }
+#endif
+    for (; i < n; ++i) {
+        dst[i] = Op::apply(dst[i], src[i]);
+    }
+}
+
+inline int popcount64(std::uint64_t x) noexcept {
+    return __builtin_popcountll(x);
+}
+
+inline std::size_t popcountWordsScalar(const std::uint64_t* p,
+                                       std::size_t n) noexcept {
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        total += std::size_t(popcount64(p[i]));
+    }
+    return total;
+}
+
+#if defined(ALGO_SIMD_X86)
+// The bit-slicing popcount on two words at a time, `psadbw` summing the
+// bytes of every word.
+__attribute__((target("sse2"))) inline std::size_t
+popcountWordsSse2(const std::uint64_t* p, std::size_t n) noexcept {
+    const __m128i m1 = _mm_set1_epi8(0x55);
+    const __m128i m2 = _mm_set1_epi8(0x33);
+    const __m128i m4 = _mm_set1_epi8(0x0f);
+    __m128i acc = _mm_setzero_si128();
+    std::size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        v = _mm_sub_epi8(v, _mm_and_si128(_mm_srli_epi64(v, 1), m1));
+        v = _mm_add_epi8(_mm_and_si128(v, m2),
+                         _mm_and_si128(_mm_srli_epi64(v, 2), m2));
+        v = _mm_and_si128(_mm_add_epi8(v, _mm_srli_epi64(v, 4)), m4);
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(v, _mm_setzero_si128()));
+    }
+    alignas(16) std::uint64_t lanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    return std::size_t(lanes[0] + lanes[1]) + popcountWordsScalar(p + i, n - i);
+}
+
+// Mula's nibble lookup: `vpshufb` counts the bits of every nibble and
+// `vpsadbw` sums the bytes of every word.
+__attribute__((target("avx2"))) inline std::size_t
+popcountWordsAvx2(const std::uint64_t* p, std::size_t n) noexcept {
+    const __m256i lookup =
+        _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1,
+                         1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_mask = _mm256_set1_epi8(0x0f);
+    __m256i acc = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m256i v =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        const __m256i lo = _mm256_and_si256(v, low_mask);
+        const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+        const __m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo),
+                                              _mm256_shuffle_epi8(lookup, hi));
+        acc = _mm256_add_epi64(
+            acc, _mm256_sad_epu8(bytes, _mm256_setzero_si256()));
+    }
+    alignas(32) std::uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    return std::size_t(lanes[0] + lanes[1] + lanes[2] + lanes[3]) +
+           popcountWordsScalar(p + i, n - i);
+}
+
+// The nibble lookup on AVX-512BW, eight words at a time.
+__attribute__((target("avx512f,avx512bw"))) inline std::size_t
+popcountWordsAvx512(const std::uint64_t* p, std::size_t n) noexcept {
+    // The bit counts of nibbles 0 to 15, one byte each, in every 128 bits.
+    const __m512i lookup =
+        _mm512_set4_epi64(0x0403030203020201, 0x0302020102010100,
+                          0x0403030203020201, 0x0302020102010100);
+    const __m512i low_mask = _mm512_set1_epi8(0x0f);
+    __m512i acc = _mm512_setzero_si512();
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m512i v = _mm512_loadu_si512(p + i);
+        const __m512i lo = _mm512_and_si512(v, low_mask);
+        const __m512i hi = _mm512_and_si512(_mm512_srli_epi16(v, 4), low_mask);
+        const __m512i bytes = _mm512_add_epi8(_mm512_shuffle_epi8(lookup, lo),
+                                              _mm512_shuffle_epi8(lookup, hi));
+        acc = _mm512_add_epi64(
+            acc, _mm512_sad_epu8(bytes, _mm512_setzero_si512()));
+    }
+    alignas(64) std::uint64_t lanes[8];
+    _mm512_store_si512(lanes, acc);
+    std::size_t total = 0;
+    for (std::uint64_t lane : lanes) {
+        total += std::size_t(lane);
+    }
+    return total + popcountWordsScalar(p + i, n - i);
+}
+
+inline const simd::Dispatch<std::size_t(const std::uint64_t*, std::size_t)>
+    popcount_words(popcountWordsScalar, popcountWordsSse2, popcountWordsAvx2,
+                   popcountWordsAvx512);
+#else
+inline const simd::Dispatch<std::size_t(const std::uint64_t*, std::size_t)>
+    popcount_words(popcountWordsScalar);
+#endif
+
+// Returns the number of one bits in `n` words. Builds which enable
+// AVX512-VPOPCNTDQ count inline; others pick a kernel for the running CPU.
+inline std::size_t popcountWords(const std::uint64_t* p,
+                                 std::size_t n) noexcept {
+#if defined(__AVX512VPOPCNTDQ__)
+    std::size_t i = 0;
+    __m512i acc = _mm512_setzero_si512();
+    for (; i + 8 <= n; i += 8) {
+        acc = _mm512_add_epi64(acc,
+                               _mm512_popcnt_epi64(_mm512_loadu_si512(p + i)));
+    }
+    return std::size_t(_mm512_reduce_add_epi64(acc)) +
+           popcountWordsScalar(p + i, n - i);
+#else
+    // Too few words to pay for the indirect call.
+    if (n < 8) {
+        return popcountWordsScalar(p, n);
+    }
+    return popcount_words(p, n);
+#endif
+}
+
+// Returns the position of the `r`-th (from 0) one bit of `w`, which must
+// have more than `r` ones.
+inline unsigned selectInWord(std::uint64_t w, unsigned r) noexcept {
+#if defined(__BMI2__)
+    return unsigned(__builtin_ctzll(_pdep_u64(std::uint64_t(1) << r, w)));
+#else
+    for (; r > 0; --r) {
+        w &= w - 1;
+    }
+    return unsigned(__builtin_ctzll(w));
+#endif
+}
+
+// Returns the first set bit at or after `pos` in `n` words, or `npos`.
+inline std::size_t findNextWords(const std::uint64_t* p, std::size_t n,
+                                 std::size_t pos, std::size_t npos) noexcept {
+    std::size_t i = pos / 64;
+    if (i >= n) {
+        return npos;
+    }
+    std::uint64_t w = p[i] & (~std::uint64_t(0) << (pos % 64));
+    while (w == 0) {
+        if (++i == n) {
+            return npos;
+        }
+        w = p[i];
+    }
+    return i * 64 + std::size_t(__builtin_ctzll(w));
+}
+
+template <typename F>
+void forEachSetWords(const std::uint64_t* p, std::size_t n, F& f) {
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::uint64_t w = p[i]; w != 0; w &= w - 1) {
+            f(i * 64 + std::size_t(__builtin_ctzll(w)));
+        }
+    }
+}
+} // namespace detail
+
+/// A fixed-size sequence of `N` bits.
+///
+/// Unlike `std::bitset`, the word-wise operations are vectorized with AVX2 or
+/// AVX-512 when the build enables them, `count()` picks a vectorized kernel
+/// for the running CPU, and the set bits can be visited with `find_next()` or
+/// `for_each_set()` at the cost of one `tzcnt` per bit.
+///
+/// The words live inline, aligned to a cache line.
+///
+/// # Example
+///
+/// ```cpp
+/// Bitset<256> a, b;
+/// a.set(3).set(200);
+/// b.set(200);
+/// a &= b;
+/// assert(a.count() == 1 && a.find_first() == 200);
+/// ```
+template <std::size_t N>
+class Bitset {
+public:
+    using SizeType = std::size_t;
+
+    /// Returned by `find_first()` and `find_next()` when there is no set bit.
+    static constexpr SizeType npos = std::numeric_limits<SizeType>::max();
+
+    /// Number of 64-bit words.
+    static constexpr SizeType word_count = (N + 63) / 64;
+
+    /// Constructs a bitset with all bits cleared.
+    constexpr Bitset() noexcept = default;
+
+    /// Returns the number of bits.
+    [[nodiscard]] constexpr SizeType size() const noexcept {
+        return N;
+    }
+
+    /// Returns the bit at `pos`.
+    [[nodiscard]] bool test(SizeType pos) const noexcept {
+        assert(pos < N);
+        return words_[pos / 64] >> (pos % 64) & 1;
+    }
+
+    /// Returns the bit at `pos`.
+    ///
+    /// Throws `std::out_of_range` if `pos >= size()`.
+    [[nodiscard]] bool at(SizeType pos) const {
+        if (pos >= N) {
+            throw std::out_of_range("Bitset: pos out of range");
+        }
+        return test(pos);
+    }
+
+    /// Sets the bit at `pos` to `value`.
+    Bitset& set(SizeType pos, bool value = true) noexcept {
+        assert(pos < N);
+        const std::uint64_t mask = std::uint64_t(1) << (pos % 64);
+        words_[pos / 64] = value ? words_[pos / 64] | mask
+                                 : words_[pos / 64] & ~mask;
+        return *this;
+    }
+
+    /// Sets all bits.
+    Bitset& set() noexcept {
+        words_.fill(~std::uint64_t(0));
+        trim();
+        return *this;
+    }
+
+    /// Clears the bit at `pos`.
+    Bitset& reset(SizeType pos) noexcept {
+        return set(pos, false);
+    }
+
+    /// Clears all bits.
+    Bitset& reset() noexcept {
+        words_.fill(0);
+        return *this;
+    }
+
+    /// Flips the bit at `pos`.
+    Bitset& flip(SizeType pos) noexcept {
+        assert(pos < N);
+        words_[pos / 64] ^= std::uint64_t(1) << (pos % 64);
+        return *this;
+    }
+
+    /// Flips all bits.
+    Bitset& flip() noexcept {
+        for (std::uint64_t& w : words_) {
+            w = ~w;
+        }
+        trim();
+        return *this;
+    }
+
+    /// Returns the number of set bits.
+    [[nodiscard]] SizeType count() const noexcept {
+        return detail::popcountWords(words_.data(), word_count);
+    }
+
+    /// Returns true if any bit is set.
+    [[nodiscard]] bool any() const noexcept {
+        return std::any_of(words_.begin(), words_.end(),
+                           [](std::uint64_t w) { return w != 0; });
+    }
+
+    /// Returns true if no bit is set.
+    [[nodiscard]] bool none() const noexcept {
+        return !any();
+    }
+
+    /// Returns true if all bits are set.
+    [[nodiscard]] bool all() const noexcept {
+        return count() == N;
+    }
+
+    /// Returns the position of the first set bit, or `npos`.
+    [[nodiscard]] SizeType find_first() const noexcept {
+        return detail::findNextWords(words_.data(), word_count, 0, npos);
+    }
+
+    /// Returns the position of the first set bit after `pos`, or `npos`.
+    [[nodiscard]] SizeType find_next(SizeType pos) const noexcept {
+        return detail::findNextWords(words_.data(), word_count, pos + 1, npos);
+    }
+
+    /// Calls `f(pos)` for every set bit in ascending order.
+    template <typename F>
+    void for_each_set(F&& f) const {
+        detail::forEachSetWords(words_.data(), word_count, f);
+    }
+
+    Bitset& operator&=(const Bitset& rhs) noexcept {
+        detail::applyWords<detail::AndWords>(words_.data(), rhs.words_.data(),
+                                             word_count);
+        return *this;
+    }
+
+    Bitset& operator|=(const Bitset& rhs) noexcept {
+        detail::applyWords<detail::OrWords>(words_.data(), rhs.words_.data(),
+                                            word_count);
+        return *this;
+    }
+
+    Bitset& operator^=(const Bitset& rhs) noexcept {
+        detail::applyWords<detail::XorWords>(words_.data(), rhs.words_.data(),
+                                             word_count);
+        return *this;
+    }
+
+    /// Clears the bits which are set in `rhs`, i.e. `*this &= ~rhs`.
+    Bitset& and_not(const Bitset& rhs) noexcept {
+        detail::applyWords<detail::AndNotWords>(words_.data(),
+                                                rhs.words_.data(), word_count);
+        return *this;
+    }
+
+    friend Bitset operator&(Bitset lhs, const Bitset& rhs) noexcept {
+        return lhs &= rhs;
+    }
+
+    friend Bitset operator|(Bitset lhs, const Bitset& rhs) noexcept {
+        return lhs |= rhs;
+    }
+
+    friend Bitset operator^(Bitset lhs, const Bitset& rhs) noexcept {
+        return lhs ^= rhs;
+    }
+
+    friend Bitset operator~(Bitset x) noexcept {
+        return x.flip();
+    }
+
+    friend bool operator==(const Bitset& x, const Bitset& y) noexcept {
+        return x.words_ == y.words_;
+    }
+
+    friend bool operator!=(const Bitset& x, const Bitset& y) noexcept {
+        return !(x == y);
+    }
+
+    /// Returns the underlying words, least significant bit first.
+    const std::uint64_t* words() const noexcept {
+        return words_.data();
+    }
+
+private:
+    // Keeps the unused high bits of the last word cleared.
+    void trim() noexcept {
+        if constexpr (N % 64 != 0) {
+            words_[word_count - 1] &= (std::uint64_t(1) << (N % 64)) - 1;
+        }
+    }
+
+private:
+    alignas(64) std::array<std::uint64_t, word_count> words_{};
+};
+
+/// A resizable sequence of bits stored in a `Vector<uint64_t>`.
+///
+/// The binary operations require both operands to have the same size and are
+/// vectorized like those of `Bitset`.
+///
+/// # Example
+///
+/// ```cpp
+/// DynamicBitset bits(1000);
+/// bits.set(10).set(900);
+/// bits.for_each_set([](std::size_t pos) {
+///     // 10, then 900
+/// });
+/// ```
+class DynamicBitset {
+public:
+    using SizeType = std::size_t;
+
+    /// Returned by `find_first()` and `find_next()` when there is no set bit.
+    static constexpr SizeType npos = std::numeric_limits<SizeType>::max();
+
+    /// Constructs an empty bitset.
+    DynamicBitset() = default;
+
+    /// Constructs a bitset of `n` bits, all set to `value`.
+    explicit DynamicBitset(SizeType n, bool value = false)
+        : words_((n + 63) / 64, value ? ~std::uint64_t(0) : 0), size_(n) {
+        trim();
+    }
+
+    /// Returns the number of bits.
+    [[nodiscard]] SizeType size() const noexcept {
+        return size_;
+    }
+
+    /// Returns true if there are no bits.
+    [[nodiscard]] bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    /// Returns the number of 64-bit words.
+    [[nodiscard]] SizeType word_count() const noexcept {
+        return words_.size();
+    }
+
+    /// Resizes to `n` bits, setting the new ones to `value`.
+    void resize(SizeType n, bool value = false) {
+        const SizeType old_size = size_;
+        if (value && old_size % 64 != 0 && n > old_size) {
+            words_.back() |= ~std::uint64_t(0) << (old_size % 64);
+        }
+        const SizeType words = (n + 63) / 64;
+        while (words_.size() > words) {
+            words_.pop_back();
+        }
+        while (words_.size() < words) {
+            words_.push_back(value ? ~std::uint64_t(0) : 0);
+        }
+        size_ = n;
+        trim();
+    }
+
+    /// Appends a bit.
+    void push_back(bool value) {
+        if (size_ % 64 == 0) {
+            words_.push_back(0);
+        }
+        ++size_;
+        set(size_ - 1, value);
+    }
+
+    /// Removes all bits.
+    void clear() noexcept {
+        words_.clear();
+        size_ = 0;
+    }
+
+    /// Returns the bit at `pos`.
+    [[nodiscard]] bool test(SizeType pos) const noexcept {
+        assert(pos < size_);
+        return words_[pos / 64] >> (pos % 64) & 1;
+    }
+
+    /// Returns the bit at `pos`.
+    ///
+    /// Throws `std::out_of_range` if `pos >= size()`.
+    [[nodiscard]] bool at(SizeType pos) const {
+        if (pos >= size_) {
+            throw std::out_of_range("DynamicBitset: pos out of range");
+        }
+        return test(pos);
+    }
+
+    /// Sets the bit at `pos` to `value`.
+    DynamicBitset& set(SizeType pos, bool value = true) noexcept {
+        assert(pos < size_);
+        const std::uint64_t mask = std::uint64_t(1) << (pos % 64);
+        words_[pos / 64] = value ? words_[pos / 64] | mask
+                                 : words_[pos / 64] & ~mask;
+        return *this;
+    }
+
+    /// Sets all bits.
+    DynamicBitset& set() noexcept {
+        std::fill(words_.begin(), words_.end(), ~std::uint64_t(0));
+        trim();
+        return *this;
+    }
+
+    /// Clears the bit at `pos`.
+    DynamicBitset& reset(SizeType pos) noexcept {
+        return set(pos, false);
+    }
+
+    /// Clears all bits.
+    DynamicBitset& reset() noexcept {
+        std::fill(words_.begin(), words_.end(), 0);
+        return *this;
+    }
+
+    /// Flips the bit at `pos`.
+    DynamicBitset& flip(SizeType pos) noexcept {
+        assert(pos < size_);
+        words_[pos / 64] ^= std::uint64_t(1) << (pos % 64);
+        return *this;
+    }
+
+    /// Flips all bits.
+    DynamicBitset& flip() noexcept {
+        for (std::uint64_t& w : words_) {
+            w = ~w;
+        }
+        trim();
+        return *this;
+    }
+
+    /// Returns the number of set bits.
+    [[nodiscard]] SizeType count() const noexcept {
+        return detail::popcountWords(words_.data(), words_.size());
+    }
+
+    /// Returns true if any bit is set.
+    [[nodiscard]] bool any() const noexcept {
+        return std::any_of(words_.begin(), words_.end(),
+                           [](std::uint64_t w) { return w != 0; });
+    }
+
+    /// Returns true if no bit is set.
+    [[nodiscard]] bool none() const noexcept {
+        return !any();
+    }
+
+    /// Returns true if all bits are set.
+    [[nodiscard]] bool all() const noexcept {
+        return count() == size_;
+    }
+
+    /// Returns the position of the first set bit, or `npos`.
+    [[nodiscard]] SizeType find_first() const noexcept {
+        return detail::findNextWords(words_.data(), words_.size(), 0, npos);
+    }
+
+    /// Returns the position of the first set bit after `pos`, or `npos`.
+    [[nodiscard]] SizeType find_next(SizeType pos) const noexcept {
+        return detail::findNextWords(words_.data(), words_.size(), pos + 1,
+                                     npos);
+    }
+
+    /// Calls `f(pos)` for every set bit in ascending order.
+    template <typename F>
+    void for_each_set(F&& f) const {
+        detail::forEachSetWords(words_.data(), words_.size(), f);
+    }
+
+    /// Throws `std::invalid_argument` if the sizes differ.
+    DynamicBitset& operator&=(const DynamicBitset& rhs) {
+        return apply<detail::AndWords>(rhs);
+    }
+
+    /// Throws `std::invalid_argument` if the sizes differ.
+    DynamicBitset& operator|=(const DynamicBitset& rhs) {
+        return apply<detail::OrWords>(rhs);
+    }
+
+    /// Throws `std::invalid_argument` if the sizes differ.
+    DynamicBitset& operator^=(const DynamicBitset& rhs) {
+        return apply<detail::XorWords>(rhs);
+    }
+
+    /// Clears the bits which are set in `rhs`, i.e. `*this &= ~rhs`.
+    ///
+    /// Throws `std::invalid_argument` if the sizes differ.
+    DynamicBitset& and_not(const DynamicBitset& rhs) {
+        return apply<detail::AndNotWords>(rhs);
+    }
+
+    friend DynamicBitset operator&(DynamicBitset lhs,
+                                   const DynamicBitset& rhs) {
+        return lhs &= rhs;
+    }
+
+    friend DynamicBitset operator|(DynamicBitset lhs,
+                                   const DynamicBitset& rhs) {
+        return lhs |= rhs;
+    }
+
+    friend DynamicBitset operator^(DynamicBitset lhs,
+                                   const DynamicBitset& rhs) {
+        return lhs ^= rhs;
+    }
+
+    friend DynamicBitset operator~(DynamicBitset x) {
+        return x.flip();
+    }
+
+    friend bool operator==(const DynamicBitset& x,
+                           const DynamicBitset& y) noexcept {
+        return x.size_ == y.size_ &&
+               std::equal(x.words_.begin(), x.words_.end(), y.words_.begin());
+    }
+
+    friend bool operator!=(const DynamicBitset& x,
+                           const DynamicBitset& y) noexcept {
+        return !(x == y);
+    }
+
+    /// Returns the underlying words, least significant bit first. The bits
+    /// past `size()` in the last word are zero.
+    const Vector<std::uint64_t>& words() const noexcept {
+        return words_;
+    }
+
+    /// Returns the underlying words for filling whole words at a time. The
+    /// bits past `size()` in the last word must be left zero.
+    std::uint64_t* word_data() noexcept {
+        return words_.data();
+    }
+
+private:
+    template <typename Op>
+    DynamicBitset& apply(const DynamicBitset& rhs) {
+        if (size_ != rhs.size_) {
+            throw std::invalid_argument("DynamicBitset: size mismatch");
+        }
+        detail::applyWords<Op>(words_.data(), rhs.words_.data(),
+                               words_.size());
+        return *this;
+    }
+
+    // Keeps the unused high bits of the last word cleared.
+    void trim() noexcept {
+        if (size_ % 64 != 0) {
+            words_.back() &= (std::uint64_t(1) << (size_ % 64)) - 1;
+        }
+    }
+
+private:
+    Vector<std::uint64_t> words_;
+    SizeType size_ = 0;
+};
+
+/// A succinct rank/select index over an immutable `DynamicBitset`.
+///
+/// Ranks follow the rank9 layout: for every block of 512 bits, the number of
+/// ones before the block and the seven cumulative word counts inside it,
+/// packed as 9-bit fields, are interleaved in one pair of words, so `rank1()`
+/// reads a single cache line of counts plus the bit word itself. The space
+/// overhead is 25%.
+///
+/// `select1()` starts from a sample taken every 512 ones, searches the block
+/// counts, and finishes inside the word with `pdep` when BMI2 is available.
+/// `select0()` does the same over a second set of samples, deriving the zero
+/// counts from the one counts.
+///
+/// # Example
+///
+/// ```cpp
+/// DynamicBitset bits(100);
+/// bits.set(3).set(50).set(99);
+/// RankSelect rs(std::move(bits));
+/// assert(rs.rank1(51) == 2);
+/// assert(rs.select1(2) == 99);
+/// ```
+class RankSelect {
+public:
+    using SizeType = std::size_t;
+
+    /// Constructs an index over no bits.
+    RankSelect() : RankSelect(DynamicBitset()) {}
+
+    /// Takes `bits` and builds the index in `O(n)`.
+    explicit RankSelect(DynamicBitset bits) : bits_(std::move(bits)) {
+        build();
+    }
+
+    /// Returns the indexed bits.
+    const DynamicBitset& bits() const noexcept {
+        return bits_;
+    }
+
+    /// Returns the number of bits.
+    [[nodiscard]] SizeType size() const noexcept {
+        return bits_.size();
+    }
+
+    /// Returns the number of ones.
+    [[nodiscard]] SizeType ones() const noexcept {
+        return ones_;
+    }
+
+    /// Returns the bytes used by the index, excluding the bits.
+    [[nodiscard]] SizeType index_bytes() const noexcept {
+        return (counts_.size() + samples_.size() + samples0_.size()) *
+               sizeof(std::uint64_t);
+    }
+
+    /// Returns the number of ones in `[0, pos)`, where `pos <= size()`.
+    [[nodiscard]] SizeType rank1(SizeType pos) const noexcept {
+        assert(pos <= size());
+        const SizeType word = pos / 64;
+        const SizeType block = word / 8;
+        const std::uint64_t* c = &counts_[2 * block];
+        SizeType r = SizeType(c[0]) + relative(c[1], word % 8);
+        if (pos % 64 != 0) {
+            const std::uint64_t w = bits_.words()[word];
+            r += SizeType(
+                detail::popcount64(w << (64 - pos % 64)));
+        }
+        return r;
+    }
+
+    /// Returns the number of zeros in `[0, pos)`, where `pos <= size()`.
+    [[nodiscard]] SizeType rank0(SizeType pos) const noexcept {
+        return pos - rank1(pos);
+    }
+
+    /// Returns the position of the `k`-th one, counting from zero, where
+    /// `k < ones()`.
+    [[nodiscard]] SizeType select1(SizeType k) const noexcept {
+        assert(k < ones_);
+        // The block holding the `k`-th one lies between the blocks of the
+        // surrounding samples.
+        SizeType lo = SizeType(samples_[k / select_sample]);
+        SizeType hi = SizeType(samples_[k / select_sample + 1]) + 1;
+        while (hi - lo > 8) {
+            const SizeType mid = lo + (hi - lo) / 2;
+            if (counts_[2 * mid] <= k) {
+                lo = mid;
+            } else {
+                hi = mid;
+            }
+        }
+        while (lo + 1 < hi && counts_[2 * (lo + 1)] <= k) {
+            ++lo;
+        }
+
+        SizeType rest = k - SizeType(counts_[2 * lo]);
+        const std::uint64_t rel = counts_[2 * lo + 1];
+        SizeType j = 0;
+        while (j < 7 && relative(rel, j + 1) <= rest) {
+            ++j;
+        }
+        rest -= relative(rel, j);
+        const SizeType word = lo * 8 + j;
+        return word * 64 + detail::selectInWord(bits_.words()[word],
+                                                unsigned(rest));
+    }
+
+    /// Returns the position of the `k`-th zero, counting from zero, where
+    /// `k < size() - ones()`.
+    [[nodiscard]] SizeType select0(SizeType k) const noexcept {
+        assert(k < size() - ones_);
+        SizeType lo = SizeType(samples0_[k / select_sample]);
+        SizeType hi = SizeType(samples0_[k / select_sample + 1]) + 1;
+        while (hi - lo > 8) {
+            const SizeType mid = lo + (hi - lo) / 2;
+            if (zerosBefore(mid) <= k) {
+                lo = mid;
+            } else {
+                hi = mid;
+            }
+        }
+        while (lo + 1 < hi && zerosBefore(lo + 1) <= k) {
+            ++lo;
+        }
+
+        SizeType rest = k - zerosBefore(lo);
+        const std::uint64_t rel = counts_[2 * lo + 1];
+        SizeType j = 0;
+        while (j < 7 && 64 * (j + 1) - relative(rel, j + 1) <= rest) {
+            ++j;
+        }
+        rest -= 64 * j - relative(rel, j);
+        const SizeType word = lo * 8 + j;
+        return word * 64 + detail::selectInWord(~bits_.words()[word],
+                                                unsigned(rest));
+    }
+
+private:
+    static constexpr SizeType select_sample = 512;
+
+    // Returns the zeros before `block`. Past the last word this overcounts,
+    // which only ever bounds the search from above.
+    SizeType zerosBefore(SizeType block) const noexcept {
+        return 512 * block - SizeType(counts_[2 * block]);
+    }
+
+    // Appends `block` to `samples` if it holds the `select_sample`-th item
+    // after the `before` preceding ones, given `count` items in the word.
+    static void sample(Vector<std::uint64_t>& samples, SizeType block,
+                       SizeType before, SizeType count) {
+        if ((before + select_sample - 1) / select_sample !=
+            (before + count + select_sample - 1) / select_sample) {
+            samples.push_back(block);
+        }
+    }
+
+    // Returns the ones in the first `j` words of a block.
+    static SizeType relative(std::uint64_t packed, SizeType j) noexcept {
+        return j == 0 ? 0 : SizeType(packed >> (9 * (j - 1)) & 0x1ff);
+    }
+
+    void build() {
+        const Vector<std::uint64_t>& words = bits_.words();
+        const SizeType blocks = words.size() / 8 + 1;
+        counts_.clear();
+        counts_.reserve(2 * blocks);
+        samples_.clear();
+        samples0_.clear();
+
+        SizeType total = 0;
+        for (SizeType b = 0; b < blocks; ++b) {
+            std::uint64_t packed = 0;
+            SizeType in_block = 0;
+            for (SizeType j = 0; j < 8; ++j) {
+                if (j > 0) {
+                    packed |= std::uint64_t(in_block) << (9 * (j - 1));
+                }
+                const SizeType w = b * 8 + j;
+                if (w < words.size()) {
+                    const SizeType c = SizeType(detail::popcount64(words[w]));
+                    const SizeType bits =
+                        std::min<SizeType>(64, bits_.size() - 64 * w);
+                    // Sample the block of every `select_sample`-th one and
+                    // every `select_sample`-th zero.
+                    sample(samples_, b, total + in_block, c);
+                    sample(samples0_, b, 64 * w - total - in_block, bits - c);
+                    in_block += c;
+                }
+            }
+            counts_.push_back(total);
+            counts_.push_back(packed);
+            total += in_block;
+        }
+        ones_ = total;
+        // A sentinel sample bounds the search for the last ones.
+        samples_.push_back(blocks - 1);
+        samples0_.push_back(blocks - 1);
+    }
+
+private:
+    DynamicBitset bits_;
+    // Interleaved (ones before the block, packed relative counts) pairs,
+    // with one extra block so that `rank1(size())` needs no special case.
+    Vector<std::uint64_t> counts_;
+    // The block of every `select_sample`-th one.
+    Vector<std::uint64_t> samples_;
+    // The block of every `select_sample`-th zero.
+    Vector<std::uint64_t> samples0_;
+    SizeType ones_ = 0;
+};
+} // namespace algo
@@ -0,0 +1,740 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "vector.hpp"
+
+namespace algo {
+namespace detail {
+// Spreads the bits of a `std::hash` result, which is the identity for
+// integers in common implementations.
+constexpr std::uint64_t mixHash(std::size_t h) noexcept {
+    std::uint64_t x = static_cast<std::uint64_t>(h);
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+// An open-addressing index from hashes to slot numbers with linear probing.
+// The keys live in the caller's slab, so lookups take a predicate telling
+// whether a slot holds the wanted key. Erasure shifts the following buckets
+// back instead of leaving tombstones.
+class SlotIndex {
+public:
+    static constexpr std::uint32_t npos =
+        std::numeric_limits<std::uint32_t>::max();
+
+    // Sizes the table for at most `n` slots at half load.
+    explicit SlotIndex(std::size_t n = 0) {
+        std::size_t buckets = 8;
+        while (buckets < 2 * n) {
+            buckets *= 2;
+        }
+        buckets_.assign(buckets, Bucket{npos, 0});
+        mask_ = buckets - 1;
+    }
+
+    template <typename Matches>
+    std::uint32_t find(std::uint32_t hash, Matches&& matches) const {
+        for (std::size_t i = hash & mask_;; i = (i + 1) & mask_) {
+            const Bucket& b = buckets_[i];
+            if (b.slot == npos) {
+                return npos;
+            }
+            if (b.hash == hash && matches(b.slot)) {
+                return b.slot;
+            }
+        }
+    }
+
+    void insert(std::uint32_t hash, std::uint32_t slot) noexcept {
+        std::size_t i = hash & mask_;
+        while (buckets_[i].slot != npos) {
+            i = (i + 1) & mask_;
+        }
+        buckets_[i] = Bucket{slot, hash};
+    }
+
+    void erase(std::uint32_t hash, std::uint32_t slot) noexcept {
+        std::size_t i = hash & mask_;
+        while (buckets_[i].slot != slot) {
+            i = (i + 1) & mask_;
+        }
+
+        // Move back every following bucket whose home is at or before the
+        // hole, so probing never stops early.
+        for (std::size_t j = (i + 1) & mask_; buckets_[j].slot != npos;
+             j = (j + 1) & mask_) {
+            const std::size_t home = buckets_[j].hash & mask_;
+            if (((j - home) & mask_) >= ((j - i) & mask_)) {
+                buckets_[i] = buckets_[j];
+                i = j;
+            }
+        }
+        buckets_[i].slot = npos;
+    }
+
+    void clear() noexcept {
+        for (Bucket& b : buckets_) {
+            b.slot = npos;
+        }
+    }
+
+private:
+    struct Bucket {
+        std::uint32_t slot;
+        std::uint32_t hash;
+    };
+
+    Vector<Bucket> buckets_;
+    std::size_t mask_ = 0;
+};
+
+inline void checkCacheCapacity(std::size_t capacity) {
+    if (capacity == 0 || capacity > (std::size_t(1) << 30)) {
+        throw std::invalid_argument("cache capacity out of range");
+    }
+}
+} // namespace detail
+
+/// A fixed-capacity cache evicting the least recently used entry.
+///
+/// All entries live in a `Vector` slab sized at construction and are linked
+/// into the recency list by 32-bit slot indices, and the key index is an
+/// open-addressing table of slot numbers. Once the slab is full, a new entry
+/// takes over the slot of the evicted one, so the cache never allocates after
+/// warm-up.
+///
+/// Not thread-safe; see `ShardedCache`.
+///
+/// # Example
+///
+/// ```cpp
+/// LruCache<int, std::string> cache(2);
+/// cache.put(1, "one");
+/// cache.put(2, "two");
+/// cache.find(1);         // 1 becomes the most recently used
+/// cache.put(3, "three"); // evicts 2
+/// assert(cache.find(2) == nullptr);
+/// ```
+template <typename K, typename V, typename Hash = std::hash<K>,
+          typename KeyEqual = std::equal_to<K>>
+class LruCache {
+public:
+    using KeyType = K;
+    using MappedType = V;
+    using HasherType = Hash;
+    using SizeType = std::size_t;
+
+    /// Constructs an empty cache of at most `capacity` entries.
+    ///
+    /// Throws `std::invalid_argument` unless `0 < capacity <= 2^30`.
+    explicit LruCache(SizeType capacity, const Hash& hash = Hash(),
+                      const KeyEqual& equal = KeyEqual())
+        : hash_(hash), equal_(equal), index_(capacity), capacity_(capacity) {
+        detail::checkCacheCapacity(capacity);
+        slab_.reserve(capacity);
+    }
+
+    /// Returns the number of entries.
+    [[nodiscard]] SizeType size() const noexcept {
+        return size_;
+    }
+
+    /// Returns the maximum number of entries.
+    [[nodiscard]] SizeType capacity() const noexcept {
+        return capacity_;
+    }
+
+    /// Returns true if the cache is empty.
+    [[nodiscard]] bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    /// Returns a pointer to the value of `key` and marks it as the most
+    /// recently used, or returns `nullptr` if absent.
+    V* find(const K& key) {
+        const std::uint32_t slot = lookup(key, hashOf(key));
+        if (slot == npos) {
+            return nullptr;
+        }
+        moveToFront(slot);
+        return &slab_[slot].value;
+    }
+
+    /// Returns a pointer to the value of `key` without touching its recency,
+    /// or `nullptr` if absent.
+    const V* peek(const K& key) const {
+        const std::uint32_t slot = lookup(key, hashOf(key));
+        return slot == npos ? nullptr : &slab_[slot].value;
+    }
+
+    /// Returns true if `key` is present.
+    bool contains(const K& key) const {
+        return peek(key) != nullptr;
+    }
+
+    /// Inserts or assigns `value` for `key` and marks it as the most recently
+    /// used, evicting the least recently used entry if the cache is full.
+    /// Returns true if the key was inserted.
+    bool put(const K& key, const V& value) {
+        const std::uint32_t hash = hashOf(key);
+        std::uint32_t slot = lookup(key, hash);
+        if (slot != npos) {
+            slab_[slot].value = value;
+            moveToFront(slot);
+            return false;
+        }
+
+        if (free_ != npos) {
+            slot = free_;
+            free_ = slab_[slot].next;
+            slab_[slot].key = key;
+            slab_[slot].value = value;
+        } else if (slab_.size() < capacity_) {
+            slot = std::uint32_t(slab_.size());
+            slab_.push_back(Entry{key, value, hash, npos, npos});
+        } else {
+            slot = tail_;
+            unlink(slot);
+            index_.erase(slab_[slot].hash, slot);
+            --size_;
+            slab_[slot].key = key;
+            slab_[slot].value = value;
+        }
+        slab_[slot].hash = hash;
+        index_.insert(hash, slot);
+        linkFront(slot);
+        ++size_;
+        return true;
+    }
+
+    /// Removes `key`. Returns true if it was present.
+    bool erase(const K& key) {
+        const std::uint32_t hash = hashOf(key);
+        const std::uint32_t slot = lookup(key, hash);
+        if (slot == npos) {
+            return false;
+        }
+
+        unlink(slot);
+        index_.erase(hash, slot);
+        if constexpr (std::is_default_constructible_v<V>) {
+            slab_[slot].value = V();
+        }
+        slab_[slot].next = free_;
+        free_ = slot;
+        --size_;
+        return true;
+    }
+
+    /// Removes all entries, keeping the slab.
+    void clear() noexcept {
+        slab_.clear();
+        index_.clear();
+        head_ = tail_ = free_ = npos;
+        size_ = 0;
+    }
+
+    /// Calls `f(key, value)` for every entry from the most to the least
+    /// recently used.
+    template <typename F>
+    void for_each(F&& f) const {
+        for (std::uint32_t i = head_; i != npos; i = slab_[i].next) {
+            f(slab_[i].key, slab_[i].value);
+        }
+    }
+
+private:
+    static constexpr std::uint32_t npos = detail::SlotIndex::npos;
+
+    struct Entry {
+        K key;
+        V value;
+        std::uint32_t hash;
+        std::uint32_t prev;
+        std::uint32_t next;
+    };
+
+    std::uint32_t hashOf(const K& key) const {
+        return std::uint32_t(detail::mixHash(hash_(key)));
+    }
+
+    std::uint32_t lookup(const K& key, std::uint32_t hash) const {
+        return index_.find(hash, [&](std::uint32_t slot) {
+            return equal_(slab_[slot].key, key);
+        });
+    }
+
+    void unlink(std::uint32_t slot) noexcept {
+        Entry& e = slab_[slot];
+        (e.prev != npos ? slab_[e.prev].next : head_) = e.next;
+        (e.next != npos ? slab_[e.next].prev : tail_) = e.prev;
+    }
+
+    void linkFront(std::uint32_t slot) noexcept {
+        Entry& e = slab_[slot];
+        e.prev = npos;
+        e.next = head_;
+        (head_ != npos ? slab_[head_].prev : tail_) = slot;
+        head_ = slot;
+    }
+
+    void moveToFront(std::uint32_t slot) noexcept {
+        if (slot != head_) {
+            unlink(slot);
+            linkFront(slot);
+        }
+    }
+
+private:
+    [[no_unique_address]] Hash hash_;
+    [[no_unique_address]] KeyEqual equal_;
+    Vector<Entry> slab_;
+    detail::SlotIndex index_;
+    SizeType capacity_;
+    SizeType size_ = 0;
+    std::uint32_t head_ = npos;
+    std::uint32_t tail_ = npos;
+    std::uint32_t free_ = npos;
+};
+
+/// A fixed-capacity cache with CLOCK-Pro replacement.
+///
+/// CLOCK-Pro approximates LIRS with clock hands: resident entries are hot or
+/// cold, and evicted cold entries stay in the clock as non-resident test
+/// entries for a while. A test entry that is accessed again proves a short
+/// reuse distance, so it comes back hot and the share of cold entries adapts.
+/// A one-off scan only ever churns through cold entries and cannot flush the
+/// hot working set, unlike LRU.
+///
+/// Storage follows `LruCache`: a `Vector` slab of at most `2 * capacity + 1`
+/// entries linked by 32-bit indices, and an open-addressing index.
+///
+/// Not thread-safe; see `ShardedCache`.
+template <typename K, typename V, typename Hash = std::hash<K>,
+          typename KeyEqual = std::equal_to<K>>
+class ClockProCache {
+public:
+    using KeyType = K;
+    using MappedType = V;
+    using HasherType = Hash;
+    using SizeType = std::size_t;
+
+    /// Constructs an empty cache of at most `capacity` resident entries.
+    ///
+    /// Throws `std::invalid_argument` unless `0 < capacity <= 2^30`.
+    explicit ClockProCache(SizeType capacity, const Hash& hash = Hash(),
+                           const KeyEqual& equal = KeyEqual())
+        : hash_(hash), equal_(equal), index_(2 * capacity + 1),
+          capacity_(capacity), cold_target_(capacity) {
+        detail::checkCacheCapacity(capacity);
+        slab_.reserve(2 * capacity + 1);
+    }
+
+    /// Returns the number of resident entries.
+    [[nodiscard]] SizeType size() const noexcept {
+        return count_hot_ + count_cold_;
+    }
+
+    /// Returns the maximum number of resident entries.
+    [[nodiscard]] SizeType capacity() const noexcept {
+        return capacity_;
+    }
+
+    /// Returns true if no entry is resident.
+    [[nodiscard]] bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    /// Returns a pointer to the value of `key` and marks it as referenced, or
+    /// returns `nullptr` if it is not resident.
+    V* find(const K& key) {
+        const std::uint32_t slot = lookup(key, hashOf(key));
+        if (slot == npos || slab_[slot].type == test_type) {
+            return nullptr;
+        }
+        slab_[slot].referenced = true;
+        return &slab_[slot].value;
+    }
+
+    /// Returns a pointer to the value of `key` without marking it, or
+    /// `nullptr` if it is not resident.
+    const V* peek(const K& key) const {
+        const std::uint32_t slot = lookup(key, hashOf(key));
+        return slot == npos || slab_[slot].type == test_type
+                   ? nullptr
+                   : &slab_[slot].value;
+    }
+
+    /// Returns true if `key` is resident.
+    bool contains(const K& key) const {
+        return peek(key) != nullptr;
+    }
+
+    /// Inserts or assigns `value` for `key`, evicting cold entries if the
+    /// cache is full. Returns true if the key was not resident.
+    bool put(const K& key, const V& value) {
+        const std::uint32_t hash = hashOf(key);
+        const std::uint32_t slot = lookup(key, hash);
+        if (slot == npos) {
+            const std::uint32_t s = allocate(key, value, hash);
+            slab_[s].type = cold_type;
+            slab_[s].referenced = false;
+            add(s);
+            ++count_cold_;
+            return true;
+        }
+
+        Entry& e = slab_[slot];
+        if (e.type != test_type) {
+            e.value = value;
+            e.referenced = true;
+            return false;
+        }
+
+        // A test entry was reused within its test period: give cold entries
+        // more room and bring it back as hot.
+        if (cold_target_ < capacity_) {
+            ++cold_target_;
+        }
+        e.value = value;
+        e.referenced = false;
+        e.type = hot_type;
+        --count_test_;
+        remove(slot);
+        add(slot);
+        ++count_hot_;
+        return true;
+    }
+
+    /// Removes `key`, resident or not. Returns true if it was resident.
+    bool erase(const K& key) {
+        const std::uint32_t slot = lookup(key, hashOf(key));
+        if (slot == npos) {
+            return false;
+        }
+
+        const std::uint8_t type = slab_[slot].type;
+        if (type == hot_type) {
+            --count_hot_;
+        } else if (type == cold_type) {
+            --count_cold_;
+        } else {
+            --count_test_;
+        }
+        remove(slot);
+        release(slot);
+        return type != test_type;
+    }
+
+    /// Removes all entries, keeping the slab.
+    void clear() noexcept {
+        slab_.clear();
+        index_.clear();
+        hand_hot_ = hand_cold_ = hand_test_ = free_ = npos;
+        count_hot_ = count_cold_ = count_test_ = 0;
+        cold_target_ = capacity_;
+    }
+
+private:
+    static constexpr std::uint32_t npos = detail::SlotIndex::npos;
+    static constexpr std::uint8_t hot_type = 0;
+    static constexpr std::uint8_t cold_type = 1;
+    static constexpr std::uint8_t test_type = 2;
+
+    struct Entry {
+        K key;
+        V value;
+        std::uint32_t hash;
+        std::uint32_t prev;
+        std::uint32_t next;
+        std::uint8_t type;
+        bool referenced;
+    };
+
+    std::uint32_t hashOf(const K& key) const {
+        return std::uint32_t(detail::mixHash(hash_(key)));
+    }
+
+    std::uint32_t lookup(const K& key, std::uint32_t hash) const {
+        return index_.find(hash, [&](std::uint32_t slot) {
+            return equal_(slab_[slot].key, key);
+        });
+    }
+
+    std::uint32_t allocate(const K& key, const V& value, std::uint32_t hash) {
+        std::uint32_t slot;
+        if (free_ != npos) {
+            slot = free_;
+            free_ = slab_[slot].next;
+            slab_[slot].key = key;
+            slab_[slot].value = value;
+            slab_[slot].hash = hash;
+        } else {
+            slot = std::uint32_t(slab_.size());
+            slab_.push_back(Entry{key, value, hash, npos, npos, cold_type,
+                                  false});
+        }
+        return slot;
+    }
+
+    void release(std::uint32_t slot) {
+        if constexpr (std::is_default_constructible_v<V>) {
+            slab_[slot].value = V();
+        }
+        slab_[slot].next = free_;
+        free_ = slot;
+    }
+
+    // Makes room for one resident entry and links `slot` into the clock right
+    // behind the hot hand.
+    void add(std::uint32_t slot) {
+        while (capacity_ <= count_hot_ + count_cold_) {
+            runHandCold();
+        }
+
+        index_.insert(slab_[slot].hash, slot);
+        if (hand_hot_ == npos) {
+            slab_[slot].prev = slab_[slot].next = slot;
+            hand_hot_ = hand_cold_ = hand_test_ = slot;
+        } else {
+            const std::uint32_t next = hand_hot_;
+            const std::uint32_t prev = slab_[next].prev;
+            slab_[slot].prev = prev;
+            slab_[slot].next = next;
+            slab_[prev].next = slot;
+            slab_[next].prev = slot;
+        }
+        if (hand_cold_ == hand_hot_) {
+            hand_cold_ = slab_[hand_cold_].prev;
+        }
+    }
+
+    // Unlinks `slot` from the clock and the index, moving the hands off it.
+    void remove(std::uint32_t slot) noexcept {
+        index_.erase(slab_[slot].hash, slot);
+
+        const std::uint32_t prev = slab_[slot].prev;
+        const std::uint32_t next = slab_[slot].next;
+        if (prev == slot) {
+            hand_hot_ = hand_cold_ = hand_test_ = npos;
+            return;
+        }
+        for (std::uint32_t* hand : {&hand_hot_, &hand_cold_, &hand_test_}) {
+            if (*hand == slot) {
+                *hand = prev;
+            }
+        }
+        slab_[prev].next = next;
+        slab_[next].prev = prev;
+    }
+
+    void runHandCold() {
+        Entry& e = slab_[hand_cold_];
+        if (e.type == cold_type) {
+            if (e.referenced) {
+                e.type = hot_type;
+                e.referenced = false;
+                --count_cold_;
+                ++count_hot_;
+            } else {
+                e.type = test_type;
+                if constexpr (std::is_default_constructible_v<V>) {
+                    e.value = V();
+                }
+                --count_cold_;
+                ++count_test_;
+                while (capacity_ < count_test_) {
+                    runHandTest();
+                }
+            }
+        }
+        hand_cold_ = slab_[hand_cold_].next;
+        while (capacity_ - cold_target_ < count_hot_) {
+            runHandHot();
+        }
+    }
+
+    void runHandHot() {
+        if (hand_hot_ == hand_test_) {
+            runHandTest();
+        }
+        Entry& e = slab_[hand_hot_];
+        if (e.type == hot_type) {
+            if (e.referenced) {
+                e.referenced = false;
+            } else {
+                e.type = cold_type;
+                --count_hot_;
+                ++count_cold_;
+            }
+        }
+        hand_hot_ = slab_[hand_hot_].next;
+    }
+
+    void runHandTest() {
+        if (hand_test_ == hand_cold_) {
+            runHandCold();
+        }
+        if (slab_[hand_test_].type == test_type) {
+            const std::uint32_t slot = hand_test_;
+            const std::uint32_t prev = slab_[slot].prev;
+            remove(slot);
+            release(slot);
+            hand_test_ = prev;
+            --count_test_;
+            if (cold_target_ > 1) {
+                --cold_target_;
+            }
+        }
+        hand_test_ = slab_[hand_test_].next;
+    }
+
+private:
+    [[no_unique_address]] Hash hash_;
+    [[no_unique_address]] KeyEqual equal_;
+    Vector<Entry> slab_;
+    detail::SlotIndex index_;
+    SizeType capacity_;
+    SizeType cold_target_;
+    SizeType count_hot_ = 0;
+    SizeType count_cold_ = 0;
+    SizeType count_test_ = 0;
+    std::uint32_t hand_hot_ = npos;
+    std::uint32_t hand_cold_ = npos;
+    std::uint32_t hand_test_ = npos;
+    std::uint32_t free_ = npos;
+};
+
+/// A thread-safe cache made of independently locked shards.
+///
+/// Keys are spread over a power-of-two number of shards by their hash, each
+/// shard being a `Cache` (`LruCache` or `ClockProCache`) behind its own mutex
+/// on its own cache line, so threads touching different shards do not
+/// contend. Eviction is per shard, hence approximate across the whole cache.
+///
+/// Values are returned by copy since a pointer into a shard would outlive the
+/// lock.
+///
+/// # Example
+///
+/// ```cpp
+/// ShardedCache<int, std::string> cache(1024, 16);
+/// cache.put(1, "one");
+/// assert(cache.get(1) == "one");
+///
+/// ShardedCache<int, int, ClockProCache<int, int>> scan_resistant(1024);
+/// ```
+template <typename K, typename V, typename Cache = LruCache<K, V>>
+class ShardedCache {
+public:
+    using KeyType = K;
+    using MappedType = V;
+    using CacheType = Cache;
+    using HasherType = typename Cache::HasherType;
+    using SizeType = std::size_t;
+
+    /// Constructs a cache of about `capacity` entries split into `shards`
+    /// shards, rounded up to a power of two. `hash` both picks the shard of
+    /// a key and is copied into every shard.
+    explicit ShardedCache(SizeType capacity, SizeType shards = 16,
+                          const HasherType& hash = HasherType())
+        : hash_(hash) {
+        SizeType n = 1;
+        while (n < shards && n < capacity) {
+            n *= 2;
+        }
+        shift_ = 64;
+        for (SizeType i = n; i > 1; i /= 2) {
+            --shift_;
+        }
+        shards_.reserve(n);
+        for (SizeType i = 0; i < n; ++i) {
+            shards_.push_back(
+                std::make_unique<Shard>((capacity + n - 1) / n, hash));
+        }
+    }
+
+    /// Returns the number of shards.
+    SizeType shard_count() const noexcept {
+        return shards_.size();
+    }
+
+    /// Returns the total number of resident entries.
+    SizeType size() const {
+        SizeType total = 0;
+        for (const auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            total += shard->cache.size();
+        }
+        return total;
+    }
+
+    /// Returns a copy of the value of `key`, if resident, and records the
+    /// access.
+    std::optional<V> get(const K& key) {
+        Shard& shard = shardOf(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (const V* v = shard.cache.find(key)) {
+            return *v;
+        }
+        return std::nullopt;
+    }
+
+    /// Inserts or assigns `value` for `key`. Returns true if the key was not
+    /// resident.
+    bool put(const K& key, const V& value) {
+        Shard& shard = shardOf(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.cache.put(key, value);
+    }
+
+    /// Removes `key`. Returns true if it was resident.
+    bool erase(const K& key) {
+        Shard& shard = shardOf(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.cache.erase(key);
+    }
+
+    /// Removes all entries.
+    void clear() {
+        for (const auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            shard->cache.clear();
+        }
+    }
+
+private:
+    struct alignas(64) Shard {
+        Shard(SizeType capacity, const HasherType& hash)
+            : cache(capacity, hash) {}
+
+        mutable std::mutex mutex;
+        Cache cache;
+    };
+
+    // The shard is chosen by the high bits of the mixed hash, while the
+    // shard's own index uses the low bits.
+    Shard& shardOf(const K& key) const {
+        const std::uint64_t h = detail::mixHash(hash_(key));
+        return *shards_[shift_ == 64 ? 0 : h >> shift_];
+    }
+
+private:
+    std::vector<std::unique_ptr<Shard>> shards_;
+    unsigned shift_;
+    [[no_unique_address]] HasherType hash_;
+};
+} // namespace algo
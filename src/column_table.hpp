@@ -0,0 +1,747 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include "bitset.hpp"
+#include "simd.hpp"
+#include "vector.hpp"
+
+namespace algo {
+/// The comparison of a `ColumnTable::filter()`, with the column value on the
+/// left-hand side.
+enum class CompareOp {
+    equal,
+    not_equal,
+    less,
+    less_equal,
+    greater,
+    greater_equal
+};
+
+namespace detail {
+template <CompareOp Op, typename T>
+bool compareScalar(const T& a, const T& b) noexcept {
+    if constexpr (Op == CompareOp::equal) {
+        return a == b;
+    } else if constexpr (Op == CompareOp::not_equal) {
+        return a != b;
+    } else if constexpr (Op == CompareOp::less) {
+        return a < b;
+    } else if constexpr (Op == CompareOp::less_equal) {
+        return a <= b;
+    } else if constexpr (Op == CompareOp::greater) {
+        return a > b;
+    } else {
+        return a >= b;
+    }
+}
+
+template <typename T>
+constexpr bool is_simd_filterable =
+    std::is_same_v<T, std::int32_t> || std::is_same_v<T, std::uint32_t> ||
+    std::is_same_v<T, std::int64_t> || std::is_same_v<T, std::uint64_t> ||
+    std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+#if defined(ALGO_SIMD_X86)
+// The ordered, non-signalling `_CMP_*` predicate of `Op`; `!=` is unordered,
+// so that it holds for NaN like the scalar operator.
+template <CompareOp Op>
+constexpr int floatPredicate() noexcept {
+    constexpr int predicates[] = {_CMP_EQ_OQ, _CMP_NEQ_UQ, _CMP_LT_OQ,
+                                  _CMP_LE_OQ, _CMP_GT_OQ,  _CMP_GE_OQ};
+    return predicates[int(Op)];
+}
+
+// Compares one register of values against a broadcast value into a bit mask,
+// lowest lane first.
+template <typename T>
+struct FilterLanesAvx512 {
+    static constexpr unsigned width = 64 / sizeof(T);
+
+    template <CompareOp Op>
+    __attribute__((target("avx512f"))) static std::uint64_t
+    mask(const T* p, T value) noexcept {
+        // The `_MM_CMPINT_*` encoding of `Op`.
+        constexpr int ints[] = {0, 4, 1, 2, 6, 5};
+        constexpr int pred = ints[int(Op)];
+        constexpr int float_pred = floatPredicate<Op>();
+        if constexpr (std::is_same_v<T, float>) {
+            return _mm512_cmp_ps_mask(_mm512_loadu_ps(p), _mm512_set1_ps(value),
+                                      float_pred);
+        } else if constexpr (std::is_same_v<T, double>) {
+            return _mm512_cmp_pd_mask(_mm512_loadu_pd(p), _mm512_set1_pd(value),
+                                      float_pred);
+        } else if constexpr (std::is_same_v<T, std::int32_t>) {
+            return _mm512_cmp_epi32_mask(_mm512_loadu_si512(p),
+                                         _mm512_set1_epi32(value), pred);
+        } else if constexpr (std::is_same_v<T, std::uint32_t>) {
+            return _mm512_cmp_epu32_mask(_mm512_loadu_si512(p),
+                                         _mm512_set1_epi32(int(value)), pred);
+        } else if constexpr (std::is_same_v<T, std::int64_t>) {
+            return _mm512_cmp_epi64_mask(_mm512_loadu_si512(p),
+                                         _mm512_set1_epi64(value), pred);
+        } else {
+            return _mm512_cmp_epu64_mask(
+                _mm512_loadu_si512(p), _mm512_set1_epi64((long long)value),
+                pred);
+        }
+    }
+};
+
+template <typename T>
+struct FilterLanesAvx2 {
+    static constexpr unsigned width = 32 / sizeof(T);
+
+    template <CompareOp Op>
+    __attribute__((target("avx2"))) static std::uint64_t
+    mask(const T* p, T value) noexcept {
+        constexpr int float_pred = floatPredicate<Op>();
+        if constexpr (std::is_same_v<T, float>) {
+            return unsigned(_mm256_movemask_ps(_mm256_cmp_ps(
+                _mm256_loadu_ps(p), _mm256_set1_ps(value), float_pred)));
+        } else if constexpr (std::is_same_v<T, double>) {
+            return unsigned(_mm256_movemask_pd(_mm256_cmp_pd(
+                _mm256_loadu_pd(p), _mm256_set1_pd(value), float_pred)));
+        } else {
+            const __m256i v =
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            const __m256i x = broadcast(value);
+            const unsigned all = (1u << width) - 1;
+            unsigned eq, gt, lt;
+            if constexpr (sizeof(T) == 4) {
+                eq = signs(_mm256_cmpeq_epi32(v, x));
+                gt = signs(_mm256_cmpgt_epi32(flip(v), flip(x)));
+                lt = signs(_mm256_cmpgt_epi32(flip(x), flip(v)));
+            } else {
+                eq = signs(_mm256_cmpeq_epi64(v, x));
+                gt = signs(_mm256_cmpgt_epi64(flip(v), flip(x)));
+                lt = signs(_mm256_cmpgt_epi64(flip(x), flip(v)));
+            }
+            if constexpr (Op == CompareOp::equal) {
+                return eq;
+            } else if constexpr (Op == CompareOp::not_equal) {
+                return eq ^ all;
+            } else if constexpr (Op == CompareOp::less) {
+                return lt;
+            } else if constexpr (Op == CompareOp::less_equal) {
+                return gt ^ all;
+            } else if constexpr (Op == CompareOp::greater) {
+                return gt;
+            } else {
+                return lt ^ all;
+            }
+        }
+    }
+
+private:
+    __attribute__((target("avx2"))) static __m256i broadcast(T value) noexcept {
+        if constexpr (sizeof(T) == 4) {
+            return _mm256_set1_epi32(int(value));
+        } else {
+            return _mm256_set1_epi64x((long long)(value));
+        }
+    }
+
+    // Unsigned order is signed order with the sign bits flipped.
+    __attribute__((target("avx2"))) static __m256i flip(__m256i v) noexcept {
+        if constexpr (std::is_signed_v<T>) {
+            return v;
+        } else if constexpr (sizeof(T) == 4) {
+            return _mm256_xor_si256(v, _mm256_set1_epi32(INT32_MIN));
+        } else {
+            return _mm256_xor_si256(v, _mm256_set1_epi64x(INT64_MIN));
+        }
+    }
+
+    __attribute__((target("avx2"))) static unsigned signs(__m256i v) noexcept {
+        if constexpr (sizeof(T) == 4) {
+            return unsigned(_mm256_movemask_ps(_mm256_castsi256_ps(v)));
+        } else {
+            return unsigned(_mm256_movemask_pd(_mm256_castsi256_pd(v)));
+        }
+    }
+};
+#endif
+
+// Sets bit `i` of `words` to `p[i] Op value`, a whole word at a time, with
+// the registers of `Lanes` or, if it is `void`, one value at a time.
+template <typename Lanes, CompareOp Op, typename T>
+__attribute__((always_inline)) inline void
+compareWordsWith(const T* p, std::size_t n, T value,
+                 std::uint64_t* words) noexcept {
+    std::size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        std::uint64_t w = 0;
+        if constexpr (!std::is_void_v<Lanes>) {
+            for (unsigned j = 0; j < 64; j += Lanes::width) {
+                w |= Lanes::template mask<Op>(p + i + j, value) << j;
+            }
+        } else {
+            for (unsigned j = 0; j < 64; ++j) {
+                w |= std::uint64_t(compareScalar<Op>(p[i + j], value)) << j;
+            }
+        }
+        words[i / 64] = w;
+    }
+    if (i < n) {
+        std::uint64_t w = 0;
+        for (unsigned j = 0; i + j < n; ++j) {
+            w |= std::uint64_t(compareScalar<Op>(p[i + j], value)) << j;
+        }
+        words[i / 64] = w;
+    }
+}
+
+template <CompareOp Op, typename T>
+void compareWordsScalar(const T* p, std::size_t n, T value,
+                        std::uint64_t* words) noexcept {
+    compareWordsWith<void, Op>(p, n, value, words);
+}
+
+#if defined(ALGO_SIMD_X86)
+template <CompareOp Op, typename T>
+__attribute__((target("avx2"))) void
+compareWordsAvx2(const T* p, std::size_t n, T value,
+                 std::uint64_t* words) noexcept {
+    compareWordsWith<FilterLanesAvx2<T>, Op>(p, n, value, words);
+}
+
+template <CompareOp Op, typename T>
+__attribute__((target("avx512f"))) void
+compareWordsAvx512(const T* p, std::size_t n, T value,
+                   std::uint64_t* words) noexcept {
+    compareWordsWith<FilterLanesAvx512<T>, Op>(p, n, value, words);
+}
+
+template <CompareOp Op, typename T>
+inline const simd::Dispatch<void(const T*, std::size_t, T, std::uint64_t*)>
+    compare_words(compareWordsScalar<Op, T>, nullptr,
+                  compareWordsAvx2<Op, T>, compareWordsAvx512<Op, T>);
+#else
+template <CompareOp Op, typename T>
+inline const simd::Dispatch<void(const T*, std::size_t, T, std::uint64_t*)>
+    compare_words(compareWordsScalar<Op, T>);
+#endif
+
+template <CompareOp Op, typename T>
+void compareWords(const T* p, std::size_t n, T value, std::uint64_t* words) {
+    if constexpr (is_simd_filterable<T>) {
+        compare_words<Op, T>(p, n, value, words);
+    } else {
+        compareWordsScalar<Op>(p, n, value, words);
+    }
+}
+
+template <typename T>
+void compareWords(const T* p, std::size_t n, CompareOp op, T value,
+                  std::uint64_t* words) {
+    switch (op) {
+    case CompareOp::equal:
+        return compareWords<CompareOp::equal>(p, n, value, words);
+    case CompareOp::not_equal:
+        return compareWords<CompareOp::not_equal>(p, n, value, words);
+    case CompareOp::less:
+        return compareWords<CompareOp::less>(p, n, value, words);
+    case CompareOp::less_equal:
+        return compareWords<CompareOp::less_equal>(p, n, value, words);
+    case CompareOp::greater:
+        return compareWords<CompareOp::greater>(p, n, value, words);
+    case CompareOp::greater_equal:
+        return compareWords<CompareOp::greater_equal>(p, n, value, words);
+    }
+}
+
+// Copies `src[rows[i]]` to `out[i]` for the `n` selected rows.
+template <typename T>
+void gatherRows(const T* src, const std::uint32_t* rows, std::size_t n,
+                T* out) noexcept {
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = src[rows[i]];
+    }
+}
+} // namespace detail
+
+/// A column of strings stored as dictionary codes.
+///
+/// Every distinct string is kept once in a pool of characters and numbered in
+/// order of first appearance; the rows hold only the 32-bit codes. Scans and
+/// filters then read 4 bytes per row, and equality becomes an integer
+/// comparison. An open-addressing table over the pool finds the code of a
+/// string without storing it twice. Copies of a column and the columns
+/// `gather()` returns share the pool and the table until one of them adds a
+/// string.
+///
+/// # Example
+///
+/// ```cpp
+/// DictionaryColumn city;
+/// city.push_back("Paris");
+/// city.push_back("Oslo");
+/// city.push_back("Paris");
+/// assert(city.dictionary_size() == 2 && city.code(2) == city.code(0));
+/// assert(city[1] == "Oslo");
+/// ```
+class DictionaryColumn {
+public:
+    using SizeType = std::size_t;
+
+    /// Returned by `find()` for a string that is not in the dictionary.
+    static constexpr std::uint32_t npos = std::uint32_t(-1);
+
+    /// Constructs an empty column.
+    DictionaryColumn() = default;
+
+    /// Returns the number of rows.
+    [[nodiscard]] SizeType size() const noexcept {
+        return codes_.size();
+    }
+
+    /// Returns true if there are no rows.
+    [[nodiscard]] bool empty() const noexcept {
+        return codes_.empty();
+    }
+
+    /// Returns the number of distinct strings.
+    [[nodiscard]] SizeType dictionary_size() const noexcept {
+        return dict_ ? dict_->size() : 0;
+    }
+
+    /// Reserves room for `n` rows.
+    void reserve(SizeType n) {
+        codes_.reserve(n);
+    }
+
+    /// Appends a row.
+    ///
+    /// Throws `std::length_error` if the dictionary already holds 2^32 - 1
+    /// strings.
+    void push_back(std::string_view s) {
+        codes_.push_back(encode(s));
+    }
+
+    /// Returns the code of `s`, adding it to the dictionary if needed, without
+    /// appending a row. A dictionary shared with other columns is copied
+    /// before a string is added.
+    ///
+    /// Throws `std::length_error` if the dictionary is full.
+    std::uint32_t encode(std::string_view s) {
+        const std::size_t h = std::hash<std::string_view>()(s);
+        const std::uint32_t code = find(s, h);
+        if (code != npos) {
+            return code;
+        }
+        if (dictionary_size() >= npos - 1) {
+            throw std::length_error("DictionaryColumn: too many strings");
+        }
+        return ownDictionary().insert(s, h);
+    }
+
+    /// Returns the code of `s`, or `npos` if it is not in the dictionary.
+    [[nodiscard]] std::uint32_t find(std::string_view s) const {
+        return find(s, std::hash<std::string_view>()(s));
+    }
+
+    /// Returns the string of row `i`.
+    [[nodiscard]] std::string_view operator[](SizeType i) const noexcept {
+        assert(i < size());
+        return value(codes_[i]);
+    }
+
+    /// Returns the code of row `i`.
+    [[nodiscard]] std::uint32_t code(SizeType i) const noexcept {
+        assert(i < size());
+        return codes_[i];
+    }
+
+    /// Returns the string numbered `code`.
+    [[nodiscard]] std::string_view value(std::uint32_t code) const noexcept {
+        assert(code < dictionary_size());
+        return dict_->value(code);
+    }
+
+    /// Returns the codes of all rows.
+    [[nodiscard]] const Vector<std::uint32_t>& codes() const noexcept {
+        return codes_;
+    }
+
+    /// Returns a column of the rows at the ascending positions `rows`, sharing
+    /// this dictionary rather than copying it. Copies of the column share it
+    /// too.
+    [[nodiscard]] DictionaryColumn gather(
+        const Vector<std::uint32_t>& rows) const {
+        DictionaryColumn out;
+        out.dict_ = dict_;
+        out.codes_.resize(rows.size());
+        detail::gatherRows(codes_.data(), rows.data(), rows.size(),
+                           out.codes_.data());
+        return out;
+    }
+
+    /// Removes all rows and strings.
+    void clear() noexcept {
+        codes_.clear();
+        dict_.reset();
+    }
+
+private:
+    // The strings of one or more columns, with an open-addressing index from
+    // their hashes to their codes.
+    struct Dictionary {
+        Vector<char> pool;
+        // String `c` is `pool[offsets[c], offsets[c + 1])`.
+        Vector<std::size_t> offsets = Vector<std::size_t>(1, 0);
+        // Code + 1 of the string hashed there, or 0; a power of two in size
+        // and at most half full.
+        Vector<std::uint32_t> slots;
+
+        SizeType size() const noexcept {
+            return offsets.size() - 1;
+        }
+
+        std::string_view value(std::uint32_t code) const noexcept {
+            return std::string_view(pool.data() + offsets[code],
+                                    offsets[code + 1] - offsets[code]);
+        }
+
+        // Returns the slot holding `s`, or the empty slot where it belongs.
+        SizeType probe(std::string_view s, std::size_t h) const noexcept {
+            const SizeType mask = slots.size() - 1;
+            for (SizeType i = h & mask;; i = (i + 1) & mask) {
+                const std::uint32_t slot = slots[i];
+                if (slot == 0 || value(slot - 1) == s) {
+                    return i;
+                }
+            }
+        }
+
+        // Adds `s`, which is not in the dictionary yet, and returns its code.
+        std::uint32_t insert(std::string_view s, std::size_t h) {
+            if (2 * (size() + 1) > slots.size()) {
+                rehash(std::max<SizeType>(16, 2 * slots.size()));
+            }
+            std::uint32_t& slot = slots[probe(s, h)];
+            pool.insert(pool.end(), s.begin(), s.end());
+            offsets.push_back(pool.size());
+            slot = std::uint32_t(size());
+            return slot - 1;
+        }
+
+        void rehash(SizeType n) {
+            slots.assign(n, 0);
+            const SizeType mask = n - 1;
+            for (std::uint32_t code = 0; code < size(); ++code) {
+                SizeType i = std::hash<std::string_view>()(value(code)) & mask;
+                while (slots[i] != 0) {
+                    i = (i + 1) & mask;
+                }
+                slots[i] = code + 1;
+            }
+        }
+    };
+
+    std::uint32_t find(std::string_view s, std::size_t h) const {
+        if (!dict_ || dict_->slots.empty()) {
+            return npos;
+        }
+        const std::uint32_t slot = dict_->slots[dict_->probe(s, h)];
+        return slot == 0 ? npos : slot - 1;
+    }
+
+    // Returns the dictionary for writing, copied first if another column
+    // shares it.
+    Dictionary& ownDictionary() {
+        if (!dict_) {
+            dict_ = std::make_shared<Dictionary>();
+        } else if (dict_.use_count() > 1) {
+            dict_ = std::make_shared<Dictionary>(*dict_);
+        }
+        return *dict_;
+    }
+
+private:
+    Vector<std::uint32_t> codes_;
+    // Null while there are no strings.
+    std::shared_ptr<Dictionary> dict_;
+};
+
+/// A table of named columns stored one `Vector` per column.
+///
+/// Each column is a `Vector` of `std::int32_t`, `std::uint32_t`,
+/// `std::int64_t`, `std::uint64_t`, `float` or `double`, or a
+/// `DictionaryColumn` of strings. A scan over some fields then reads only
+/// those fields, densely packed, instead of striding over whole rows.
+///
+/// `filter()` compares a column against a constant into a `DynamicBitset`
+/// of matching rows, 64 rows per word and, for numeric columns, an AVX2 or
+/// AVX-512 register at a time when `simd::level()` allows; selections of
+/// several columns are combined with the word-wise operators of the bitset.
+/// `gather()` then materializes only the selected rows of only the columns
+/// needed.
+///
+/// Columns are filled through the references `add_column()` returns, which
+/// stay valid as long as the table. Each operation requires the columns it
+/// reads to have the same length.
+///
+/// # Example
+///
+/// ```cpp
+/// ColumnTable t;
+/// auto& price = t.add_column<double>("price");
+/// auto& city = t.add_string_column("city");
+/// price.push_back(12.5);
+/// city.push_back("Paris");
+/// price.push_back(99.0);
+/// city.push_back("Oslo");
+///
+/// DynamicBitset hits = t.filter<double>("price", CompareOp::less, 50.0);
+/// hits &= t.filter("city", CompareOp::equal, "Paris");
+/// ColumnTable cheap = t.gather(hits, {"city"});
+/// assert(cheap.rows() == 1);
+/// ```
+class ColumnTable {
+    using Column =
+        std::variant<Vector<std::int32_t>, Vector<std::uint32_t>,
+                     Vector<std::int64_t>, Vector<std::uint64_t>,
+                     Vector<float>, Vector<double>, DictionaryColumn>;
+
+public:
+    using SizeType = std::size_t;
+
+    /// Constructs a table without columns.
+    ColumnTable() = default;
+
+    /// Adds an empty column of `T` and returns it.
+    ///
+    /// Throws `std::invalid_argument` if a column is already named `name`.
+    template <typename T>
+    Vector<T>& add_column(const std::string& name) {
+        static_assert(detail::is_simd_filterable<T>,
+                      "ColumnTable: unsupported column type");
+        return std::get<Vector<T>>(addColumn(name, Vector<T>()));
+    }
+
+    /// Adds an empty dictionary-encoded string column and returns it.
+    ///
+    /// Throws `std::invalid_argument` if a column is already named `name`.
+    DictionaryColumn& add_string_column(const std::string& name) {
+        return std::get<DictionaryColumn>(addColumn(name, DictionaryColumn()));
+    }
+
+    /// Returns true if there is a column named `name`.
+    [[nodiscard]] bool contains(const std::string& name) const noexcept {
+        return std::find(names_.begin(), names_.end(), name) != names_.end();
+    }
+
+    /// Returns the number of columns.
+    [[nodiscard]] SizeType column_count() const noexcept {
+        return columns_.size();
+    }
+
+    /// Returns the names of the columns in the order they were added.
+    [[nodiscard]] const Vector<std::string>& names() const noexcept {
+        return names_;
+    }
+
+    /// Returns the number of rows of the first column, or zero.
+    [[nodiscard]] SizeType rows() const noexcept {
+        return columns_.empty() ? 0 : columnSize(columns_[0]);
+    }
+
+    /// Returns the column of `T` named `name`.
+    ///
+    /// Throws `std::out_of_range` if there is no such column and
+    /// `std::invalid_argument` if it holds another type.
+    template <typename T>
+    [[nodiscard]] Vector<T>& column(const std::string& name) {
+        return typedColumn<Vector<T>>(name);
+    }
+
+    template <typename T>
+    [[nodiscard]] const Vector<T>& column(const std::string& name) const {
+        return const_cast<ColumnTable*>(this)->column<T>(name);
+    }
+
+    /// Returns the string column named `name`.
+    ///
+    /// Throws `std::out_of_range` if there is no such column and
+    /// `std::invalid_argument` if it is not a string column.
+    [[nodiscard]] DictionaryColumn& string_column(const std::string& name) {
+        return typedColumn<DictionaryColumn>(name);
+    }
+
+    [[nodiscard]] const DictionaryColumn& string_column(
+        const std::string& name) const {
+        return const_cast<ColumnTable*>(this)->string_column(name);
+    }
+
+    /// Returns the rows of the column of `T` named `name` whose value
+    /// compares to `value` by `op`.
+    ///
+    /// `T` is given explicitly and must be the type of the column, e.g.
+    /// `filter<std::int64_t>("id", CompareOp::less, 100)`.
+    ///
+    /// Throws `std::out_of_range` if there is no such column and
+    /// `std::invalid_argument` if it holds another type.
+    template <typename T>
+    [[nodiscard]] DynamicBitset filter(const std::string& name, CompareOp op,
+                                       std::common_type_t<T> value) const {
+        const Vector<T>& c = column<T>(name);
+        DynamicBitset out(c.size());
+        detail::compareWords(c.data(), c.size(), op, value, out.word_data());
+        return out;
+    }
+
+    /// Returns the rows of the string column named `name` whose string
+    /// compares to `value` by `op`, in the order of `std::string_view`.
+    ///
+    /// Equality tests the codes against the code of `value`. Other
+    /// comparisons are evaluated once per distinct string and then looked up
+    /// by code.
+    ///
+    /// Throws `std::out_of_range` if there is no such column and
+    /// `std::invalid_argument` if it is not a string column.
+    [[nodiscard]] DynamicBitset filter(const std::string& name, CompareOp op,
+                                       std::string_view value) const {
+        const DictionaryColumn& c = string_column(name);
+        const Vector<std::uint32_t>& codes = c.codes();
+        DynamicBitset out(c.size());
+        if (op == CompareOp::equal || op == CompareOp::not_equal) {
+            const std::uint32_t code = c.find(value);
+            if (code == DictionaryColumn::npos) {
+                return op == CompareOp::equal ? out : out.set();
+            }
+            detail::compareWords(codes.data(), codes.size(), op, code,
+                                 out.word_data());
+            return out;
+        }
+
+        Vector<std::uint8_t> hit(c.dictionary_size());
+        for (std::uint32_t code = 0; code < hit.size(); ++code) {
+            const int order = c.value(code).compare(value);
+            hit[code] = op == CompareOp::less         ? order < 0
+                        : op == CompareOp::less_equal ? order <= 0
+                        : op == CompareOp::greater    ? order > 0
+                                                      : order >= 0;
+        }
+        std::uint64_t* words = out.word_data();
+        for (SizeType i = 0; i < codes.size(); i += 64) {
+            const SizeType n = std::min<SizeType>(64, codes.size() - i);
+            std::uint64_t w = 0;
+            for (SizeType j = 0; j < n; ++j) {
+                w |= std::uint64_t(hit[codes[i + j]]) << j;
+            }
+            words[i / 64] = w;
+        }
+        return out;
+    }
+
+    /// Returns a table of the rows set in `selection`, with all columns.
+    ///
+    /// Throws `std::invalid_argument` if a column does not have
+    /// `selection.size()` rows.
+    [[nodiscard]] ColumnTable gather(const DynamicBitset& selection) const {
+        return gather(selection, names_);
+    }
+
+    /// Returns a table of the rows set in `selection`, with only the columns
+    /// in `names`, in that order.
+    ///
+    /// The row numbers are taken from the bitmap once and every column is
+    /// then copied in a single pass, so only the requested values are ever
+    /// read.
+    ///
+    /// Throws `std::out_of_range` if a column does not exist,
+    /// `std::invalid_argument` if it does not have `selection.size()` rows,
+    /// and `std::length_error` if there are 2^32 rows or more.
+    [[nodiscard]] ColumnTable gather(const DynamicBitset& selection,
+                                     const Vector<std::string>& names) const {
+        if (selection.size() > std::uint32_t(-1)) {
+            throw std::length_error("ColumnTable: too many rows to gather");
+        }
+        Vector<std::uint32_t> rows;
+        rows.reserve(selection.count());
+        selection.for_each_set(
+            [&rows](std::size_t pos) { rows.push_back(std::uint32_t(pos)); });
+
+        ColumnTable out;
+        for (const std::string& name : names) {
+            const Column& c = columns_[indexOf(name)];
+            if (columnSize(c) != selection.size()) {
+                throw std::invalid_argument(
+                    "ColumnTable: selection size does not match column " +
+                    name);
+            }
+            out.addColumn(name, std::visit(
+                                    [&rows](const auto& values) -> Column {
+                                        return gatherColumn(values, rows);
+                                    },
+                                    c));
+        }
+        return out;
+    }
+
+private:
+    Column& addColumn(const std::string& name, Column c) {
+        if (contains(name)) {
+            throw std::invalid_argument("ColumnTable: duplicate column " +
+                                        name);
+        }
+        names_.push_back(name);
+        columns_.push_back(std::move(c));
+        return columns_.back();
+    }
+
+    SizeType indexOf(const std::string& name) const {
+        const auto it = std::find(names_.begin(), names_.end(), name);
+        if (it == names_.end()) {
+            throw std::out_of_range("ColumnTable: no column named " + name);
+        }
+        return SizeType(it - names_.begin());
+    }
+
+    template <typename C>
+    C& typedColumn(const std::string& name) {
+        C* c = std::get_if<C>(&columns_[indexOf(name)]);
+        if (c == nullptr) {
+            throw std::invalid_argument("ColumnTable: column " + name +
+                                        " has another type");
+        }
+        return *c;
+    }
+
+    static SizeType columnSize(const Column& c) noexcept {
+        return std::visit([](const auto& values) { return values.size(); },
+                          c);
+    }
+
+    template <typename T>
+    static Vector<T> gatherColumn(const Vector<T>& values,
+                                  const Vector<std::uint32_t>& rows) {
+        Vector<T> out(rows.size());
+        detail::gatherRows(values.data(), rows.data(), rows.size(),
+                           out.data());
+        return out;
+    }
+
+    static DictionaryColumn gatherColumn(const DictionaryColumn& values,
+                                         const Vector<std::uint32_t>& rows) {
+        return values.gather(rows);
+    }
+
+private:
+    Vector<std::string> names_;
+    // A deque, so that references to columns survive adding more.
+    std::deque<Column> columns_;
+};
+} // namespace algo
@@ -0,0 +1,393 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
+#include "vector.hpp"
+
+namespace algo {
+namespace detail {
+// A thread-safe bump allocator carving memory out of large blocks. Memory is
+// released only when the arena is destroyed.
+class ConcurrentArena {
+public:
+    static constexpr std::size_t alignment = alignof(std::max_align_t);
+
+    explicit ConcurrentArena(std::size_t block_size = 1 << 20)
+        : block_size_(block_size) {}
+
+    ConcurrentArena(const ConcurrentArena&) = delete;
+    ConcurrentArena& operator=(const ConcurrentArena&) = delete;
+
+    ~ConcurrentArena() noexcept {
+        for (Block* b : blocks_) {
+            ::operator delete(b);
+        }
+    }
+
+    // Returns `n` bytes aligned to `alignment`.
+    void* allocate(std::size_t n) {
+        n = (n + alignment - 1) & ~(alignment - 1);
+        for (;;) {
+            Block* b = current_.load(std::memory_order_acquire);
+            if (b) {
+                const std::size_t off =
+                    b->used.fetch_add(n, std::memory_order_relaxed);
+                if (off + n <= b->capacity) {
+                    return b->data() + off;
+                }
+            }
+            grow(b, n);
+        }
+    }
+
+    // Returns the number of bytes reserved from the system.
+    std::size_t memory_usage() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::size_t total = 0;
+        for (const Block* b : blocks_) {
+            total += b->capacity;
+        }
+        return total;
+    }
+
+private:
+    struct alignas(alignment) Block {
+        std::atomic<std::size_t> used;
+        std::size_t capacity;
+
+        char* data() noexcept {
+            return reinterpret_cast<char*>(this + 1);
+        }
+    };
+
+    // Replaces the exhausted block `full` unless another thread already did.
+    void grow(Block* full, std::size_t n) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (current_.load(std::memory_order_relaxed) != full) {
+            return;
+        }
+
+        const std::size_t capacity = std::max(block_size_, n);
+        void* p = ::operator new(sizeof(Block) + capacity);
+        Block* b = new (p) Block{{0}, capacity};
+        blocks_.push_back(b);
+        current_.store(b, std::memory_order_release);
+    }
+
+private:
+    const std::size_t block_size_;
+    std::atomic<Block*> current_{nullptr};
+    mutable std::mutex mutex_;
+    Vector<Block*> blocks_;
+};
+} // namespace detail
+
+/// An ordered map supporting lock-free concurrent `insert()` and lookups.
+///
+/// Every node is allocated with its whole tower of forward pointers in one
+/// piece, out of large blocks owned by the list, so an insert is a single
+/// bump allocation followed by compare-and-swap on each level. Nodes are never
+/// removed or moved, hence lookups and iteration may run concurrently with
+/// inserts: an iterator observes every key inserted before it reached the
+/// key's position, and possibly some inserted later.
+///
+/// Keys are unique and values are immutable once inserted, which is the
+/// contract of an in-memory write buffer. There is no `erase()`; memory is
+/// released when the list is destroyed.
+///
+/// # Example
+///
+/// ```cpp
+/// ConcurrentSkipList<int, std::string> list;
+/// std::thread t([&] { list.insert(2, "two"); });
+/// list.insert(1, "one");
+/// t.join();
+///
+/// for (auto it = list.begin(); it != list.end(); ++it) {
+///     // visits 1 then 2
+/// }
+/// assert(*list.find(2) == "two");
+/// ```
+template <typename K, typename V, typename Compare = std::less<K>>
+class ConcurrentSkipList {
+public:
+    using KeyType = K;
+    using MappedType = V;
+    using SizeType = std::size_t;
+
+    /// Maximum height of a tower.
+    static constexpr int max_height = 12;
+
+private:
+    struct Node {
+        K key;
+        V value;
+        // The tower continues past the end of the node.
+        std::atomic<Node*> next[1];
+
+        Node* load(int level) const noexcept {
+            return next[level].load(std::memory_order_acquire);
+        }
+    };
+
+public:
+    /// A forward iterator over the list in key order. It stays valid while
+    /// other threads insert.
+    class ConstIterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::pair<const K&, const V&>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = value_type;
+
+        ConstIterator() = default;
+
+        const K& key() const noexcept {
+            return node_->key;
+        }
+
+        const V& value() const noexcept {
+            return node_->value;
+        }
+
+        reference operator*() const noexcept {
+            return {node_->key, node_->value};
+        }
+
+        ConstIterator& operator++() noexcept {
+            node_ = node_->load(0);
+            return *this;
+        }
+
+        ConstIterator operator++(int) noexcept {
+            ConstIterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        friend bool operator==(ConstIterator x, ConstIterator y) noexcept {
+            return x.node_ == y.node_;
+        }
+
+        friend bool operator!=(ConstIterator x, ConstIterator y) noexcept {
+            return x.node_ != y.node_;
+        }
+
+    private:
+        friend class ConcurrentSkipList;
+
+        explicit ConstIterator(const Node* node) noexcept : node_(node) {}
+
+        const Node* node_ = nullptr;
+    };
+
+    /// Constructs an empty list whose nodes are allocated from blocks of
+    /// `block_size` bytes.
+    explicit ConcurrentSkipList(const Compare& comp = Compare(),
+                                std::size_t block_size = 1 << 20)
+        : comp_(comp), arena_(block_size) {
+        head_ = allocateNode(max_height);
+    }
+
+    ConcurrentSkipList(const ConcurrentSkipList&) = delete;
+    ConcurrentSkipList& operator=(const ConcurrentSkipList&) = delete;
+
+    /// Destroys all keys and values. No other thread may access the list.
+    ~ConcurrentSkipList() noexcept {
+        for (Node* x = head_->load(0); x;) {
+            Node* next = x->load(0);
+            x->key.~K();
+            x->value.~V();
+            x = next;
+        }
+    }
+
+    /// Returns the number of keys. Concurrent inserts may not be reflected.
+    [[nodiscard]] SizeType size() const noexcept {
+        return size_.load(std::memory_order_relaxed);
+    }
+
+    /// Returns true if the list has no keys.
+    [[nodiscard]] bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    /// Returns the bytes allocated by the node pool.
+    SizeType memory_usage() const {
+        return arena_.memory_usage();
+    }
+
+    /// Inserts `key` with `value` if `key` is absent. Returns true if the key
+    /// was inserted. Thread-safe.
+    bool insert(const K& key, const V& value) {
+        Node* prev[max_height];
+        Node* next[max_height];
+        int list_height = height_.load(std::memory_order_acquire);
+        for (int level = max_height - 1; level >= list_height; --level) {
+            prev[level] = head_;
+            next[level] = nullptr;
+        }
+        Node* x = head_;
+        for (int level = list_height - 1; level >= 0; --level) {
+            findSplice(key, x, level, prev[level], next[level]);
+            x = prev[level];
+        }
+        if (next[0] && !comp_(key, next[0]->key)) {
+            return false;
+        }
+
+        const int height = randomHeight();
+        Node* node = newNode(key, value, height);
+        while (height > list_height &&
+               !height_.compare_exchange_weak(list_height, height,
+                                              std::memory_order_acq_rel)) {
+        }
+
+        for (int level = 0; level < height; ++level) {
+            for (;;) {
+                node->next[level].store(next[level], std::memory_order_relaxed);
+                if (prev[level]->next[level].compare_exchange_strong(
+                        next[level], node, std::memory_order_release,
+                        std::memory_order_relaxed)) {
+                    break;
+                }
+
+                // Lost a race, so find the splice again from the old
+                // predecessor, which is still before `key`.
+                findSplice(key, prev[level], level, prev[level], next[level]);
+                if (level == 0 && next[0] && !comp_(key, next[0]->key)) {
+                    // Another thread inserted the same key. The node never
+                    // became reachable, so only its contents are destroyed.
+                    node->key.~K();
+                    node->value.~V();
+                    return false;
+                }
+            }
+        }
+        size_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /// Returns a pointer to the value of `key`, or `nullptr` if absent.
+    /// Thread-safe.
+    const V* find(const K& key) const noexcept {
+        const Node* x = lowerBound(key);
+        return x && !comp_(key, x->key) ? &x->value : nullptr;
+    }
+
+    /// Returns true if `key` is present. Thread-safe.
+    bool contains(const K& key) const noexcept {
+        return find(key) != nullptr;
+    }
+
+    /// Returns an iterator to the smallest key.
+    ConstIterator begin() const noexcept {
+        return ConstIterator(head_->load(0));
+    }
+
+    /// Returns the past-the-end iterator.
+    ConstIterator end() const noexcept {
+        return ConstIterator();
+    }
+
+    /// Returns an iterator to the first key not less than `key`.
+    ConstIterator lower_bound(const K& key) const noexcept {
+        return ConstIterator(lowerBound(key));
+    }
+
+    /// Calls `f(key, value)` for every key in `[first, last)`, in order.
+    template <typename F>
+    void for_each_range(const K& first, const K& last, F&& f) const {
+        for (const Node* x = lowerBound(first); x && comp_(x->key, last);
+             x = x->load(0)) {
+            f(x->key, x->value);
+        }
+    }
+
+private:
+    static_assert(alignof(Node) <= detail::ConcurrentArena::alignment,
+                  "over-aligned keys or values are not supported");
+
+    // Allocates a node with a tower of `height` null pointers. The key and
+    // value are left unconstructed, which is how the head stays.
+    Node* allocateNode(int height) {
+        const std::size_t bytes =
+            sizeof(Node) + (height - 1) * sizeof(std::atomic<Node*>);
+        auto* node = static_cast<Node*>(arena_.allocate(bytes));
+        for (int level = 0; level < height; ++level) {
+            new (&node->next[level]) std::atomic<Node*>(nullptr);
+        }
+        return node;
+    }
+
+    Node* newNode(const K& key, const V& value, int height) {
+        Node* node = allocateNode(height);
+        new (&node->key) K(key);
+        try {
+            new (&node->value) V(value);
+        } catch (...) {
+            node->key.~K();
+            throw;
+        }
+        return node;
+    }
+
+    // Finds the nodes around `key` on `level`, starting from `before`, which
+    // must be before `key`.
+    void findSplice(const K& key, Node* before, int level, Node*& prev,
+                    Node*& next) const noexcept {
+        for (;;) {
+            Node* x = before->load(level);
+            if (!x || !comp_(x->key, key)) {
+                prev = before;
+                next = x;
+                return;
+            }
+            before = x;
+        }
+    }
+
+    const Node* lowerBound(const K& key) const noexcept {
+        Node* x = head_;
+        Node* next = nullptr;
+        for (int level = height_.load(std::memory_order_acquire) - 1;
+             level >= 0; --level) {
+            findSplice(key, x, level, x, next);
+        }
+        return next;
+    }
+
+    static int randomHeight() noexcept {
+        thread_local std::uint32_t state = std::uint32_t(
+            std::hash<std::thread::id>()(std::this_thread::get_id())) | 1;
+        // xorshift32, taking two bits per level for a 1/4 branching factor.
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        std::uint32_t bits = state;
+        int height = 1;
+        while (height < max_height && (bits & 3) == 0) {
+            ++height;
+            bits >>= 2;
+        }
+        return height;
+    }
+
+private:
+    [[no_unique_address]] Compare comp_;
+    detail::ConcurrentArena arena_;
+    Node* head_;
+    std::atomic<int> height_{1};
+    std::atomic<SizeType> size_{0};
+};
+} // namespace algo
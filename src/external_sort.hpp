@@ -0,0 +1,308 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <future>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "file_io.hpp"
+#include "merge.hpp"
+#include "thread_pool.hpp"
+#include "vector.hpp"
+
+namespace algo {
+namespace detail {
+// Creates a scratch file next to `output` under a fresh name, so no existing
+// file is touched, and unlinks it right away, so it goes away with the
+// descriptor even if sorting fails.
+inline FileDescriptor scratchFile(const std::string& output) {
+    std::string path = output + ".sortXXXXXX";
+    const int fd = ::mkostemp(path.data(), O_CLOEXEC);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(),
+                                "external_sort: create " + path);
+    }
+    ::unlink(path.c_str());
+    return FileDescriptor(fd);
+}
+
+// Reads `count` records of `T` starting at record `index`.
+template <typename T>
+void readRecords(int fd, T* out, std::size_t count, std::uint64_t index) {
+    auto* p = reinterpret_cast<char*>(out);
+    const std::size_t bytes = count * sizeof(T);
+    const std::uint64_t offset = index * sizeof(T);
+    for (std::size_t done = 0; done < bytes;) {
+        const ssize_t r =
+            ::pread(fd, p + done, bytes - done, off_t(offset + done));
+        if (r < 0 && errno == EINTR) {
+            continue;
+        }
+        if (r < 0) {
+            throw std::system_error(errno, std::generic_category(),
+                                    "external_sort: read");
+        }
+        if (r == 0) {
+            throw std::runtime_error("external_sort: unexpected end of file");
+        }
+        done += std::size_t(r);
+    }
+}
+
+// Writes `count` records of `T` starting at record `index`.
+template <typename T>
+void writeRecords(int fd, const T* in, std::size_t count,
+                  std::uint64_t index) {
+    const auto* p = reinterpret_cast<const char*>(in);
+    const std::size_t bytes = count * sizeof(T);
+    const std::uint64_t offset = index * sizeof(T);
+    for (std::size_t done = 0; done < bytes;) {
+        const ssize_t r =
+            ::pwrite(fd, p + done, bytes - done, off_t(offset + done));
+        if (r < 0 && errno == EINTR) {
+            continue;
+        }
+        if (r < 0) {
+            throw std::system_error(errno, std::generic_category(),
+                                    "external_sort: write");
+        }
+        done += std::size_t(r);
+    }
+}
+
+// A sorted run of records. Runs keep the record positions of the input they
+// were formed from, so a merged group is written where its first run starts.
+struct ExternalRun {
+    std::uint64_t first;
+    std::uint64_t count;
+};
+
+// Sorts the input in chunks of `run_length` records into runs at the same
+// positions of `dst`. Each chunk is written behind while the next one is
+// read, so the two buffers take turns.
+template <typename T, typename Compare>
+Vector<ExternalRun> formRuns(int src, std::uint64_t n, int dst,
+                             std::size_t run_length, Compare& comp) {
+    Vector<T> buffers[2] = {Vector<T>(run_length), Vector<T>(run_length)};
+    Vector<ExternalRun> runs;
+    std::future<void> written[2];
+    ThreadPool io(1);
+    unsigned side = 0;
+    for (std::uint64_t first = 0; first < n; first += run_length) {
+        const std::size_t count = std::size_t(std::min<std::uint64_t>(
+            run_length, n - first));
+        if (written[side].valid()) {
+            written[side].get();
+        }
+        T* buffer = buffers[side].data();
+        readRecords(src, buffer, count, first);
+        std::sort(buffer, buffer + count, comp);
+        written[side] = io.submit(
+            [=] { writeRecords(dst, buffer, count, first); });
+        runs.push_back({first, count});
+        side ^= 1;
+    }
+    for (std::future<void>& w : written) {
+        if (w.valid()) {
+            w.get();
+        }
+    }
+    return runs;
+}
+
+// Merges `k` runs of `src` into one run of `dst` through blocks of `block`
+// records. Every run and the output have two blocks: while the merge uses
+// one, the next block of the run is read ahead, or the last block of output
+// is written behind.
+template <typename T, typename Compare>
+void mergeExternalRuns(int src, const ExternalRun* runs, std::size_t k,
+                       int dst, std::size_t block, Compare& comp) {
+    Vector<T> arena((2 * k + 2) * block);
+    Vector<std::uint64_t> next(k, 0);
+    Vector<std::uint64_t> end(k, 0);
+    Vector<unsigned> side(k, 0);
+    std::vector<std::future<std::size_t>> pending(k);
+    std::future<void> written;
+    // Declared last so that queued reads and writes finish before the
+    // buffers go away, also when an exception unwinds.
+    ThreadPool io(2);
+
+    auto buffer = [&](std::size_t i, unsigned s) {
+        return arena.data() + (2 * i + s) * block;
+    };
+    auto prefetch = [&](std::size_t i) {
+        if (next[i] == end[i]) {
+            return;
+        }
+        const std::size_t count =
+            std::size_t(std::min<std::uint64_t>(block, end[i] - next[i]));
+        T* buf = buffer(i, side[i]);
+        const std::uint64_t at = next[i];
+        next[i] += count;
+        pending[i] = io.submit([=] {
+            readRecords(src, buf, count, at);
+            return count;
+        });
+    };
+    auto refill = [&](MergeSource<T>& source, std::size_t i) {
+        if (!pending[i].valid()) {
+            return false;
+        }
+        const std::size_t count = pending[i].get();
+        const T* buf = buffer(i, side[i]);
+        source = {buf, buf + count};
+        side[i] ^= 1;
+        prefetch(i);
+        return true;
+    };
+
+    Vector<MergeSource<T>> sources(k);
+    for (std::size_t i = 0; i < k; ++i) {
+        next[i] = runs[i].first;
+        end[i] = runs[i].first + runs[i].count;
+        prefetch(i);
+    }
+    for (std::size_t i = 0; i < k; ++i) {
+        refill(sources[i], i);
+    }
+
+    unsigned out_side = 0;
+    T* out = buffer(k, out_side);
+    T* out_end = out + block;
+    std::uint64_t out_at = runs[0].first;
+    auto flush = [&] {
+        const T* buf = buffer(k, out_side);
+        const std::size_t count = std::size_t(out - buf);
+        const std::uint64_t at = out_at;
+        if (written.valid()) {
+            written.get();
+        }
+        written = io.submit([=] { writeRecords(dst, buf, count, at); });
+        out_at += count;
+        out_side ^= 1;
+        out = buffer(k, out_side);
+        out_end = out + block;
+    };
+
+    LoserTree<T, Compare, decltype(refill)> tree(sources, comp, refill);
+    do {
+        *out++ = *tree.winner().cur++;
+        if (out == out_end) {
+            flush();
+        }
+    } while (tree.replay());
+    flush();
+    written.get();
+}
+} // namespace detail
+
+/// Sorts the file `input`, an array of `T`, into the file `output` using
+/// about `mem_budget` bytes of memory.
+///
+/// The input is cut into runs of half the budget, which are sorted in memory
+/// and written to a scratch file while the next run is read. The runs are
+/// then merged with a loser tree in as few passes as blocks of at least
+/// 64 KiB allow, alternating between two scratch files and writing the last
+/// pass to `output`. Every run being merged reads its next block ahead and
+/// the output is written behind, both on background threads, so the disk
+/// stays busy while the merge computes. All I/O is in large sequential
+/// blocks.
+///
+/// The scratch files are created next to `output` and unlinked at once.
+/// `input` and `output` may be the same file, since the output is only
+/// opened after the input has been read.
+///
+/// Throws `std::invalid_argument` if the input size is not a multiple of
+/// `sizeof(T)` or `mem_budget` holds fewer than six records, and
+/// `std::system_error` if a file operation fails.
+///
+/// # Example
+///
+/// ```cpp
+/// // Sorts 500 GB of records with 16 GB of memory.
+/// external_sort<std::uint64_t>("keys.bin", "sorted.bin", 16ull << 30);
+/// ```
+template <typename T, typename Compare = std::less<T>>
+void external_sort(const std::string& input, const std::string& output,
+                   std::size_t mem_budget, Compare comp = Compare()) {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "external_sort needs trivially copyable records");
+    const std::size_t memory = mem_budget / sizeof(T);
+    if (memory < 6) {
+        throw std::invalid_argument("external_sort: memory budget too small");
+    }
+
+    detail::FileDescriptor in(input, O_RDONLY);
+    struct stat st;
+    if (::fstat(in.get(), &st) != 0) {
+        throw std::system_error(errno, std::generic_category(),
+                                "external_sort: stat " + input);
+    }
+    const std::uint64_t bytes = std::uint64_t(st.st_size);
+    if (bytes % sizeof(T) != 0) {
+        throw std::invalid_argument(
+            "external_sort: input size is not a multiple of the record size");
+    }
+    const std::uint64_t n = bytes / sizeof(T);
+
+    // A single run is sorted in memory and written straight to the output.
+    if (n <= memory) {
+        Vector<T> values(static_cast<std::size_t>(n));
+        detail::readRecords(in.get(), values.data(), values.size(), 0);
+        std::sort(values.begin(), values.end(), comp);
+        detail::FileDescriptor out(output, O_WRONLY | O_CREAT | O_TRUNC);
+        detail::writeRecords(out.get(), values.data(), values.size(), 0);
+        return;
+    }
+
+    detail::FileDescriptor scratch[2] = {detail::scratchFile(output),
+                                         detail::scratchFile(output)};
+    Vector<detail::ExternalRun> runs = detail::formRuns<T>(
+        in.get(), n, scratch[0].get(), memory / 2, comp);
+
+    // Each pass merges groups of `fan_in` runs with two blocks per run and
+    // two for the output.
+    const std::size_t target_block = std::max<std::size_t>(
+        (std::size_t(1) << 16) / sizeof(T), 1);
+    const std::size_t fan_in = std::clamp<std::size_t>(
+        memory / (2 * target_block), 3, runs.size() + 1) - 1;
+    const std::size_t block = memory / (2 * fan_in + 2);
+
+    unsigned src = 0;
+    for (;;) {
+        const bool last = runs.size() <= fan_in;
+        std::optional<detail::FileDescriptor> out;
+        if (last) {
+            out.emplace(output, O_WRONLY | O_CREAT | O_TRUNC);
+        }
+        const int dst = last ? out->get() : scratch[src ^ 1].get();
+
+        Vector<detail::ExternalRun> merged;
+        for (std::size_t g = 0; g < runs.size(); g += fan_in) {
+            const std::size_t k = std::min(fan_in, runs.size() - g);
+            detail::mergeExternalRuns<T>(scratch[src].get(), runs.data() + g,
+                                         k, dst, block, comp);
+            merged.push_back({runs[g].first, 0});
+            for (std::size_t i = g; i < g + k; ++i) {
+                merged.back().count += runs[i].count;
+            }
+        }
+        if (last) {
+            return;
+        }
+        runs = std::move(merged);
+        src ^= 1;
+    }
+}
+} // namespace algo
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include "vector.hpp"
+
+namespace algo {
+namespace detail {
+// Owns an open POSIX file descriptor.
+class FileDescriptor {
+public:
+    FileDescriptor(const std::string& path, int flags, mode_t mode = 0644)
+        : fd_(::open(path.c_str(), flags | O_CLOEXEC, mode)) {
+        if (fd_ < 0) {
+            throw std::system_error(errno, std::generic_category(),
+                                    "open " + path);
+        }
+    }
+
+    // Takes ownership of the open descriptor `fd`.
+    explicit FileDescriptor(int fd) noexcept : fd_(fd) {}
+
+    FileDescriptor(FileDescriptor&& other) noexcept
+        : fd_(std::exchange(other.fd_, -1)) {}
+
+    FileDescriptor(const FileDescriptor&) = delete;
+    FileDescriptor& operator=(const FileDescriptor&) = delete;
+
+    ~FileDescriptor() noexcept {
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    int get() const noexcept {
+        return fd_;
+    }
+
+private:
+    int fd_;
+};
+
+// Reads at most `bytes` bytes, returning zero only at the end of the input.
+inline std::size_t readSome(int fd, char* p, std::size_t bytes) {
+    for (;;) {
+        const ssize_t r = ::read(fd, p, bytes);
+        if (r >= 0) {
+            return std::size_t(r);
+        }
+        if (errno != EINTR) {
+            throw std::system_error(errno, std::generic_category(),
+                                    "append_from_fd: read");
+        }
+    }
+}
+} // namespace detail
+
+/// Appends the raw values of type `T` read from `fd` to `v`, at most
+/// `max_bytes` bytes of them, and returns the number of values appended.
+///
+/// The bytes are read straight into the spare capacity of `v`, with no
+/// staging buffer. For a regular file, the rest of the file is sized with
+/// `fstat()` and read into an exactly reserved range, in as few `read()`
+/// calls as the kernel allows. Pipes, sockets, terminals and files that
+/// report a size of zero, as those of procfs and sysfs do, are read in
+/// chunks of growing size until the end of the input, taking each chunk as
+/// soon as it ends on a whole value, so the call returns once the writer
+/// closes its end.
+///
+/// Throws `std::runtime_error` if the input ends inside a value and
+/// `std::system_error` if reading fails. The values read before an error
+/// stay appended, except for a chunk that was being read.
+///
+/// # Example
+///
+/// ```cpp
+/// Vector<std::uint32_t> ids;
+/// append_from_fd(ids, STDIN_FILENO);
+/// ```
+template <typename T, typename Alloc>
+std::size_t append_from_fd(Vector<T, Alloc>& v, int fd,
+                           std::size_t max_bytes = std::size_t(-1)) {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "append_from_fd needs trivially copyable values");
+    const std::size_t limit = max_bytes / sizeof(T);
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        throw std::system_error(errno, std::generic_category(),
+                                "append_from_fd: stat");
+    }
+    // Pseudo-files report a size of zero whatever they hold, like an empty
+    // file, which the chunked loop reads just as well.
+    const off_t offset = S_ISREG(st.st_mode) && st.st_size > 0
+                             ? ::lseek(fd, 0, SEEK_CUR)
+                             : off_t(-1);
+    const bool sized = offset >= 0;
+
+    std::size_t chunk = std::max<std::size_t>((1 << 16) / sizeof(T), 1);
+    if (sized) {
+        const std::uint64_t rest =
+            st.st_size > offset ? std::uint64_t(st.st_size - offset) : 0;
+        if (rest % sizeof(T) != 0 && rest / sizeof(T) < limit) {
+            throw std::runtime_error("append_from_fd: input ends inside a "
+                                     "value");
+        }
+        chunk = std::size_t(std::min<std::uint64_t>(rest / sizeof(T), limit));
+    }
+
+    std::size_t appended = 0;
+    bool done = false;
+    while (!done && appended < limit && chunk > 0) {
+        const std::size_t old_size = v.size();
+        const std::size_t want = std::min(chunk, limit - appended);
+        if (sized) {
+            // Exactly the rest of the file, not the geometric growth of
+            // `resize_and_overwrite()`.
+            v.reserve(old_size + want);
+        }
+        v.resize_and_overwrite(old_size + want, [&](T* p, std::size_t) {
+            char* dst = reinterpret_cast<char*>(p + old_size);
+            const std::size_t room = want * sizeof(T);
+            std::size_t bytes = 0;
+            while (bytes < room) {
+                const std::size_t r =
+                    detail::readSome(fd, dst + bytes, room - bytes);
+                if (r == 0) {
+                    done = true;
+                    break;
+                }
+                bytes += r;
+                if (!sized && bytes % sizeof(T) == 0) {
+                    break;
+                }
+            }
+            if (bytes % sizeof(T) != 0) {
+                throw std::runtime_error(
+                    "append_from_fd: input ends inside a value");
+            }
+            return old_size + bytes / sizeof(T);
+        });
+        appended += v.size() - old_size;
+        // The size of a regular file is known, so there is nothing to wait
+        // for once it has been read.
+        done = done || sized;
+        chunk = std::min(chunk * 2, std::max<std::size_t>(
+                                        (std::size_t(1) << 24) / sizeof(T),
+                                        1));
+    }
+    return appended;
+}
+
+/// Replaces the contents of `v` with the raw values of type `T` stored in
+/// the file at `path`.
+///
+/// The file is read with `append_from_fd()`, so `v` is reserved to the size
+/// reported by `fstat()` and filled in place.
+///
+/// Throws `std::system_error` if the file cannot be opened or read, and
+/// `std::runtime_error` if its size is not a multiple of `sizeof(T)`.
+///
+/// # Example
+///
+/// ```cpp
+/// Vector<double> samples;
+/// read_file_into(samples, "samples.bin");
+/// ```
+template <typename T, typename Alloc>
+void read_file_into(Vector<T, Alloc>& v, const std::string& path) {
+    detail::FileDescriptor fd(path, O_RDONLY);
+    v.clear();
+    append_from_fd(v, fd.get());
+}
+} // namespace algo
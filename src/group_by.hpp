@@ -0,0 +1,474 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "cache.hpp"
+#include "simd.hpp"
+#include "thread_pool.hpp"
+#include "vector.hpp"
+
+namespace algo {
+/// An aggregate computed per group by `group_by()`.
+enum class Aggregate { sum, count, min, max, avg };
+
+/// The groups found by `group_by()`, one entry per group in each vector.
+///
+/// Only the vectors of the requested aggregates are filled; the others stay
+/// empty. Sums of integers are kept in 64 bits and wrap on overflow.
+template <typename K, typename V>
+struct GroupByResult {
+    using SumType = std::conditional_t<
+        std::is_floating_point_v<V>, double,
+        std::conditional_t<std::is_signed_v<V>, std::int64_t, std::uint64_t>>;
+
+    Vector<K> keys;
+    Vector<std::uint64_t> count;
+    Vector<SumType> sum;
+    Vector<V> min;
+    Vector<V> max;
+    Vector<double> avg;
+};
+
+namespace detail {
+// Whether `mixHashes()` has SIMD kernels for keys of type `K`, which are
+// widened to 64 bits as `std::size_t(key)` does.
+template <typename K>
+constexpr bool is_simd_hashable =
+    std::is_integral_v<K> && (sizeof(K) == 4 || sizeof(K) == 8);
+
+#if defined(ALGO_SIMD_X86)
+// The steps of `mixHash()` on four keys. AVX2 has no 64-bit multiply, so
+// each product is put together from three 32-bit ones.
+template <typename K>
+struct MixLanesAvx2 {
+    static constexpr std::size_t width = 4;
+
+    __attribute__((target("avx2"))) static void
+    mix(const K* keys, std::uint64_t* out) noexcept {
+        __m256i x;
+        if constexpr (sizeof(K) == 8) {
+            x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys));
+        } else {
+            const __m128i k =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys));
+            x = std::is_signed_v<K> ? _mm256_cvtepi32_epi64(k)
+                                    : _mm256_cvtepu32_epi64(k);
+        }
+        x = _mm256_xor_si256(x, _mm256_srli_epi64(x, 33));
+        x = multiply(x, 0xff51afd7ed558ccdULL);
+        x = _mm256_xor_si256(x, _mm256_srli_epi64(x, 33));
+        x = multiply(x, 0xc4ceb9fe1a85ec53ULL);
+        x = _mm256_xor_si256(x, _mm256_srli_epi64(x, 33));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), x);
+    }
+
+private:
+    // Returns the low 64 bits of every lane of `x` times `m`.
+    __attribute__((target("avx2"))) static __m256i
+    multiply(__m256i x, std::uint64_t m) noexcept {
+        const __m256i lo = _mm256_set1_epi64x((long long)(m & 0xffffffff));
+        const __m256i hi = _mm256_set1_epi64x((long long)(m >> 32));
+        const __m256i cross =
+            _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(x, 32), lo),
+                             _mm256_mul_epu32(x, hi));
+        return _mm256_add_epi64(_mm256_mul_epu32(x, lo),
+                                _mm256_slli_epi64(cross, 32));
+    }
+};
+
+// The steps of `mixHash()` on eight keys. The shifts and widening take the
+// zero-masking forms, since GCC 12 warns about the undefined source operand
+// of the plain ones.
+template <typename K>
+struct MixLanesAvx512 {
+    static constexpr std::size_t width = 8;
+
+    __attribute__((target("avx512f,avx512dq"))) static void
+    mix(const K* keys, std::uint64_t* out) noexcept {
+        const __m512i m1 = _mm512_set1_epi64(0xff51afd7ed558ccdLL);
+        const __m512i m2 = _mm512_set1_epi64(0xc4ceb9fe1a85ec53LL);
+        __m512i x;
+        if constexpr (sizeof(K) == 8) {
+            x = _mm512_loadu_si512(keys);
+        } else {
+            const __m256i k =
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys));
+            x = std::is_signed_v<K> ? _mm512_maskz_cvtepi32_epi64(all, k)
+                                    : _mm512_maskz_cvtepu32_epi64(all, k);
+        }
+        x = _mm512_xor_si512(x, _mm512_maskz_srli_epi64(all, x, 33));
+        x = _mm512_mullo_epi64(x, m1);
+        x = _mm512_xor_si512(x, _mm512_maskz_srli_epi64(all, x, 33));
+        x = _mm512_mullo_epi64(x, m2);
+        x = _mm512_xor_si512(x, _mm512_maskz_srli_epi64(all, x, 33));
+        _mm512_storeu_si512(out, x);
+    }
+
+private:
+    static constexpr __mmask8 all = 0xff;
+};
+#endif
+
+// Writes `mixHash(key)` of `n` keys to `out`, `Lanes::width` at a time or,
+// if `Lanes` is `void`, one at a time.
+template <typename Lanes, typename K>
+__attribute__((always_inline)) inline void
+mixHashesWith(const K* keys, std::size_t n, std::uint64_t* out) noexcept {
+    std::size_t i = 0;
+    if constexpr (!std::is_void_v<Lanes>) {
+        for (; i + Lanes::width <= n; i += Lanes::width) {
+            Lanes::mix(keys + i, out + i);
+        }
+    }
+    for (; i < n; ++i) {
+        out[i] = mixHash(std::size_t(keys[i]));
+    }
+}
+
+template <typename K>
+void mixHashesScalar(const K* keys, std::size_t n,
+                     std::uint64_t* out) noexcept {
+    mixHashesWith<void>(keys, n, out);
+}
+
+// Two 64-bit lanes save nothing over scalar multiplies, so SSE2 has no
+// kernel of its own.
+#if defined(ALGO_SIMD_X86)
+template <typename K>
+__attribute__((target("avx2"))) void
+mixHashesAvx2(const K* keys, std::size_t n, std::uint64_t* out) noexcept {
+    mixHashesWith<MixLanesAvx2<K>>(keys, n, out);
+}
+
+template <typename K>
+__attribute__((target("avx512f,avx512dq"))) void
+mixHashesAvx512(const K* keys, std::size_t n, std::uint64_t* out) noexcept {
+    mixHashesWith<MixLanesAvx512<K>>(keys, n, out);
+}
+
+template <typename K>
+inline const simd::Dispatch<void(const K*, std::size_t, std::uint64_t*)>
+    mix_hashes(mixHashesScalar<K>, nullptr, mixHashesAvx2<K>,
+               mixHashesAvx512<K>);
+#else
+template <typename K>
+inline const simd::Dispatch<void(const K*, std::size_t, std::uint64_t*)>
+    mix_hashes(mixHashesScalar<K>);
+#endif
+
+// Writes `mixHash(key)` of `n` keys to `out`, with the widest registers the
+// running CPU has for 32-bit and 64-bit integers.
+template <typename K>
+void mixHashes(const K* keys, std::size_t n, std::uint64_t* out) noexcept {
+    if constexpr (is_simd_hashable<K>) {
+        mix_hashes<K>(keys, n, out);
+    } else {
+        mixHashesScalar(keys, n, out);
+    }
+}
+
+// An open-addressing table from keys to group numbers, with the aggregate
+// state of the groups in flat vectors. The top `shift` bits of the hashes
+// choose the partition of the table and are skipped.
+template <typename K, typename V>
+class GroupTable {
+    using Result = GroupByResult<K, V>;
+
+public:
+    // Rows are added in batches of this many.
+    static constexpr std::size_t batch = 1024;
+
+    GroupTable(const Vector<Aggregate>& aggregates, unsigned shift)
+        : shift_(shift) {
+        for (Aggregate a : aggregates) {
+            wanted_ |= 1u << unsigned(a);
+        }
+        counts_ = wanted(Aggregate::count) || wanted(Aggregate::avg);
+        sums_ = wanted(Aggregate::sum) || wanted(Aggregate::avg);
+        mins_ = wanted(Aggregate::min);
+        maxs_ = wanted(Aggregate::max);
+        slots_.assign(SizeType(1) << bits_, Slot{K(), 0});
+    }
+
+    // Adds at most `batch` rows with the hashes of their keys, prefetching
+    // the slot of a row a few rows before probing it.
+    void add(const K* keys, const V* values, const std::uint64_t* hashes,
+             std::size_t n) {
+        constexpr std::size_t distance = 16;
+        for (std::size_t i = 0; i < std::min(distance, n); ++i) {
+            __builtin_prefetch(&slots_[index(hashes[i])]);
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            if (i + distance < n) {
+                __builtin_prefetch(&slots_[index(hashes[i + distance])]);
+            }
+            update(findOrInsert(keys[i], hashes[i], values[i]), values[i]);
+        }
+    }
+
+    Result finish() {
+        if (wanted(Aggregate::avg)) {
+            out_.avg.resize(out_.keys.size());
+            for (SizeType g = 0; g < out_.keys.size(); ++g) {
+                out_.avg[g] = double(out_.sum[g]) / double(out_.count[g]);
+            }
+        }
+        if (!wanted(Aggregate::count)) {
+            out_.count.clear();
+        }
+        if (!wanted(Aggregate::sum)) {
+            out_.sum.clear();
+        }
+        return std::move(out_);
+    }
+
+private:
+    using SizeType = std::size_t;
+
+    struct Slot {
+        K key;
+        // Group number + 1, or 0 for an empty slot.
+        std::uint32_t group;
+    };
+
+    bool wanted(Aggregate a) const noexcept {
+        return wanted_ >> unsigned(a) & 1;
+    }
+
+    SizeType index(std::uint64_t h) const noexcept {
+        return SizeType((h << shift_) >> (64 - bits_));
+    }
+
+    std::uint32_t findOrInsert(K key, std::uint64_t h, V value) {
+        const SizeType mask = slots_.size() - 1;
+        for (SizeType i = index(h);; i = (i + 1) & mask) {
+            Slot& s = slots_[i];
+            if (s.group != 0 && s.key == key) {
+                return s.group - 1;
+            }
+            if (s.group == 0) {
+                const std::uint32_t g = std::uint32_t(out_.keys.size());
+                s = {key, g + 1};
+                addGroup(key, value);
+                if (2 * out_.keys.size() > slots_.size()) {
+                    grow();
+                }
+                return g;
+            }
+        }
+    }
+
+    void addGroup(K key, V value) {
+        if (out_.keys.size() == std::numeric_limits<std::uint32_t>::max()) {
+            throw std::length_error("group_by: too many groups");
+        }
+        out_.keys.push_back(key);
+        if (counts_) {
+            out_.count.push_back(0);
+        }
+        if (sums_) {
+            out_.sum.push_back(0);
+        }
+        if (mins_) {
+            out_.min.push_back(value);
+        }
+        if (maxs_) {
+            out_.max.push_back(value);
+        }
+    }
+
+    void update(std::uint32_t g, V value) noexcept {
+        if (counts_) {
+            ++out_.count[g];
+        }
+        if (sums_) {
+            out_.sum[g] += value;
+        }
+        if (mins_) {
+            out_.min[g] = std::min(out_.min[g], value);
+        }
+        if (maxs_) {
+            out_.max[g] = std::max(out_.max[g], value);
+        }
+    }
+
+    void grow() {
+        ++bits_;
+        slots_.assign(SizeType(1) << bits_, Slot{K(), 0});
+        const SizeType mask = slots_.size() - 1;
+        for (std::uint32_t g = 0; g < out_.keys.size(); ++g) {
+            const K key = out_.keys[g];
+            SizeType i = index(mixHash(std::size_t(key)));
+            while (slots_[i].group != 0) {
+                i = (i + 1) & mask;
+            }
+            slots_[i] = {key, g + 1};
+        }
+    }
+
+private:
+    unsigned shift_;
+    unsigned bits_ = 8;
+    unsigned wanted_ = 0;
+    bool counts_;
+    bool sums_;
+    bool mins_;
+    bool maxs_;
+    Vector<Slot> slots_;
+    Result out_;
+};
+
+template <typename K, typename V>
+void checkGroupBy(const Vector<K>& keys, const Vector<V>& values) {
+    static_assert(std::is_integral_v<K>, "group_by needs integer keys");
+    static_assert(std::is_arithmetic_v<V>, "group_by needs numeric values");
+    if (keys.size() != values.size()) {
+        throw std::invalid_argument("group_by: key and value counts differ");
+    }
+}
+
+// Appends the groups of `part` to `out`.
+template <typename K, typename V>
+void appendGroups(GroupByResult<K, V>& out, GroupByResult<K, V>& part) {
+    out.keys.insert(out.keys.end(), part.keys.begin(), part.keys.end());
+    out.count.insert(out.count.end(), part.count.begin(), part.count.end());
+    out.sum.insert(out.sum.end(), part.sum.begin(), part.sum.end());
+    out.min.insert(out.min.end(), part.min.begin(), part.min.end());
+    out.max.insert(out.max.end(), part.max.begin(), part.max.end());
+    out.avg.insert(out.avg.end(), part.avg.begin(), part.avg.end());
+}
+} // namespace detail
+
+/// Groups `values` by the `keys` of the same rows and computes the
+/// `aggregates` of every group.
+///
+/// The rows are processed in batches of 1024: the keys of a batch are hashed
+/// at once, eight per AVX-512 register when the build enables it, and each
+/// row then probes an open-addressing table whose slot was prefetched 16 rows
+/// earlier. The aggregate states are flat vectors indexed by group number,
+/// so updates touch one element per aggregate.
+///
+/// The groups are returned in the order of their first rows.
+///
+/// Throws `std::invalid_argument` if `keys` and `values` differ in size.
+///
+/// # Example
+///
+/// ```cpp
+/// Vector<std::uint32_t> store = {1, 2, 1, 1};
+/// Vector<double> amount = {10, 5, 20, 30};
+/// auto r = group_by(store, amount, {Aggregate::sum, Aggregate::max});
+/// assert(r.keys == Vector<std::uint32_t>({1, 2}));
+/// assert(r.sum[0] == 60 && r.max[0] == 30 && r.count.empty());
+/// ```
+template <typename K, typename V>
+GroupByResult<K, V> group_by(const Vector<K>& keys, const Vector<V>& values,
+                             const Vector<Aggregate>& aggregates) {
+    detail::checkGroupBy(keys, values);
+    constexpr std::size_t batch = detail::GroupTable<K, V>::batch;
+    detail::GroupTable<K, V> table(aggregates, 0);
+    std::uint64_t hashes[batch];
+    for (std::size_t i = 0; i < keys.size(); i += batch) {
+        const std::size_t n = std::min(batch, keys.size() - i);
+        detail::mixHashes(keys.data() + i, n, hashes);
+        table.add(keys.data() + i, values.data() + i, hashes, n);
+    }
+    return table.finish();
+}
+
+/// Same as `group_by()`, using the threads of `pool`.
+///
+/// The rows are radix-partitioned by the top 8 bits of their key hashes into
+/// 256 partitions: every thread hashes and histograms a slice of the rows,
+/// then scatters it to the partitions. The partitions have disjoint groups
+/// and small tables, and are aggregated in parallel. Small inputs are
+/// grouped serially.
+///
+/// The groups are returned in partition order, and within a partition in the
+/// order of their first rows.
+///
+/// Throws `std::invalid_argument` if `keys` and `values` differ in size.
+template <typename K, typename V>
+GroupByResult<K, V> group_by_parallel(const Vector<K>& keys,
+                                      const Vector<V>& values,
+                                      const Vector<Aggregate>& aggregates,
+                                      ThreadPool& pool) {
+    detail::checkGroupBy(keys, values);
+    const std::size_t n = keys.size();
+    const std::size_t grain = 1 << 16;
+    if (pool.size() < 2 || n < 2 * grain) {
+        return group_by(keys, values, aggregates);
+    }
+
+    constexpr unsigned bits = 8;
+    constexpr std::size_t parts = std::size_t(1) << bits;
+    const std::size_t slices = std::min(pool.size(), n / grain);
+    auto slice = [&](std::size_t s) { return n * s / slices; };
+
+    // Hash and histogram.
+    Vector<std::uint64_t> hashes(n);
+    Vector<std::size_t> offsets(slices * parts, 0);
+    pool.parallel_for(0, slices, [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t s = lo; s < hi; ++s) {
+            detail::mixHashes(keys.data() + slice(s), slice(s + 1) - slice(s),
+                              hashes.data() + slice(s));
+            std::size_t* histogram = offsets.data() + s * parts;
+            for (std::size_t i = slice(s); i < slice(s + 1); ++i) {
+                ++histogram[hashes[i] >> (64 - bits)];
+            }
+        }
+    });
+
+    // Every slice writes each partition after the earlier slices.
+    Vector<std::size_t> bounds(parts + 1, 0);
+    std::size_t total = 0;
+    for (std::size_t p = 0; p < parts; ++p) {
+        bounds[p] = total;
+        for (std::size_t s = 0; s < slices; ++s) {
+            const std::size_t count = offsets[s * parts + p];
+            offsets[s * parts + p] = total;
+            total += count;
+        }
+    }
+    bounds[parts] = total;
+
+    Vector<K> part_keys(n);
+    Vector<V> part_values(n);
+    Vector<std::uint64_t> part_hashes(n);
+    pool.parallel_for(0, slices, [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t s = lo; s < hi; ++s) {
+            std::size_t* next = offsets.data() + s * parts;
+            for (std::size_t i = slice(s); i < slice(s + 1); ++i) {
+                const std::size_t at = next[hashes[i] >> (64 - bits)]++;
+                part_keys[at] = keys[i];
+                part_values[at] = values[i];
+                part_hashes[at] = hashes[i];
+            }
+        }
+    });
+
+    Vector<GroupByResult<K, V>> results(parts);
+    pool.parallel_for(0, parts, [&](std::size_t lo, std::size_t hi) {
+        constexpr std::size_t batch = detail::GroupTable<K, V>::batch;
+        for (std::size_t p = lo; p < hi; ++p) {
+            detail::GroupTable<K, V> table(aggregates, bits);
+            for (std::size_t i = bounds[p]; i < bounds[p + 1]; i += batch) {
+                table.add(part_keys.data() + i, part_values.data() + i,
+                          part_hashes.data() + i,
+                          std::min(batch, bounds[p + 1] - i));
+            }
+            results[p] = table.finish();
+        }
+    });
+
+    GroupByResult<K, V> out;
+    for (GroupByResult<K, V>& part : results) {
+        detail::appendGroups(out, part);
+    }
+    return out;
+}
+} // namespace algo
@@ -0,0 +1,309 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "cache.hpp"
+#include "thread_pool.hpp"
+#include "vector.hpp"
+
+namespace algo {
+/// The matches of `hash_join()`: `probe_keys[probe[i]] == build_keys[build[i]]`
+/// for every `i`.
+struct HashJoinResult {
+    Vector<std::uint32_t> build;
+    Vector<std::uint32_t> probe;
+};
+
+namespace detail {
+template <typename K>
+struct JoinTuple {
+    K key;
+    std::uint32_t row;
+};
+
+// The `bits` hash bits of `key` starting `shift` bits below the top.
+template <typename K>
+std::size_t radixOf(K key, unsigned shift, unsigned bits) noexcept {
+    return std::size_t((mixHash(std::size_t(key)) << shift) >> (64 - bits));
+}
+
+template <typename K>
+Vector<JoinTuple<K>> joinTuples(const Vector<K>& keys) {
+    if (keys.size() > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::length_error("hash_join: too many rows");
+    }
+    Vector<JoinTuple<K>> tuples(keys.size());
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        tuples[i] = {keys[i], std::uint32_t(i)};
+    }
+    return tuples;
+}
+
+// Adds the partition sizes of `n` tuples to `counts`.
+template <typename K>
+void radixHistogram(const JoinTuple<K>* in, std::size_t n, unsigned shift,
+                    unsigned bits, std::size_t* counts) noexcept {
+    for (std::size_t i = 0; i < n; ++i) {
+        ++counts[radixOf(in[i].key, shift, bits)];
+    }
+}
+
+// Scatters `n` tuples to their partitions of `out`, the next free position
+// of partition `p` being `next[p]`. Tuples are staged in one cache line per
+// partition and copied out a full line at a time, so the scattered writes do
+// not read lines in for ownership nor thrash the TLB one tuple at a time.
+template <typename K>
+void radixScatter(const JoinTuple<K>* in, std::size_t n, unsigned shift,
+                  unsigned bits, std::size_t* next, JoinTuple<K>* out) {
+    using Tuple = JoinTuple<K>;
+    constexpr std::size_t line = std::max<std::size_t>(64 / sizeof(Tuple), 1);
+    struct alignas(64) Buffer {
+        Tuple tuples[line];
+    };
+    const std::size_t parts = std::size_t(1) << bits;
+    Vector<Buffer> buffers(parts);
+    Vector<std::uint8_t> fill(parts, 0);
+    for (std::size_t i = 0; i < n; ++i) {
+        const std::size_t p = radixOf(in[i].key, shift, bits);
+        buffers[p].tuples[fill[p]] = in[i];
+        if (++fill[p] == line) {
+            std::memcpy(out + next[p], buffers[p].tuples, sizeof(Buffer));
+            next[p] += line;
+            fill[p] = 0;
+        }
+    }
+    for (std::size_t p = 0; p < parts; ++p) {
+        std::memcpy(out + next[p], buffers[p].tuples, fill[p] * sizeof(Tuple));
+        next[p] += fill[p];
+    }
+}
+
+// Runs `f(i)` for `i` in `[0, n)`, on `pool` if there is one.
+template <typename F>
+void forEachTask(ThreadPool* pool, std::size_t n, F f) {
+    if (pool == nullptr) {
+        for (std::size_t i = 0; i < n; ++i) {
+            f(i);
+        }
+        return;
+    }
+    pool->parallel_for(0, n, [&f](std::size_t lo, std::size_t hi) {
+        for (std::size_t i = lo; i < hi; ++i) {
+            f(i);
+        }
+    });
+}
+
+// Splits `data` into `2^bits` partitions by the hash bits below the top
+// `shift`, into `scratch`, and returns the partition bounds. The first pass
+// splits slices of the input in parallel; later passes split every existing
+// partition of `bounds` on its own.
+template <typename K>
+Vector<std::size_t> radixPass(const Vector<JoinTuple<K>>& data,
+                              const Vector<std::size_t>& bounds,
+                              unsigned shift, unsigned bits,
+                              Vector<JoinTuple<K>>& scratch,
+                              ThreadPool* pool) {
+    const std::size_t fan_out = std::size_t(1) << bits;
+    const std::size_t parts = bounds.size() - 1;
+    Vector<std::size_t> out_bounds(parts * fan_out + 1, 0);
+    out_bounds[parts * fan_out] = data.size();
+    scratch.resize(data.size());
+
+    if (parts == 1) {
+        const std::size_t n = data.size();
+        const std::size_t slices =
+            pool == nullptr
+                ? 1
+                : std::clamp<std::size_t>(n >> 16, 1, pool->size());
+        auto slice = [&](std::size_t s) { return n * s / slices; };
+        Vector<std::size_t> next(slices * fan_out, 0);
+        forEachTask(pool, slices, [&](std::size_t s) {
+            radixHistogram(data.data() + slice(s), slice(s + 1) - slice(s),
+                           shift, bits, next.data() + s * fan_out);
+        });
+        std::size_t total = 0;
+        for (std::size_t p = 0; p < fan_out; ++p) {
+            out_bounds[p] = total;
+            for (std::size_t s = 0; s < slices; ++s) {
+                const std::size_t count = next[s * fan_out + p];
+                next[s * fan_out + p] = total;
+                total += count;
+            }
+        }
+        forEachTask(pool, slices, [&](std::size_t s) {
+            radixScatter(data.data() + slice(s), slice(s + 1) - slice(s),
+                         shift, bits, next.data() + s * fan_out,
+                         scratch.data());
+        });
+        return out_bounds;
+    }
+
+    forEachTask(pool, parts, [&](std::size_t q) {
+        const JoinTuple<K>* in = data.data() + bounds[q];
+        const std::size_t n = bounds[q + 1] - bounds[q];
+        Vector<std::size_t> next(fan_out, 0);
+        radixHistogram(in, n, shift, bits, next.data());
+        std::size_t total = bounds[q];
+        for (std::size_t p = 0; p < fan_out; ++p) {
+            out_bounds[q * fan_out + p] = total;
+            total += std::exchange(next[p], total);
+        }
+        radixScatter(in, n, shift, bits, next.data(), scratch.data());
+    });
+    return out_bounds;
+}
+
+// Joins the partitions `[first, last)` of both sides. Each build partition
+// fits in the L2 cache, so the chained table built on it is probed without
+// misses to memory.
+template <typename K>
+void joinPartitions(const Vector<JoinTuple<K>>& build,
+                    const Vector<std::size_t>& build_bounds,
+                    const Vector<JoinTuple<K>>& probe,
+                    const Vector<std::size_t>& probe_bounds, unsigned shift,
+                    std::size_t first, std::size_t last, HashJoinResult& out) {
+    // Tuple `i` + 1 of the chain of each bucket, or 0.
+    Vector<std::uint32_t> heads;
+    Vector<std::uint32_t> next;
+    for (std::size_t p = first; p < last; ++p) {
+        const JoinTuple<K>* b = build.data() + build_bounds[p];
+        const std::size_t nb = build_bounds[p + 1] - build_bounds[p];
+        const JoinTuple<K>* q = probe.data() + probe_bounds[p];
+        const std::size_t nq = probe_bounds[p + 1] - probe_bounds[p];
+        if (nb == 0 || nq == 0) {
+            continue;
+        }
+        unsigned bits = 1;
+        while ((std::size_t(1) << bits) < nb) {
+            ++bits;
+        }
+        heads.assign(std::size_t(1) << bits, 0);
+        next.resize(nb);
+        for (std::size_t i = 0; i < nb; ++i) {
+            const std::size_t bucket = radixOf(b[i].key, shift, bits);
+            next[i] = heads[bucket];
+            heads[bucket] = std::uint32_t(i + 1);
+        }
+        for (std::size_t j = 0; j < nq; ++j) {
+            const std::size_t bucket = radixOf(q[j].key, shift, bits);
+            for (std::uint32_t i = heads[bucket]; i != 0; i = next[i - 1]) {
+                if (b[i - 1].key == q[j].key) {
+                    out.build.push_back(b[i - 1].row);
+                    out.probe.push_back(q[j].row);
+                }
+            }
+        }
+    }
+}
+
+template <typename K>
+HashJoinResult hashJoin(const Vector<K>& build_keys,
+                        const Vector<K>& probe_keys, ThreadPool* pool) {
+    static_assert(std::is_integral_v<K>, "hash_join needs integer keys");
+    using Tuple = JoinTuple<K>;
+    if (build_keys.empty() || probe_keys.empty()) {
+        return HashJoinResult();
+    }
+
+    // Enough partitions for every build side table, tuples plus chains, to
+    // take about 256 KiB, and for each thread to have several.
+    constexpr std::size_t l2_budget = std::size_t(1) << 18;
+    constexpr unsigned max_pass_bits = 8;
+    const std::size_t table_bytes = build_keys.size() * (sizeof(Tuple) + 8);
+    unsigned bits = 0;
+    while ((table_bytes >> bits) > l2_budget ||
+           (pool != nullptr && (std::size_t(1) << bits) < 4 * pool->size())) {
+        ++bits;
+    }
+    bits = std::min(bits, 2 * max_pass_bits);
+
+    Vector<Tuple> build = joinTuples(build_keys);
+    Vector<Tuple> probe = joinTuples(probe_keys);
+    Vector<std::size_t> build_bounds = {0, build.size()};
+    Vector<std::size_t> probe_bounds = {0, probe.size()};
+    Vector<Tuple> scratch;
+    // One pass splits at most 256 ways, a fan-out whose write buffers stay
+    // in cache; more partitions take a second pass.
+    for (unsigned shift = 0; shift < bits;) {
+        const unsigned pass = std::min(bits - shift, max_pass_bits);
+        build_bounds = radixPass(build, build_bounds, shift, pass, scratch,
+                                 pool);
+        std::swap(build, scratch);
+        probe_bounds = radixPass(probe, probe_bounds, shift, pass, scratch,
+                                 pool);
+        std::swap(probe, scratch);
+        shift += pass;
+    }
+
+    const std::size_t parts = build_bounds.size() - 1;
+    const std::size_t tasks =
+        pool == nullptr ? 1 : std::min(parts, 4 * pool->size());
+    Vector<HashJoinResult> results(tasks);
+    forEachTask(pool, tasks, [&](std::size_t t) {
+        joinPartitions(build, build_bounds, probe, probe_bounds, bits,
+                       parts * t / tasks, parts * (t + 1) / tasks,
+                       results[t]);
+    });
+    if (tasks == 1) {
+        return std::move(results[0]);
+    }
+
+    HashJoinResult out;
+    std::size_t total = 0;
+    for (const HashJoinResult& r : results) {
+        total += r.build.size();
+    }
+    out.build.reserve(total);
+    out.probe.reserve(total);
+    for (const HashJoinResult& r : results) {
+        out.build.insert(out.build.end(), r.build.begin(), r.build.end());
+        out.probe.insert(out.probe.end(), r.probe.begin(), r.probe.end());
+    }
+    return out;
+}
+} // namespace detail
+
+/// Returns the pairs of rows of `build_keys` and `probe_keys` with equal
+/// keys, in no particular order.
+///
+/// Both sides are radix-partitioned by the same key hash bits until every
+/// build partition fits in the L2 cache, in passes of at most 256 ways with a
+/// cache line of write buffer per partition. Each build partition is then
+/// loaded into a chained hash table which its probe partition scans, so the
+/// random accesses of the join stay in cache. Duplicate keys on either side
+/// yield every combination.
+///
+/// Throws `std::length_error` if a side has more than 2^32 - 1 rows.
+///
+/// # Example
+///
+/// ```cpp
+/// Vector<std::uint64_t> customers = {7, 3, 9};
+/// Vector<std::uint64_t> orders = {3, 3, 5, 9};
+/// HashJoinResult m = hash_join(customers, orders);
+/// // m.build and m.probe hold (1, 0), (1, 1) and (2, 3) in some order.
+/// ```
+template <typename K>
+HashJoinResult hash_join(const Vector<K>& build_keys,
+                         const Vector<K>& probe_keys) {
+    return detail::hashJoin(build_keys, probe_keys, nullptr);
+}
+
+/// Same as `hash_join()`, partitioning and joining on the threads of `pool`.
+///
+/// The first partitioning pass splits slices of the input in parallel, with
+/// per-thread histograms; later passes and the joins of the partitions are
+/// spread over the threads.
+template <typename K>
+HashJoinResult hash_join_parallel(const Vector<K>& build_keys,
+                                  const Vector<K>& probe_keys,
+                                  ThreadPool& pool) {
+    return detail::hashJoin(build_keys, probe_keys, &pool);
+}
+} // namespace algo
@@ -0,0 +1,463 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include "vector.hpp"
+
+namespace algo {
+/// A d-ary heap of values, with the highest priority value, the least under
+/// `Compare`, on top.
+///
+/// A wider node makes the tree shallower, so `push()` compares fewer parents
+/// and the children scanned by `pop()` share a cache line. `replace_top()`
+/// pops and pushes with a single sift, which is the inner step of a bounded
+/// top-k selection.
+///
+/// # Example
+///
+/// ```cpp
+/// DaryHeap<int> heap;
+/// heap.push(5);
+/// heap.push(2);
+/// heap.push(8);
+/// assert(heap.top() == 2);
+/// heap.replace_top(9);
+/// assert(heap.top() == 5);
+/// ```
+template <typename T, std::size_t Arity = 4, typename Compare = std::less<T>>
+class DaryHeap {
+    static_assert(Arity >= 2, "Arity must be at least 2");
+
+public:
+    using ValueType = T;
+    using SizeType = std::size_t;
+
+    /// Constructs an empty heap.
+    explicit DaryHeap(const Compare& comp = Compare()) : comp_(comp) {}
+
+    /// Returns true if the heap is empty.
+    [[nodiscard]] bool empty() const noexcept {
+        return heap_.empty();
+    }
+
+    /// Returns the number of values in the heap.
+    [[nodiscard]] SizeType size() const noexcept {
+        return heap_.size();
+    }
+
+    /// Reserves room for `n` values.
+    void reserve(SizeType n) {
+        heap_.reserve(n);
+    }
+
+    /// Returns the value with the highest priority.
+    const T& top() const noexcept {
+        assert(!empty());
+        return heap_.front();
+    }
+
+    /// Inserts `value`.
+    void push(const T& value) {
+        heap_.push_back(value);
+        siftUp(heap_.size() - 1);
+    }
+
+    /// Removes the value with the highest priority.
+    void pop() noexcept {
+        assert(!empty());
+        if (heap_.size() > 1) {
+            heap_.front() = std::move(heap_.back());
+            heap_.pop_back();
+            siftDown(0);
+        } else {
+            heap_.pop_back();
+        }
+    }
+
+    /// Replaces the value with the highest priority by `value`.
+    void replace_top(const T& value) {
+        assert(!empty());
+        heap_.front() = value;
+        siftDown(0);
+    }
+
+    /// Removes all values.
+    void clear() noexcept {
+        heap_.clear();
+    }
+
+    /// Returns the values in heap order.
+    const Vector<T>& values() const noexcept {
+        return heap_;
+    }
+
+private:
+    void siftUp(SizeType i) {
+        T e = std::move(heap_[i]);
+        while (i > 0) {
+            const SizeType parent = (i - 1) / Arity;
+            if (!comp_(e, heap_[parent])) {
+                break;
+            }
+            heap_[i] = std::move(heap_[parent]);
+            i = parent;
+        }
+        heap_[i] = std::move(e);
+    }
+
+    void siftDown(SizeType i) {
+        const SizeType n = heap_.size();
+        T e = std::move(heap_[i]);
+        for (;;) {
+            const SizeType first = i * Arity + 1;
+            if (first >= n) {
+                break;
+            }
+
+            const SizeType last = std::min(first + Arity, n);
+            SizeType best = first;
+            for (SizeType c = first + 1; c < last; ++c) {
+                if (comp_(heap_[c], heap_[best])) {
+                    best = c;
+                }
+            }
+            if (!comp_(heap_[best], e)) {
+                break;
+            }
+            heap_[i] = std::move(heap_[best]);
+            i = best;
+        }
+        heap_[i] = std::move(e);
+    }
+
+private:
+    [[no_unique_address]] Compare comp_;
+    Vector<T> heap_;
+};
+
+/// A d-ary heap over the integer keys `[0, capacity())` which supports
+/// `decrease_key()` in `O(log_d n)`.
+///
+/// Every key stores its slot in the heap inside a position `Vector`, so a key
+/// can be located without searching. The heap entries keep the priority next
+/// to the key, which makes sifting touch only one contiguous array.
+///
+/// Popped keys have their position reset eagerly, hence `clear()` costs
+/// `O(size())` instead of `O(capacity())` and a heap can be reused across many
+/// queries without touching the whole position array.
+///
+/// # Example
+///
+/// ```cpp
+/// IndexedDaryHeap<int> heap(8);
+/// heap.push(3, 30);
+/// heap.push(5, 50);
+/// heap.decrease_key(5, 10);
+/// assert(heap.top() == 5);
+/// assert(heap.top_priority() == 10);
+/// ```
+template <typename Priority, std::size_t Arity = 4,
+          typename Compare = std::less<Priority>>
+class IndexedDaryHeap {
+    static_assert(Arity >= 2, "Arity must be at least 2");
+
+public:
+    using KeyType = std::uint32_t;
+    using PriorityType = Priority;
+    using SizeType = std::size_t;
+
+    /// Position of the keys which are not in the heap.
+    static constexpr KeyType npos = std::numeric_limits<KeyType>::max();
+
+    /// Constructs an empty heap for the keys `[0, n)`.
+    explicit IndexedDaryHeap(SizeType n = 0, const Compare& comp = Compare())
+        : comp_(comp) {
+        pos_.assign(n, npos);
+    }
+
+    /// Grows or shrinks the key universe to `[0, n)`. The heap must be empty.
+    void reset(SizeType n) {
+        assert(empty());
+        if (n != pos_.size()) {
+            pos_.assign(n, npos);
+        }
+    }
+
+    /// Returns the number of keys the heap can hold.
+    [[nodiscard]] SizeType capacity() const noexcept {
+        return pos_.size();
+    }
+
+    /// Returns true if the heap is empty.
+    [[nodiscard]] bool empty() const noexcept {
+        return heap_.empty();
+    }
+
+    /// Returns the number of keys in the heap.
+    [[nodiscard]] SizeType size() const noexcept {
+        return heap_.size();
+    }
+
+    /// Returns true if `key` is in the heap.
+    [[nodiscard]] bool contains(KeyType key) const noexcept {
+        return pos_[key] != npos;
+    }
+
+    /// Returns the key with the highest priority.
+    KeyType top() const noexcept {
+        return heap_.front().key;
+    }
+
+    /// Returns the priority of `top()`.
+    const Priority& top_priority() const noexcept {
+        return heap_.front().priority;
+    }
+
+    /// Returns the priority of `key`, which must be in the heap.
+    const Priority& priority(KeyType key) const noexcept {
+        return heap_[pos_[key]].priority;
+    }
+
+    /// Inserts `key` which must not be in the heap.
+    void push(KeyType key, const Priority& priority) {
+        assert(!contains(key));
+        heap_.push_back(Entry{priority, key});
+        siftUp(heap_.size() - 1);
+    }
+
+    /// Removes the key with the highest priority.
+    void pop() noexcept {
+        pos_[heap_.front().key] = npos;
+        if (heap_.size() > 1) {
+            heap_.front() = heap_.back();
+            heap_.pop_back();
+            siftDown(0);
+        } else {
+            heap_.pop_back();
+        }
+    }
+
+    /// Raises the priority of `key`, which must be in the heap, to `priority`.
+    void decrease_key(KeyType key, const Priority& priority) noexcept {
+        assert(!comp_(heap_[pos_[key]].priority, priority));
+        const SizeType i = pos_[key];
+        heap_[i].priority = priority;
+        siftUp(i);
+    }
+
+    /// Inserts `key`, or changes its priority if it is already in the heap.
+    void update(KeyType key, const Priority& priority) {
+        if (!contains(key)) {
+            push(key, priority);
+            return;
+        }
+
+        const SizeType i = pos_[key];
+        const bool up = comp_(priority, heap_[i].priority);
+        heap_[i].priority = priority;
+        if (up) {
+            siftUp(i);
+        } else {
+            siftDown(i);
+        }
+    }
+
+    /// Removes all keys. Only the positions of the remaining keys are reset.
+    void clear() noexcept {
+        for (const Entry& e : heap_) {
+            pos_[e.key] = npos;
+        }
+        heap_.clear();
+    }
+
+private:
+    struct Entry {
+        Priority priority;
+        KeyType key;
+    };
+
+    void siftUp(SizeType i) noexcept {
+        Entry e = heap_[i];
+        while (i > 0) {
+            const SizeType parent = (i - 1) / Arity;
+            if (!comp_(e.priority, heap_[parent].priority)) {
+                break;
+            }
+            heap_[i] = heap_[parent];
+            pos_[heap_[i].key] = static_cast<KeyType>(i);
+            i = parent;
+        }
+        heap_[i] = e;
+        pos_[e.key] = static_cast<KeyType>(i);
+    }
+
+    void siftDown(SizeType i) noexcept {
+        const SizeType n = heap_.size();
+        Entry e = heap_[i];
+        for (;;) {
+            const SizeType first = i * Arity + 1;
+            if (first >= n) {
+                break;
+            }
+
+            const SizeType last = std::min(first + Arity, n);
+            SizeType best = first;
+            for (SizeType c = first + 1; c < last; ++c) {
+                if (comp_(heap_[c].priority, heap_[best].priority)) {
+                    best = c;
+                }
+            }
+            if (!comp_(heap_[best].priority, e.priority)) {
+                break;
+            }
+            heap_[i] = heap_[best];
+            pos_[heap_[i].key] = static_cast<KeyType>(i);
+            i = best;
+        }
+        heap_[i] = e;
+        pos_[e.key] = static_cast<KeyType>(i);
+    }
+
+private:
+    [[no_unique_address]] Compare comp_;
+    Vector<Entry> heap_;
+    Vector<KeyType> pos_;
+};
+
+/// A monotone priority queue for unsigned integer priorities.
+///
+/// The popped priorities must never decrease, i.e. every pushed priority must
+/// be no less than the last popped one, which is exactly the access pattern of
+/// Dijkstra's algorithm with non-negative integer weights. Entries are
+/// distributed into `bits + 1` buckets by the highest bit in which they differ
+/// from the last popped priority, so each entry is moved at most `bits` times.
+///
+/// The buckets keep their capacity across `clear()`, so a reused heap stops
+/// allocating after warm-up.
+///
+/// # Example
+///
+/// ```cpp
+/// RadixHeap<std::uint32_t, int> heap;
+/// heap.push(7, 100);
+/// heap.push(3, 200);
+/// assert(heap.top_priority() == 3);
+/// assert(heap.top() == 200);
+/// ```
+template <typename Priority, typename T>
+class RadixHeap {
+    static_assert(std::is_unsigned_v<Priority>,
+                  "Priority must be an unsigned integer");
+
+    static constexpr std::size_t bits = std::numeric_limits<Priority>::digits;
+
+public:
+    using PriorityType = Priority;
+    using ValueType = T;
+    using SizeType = std::size_t;
+
+    /// Returns true if the heap is empty.
+    [[nodiscard]] bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    /// Returns the number of entries in the heap.
+    [[nodiscard]] SizeType size() const noexcept {
+        return size_;
+    }
+
+    /// Inserts `value` with `priority`, which must be no less than the last
+    /// popped priority.
+    void push(Priority priority, const T& value) {
+        assert(priority >= last_);
+        buckets_[bucketIndex(priority)].push_back(Entry{priority, value});
+        ++size_;
+    }
+
+    /// Returns the value with the smallest priority.
+    const T& top() {
+        pull();
+        return buckets_[0].back().value;
+    }
+
+    /// Returns the smallest priority.
+    Priority top_priority() {
+        pull();
+        return last_;
+    }
+
+    /// Removes the entry with the smallest priority.
+    void pop() {
+        pull();
+        buckets_[0].pop_back();
+        --size_;
+    }
+
+    /// Removes all entries and restarts the monotone sequence from zero.
+    void clear() noexcept {
+        for (auto& bucket : buckets_) {
+            bucket.clear();
+        }
+        size_ = 0;
+        last_ = 0;
+    }
+
+private:
+    struct Entry {
+        Priority priority;
+        T value;
+    };
+
+    std::size_t bucketIndex(Priority priority) const noexcept {
+        if (priority == last_) {
+            return 0;
+        }
+        const int clz = countLeadingZeros(priority ^ last_);
+        return bits - static_cast<std::size_t>(clz);
+    }
+
+    static int countLeadingZeros(Priority x) noexcept {
+        if constexpr (bits <= 32) {
+            return __builtin_clz(static_cast<unsigned>(x)) - (32 - int(bits));
+        } else {
+            return __builtin_clzll(static_cast<unsigned long long>(x)) -
+                   (64 - int(bits));
+        }
+    }
+
+    // Makes `buckets_[0]` non-empty by redistributing the first non-empty
+    // bucket around its minimum.
+    void pull() {
+        assert(!empty());
+        if (!buckets_[0].empty()) {
+            return;
+        }
+
+        std::size_t i = 1;
+        while (buckets_[i].empty()) {
+            ++i;
+        }
+
+        Vector<Entry>& bucket = buckets_[i];
+        Priority new_last = bucket.front().priority;
+        for (const Entry& e : bucket) {
+            new_last = std::min(new_last, e.priority);
+        }
+        last_ = new_last;
+        for (const Entry& e : bucket) {
+            buckets_[bucketIndex(e.priority)].push_back(e);
+        }
+        bucket.clear();
+    }
+
+private:
+    std::array<Vector<Entry>, bits + 1> buckets_;
+    SizeType size_ = 0;
+    Priority last_ = 0;
+};
+} // namespace algo
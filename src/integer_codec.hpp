@@ -0,0 +1,592 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include "bitset.hpp"
+#include "vector.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace algo {
+namespace detail {
+// Operations on one 128-bit frame row of `16 / sizeof(T)` lanes, done one
+// lane at a time. The SSE2 specializations below produce identical bytes.
+template <typename T>
+struct ScalarLanes {
+    static constexpr std::size_t lanes = 16 / sizeof(T);
+    using Reg = std::array<T, lanes>;
+
+    static Reg load(const T* p) noexcept {
+        Reg r;
+        std::memcpy(r.data(), p, sizeof(Reg));
+        return r;
+    }
+    static void store(T* p, const Reg& r) noexcept {
+        std::memcpy(p, r.data(), sizeof(Reg));
+    }
+    static Reg set1(T v) noexcept {
+        Reg r;
+        r.fill(v);
+        return r;
+    }
+    template <typename Op>
+    static Reg map(const Reg& a, const Reg& b, Op op) noexcept {
+        Reg r;
+        for (std::size_t i = 0; i < lanes; ++i) {
+            r[i] = op(a[i], b[i]);
+        }
+        return r;
+    }
+    static Reg shiftLeft(const Reg& a, unsigned c) noexcept {
+        return map(a, a, [c](T x, T) { return T(x << c); });
+    }
+    static Reg shiftRight(const Reg& a, unsigned c) noexcept {
+        return map(a, a, [c](T x, T) { return T(x >> c); });
+    }
+    static Reg bitOr(const Reg& a, const Reg& b) noexcept {
+        return map(a, b, [](T x, T y) { return T(x | y); });
+    }
+    static Reg bitAnd(const Reg& a, const Reg& b) noexcept {
+        return map(a, b, [](T x, T y) { return T(x & y); });
+    }
+    static Reg add(const Reg& a, const Reg& b) noexcept {
+        return map(a, b, [](T x, T y) { return T(x + y); });
+    }
+};
+
+#if defined(__SSE2__)
+template <typename T>
+struct SseLanesBase {
+    static constexpr std::size_t lanes = 16 / sizeof(T);
+    using Reg = __m128i;
+
+    static Reg load(const T* p) noexcept {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    }
+    static void store(T* p, Reg r) noexcept {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p), r);
+    }
+    static Reg bitOr(Reg a, Reg b) noexcept {
+        return _mm_or_si128(a, b);
+    }
+    static Reg bitAnd(Reg a, Reg b) noexcept {
+        return _mm_and_si128(a, b);
+    }
+};
+
+template <typename T>
+struct SseLanes;
+
+template <>
+struct SseLanes<std::uint32_t> : SseLanesBase<std::uint32_t> {
+    static Reg set1(std::uint32_t v) noexcept {
+        return _mm_set1_epi32(int(v));
+    }
+    static Reg shiftLeft(Reg a, unsigned c) noexcept {
+        return _mm_sll_epi32(a, _mm_cvtsi32_si128(int(c)));
+    }
+    static Reg shiftRight(Reg a, unsigned c) noexcept {
+        return _mm_srl_epi32(a, _mm_cvtsi32_si128(int(c)));
+    }
+    static Reg add(Reg a, Reg b) noexcept {
+        return _mm_add_epi32(a, b);
+    }
+};
+
+template <>
+struct SseLanes<std::uint64_t> : SseLanesBase<std::uint64_t> {
+    static Reg set1(std::uint64_t v) noexcept {
+        return _mm_set1_epi64x(static_cast<long long>(v));
+    }
+    static Reg shiftLeft(Reg a, unsigned c) noexcept {
+        return _mm_sll_epi64(a, _mm_cvtsi32_si128(int(c)));
+    }
+    static Reg shiftRight(Reg a, unsigned c) noexcept {
+        return _mm_srl_epi64(a, _mm_cvtsi32_si128(int(c)));
+    }
+    static Reg add(Reg a, Reg b) noexcept {
+        return _mm_add_epi64(a, b);
+    }
+};
+
+template <typename T>
+using FrameLanes = SseLanes<T>;
+#else
+template <typename T>
+using FrameLanes = ScalarLanes<T>;
+#endif
+
+// Packs a frame of 128 values, each below `2^b`, into `b` rows. Value `i`
+// belongs to lane `i % lanes`, and every lane is packed as its own stream,
+// so that all lanes are shifted at once.
+template <typename T, typename Lanes = FrameLanes<T>>
+void packFrame(const T* in, unsigned b, T* out) noexcept {
+    constexpr unsigned width = 8 * sizeof(T);
+    constexpr std::size_t lanes = Lanes::lanes;
+    if (b == 0) {
+        return;
+    }
+    typename Lanes::Reg acc = Lanes::set1(0);
+    unsigned shift = 0;
+    std::size_t k = 0;
+    for (std::size_t r = 0; r < 128 / lanes; ++r) {
+        const typename Lanes::Reg v = Lanes::load(in + r * lanes);
+        acc = Lanes::bitOr(acc, Lanes::shiftLeft(v, shift));
+        shift += b;
+        if (shift >= width) {
+            Lanes::store(out + k++ * lanes, acc);
+            shift -= width;
+            acc = shift != 0 ? Lanes::shiftRight(v, b - shift)
+                             : Lanes::set1(0);
+        }
+    }
+}
+
+// Unpacks a frame packed with width `B` and adds every row of deltas to the
+// row before it, starting from `base` in every lane. With `B` a constant,
+// the loop unrolls into straight-line shifts.
+template <typename T, unsigned B, typename Lanes = FrameLanes<T>>
+void unpackFrameFixed(const T* in, T base, T* out) noexcept {
+    constexpr unsigned width = 8 * sizeof(T);
+    constexpr std::size_t lanes = Lanes::lanes;
+    typename Lanes::Reg prev = Lanes::set1(base);
+    if constexpr (B == 0) {
+        for (std::size_t r = 0; r < 128 / lanes; ++r) {
+            Lanes::store(out + r * lanes, prev);
+        }
+    } else {
+        const typename Lanes::Reg mask = Lanes::set1(
+            B == width ? std::numeric_limits<T>::max()
+                       : T((T(1) << (B % width)) - 1));
+        typename Lanes::Reg cur = Lanes::load(in);
+        std::size_t k = 1;
+        unsigned shift = 0;
+        for (std::size_t r = 0; r < 128 / lanes; ++r) {
+            typename Lanes::Reg v = Lanes::shiftRight(cur, shift);
+            shift += B;
+            if (shift >= width) {
+                shift -= width;
+                if (k < B) {
+                    cur = Lanes::load(in + k++ * lanes);
+                }
+                if (shift != 0) {
+                    v = Lanes::bitOr(v, Lanes::shiftLeft(cur, B - shift));
+                }
+            }
+            prev = Lanes::add(Lanes::bitAnd(v, mask), prev);
+            Lanes::store(out + r * lanes, prev);
+        }
+    }
+}
+
+template <typename T>
+using UnpackFrameFn = void (*)(const T*, T, T*);
+
+template <typename T, typename Lanes, std::size_t... B>
+constexpr std::array<UnpackFrameFn<T>, sizeof...(B)>
+makeUnpackTable(std::index_sequence<B...>) noexcept {
+    return {{&unpackFrameFixed<T, unsigned(B), Lanes>...}};
+}
+
+// Dispatches to the unpacker specialized for width `b`.
+template <typename T, typename Lanes = FrameLanes<T>>
+void unpackFrame(const T* in, unsigned b, T base, T* out) noexcept {
+    static constexpr auto table = makeUnpackTable<T, Lanes>(
+        std::make_index_sequence<8 * sizeof(T) + 1>());
+    table[b](in, base, out);
+}
+
+// Returns the number of bits needed to store `x`.
+template <typename T>
+unsigned bitWidth(T x) noexcept {
+    if (x == 0) {
+        return 0;
+    }
+    if constexpr (sizeof(T) <= sizeof(unsigned)) {
+        return unsigned(8 * sizeof(unsigned)) - unsigned(__builtin_clz(x));
+    } else {
+        return 64 - unsigned(__builtin_clzll(x));
+    }
+}
+
+// Throws unless `values[0, n)` is non-decreasing.
+template <typename T>
+void checkSorted(const T* values, std::size_t n, const char* what) {
+    for (std::size_t i = 1; i < n; ++i) {
+        if (values[i] < values[i - 1]) {
+            throw std::invalid_argument(std::string(what) +
+                                        ": values are not sorted");
+        }
+    }
+}
+} // namespace detail
+
+/// A sorted sequence of unsigned integers in Elias-Fano encoding.
+///
+/// Each value is split into `l` low bits, stored verbatim, and the remaining
+/// high bits, stored in unary in a bitset of `n + (max >> l) + 1` bits where
+/// value `i` sets bit `(value >> l) + i`. Choosing `l = log2(max / n)` takes
+/// at most `2 + log2(max / n)` bits per value, within a fraction of a bit of
+/// the lower bound for the sequence.
+///
+/// A `RankSelect` index over the high bits makes `operator[]` one `select1()`
+/// and `next_geq()` one `select0()` that jumps to the first value with the
+/// right high bits, followed by a short scan.
+///
+/// # Example
+///
+/// ```cpp
+/// Vector<std::uint32_t> ids = {3, 4, 7, 13, 14, 15, 21, 43};
+/// EliasFanoVector ef(ids);
+/// assert(ef[3] == 13);
+/// assert(ef.next_geq(16) == 6); // ef[6] == 21
+/// ```
+class EliasFanoVector {
+public:
+    using ValueType = std::uint64_t;
+    using SizeType = std::size_t;
+
+    /// Constructs an empty sequence.
+    EliasFanoVector() = default;
+
+    /// Encodes the non-decreasing `values`.
+    ///
+    /// Throws `std::invalid_argument` if `values` is not sorted.
+    template <typename U, typename Alloc>
+    explicit EliasFanoVector(const Vector<U, Alloc>& values) {
+        assign(values.data(), values.size());
+    }
+
+    /// Replaces the contents with the non-decreasing `values[0, n)`.
+    ///
+    /// Throws `std::invalid_argument` if the values are not sorted.
+    template <typename U>
+    void assign(const U* values, SizeType n) {
+        static_assert(std::is_unsigned_v<U>,
+                      "EliasFanoVector stores unsigned integers");
+        detail::checkSorted(values, n, "EliasFanoVector");
+        size_ = n;
+        low_bits_ = 0;
+        back_ = n == 0 ? 0 : ValueType(values[n - 1]);
+        if (n != 0 && back_ / n != 0) {
+            low_bits_ = detail::bitWidth(ValueType(back_ / n)) - 1;
+        }
+
+        lows_.assign((n * low_bits_ + 63) / 64, 0);
+        DynamicBitset highs(n == 0 ? 0 : n + (back_ >> low_bits_) + 1);
+        const ValueType mask = (ValueType(1) << low_bits_) - 1;
+        for (SizeType i = 0; i < n; ++i) {
+            const ValueType v = ValueType(values[i]);
+            highs.set(SizeType(v >> low_bits_) + i);
+            if (low_bits_ != 0) {
+                const SizeType pos = i * low_bits_;
+                lows_[pos / 64] |= (v & mask) << (pos % 64);
+                if (pos % 64 + low_bits_ > 64) {
+                    lows_[pos / 64 + 1] |= (v & mask) >> (64 - pos % 64);
+                }
+            }
+        }
+        highs_ = RankSelect(std::move(highs));
+    }
+
+    /// Returns the number of values.
+    [[nodiscard]] SizeType size() const noexcept {
+        return size_;
+    }
+
+    /// Returns true if there are no values.
+    [[nodiscard]] bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    /// Returns the number of low bits stored verbatim per value.
+    [[nodiscard]] unsigned low_bits() const noexcept {
+        return low_bits_;
+    }
+
+    /// Returns the bytes used by the encoding and its index.
+    [[nodiscard]] SizeType size_in_bytes() const noexcept {
+        return (lows_.size() + highs_.bits().word_count()) *
+                   sizeof(std::uint64_t) +
+               highs_.index_bytes();
+    }
+
+    /// Returns the `i`-th value, where `i < size()`.
+    [[nodiscard]] ValueType operator[](SizeType i) const noexcept {
+        assert(i < size_);
+        return ValueType(highs_.select1(i) - i) << low_bits_ | lowAt(i);
+    }
+
+    /// Returns the `i`-th value.
+    ///
+    /// Throws `std::out_of_range` if `i >= size()`.
+    [[nodiscard]] ValueType at(SizeType i) const {
+        if (i >= size_) {
+            throw std::out_of_range("EliasFanoVector: index out of range");
+        }
+        return (*this)[i];
+    }
+
+    /// Returns the last value, where the sequence is not empty.
+    [[nodiscard]] ValueType back() const noexcept {
+        assert(size_ != 0);
+        return back_;
+    }
+
+    /// Returns the index of the first value not less than `x`, or `size()`
+    /// if there is none.
+    [[nodiscard]] SizeType next_geq(ValueType x) const noexcept {
+        if (size_ == 0 || x > back_) {
+            return size_;
+        }
+        // Zero `h - 1` ends the bucket of values with high bits below `h`.
+        const SizeType high = SizeType(x >> low_bits_);
+        SizeType pos = high == 0 ? 0 : highs_.select0(high - 1) + 1;
+        SizeType i = pos - high;
+        const Vector<std::uint64_t>& words = highs_.bits().words();
+        for (;;) {
+            // The next one at or after `pos` is the `i`-th value.
+            std::uint64_t w = words[pos / 64] >> (pos % 64);
+            while (w == 0) {
+                pos = (pos / 64 + 1) * 64;
+                w = words[pos / 64];
+            }
+            pos += SizeType(__builtin_ctzll(w));
+            const ValueType v =
+                ValueType(pos - i) << low_bits_ | lowAt(i);
+            if (v >= x) {
+                return i;
+            }
+            ++pos;
+            ++i;
+        }
+    }
+
+    /// Calls `f(value)` for every value in order.
+    template <typename F>
+    void for_each(F&& f) const {
+        SizeType i = 0;
+        highs_.bits().for_each_set([&](SizeType pos) {
+            f(ValueType(pos - i) << low_bits_ | lowAt(i));
+            ++i;
+        });
+    }
+
+    /// Removes all values.
+    void clear() noexcept {
+        *this = EliasFanoVector();
+    }
+
+private:
+    ValueType lowAt(SizeType i) const noexcept {
+        if (low_bits_ == 0) {
+            return 0;
+        }
+        const SizeType pos = i * low_bits_;
+        ValueType v = lows_[pos / 64] >> (pos % 64);
+        if (pos % 64 + low_bits_ > 64) {
+            v |= lows_[pos / 64 + 1] << (64 - pos % 64);
+        }
+        return v & ((ValueType(1) << low_bits_) - 1);
+    }
+
+private:
+    Vector<std::uint64_t> lows_;
+    RankSelect highs_;
+    SizeType size_ = 0;
+    ValueType back_ = 0;
+    unsigned low_bits_ = 0;
+};
+
+/// A sorted sequence of `std::uint32_t` or `std::uint64_t` values in frames of
+/// 128, each storing the differences between values with one bit width.
+///
+/// Value `i` of a frame is stored as its difference from value `i - lanes`,
+/// where `lanes` is the 4 or 2 values fitting a 128-bit register, and the
+/// first row of a frame is taken relative to the frame's first value. The
+/// differences are bit-packed lane by lane, so decoding a frame is a run of
+/// 128-bit shifts, masks and adds without any dependency across lanes, using
+/// SSE2 where available. The layout does not depend on the instruction set.
+///
+/// Frames decode independently of each other, and `next_geq()` searches the
+/// frame heads before decoding a single frame.
+///
+/// # Example
+///
+/// ```cpp
+/// Vector<std::uint32_t> ids = {3, 4, 7, 13, 14, 15, 21, 43};
+/// DeltaBitpacked<std::uint32_t> packed(ids);
+/// Vector<std::uint32_t> out;
+/// packed.decode(out);
+/// assert(out == ids);
+/// ```
+template <typename T>
+class DeltaBitpacked {
+    static_assert(std::is_same_v<T, std::uint32_t> ||
+                      std::is_same_v<T, std::uint64_t>,
+                  "DeltaBitpacked stores std::uint32_t or std::uint64_t");
+
+public:
+    using ValueType = T;
+    using SizeType = std::size_t;
+
+    /// The number of values in a frame.
+    static constexpr SizeType block_size = 128;
+
+    /// Constructs an empty sequence.
+    DeltaBitpacked() = default;
+
+    /// Encodes the non-decreasing `values`.
+    ///
+    /// Throws `std::invalid_argument` if `values` is not sorted.
+    template <typename Alloc>
+    explicit DeltaBitpacked(const Vector<T, Alloc>& values) {
+        assign(values.data(), values.size());
+    }
+
+    /// Replaces the contents with the non-decreasing `values[0, n)`.
+    ///
+    /// Throws `std::invalid_argument` if the values are not sorted.
+    void assign(const T* values, SizeType n) {
+        detail::checkSorted(values, n, "DeltaBitpacked");
+        clear();
+        size_ = n;
+        const SizeType blocks = (n + block_size - 1) / block_size;
+        heads_.reserve(blocks);
+        widths_.reserve(blocks);
+        offsets_.reserve(blocks + 1);
+        offsets_.push_back(0);
+
+        alignas(16) T deltas[block_size];
+        for (SizeType b = 0; b < blocks; ++b) {
+            const T* in = values + b * block_size;
+            const SizeType count = std::min(block_size, n - b * block_size);
+            // A short last frame repeats its last value.
+            T mask = 0;
+            for (SizeType i = 0; i < block_size; ++i) {
+                const T v = in[std::min(i, count - 1)];
+                const T prev =
+                    i < lanes ? in[0] : in[std::min(i - lanes, count - 1)];
+                deltas[i] = T(v - prev);
+                mask |= deltas[i];
+            }
+            const unsigned width = detail::bitWidth(mask);
+            heads_.push_back(in[0]);
+            widths_.push_back(std::uint8_t(width));
+            const SizeType offset = data_.size();
+            data_.resize(offset + width * lanes);
+            detail::packFrame(deltas, width, data_.data() + offset);
+            offsets_.push_back(data_.size());
+        }
+    }
+
+    /// Returns the number of values.
+    [[nodiscard]] SizeType size() const noexcept {
+        return size_;
+    }
+
+    /// Returns true if there are no values.
+    [[nodiscard]] bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    /// Returns the number of frames.
+    [[nodiscard]] SizeType block_count() const noexcept {
+        return heads_.size();
+    }
+
+    /// Returns the bytes used by the packed frames and their headers.
+    [[nodiscard]] SizeType size_in_bytes() const noexcept {
+        return data_.size() * sizeof(T) + heads_.size() * sizeof(T) +
+               widths_.size() + offsets_.size() * sizeof(std::uint64_t);
+    }
+
+    /// Decodes frame `block` into `out[0, block_size)` and returns the number
+    /// of values it holds, which is less than `block_size` only for the last
+    /// frame. The rest of `out` is overwritten with the last value.
+    SizeType decode_block(SizeType block, T* out) const noexcept {
+        assert(block < block_count());
+        detail::unpackFrame(data_.data() + offsets_[block], widths_[block],
+                            heads_[block], out);
+        return std::min(block_size, size_ - block * block_size);
+    }
+
+    /// Decodes all values into `out`, replacing its contents.
+    template <typename Alloc>
+    void decode(Vector<T, Alloc>& out) const {
+        out.resize(size_);
+        const SizeType full = size_ / block_size;
+        for (SizeType b = 0; b < full; ++b) {
+            decode_block(b, out.data() + b * block_size);
+        }
+        if (full < block_count()) {
+            alignas(16) T tail[block_size];
+            const SizeType count = decode_block(full, tail);
+            std::copy(tail, tail + count, out.data() + full * block_size);
+        }
+    }
+
+    /// Returns the `i`-th value, decoding its frame.
+    ///
+    /// Throws `std::out_of_range` if `i >= size()`.
+    [[nodiscard]] T at(SizeType i) const {
+        if (i >= size_) {
+            throw std::out_of_range("DeltaBitpacked: index out of range");
+        }
+        alignas(16) T values[block_size];
+        decode_block(i / block_size, values);
+        return values[i % block_size];
+    }
+
+    /// Returns the index of the first value not less than `x`, or `size()`
+    /// if there is none.
+    [[nodiscard]] SizeType next_geq(T x) const noexcept {
+        // The first value not less than `x` is either in the frame before the
+        // first frame whose head is not less than `x`, or that frame's head.
+        const SizeType block = SizeType(
+            std::lower_bound(heads_.begin(), heads_.end(), x) -
+            heads_.begin());
+        if (block == 0) {
+            return 0;
+        }
+        alignas(16) T values[block_size];
+        const SizeType count = decode_block(block - 1, values);
+        const SizeType i = SizeType(
+            std::lower_bound(values, values + count, x) - values);
+        return i < count ? (block - 1) * block_size + i
+                         : std::min(block * block_size, size_);
+    }
+
+    /// Removes all values.
+    void clear() noexcept {
+        data_.clear();
+        heads_.clear();
+        widths_.clear();
+        offsets_.clear();
+        size_ = 0;
+    }
+
+private:
+    static constexpr SizeType lanes = 16 / sizeof(T);
+
+private:
+    // The packed frames, `widths_[b] * lanes` words each.
+    Vector<T> data_;
+    // The first value of every frame.
+    Vector<T> heads_;
+    Vector<std::uint8_t> widths_;
+    // The first word of every frame, plus the end.
+    Vector<std::uint64_t> offsets_;
+    SizeType size_ = 0;
+};
+} // namespace algo
@@ -0,0 +1,300 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <stdexcept>
+#include "vector.hpp"
+
+namespace algo {
+/// A static index of half-open intervals `[start, end)` answering overlap and
+/// stabbing queries.
+///
+/// The intervals are sorted by start into one `Vector`, and that sorted array
+/// is read as an implicit balanced binary search tree, as in cgranges: the
+/// node at index `i` is on the level given by the number of trailing one bits
+/// of `i`, and its children are `i - 2^(level - 1)` and `i + 2^(level - 1)`.
+/// Every node is augmented with the largest end in its subtree, which prunes
+/// whole subtrees from overlap queries. There are no pointers, subtrees are
+/// contiguous and the bottom levels are scanned linearly.
+///
+/// Counting queries use a second sorted array of the ends and run in
+/// `O(log n)` without enumerating anything.
+///
+/// Intervals are identified by their insertion order. Queries are only valid
+/// after `build()`, and `add()` invalidates the index again.
+///
+/// # Example
+///
+/// ```cpp
+/// IntervalIndex<int> index;
+/// index.add(10, 20); // id 0
+/// index.add(15, 30); // id 1
+/// index.add(40, 50); // id 2
+/// index.build();
+///
+/// Vector<std::uint32_t> ids;
+/// index.overlap(18, 42, ids); // {0, 1, 2}
+/// assert(index.stab_count(16) == 2);
+/// ```
+template <typename T>
+class IntervalIndex {
+public:
+    using ValueType = T;
+    using SizeType = std::size_t;
+    using IdType = std::uint32_t;
+
+    struct Interval {
+        T start;
+        T end;
+    };
+
+    /// Constructs an empty index.
+    IntervalIndex() = default;
+
+    /// Bulk-builds an index over `intervals`, whose ids are their positions.
+    explicit IntervalIndex(const Vector<Interval>& intervals) {
+        assign(intervals.begin(), intervals.end());
+    }
+
+    /// Bulk-builds an index over `list`, whose ids are their positions.
+    IntervalIndex(std::initializer_list<Interval> list) {
+        assign(list.begin(), list.end());
+    }
+
+    /// Replaces the contents with `[first, last)` and builds the index.
+    template <typename InputIt>
+    void assign(InputIt first, InputIt last) {
+        clear();
+        for (; first != last; ++first) {
+            const Interval& iv = *first;
+            add(iv.start, iv.end);
+        }
+        build();
+    }
+
+    /// Returns the number of intervals.
+    [[nodiscard]] SizeType size() const noexcept {
+        return nodes_.size();
+    }
+
+    /// Returns true if there are no intervals.
+    [[nodiscard]] bool empty() const noexcept {
+        return nodes_.empty();
+    }
+
+    /// Returns true if the index is up to date and can be queried.
+    [[nodiscard]] bool indexed() const noexcept {
+        return indexed_;
+    }
+
+    /// Removes all intervals.
+    void clear() noexcept {
+        nodes_.clear();
+        ends_.clear();
+        root_level_ = 0;
+        indexed_ = true;
+    }
+
+    /// Appends `[start, end)` and returns its id. The index must be rebuilt
+    /// before the next query.
+    ///
+    /// Throws `std::invalid_argument` if `end < start`.
+    IdType add(T start, T end) {
+        if (end < start) {
+            throw std::invalid_argument("IntervalIndex: end < start");
+        }
+        if (nodes_.size() >= std::numeric_limits<IdType>::max()) {
+            throw std::length_error("IntervalIndex: too many intervals");
+        }
+        const IdType id = static_cast<IdType>(nodes_.size());
+        nodes_.push_back(Node{start, end, end, id});
+        indexed_ = false;
+        return id;
+    }
+
+    /// Sorts the intervals and computes the subtree maxima in `O(n log n)`.
+    void build() {
+        std::sort(nodes_.begin(), nodes_.end(),
+                  [](const Node& x, const Node& y) {
+                      return x.start < y.start ||
+                             (!(y.start < x.start) && x.end < y.end);
+                  });
+
+        ends_.clear();
+        ends_.reserve(nodes_.size());
+        for (const Node& node : nodes_) {
+            ends_.push_back(node.end);
+        }
+        std::sort(ends_.begin(), ends_.end());
+
+        root_level_ = indexNodes();
+        indexed_ = true;
+    }
+
+    /// Calls `f(start, end, id)` for every interval overlapping
+    /// `[start, end)`, in ascending order of start.
+    template <typename F>
+    void overlap(T start, T end, F&& f) const {
+        traverse(
+            start, [&](const T& s) { return s < end; }, f);
+    }
+
+    /// Appends the ids of the intervals overlapping `[start, end)` to `out`,
+    /// in ascending order of start, and returns their number.
+    SizeType overlap(T start, T end, Vector<IdType>& out) const {
+        const SizeType before = out.size();
+        overlap(start, end,
+                [&out](const T&, const T&, IdType id) { out.push_back(id); });
+        return out.size() - before;
+    }
+
+    /// Calls `f(start, end, id)` for every interval containing `point`, in
+    /// ascending order of start.
+    template <typename F>
+    void stab(T point, F&& f) const {
+        traverse(
+            point, [&](const T& s) { return !(point < s); }, f);
+    }
+
+    /// Returns the number of intervals overlapping `[start, end)`, where
+    /// `start < end`, in `O(log n)`.
+    SizeType count_overlaps(T start, T end) const {
+        assert(indexed_);
+        assert(start < end);
+        // The intervals starting at or after `end` and those ending at or
+        // before `start` are disjoint sets, and every other one overlaps.
+        const auto starts_after = static_cast<SizeType>(
+            nodes_.end() -
+            std::lower_bound(nodes_.begin(), nodes_.end(), end,
+                             [](const Node& node, const T& value) {
+                                 return node.start < value;
+                             }));
+        const auto ends_before = static_cast<SizeType>(
+            std::upper_bound(ends_.begin(), ends_.end(), start) -
+            ends_.begin());
+        return nodes_.size() - starts_after - ends_before;
+    }
+
+    /// Returns the number of intervals containing `point` in `O(log n)`.
+    SizeType stab_count(T point) const {
+        assert(indexed_);
+        // Every interval ending at or before `point` also starts at or
+        // before it.
+        const auto started = static_cast<SizeType>(
+            std::upper_bound(nodes_.begin(), nodes_.end(), point,
+                             [](const T& value, const Node& node) {
+                                 return value < node.start;
+                             }) -
+            nodes_.begin());
+        const auto ended = static_cast<SizeType>(
+            std::upper_bound(ends_.begin(), ends_.end(), point) -
+            ends_.begin());
+        return started - ended;
+    }
+
+private:
+    struct Node {
+        T start;
+        T end;
+        // The largest end in the subtree rooted at this node.
+        T max_end;
+        IdType id;
+    };
+
+    // Subtrees of at most this level are scanned linearly.
+    static constexpr int scan_level = 3;
+
+    // Fills `max_end` bottom-up and returns the level of the root. Nodes past
+    // the end of the array are virtual; their maximum is taken from the last
+    // real node on the way up.
+    int indexNodes() noexcept {
+        const std::int64_t n = std::int64_t(nodes_.size());
+        if (n == 0) {
+            return 0;
+        }
+
+        std::int64_t last_i = 0;
+        T last = nodes_[0].end;
+        for (std::int64_t i = 0; i < n; i += 2) {
+            last_i = i;
+            last = nodes_[i].max_end = nodes_[i].end;
+        }
+
+        int k = 1;
+        for (; (std::int64_t(1) << k) <= n; ++k) {
+            const std::int64_t x = std::int64_t(1) << (k - 1);
+            const std::int64_t step = x << 2;
+            for (std::int64_t i = (x << 1) - 1; i < n; i += step) {
+                const T& left = nodes_[i - x].max_end;
+                const T& right = i + x < n ? nodes_[i + x].max_end : last;
+                nodes_[i].max_end = std::max({nodes_[i].end, left, right});
+            }
+            // Move `last_i` to its parent.
+            last_i = (last_i >> k & 1) ? last_i - x : last_i + x;
+            if (last_i < n && last < nodes_[last_i].max_end) {
+                last = nodes_[last_i].max_end;
+            }
+        }
+        return k - 1;
+    }
+
+    // Visits the nodes whose end is after `start` and whose start satisfies
+    // `startOk`, which must be monotone along the sorted starts.
+    template <typename StartOk, typename F>
+    void traverse(const T& start, StartOk startOk, F& f) const {
+        assert(indexed_);
+        if (nodes_.empty()) {
+            return;
+        }
+
+        struct Frame {
+            std::int64_t x;
+            int level;
+            bool left_done;
+        };
+
+        const std::int64_t n = std::int64_t(nodes_.size());
+        Frame stack[64];
+        int top = 0;
+        stack[top++] = Frame{(std::int64_t(1) << root_level_) - 1, root_level_,
+                             false};
+        while (top > 0) {
+            const Frame z = stack[--top];
+            if (z.level <= scan_level) {
+                const std::int64_t first = z.x >> z.level << z.level;
+                const std::int64_t last =
+                    std::min(first + (std::int64_t(1) << (z.level + 1)) - 1, n);
+                for (std::int64_t i = first;
+                     i < last && startOk(nodes_[i].start); ++i) {
+                    if (start < nodes_[i].end) {
+                        f(nodes_[i].start, nodes_[i].end, nodes_[i].id);
+                    }
+                }
+            } else if (!z.left_done) {
+                // The left child may be virtual, in which case it cannot be
+                // pruned by its maximum.
+                const std::int64_t y = z.x - (std::int64_t(1) << (z.level - 1));
+                stack[top++] = Frame{z.x, z.level, true};
+                if (y >= n || start < nodes_[y].max_end) {
+                    stack[top++] = Frame{y, z.level - 1, false};
+                }
+            } else if (z.x < n && startOk(nodes_[z.x].start)) {
+                if (start < nodes_[z.x].end) {
+                    f(nodes_[z.x].start, nodes_[z.x].end, nodes_[z.x].id);
+                }
+                stack[top++] = Frame{z.x + (std::int64_t(1) << (z.level - 1)),
+                                     z.level - 1, false};
+            }
+        }
+    }
+
+private:
+    Vector<Node> nodes_;
+    Vector<T> ends_;
+    int root_level_ = 0;
+    bool indexed_ = true;
+};
+} // namespace algo
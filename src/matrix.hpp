@@ -0,0 +1,848 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+#include "aligned_allocator.hpp"
+#include "simd.hpp"
+#include "vector.hpp"
+
+namespace algo {
+namespace detail {
+// Keeps `T` out of template argument deduction.
+template <typename T>
+struct Identity {
+    using Type = T;
+};
+
+template <typename T>
+using NonDeduced = typename Identity<T>::Type;
+
+// One SIMD register of `T` for the matrix kernels, or a single value for
+// types without one.
+template <typename T>
+struct MatrixLanes {
+    static constexpr std::size_t lanes = 1;
+    using Reg = T;
+
+    static Reg load(const T* p) noexcept {
+        return *p;
+    }
+    static void store(T* p, Reg r) noexcept {
+        *p = r;
+    }
+    static Reg set1(T v) noexcept {
+        return v;
+    }
+    static Reg fmadd(Reg a, Reg b, Reg c) noexcept {
+        return a * b + c;
+    }
+    static T sum(Reg r) noexcept {
+        return r;
+    }
+};
+
+template <typename T>
+constexpr bool is_simd_matrix =
+    std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+#if defined(ALGO_SIMD_X86)
+template <typename T>
+struct MatrixLanesSse2;
+
+template <>
+struct MatrixLanesSse2<double> {
+    static constexpr std::size_t lanes = 2;
+    using Reg = __m128d;
+
+    __attribute__((target("sse2"))) static Reg load(const double* p) noexcept {
+        return _mm_loadu_pd(p);
+    }
+    __attribute__((target("sse2"))) static void store(double* p,
+                                                      Reg r) noexcept {
+        _mm_storeu_pd(p, r);
+    }
+    __attribute__((target("sse2"))) static Reg set1(double v) noexcept {
+        return _mm_set1_pd(v);
+    }
+    __attribute__((target("sse2"))) static Reg fmadd(Reg a, Reg b,
+                                                     Reg c) noexcept {
+        return _mm_add_pd(_mm_mul_pd(a, b), c);
+    }
+    __attribute__((target("sse2"))) static double sum(Reg r) noexcept {
+        return _mm_cvtsd_f64(_mm_add_sd(r, _mm_unpackhi_pd(r, r)));
+    }
+};
+
+template <>
+struct MatrixLanesSse2<float> {
+    static constexpr std::size_t lanes = 4;
+    using Reg = __m128;
+
+    __attribute__((target("sse2"))) static Reg load(const float* p) noexcept {
+        return _mm_loadu_ps(p);
+    }
+    __attribute__((target("sse2"))) static void store(float* p,
+                                                      Reg r) noexcept {
+        _mm_storeu_ps(p, r);
+    }
+    __attribute__((target("sse2"))) static Reg set1(float v) noexcept {
+        return _mm_set1_ps(v);
+    }
+    __attribute__((target("sse2"))) static Reg fmadd(Reg a, Reg b,
+                                                     Reg c) noexcept {
+        return _mm_add_ps(_mm_mul_ps(a, b), c);
+    }
+    __attribute__((target("sse2"))) static float sum(Reg r) noexcept {
+        const __m128 pairs = _mm_add_ps(r, _mm_movehl_ps(r, r));
+        return _mm_cvtss_f32(
+            _mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+    }
+};
+
+template <typename T>
+struct MatrixLanesAvx2;
+
+template <>
+struct MatrixLanesAvx2<double> {
+    static constexpr std::size_t lanes = 4;
+    using Reg = __m256d;
+
+    __attribute__((target("avx2,fma"))) static Reg
+    load(const double* p) noexcept {
+        return _mm256_loadu_pd(p);
+    }
+    __attribute__((target("avx2,fma"))) static void store(double* p,
+                                                          Reg r) noexcept {
+        _mm256_storeu_pd(p, r);
+    }
+    __attribute__((target("avx2,fma"))) static Reg set1(double v) noexcept {
+        return _mm256_set1_pd(v);
+    }
+    __attribute__((target("avx2,fma"))) static Reg fmadd(Reg a, Reg b,
+                                                         Reg c) noexcept {
+        return _mm256_fmadd_pd(a, b, c);
+    }
+    __attribute__((target("avx2,fma"))) static double sum(Reg r) noexcept {
+        return MatrixLanesSse2<double>::sum(_mm_add_pd(
+            _mm256_castpd256_pd128(r), _mm256_extractf128_pd(r, 1)));
+    }
+};
+
+template <>
+struct MatrixLanesAvx2<float> {
+    static constexpr std::size_t lanes = 8;
+    using Reg = __m256;
+
+    __attribute__((target("avx2,fma"))) static Reg
+    load(const float* p) noexcept {
+        return _mm256_loadu_ps(p);
+    }
+    __attribute__((target("avx2,fma"))) static void store(float* p,
+                                                          Reg r) noexcept {
+        _mm256_storeu_ps(p, r);
+    }
+    __attribute__((target("avx2,fma"))) static Reg set1(float v) noexcept {
+        return _mm256_set1_ps(v);
+    }
+    __attribute__((target("avx2,fma"))) static Reg fmadd(Reg a, Reg b,
+                                                         Reg c) noexcept {
+        return _mm256_fmadd_ps(a, b, c);
+    }
+    __attribute__((target("avx2,fma"))) static float sum(Reg r) noexcept {
+        return MatrixLanesSse2<float>::sum(_mm_add_ps(
+            _mm256_castps256_ps128(r), _mm256_extractf128_ps(r, 1)));
+    }
+};
+
+template <typename T>
+struct MatrixLanesAvx512;
+
+template <>
+struct MatrixLanesAvx512<double> {
+    static constexpr std::size_t lanes = 8;
+    using Reg = __m512d;
+
+    __attribute__((target("avx512f"))) static Reg
+    load(const double* p) noexcept {
+        return _mm512_loadu_pd(p);
+    }
+    __attribute__((target("avx512f"))) static void store(double* p,
+                                                         Reg r) noexcept {
+        _mm512_storeu_pd(p, r);
+    }
+    __attribute__((target("avx512f"))) static Reg set1(double v) noexcept {
+        return _mm512_set1_pd(v);
+    }
+    __attribute__((target("avx512f"))) static Reg fmadd(Reg a, Reg b,
+                                                        Reg c) noexcept {
+        return _mm512_fmadd_pd(a, b, c);
+    }
+    __attribute__((target("avx512f"))) static double sum(Reg r) noexcept {
+        alignas(64) double v[lanes];
+        _mm512_store_pd(v, r);
+        double total = 0;
+        for (double x : v) {
+            total += x;
+        }
+        return total;
+    }
+};
+
+template <>
+struct MatrixLanesAvx512<float> {
+    static constexpr std::size_t lanes = 16;
+    using Reg = __m512;
+
+    __attribute__((target("avx512f"))) static Reg
+    load(const float* p) noexcept {
+        return _mm512_loadu_ps(p);
+    }
+    __attribute__((target("avx512f"))) static void store(float* p,
+                                                         Reg r) noexcept {
+        _mm512_storeu_ps(p, r);
+    }
+    __attribute__((target("avx512f"))) static Reg set1(float v) noexcept {
+        return _mm512_set1_ps(v);
+    }
+    __attribute__((target("avx512f"))) static Reg fmadd(Reg a, Reg b,
+                                                        Reg c) noexcept {
+        return _mm512_fmadd_ps(a, b, c);
+    }
+    __attribute__((target("avx512f"))) static float sum(Reg r) noexcept {
+        alignas(64) float v[lanes];
+        _mm512_store_ps(v, r);
+        float total = 0;
+        for (float x : v) {
+            total += x;
+        }
+        return total;
+    }
+};
+#endif
+} // namespace detail
+
+/// A non-owning view of a row-major matrix whose rows are `stride()`
+/// elements apart.
+///
+/// `MatrixView<T>` allows writes and converts implicitly to the read-only
+/// `MatrixView<const T>`. Views of submatrices share the stride of the
+/// parent, so taking a `block()` never copies.
+///
+/// # Example
+///
+/// ```cpp
+/// Matrix<double> m(4, 4);
+/// MatrixView<double> corner = m.block(2, 2, 2, 2);
+/// corner(0, 0) = 1.0;
+/// assert(m(2, 2) == 1.0);
+/// ```
+template <typename T>
+class MatrixView {
+public:
+    using ValueType = std::remove_const_t<T>;
+    using SizeType = std::size_t;
+
+    /// Constructs an empty view.
+    MatrixView() noexcept = default;
+
+    /// Constructs a view of `rows x cols` elements at `data` whose rows are
+    /// `stride >= cols` elements apart.
+    MatrixView(T* data, SizeType rows, SizeType cols, SizeType stride) noexcept
+        : data_(data), rows_(rows), cols_(cols), stride_(stride) {
+        assert(stride >= cols);
+    }
+
+    /// Converts a writable view into a read-only one.
+    template <typename U,
+              std::enable_if_t<std::is_same_v<const U, T> &&
+                                   !std::is_same_v<U, T>,
+                               int> = 0>
+    MatrixView(const MatrixView<U>& other) noexcept
+        : MatrixView(other.data(), other.rows(), other.cols(),
+                     other.stride()) {}
+
+    /// Returns the number of rows.
+    [[nodiscard]] SizeType rows() const noexcept {
+        return rows_;
+    }
+
+    /// Returns the number of columns.
+    [[nodiscard]] SizeType cols() const noexcept {
+        return cols_;
+    }
+
+    /// Returns the distance in elements between the starts of two rows.
+    [[nodiscard]] SizeType stride() const noexcept {
+        return stride_;
+    }
+
+    /// Returns the first element.
+    T* data() const noexcept {
+        return data_;
+    }
+
+    /// Returns the first element of row `i`.
+    T* row(SizeType i) const noexcept {
+        assert(i < rows_);
+        return data_ + i * stride_;
+    }
+
+    /// Returns the element at row `i` and column `j`.
+    T& operator()(SizeType i, SizeType j) const noexcept {
+        assert(i < rows_ && j < cols_);
+        return data_[i * stride_ + j];
+    }
+
+    /// Returns the element at row `i` and column `j`.
+    ///
+    /// Throws `std::out_of_range` if the position is outside the view.
+    T& at(SizeType i, SizeType j) const {
+        if (i >= rows_ || j >= cols_) {
+            throw std::out_of_range("MatrixView: index out of range");
+        }
+        return (*this)(i, j);
+    }
+
+    /// Returns the `rows x cols` submatrix starting at row `i` and column
+    /// `j`.
+    ///
+    /// Throws `std::out_of_range` if it does not fit in this view.
+    MatrixView block(SizeType i, SizeType j, SizeType rows,
+                     SizeType cols) const {
+        if (i > rows_ || j > cols_ || rows > rows_ - i || cols > cols_ - j) {
+            throw std::out_of_range("MatrixView: block out of range");
+        }
+        return MatrixView(data_ + i * stride_ + j, rows, cols, stride_);
+    }
+
+    /// Sets every element to `value`.
+    void fill(const ValueType& value) const {
+        for (SizeType i = 0; i < rows_; ++i) {
+            std::fill(row(i), row(i) + cols_, value);
+        }
+    }
+
+private:
+    T* data_ = nullptr;
+    SizeType rows_ = 0;
+    SizeType cols_ = 0;
+    SizeType stride_ = 0;
+};
+
+/// A dense row-major matrix of arithmetic values stored in one `Vector`.
+///
+/// Every row starts on a 64-byte boundary: the stride is the column count
+/// rounded up to a cache line, and the padding stays zero. Submatrices are
+/// `MatrixView`s sharing the storage.
+///
+/// The kernels `gemm()`, `gemv()` and `transpose()` work on views and are
+/// cache-blocked; `gemm()` and `gemv()` keep a tile of results in the SSE2,
+/// AVX2 or AVX-512 registers of the running CPU for `float` and `double`.
+///
+/// # Example
+///
+/// ```cpp
+/// Matrix<double> a = {{1, 2}, {3, 4}};
+/// Matrix<double> b = {{5, 6}, {7, 8}};
+/// Matrix<double> c = a * b;
+/// assert(c(1, 0) == 43);
+/// assert(a.transposed()(0, 1) == 3);
+/// ```
+template <typename T>
+class Matrix {
+    static_assert(std::is_arithmetic_v<T>, "Matrix holds arithmetic values");
+
+public:
+    using ValueType = T;
+    using SizeType = std::size_t;
+
+    /// The alignment of every row in bytes.
+    static constexpr SizeType row_alignment = 64;
+
+    /// Constructs an empty matrix.
+    Matrix() = default;
+
+    /// Constructs a `rows x cols` matrix filled with `value`.
+    Matrix(SizeType rows, SizeType cols, const T& value = T())
+        : rows_(rows), cols_(cols), stride_(paddedStride(cols)) {
+        data_.assign(rows_ * stride_, T());
+        if (value != T()) {
+            view().fill(value);
+        }
+    }
+
+    /// Constructs a matrix from a list of rows.
+    ///
+    /// Throws `std::invalid_argument` if the rows differ in length.
+    Matrix(std::initializer_list<std::initializer_list<T>> init)
+        : Matrix(init.size(), init.size() == 0 ? 0 : init.begin()->size()) {
+        SizeType i = 0;
+        for (const auto& r : init) {
+            if (r.size() != cols_) {
+                throw std::invalid_argument("Matrix: ragged rows");
+            }
+            std::copy(r.begin(), r.end(), row(i++));
+        }
+    }
+
+    /// Returns the number of rows.
+    [[nodiscard]] SizeType rows() const noexcept {
+        return rows_;
+    }
+
+    /// Returns the number of columns.
+    [[nodiscard]] SizeType cols() const noexcept {
+        return cols_;
+    }
+
+    /// Returns the distance in elements between the starts of two rows.
+    [[nodiscard]] SizeType stride() const noexcept {
+        return stride_;
+    }
+
+    /// Returns the first element.
+    T* data() noexcept {
+        return data_.data();
+    }
+
+    /// Returns the first element.
+    const T* data() const noexcept {
+        return data_.data();
+    }
+
+    /// Returns the first element of row `i`.
+    T* row(SizeType i) noexcept {
+        assert(i < rows_);
+        return data_.data() + i * stride_;
+    }
+
+    /// Returns the first element of row `i`.
+    const T* row(SizeType i) const noexcept {
+        assert(i < rows_);
+        return data_.data() + i * stride_;
+    }
+
+    /// Returns the element at row `i` and column `j`.
+    T& operator()(SizeType i, SizeType j) noexcept {
+        assert(i < rows_ && j < cols_);
+        return data_[i * stride_ + j];
+    }
+
+    /// Returns the element at row `i` and column `j`.
+    const T& operator()(SizeType i, SizeType j) const noexcept {
+        assert(i < rows_ && j < cols_);
+        return data_[i * stride_ + j];
+    }
+
+    /// Returns the element at row `i` and column `j`.
+    ///
+    /// Throws `std::out_of_range` if the position is outside the matrix.
+    T& at(SizeType i, SizeType j) {
+        return view().at(i, j);
+    }
+
+    /// Returns the element at row `i` and column `j`.
+    ///
+    /// Throws `std::out_of_range` if the position is outside the matrix.
+    const T& at(SizeType i, SizeType j) const {
+        return view().at(i, j);
+    }
+
+    /// Returns a view of the whole matrix.
+    MatrixView<T> view() noexcept {
+        return MatrixView<T>(data_.data(), rows_, cols_, stride_);
+    }
+
+    /// Returns a read-only view of the whole matrix.
+    MatrixView<const T> view() const noexcept {
+        return MatrixView<const T>(data_.data(), rows_, cols_, stride_);
+    }
+
+    /// Returns a view of the `rows x cols` submatrix at row `i` and column
+    /// `j`.
+    ///
+    /// Throws `std::out_of_range` if it does not fit in the matrix.
+    MatrixView<T> block(SizeType i, SizeType j, SizeType rows,
+                        SizeType cols) {
+        return view().block(i, j, rows, cols);
+    }
+
+    /// Returns a read-only view of the `rows x cols` submatrix at row `i`
+    /// and column `j`.
+    ///
+    /// Throws `std::out_of_range` if it does not fit in the matrix.
+    MatrixView<const T> block(SizeType i, SizeType j, SizeType rows,
+                              SizeType cols) const {
+        return view().block(i, j, rows, cols);
+    }
+
+    /// Sets every element to `value`.
+    void fill(const T& value) {
+        view().fill(value);
+    }
+
+    /// Returns the transpose.
+    [[nodiscard]] Matrix transposed() const {
+        Matrix result(cols_, rows_);
+        transpose(view(), result.view());
+        return result;
+    }
+
+    /// Returns true if both matrices have the same shape and elements.
+    friend bool operator==(const Matrix& lhs, const Matrix& rhs) noexcept {
+        if (lhs.rows_ != rhs.rows_ || lhs.cols_ != rhs.cols_) {
+            return false;
+        }
+        for (SizeType i = 0; i < lhs.rows_; ++i) {
+            if (!std::equal(lhs.row(i), lhs.row(i) + lhs.cols_, rhs.row(i))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    friend bool operator!=(const Matrix& lhs, const Matrix& rhs) noexcept {
+        return !(lhs == rhs);
+    }
+
+    /// Returns the product `lhs * rhs`.
+    ///
+    /// Throws `std::invalid_argument` if the shapes do not match.
+    friend Matrix operator*(const Matrix& lhs, const Matrix& rhs) {
+        Matrix result(lhs.rows_, rhs.cols_);
+        gemm(T(1), lhs.view(), rhs.view(), T(0), result.view());
+        return result;
+    }
+
+private:
+    static SizeType paddedStride(SizeType cols) noexcept {
+        constexpr SizeType per_line = row_alignment / sizeof(T);
+        return (cols + per_line - 1) / per_line * per_line;
+    }
+
+private:
+    Vector<T, AlignedAllocator<T, row_alignment>> data_;
+    SizeType rows_ = 0;
+    SizeType cols_ = 0;
+    SizeType stride_ = 0;
+};
+
+/// Writes the transpose of `src` into `dst`, which must not overlap it.
+///
+/// Both matrices are walked in 8 x 8 tiles, so the strided side of the copy
+/// touches only eight cache lines, which stay apart in the cache even when
+/// the stride is a power of two.
+///
+/// Throws `std::invalid_argument` if `dst` is not `src.cols() x src.rows()`.
+template <typename T>
+void transpose(detail::NonDeduced<MatrixView<const T>> src,
+               MatrixView<T> dst) {
+    if (dst.rows() != src.cols() || dst.cols() != src.rows()) {
+        throw std::invalid_argument("transpose: shape mismatch");
+    }
+    constexpr std::size_t tile = 8;
+    for (std::size_t i0 = 0; i0 < src.rows(); i0 += tile) {
+        const std::size_t i1 = std::min(i0 + tile, src.rows());
+        for (std::size_t j0 = 0; j0 < src.cols(); j0 += tile) {
+            const std::size_t j1 = std::min(j0 + tile, src.cols());
+            for (std::size_t i = i0; i < i1; ++i) {
+                const T* in = src.row(i);
+                for (std::size_t j = j0; j < j1; ++j) {
+                    dst(j, i) = in[j];
+                }
+            }
+        }
+    }
+}
+
+namespace detail {
+ALGO_SIMD_KERNELS_BEGIN
+// Adds `alpha * a * b` to the 4 x 2-register tile of `c`, summing over `kc`.
+template <typename Lanes, typename T>
+__attribute__((always_inline)) inline void
+gemmTile(std::size_t kc, const T* a, std::size_t lda, const T* b,
+         std::size_t ldb, T alpha, T* c, std::size_t ldc) noexcept {
+    constexpr std::size_t w = Lanes::lanes;
+    typename Lanes::Reg acc[4][2];
+    for (auto& r : acc) {
+        r[0] = r[1] = Lanes::set1(T(0));
+    }
+    for (std::size_t p = 0; p < kc; ++p) {
+        const typename Lanes::Reg b0 = Lanes::load(b + p * ldb);
+        const typename Lanes::Reg b1 = Lanes::load(b + p * ldb + w);
+        for (std::size_t r = 0; r < 4; ++r) {
+            const typename Lanes::Reg x = Lanes::set1(a[r * lda + p]);
+            acc[r][0] = Lanes::fmadd(x, b0, acc[r][0]);
+            acc[r][1] = Lanes::fmadd(x, b1, acc[r][1]);
+        }
+    }
+    const typename Lanes::Reg scale = Lanes::set1(alpha);
+    for (std::size_t r = 0; r < 4; ++r) {
+        T* out = c + r * ldc;
+        Lanes::store(out, Lanes::fmadd(scale, acc[r][0], Lanes::load(out)));
+        Lanes::store(out + w,
+                     Lanes::fmadd(scale, acc[r][1], Lanes::load(out + w)));
+    }
+}
+
+// Adds `alpha * a * b` to rows `[i0, i1)` and columns `[j0, j1)` of `c`,
+// summing over `kc`, one row at a time.
+template <typename T>
+__attribute__((always_inline)) inline void
+gemmEdge(std::size_t i0, std::size_t i1, std::size_t j0, std::size_t j1,
+         std::size_t kc, const T* a, std::size_t lda, const T* b,
+         std::size_t ldb, T alpha, T* c, std::size_t ldc) noexcept {
+    for (std::size_t i = i0; i < i1; ++i) {
+        T* out = c + i * ldc;
+        for (std::size_t p = 0; p < kc; ++p) {
+            const T x = alpha * a[i * lda + p];
+            const T* in = b + p * ldb;
+            for (std::size_t j = j0; j < j1; ++j) {
+                out[j] += x * in[j];
+            }
+        }
+    }
+}
+
+// Adds `alpha * a * b` to the `mb` x `nb` block `c`, summing over `kb`, in
+// tiles of 4 rows by two registers of columns and row by row at the edges.
+template <typename Lanes, typename T>
+__attribute__((always_inline)) inline void
+gemmBlock(std::size_t mb, std::size_t nb, std::size_t kb, const T* a,
+          std::size_t lda, const T* b, std::size_t ldb, T alpha, T* c,
+          std::size_t ldc) noexcept {
+    constexpr std::size_t tile_n = 2 * Lanes::lanes;
+    const std::size_t m4 = mb / 4 * 4;
+    const std::size_t nt = nb / tile_n * tile_n;
+    for (std::size_t i = 0; i < m4; i += 4) {
+        for (std::size_t j = 0; j < nt; j += tile_n) {
+            gemmTile<Lanes>(kb, a + i * lda, lda, b + j, ldb, alpha,
+                            c + i * ldc + j, ldc);
+        }
+    }
+    gemmEdge(0, m4, nt, nb, kb, a, lda, b, ldb, alpha, c, ldc);
+    gemmEdge(m4, mb, 0, nb, kb, a, lda, b, ldb, alpha, c, ldc);
+}
+
+// Computes `y = alpha * a * x + beta * y` for the `m` x `n` matrix `a`.
+// Four rows are multiplied at once so every load of `x` is shared. The
+// accumulators are named rather than an array, which GCC 12 may spill to a
+// misaligned slot in an SSE2 variant built with `-march=native`.
+template <typename Lanes, typename T>
+__attribute__((always_inline)) inline void
+gemvRows(std::size_t m, std::size_t n, const T* a, std::size_t lda,
+         const T* x, T alpha, T beta, T* y) noexcept {
+    constexpr std::size_t w = Lanes::lanes;
+    const std::size_t nw = n / w * w;
+    // Adds the products of the columns from `j` on of `row` to `dot`.
+    auto dotFrom = [&](const T* row, std::size_t j, T dot) {
+        for (; j < n; ++j) {
+            dot += row[j] * x[j];
+        }
+        return dot;
+    };
+    auto finish = [&](std::size_t i, T dot) {
+        y[i] = alpha * dot + (beta == T(0) ? T(0) : beta * y[i]);
+    };
+
+    std::size_t i = 0;
+    for (; i + 4 <= m; i += 4) {
+        const T* r0 = a + i * lda;
+        const T* r1 = r0 + lda;
+        const T* r2 = r1 + lda;
+        const T* r3 = r2 + lda;
+        typename Lanes::Reg acc0 = Lanes::set1(T(0));
+        typename Lanes::Reg acc1 = acc0;
+        typename Lanes::Reg acc2 = acc0;
+        typename Lanes::Reg acc3 = acc0;
+        for (std::size_t j = 0; j < nw; j += w) {
+            const typename Lanes::Reg v = Lanes::load(x + j);
+            acc0 = Lanes::fmadd(Lanes::load(r0 + j), v, acc0);
+            acc1 = Lanes::fmadd(Lanes::load(r1 + j), v, acc1);
+            acc2 = Lanes::fmadd(Lanes::load(r2 + j), v, acc2);
+            acc3 = Lanes::fmadd(Lanes::load(r3 + j), v, acc3);
+        }
+        finish(i, dotFrom(r0, nw, Lanes::sum(acc0)));
+        finish(i + 1, dotFrom(r1, nw, Lanes::sum(acc1)));
+        finish(i + 2, dotFrom(r2, nw, Lanes::sum(acc2)));
+        finish(i + 3, dotFrom(r3, nw, Lanes::sum(acc3)));
+    }
+    for (; i < m; ++i) {
+        finish(i, dotFrom(a + i * lda, 0, T(0)));
+    }
+}
+ALGO_SIMD_KERNELS_END
+
+template <typename T>
+using GemmBlock = void(std::size_t, std::size_t, std::size_t, const T*,
+                       std::size_t, const T*, std::size_t, T, T*,
+                       std::size_t);
+
+template <typename T>
+using GemvRows = void(std::size_t, std::size_t, const T*, std::size_t,
+                      const T*, T, T, T*);
+
+template <typename T>
+void gemmBlockScalar(std::size_t mb, std::size_t nb, std::size_t kb,
+                     const T* a, std::size_t lda, const T* b, std::size_t ldb,
+                     T alpha, T* c, std::size_t ldc) noexcept {
+    gemmBlock<MatrixLanes<T>>(mb, nb, kb, a, lda, b, ldb, alpha, c, ldc);
+}
+
+template <typename T>
+void gemvRowsScalar(std::size_t m, std::size_t n, const T* a,
+                    std::size_t lda, const T* x, T alpha, T beta,
+                    T* y) noexcept {
+    gemvRows<MatrixLanes<T>>(m, n, a, lda, x, alpha, beta, y);
+}
+
+#if defined(ALGO_SIMD_X86)
+template <typename T>
+__attribute__((target("sse2"))) void
+gemmBlockSse2(std::size_t mb, std::size_t nb, std::size_t kb, const T* a,
+              std::size_t lda, const T* b, std::size_t ldb, T alpha, T* c,
+              std::size_t ldc) noexcept {
+    gemmBlock<MatrixLanesSse2<T>>(mb, nb, kb, a, lda, b, ldb, alpha, c, ldc);
+}
+
+template <typename T>
+__attribute__((target("avx2,fma"))) void
+gemmBlockAvx2(std::size_t mb, std::size_t nb, std::size_t kb, const T* a,
+              std::size_t lda, const T* b, std::size_t ldb, T alpha, T* c,
+              std::size_t ldc) noexcept {
+    gemmBlock<MatrixLanesAvx2<T>>(mb, nb, kb, a, lda, b, ldb, alpha, c, ldc);
+}
+
+template <typename T>
+__attribute__((target("avx512f"))) void
+gemmBlockAvx512(std::size_t mb, std::size_t nb, std::size_t kb, const T* a,
+                std::size_t lda, const T* b, std::size_t ldb, T alpha, T* c,
+                std::size_t ldc) noexcept {
+    gemmBlock<MatrixLanesAvx512<T>>(mb, nb, kb, a, lda, b, ldb, alpha, c,
+                                    ldc);
+}
+
+template <typename T>
+__attribute__((target("sse2"))) void
+gemvRowsSse2(std::size_t m, std::size_t n, const T* a, std::size_t lda,
+             const T* x, T alpha, T beta, T* y) noexcept {
+    gemvRows<MatrixLanesSse2<T>>(m, n, a, lda, x, alpha, beta, y);
+}
+
+template <typename T>
+__attribute__((target("avx2,fma"))) void
+gemvRowsAvx2(std::size_t m, std::size_t n, const T* a, std::size_t lda,
+             const T* x, T alpha, T beta, T* y) noexcept {
+    gemvRows<MatrixLanesAvx2<T>>(m, n, a, lda, x, alpha, beta, y);
+}
+
+template <typename T>
+__attribute__((target("avx512f"))) void
+gemvRowsAvx512(std::size_t m, std::size_t n, const T* a, std::size_t lda,
+               const T* x, T alpha, T beta, T* y) noexcept {
+    gemvRows<MatrixLanesAvx512<T>>(m, n, a, lda, x, alpha, beta, y);
+}
+
+template <typename T>
+inline const simd::Dispatch<GemmBlock<T>>
+    gemm_block(gemmBlockScalar<T>, gemmBlockSse2<T>, gemmBlockAvx2<T>,
+               gemmBlockAvx512<T>);
+
+template <typename T>
+inline const simd::Dispatch<GemvRows<T>>
+    gemv_rows(gemvRowsScalar<T>, gemvRowsSse2<T>, gemvRowsAvx2<T>,
+              gemvRowsAvx512<T>);
+#else
+template <typename T>
+inline const simd::Dispatch<GemmBlock<T>> gemm_block(gemmBlockScalar<T>);
+
+template <typename T>
+inline const simd::Dispatch<GemvRows<T>> gemv_rows(gemvRowsScalar<T>);
+#endif
+} // namespace detail
+
+/// Computes `c = alpha * a * b + beta * c`. `c` must not overlap `a` or `b`.
+///
+/// The product is computed in blocks of 64 rows, 256 inner indices and 256
+/// columns, so the touched panels of `b` and `c` stay in L2, and each block
+/// in tiles of 4 rows by two registers of columns accumulated in registers.
+///
+/// Throws `std::invalid_argument` if the shapes do not match.
+template <typename T>
+void gemm(T alpha, detail::NonDeduced<MatrixView<const T>> a,
+          detail::NonDeduced<MatrixView<const T>> b, T beta,
+          MatrixView<T> c) {
+    if (a.cols() != b.rows() || c.rows() != a.rows() ||
+        c.cols() != b.cols()) {
+        throw std::invalid_argument("gemm: shape mismatch");
+    }
+    const std::size_t m = c.rows();
+    const std::size_t n = c.cols();
+    const std::size_t k = a.cols();
+    for (std::size_t i = 0; i < m; ++i) {
+        T* out = c.row(i);
+        for (std::size_t j = 0; j < n; ++j) {
+            out[j] = beta == T(0) ? T(0) : beta * out[j];
+        }
+    }
+
+    constexpr std::size_t block_m = 64;
+    constexpr std::size_t block_k = 256;
+    constexpr std::size_t block_n = 256;
+    for (std::size_t jc = 0; jc < n; jc += block_n) {
+        const std::size_t nb = std::min(block_n, n - jc);
+        for (std::size_t pc = 0; pc < k; pc += block_k) {
+            const std::size_t kb = std::min(block_k, k - pc);
+            const T* bp = b.data() + pc * b.stride() + jc;
+            for (std::size_t ic = 0; ic < m; ic += block_m) {
+                const std::size_t mb = std::min(block_m, m - ic);
+                const T* ap = a.data() + ic * a.stride() + pc;
+                T* cp = c.data() + ic * c.stride() + jc;
+                if constexpr (detail::is_simd_matrix<T>) {
+                    detail::gemm_block<T>(mb, nb, kb, ap, a.stride(), bp,
+                                          b.stride(), alpha, cp, c.stride());
+                } else {
+                    detail::gemmBlockScalar(mb, nb, kb, ap, a.stride(), bp,
+                                            b.stride(), alpha, cp,
+                                            c.stride());
+                }
+            }
+        }
+    }
+}
+
+/// Computes `y = alpha * a * x + beta * y`, where `x` has `a.cols()` and `y`
+/// has `a.rows()` elements, and `y` does not overlap `a` or `x`.
+///
+/// Four rows are multiplied at once so every load of `x` is shared, with the
+/// partial sums kept in registers.
+template <typename T>
+void gemv(T alpha, detail::NonDeduced<MatrixView<const T>> a, const T* x,
+          T beta, T* y) noexcept {
+    if constexpr (detail::is_simd_matrix<T>) {
+        detail::gemv_rows<T>(a.rows(), a.cols(), a.data(), a.stride(), x,
+                             alpha, beta, y);
+    } else {
+        detail::gemvRowsScalar(a.rows(), a.cols(), a.data(), a.stride(), x,
+                               alpha, beta, y);
+    }
+}
+
+/// Computes `y = alpha * a * x + beta * y`.
+///
+/// Throws `std::invalid_argument` if `x` does not have `a.cols()` or `y`
+/// does not have `a.rows()` elements.
+template <typename T, typename Alloc>
+void gemv(T alpha, detail::NonDeduced<MatrixView<const T>> a,
+          const Vector<T, Alloc>& x, T beta, Vector<T, Alloc>& y) {
+    if (x.size() != a.cols() || y.size() != a.rows()) {
+        throw std::invalid_argument("gemv: shape mismatch");
+    }
+    gemv(alpha, a, x.data(), beta, y.data());
+}
+} // namespace algo
@@ -0,0 +1,349 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "thread_pool.hpp"
+#include "vector.hpp"
+
+namespace algo {
+namespace detail {
+template <typename T>
+struct MergeSource {
+    const T* cur;
+    const T* end;
+};
+
+// Merges `[a, a_end)` and `[b, b_end)` into `out`, taking from `a` on ties.
+// The loop selects instead of branching on the comparison, so random
+// interleavings cost no mispredictions.
+template <typename T, typename Compare>
+T* mergeTwo(const T* a, const T* a_end, const T* b, const T* b_end, T* out,
+            Compare& comp) {
+    while (a != a_end && b != b_end) {
+        const bool take_b = comp(*b, *a);
+        *out++ = take_b ? *b : *a;
+        a += !take_b;
+        b += take_b;
+    }
+    out = std::copy(a, a_end, out);
+    return std::copy(b, b_end, out);
+}
+
+// Returns `cond ? a : b` for integers and pointers. Compilers often turn a
+// conditional expression into a branch, which mispredicts half the time when
+// `cond` is the outcome of comparing random values.
+template <typename U>
+U branchlessSelect(bool cond, U a, U b) noexcept {
+    if constexpr (std::is_pointer_v<U>) {
+        return reinterpret_cast<U>(
+            branchlessSelect(cond, reinterpret_cast<std::uintptr_t>(a),
+                             reinterpret_cast<std::uintptr_t>(b)));
+    } else {
+        return b ^ ((a ^ b) & (U(0) - U(cond)));
+    }
+}
+
+// Refills nothing, so a run leaves the merge once its values are used up.
+template <typename T>
+struct NoRefill {
+    bool operator()(MergeSource<T>&, std::size_t) const noexcept {
+        return false;
+    }
+};
+
+// A tournament tree over `k` non-empty runs whose inner nodes keep the loser
+// of their match, so replacing the winner replays only its path to the root
+// with one comparison per level. Leaves are the implicit positions `[k, 2k)`
+// and node `p` has the children `2p` and `2p + 1`, which makes any `k` a
+// complete tree. Ties go to the lower run, which keeps the merge stable.
+//
+// Matches select rather than branch, since their outcomes are random. When
+// a run is used up, `refill(source, i)` may point it at the next values of
+// the `i`-th initial run, which streams runs that do not fit in memory.
+// Otherwise the run leaves the tree, which is rebuilt over the others, so
+// that no match has to check for it.
+template <typename T, typename Compare, typename Refill = NoRefill<T>>
+class LoserTree {
+public:
+    LoserTree(Vector<MergeSource<T>>& sources, Compare& comp,
+              Refill refill = Refill())
+        : sources_(sources), comp_(comp), refill_(std::move(refill)) {
+        ids_.reserve(sources.size());
+        for (std::size_t i = 0; i < sources.size(); ++i) {
+            ids_.push_back(i);
+        }
+        build();
+    }
+
+    // Returns the run holding the smallest remaining value.
+    MergeSource<T>& winner() noexcept {
+        return sources_[tree_[0]];
+    }
+
+    // Restores the tree after the winner's run advanced, returning false once
+    // every run is exhausted.
+    bool replay() {
+        std::uint32_t w = tree_[0];
+        if (sources_[w].cur == sources_[w].end &&
+            !refill_(sources_[w], ids_[w])) {
+            sources_.erase(sources_.begin() + w);
+            ids_.erase(ids_.begin() + w);
+            if (sources_.empty()) {
+                return false;
+            }
+            build();
+            return true;
+        }
+        const T* key = sources_[w].cur;
+        for (std::uint32_t p = (k_ + w) / 2; p > 0; p /= 2) {
+            const std::uint32_t l = tree_[p];
+            const T* loser = sources_[l].cur;
+            // The lower run wins unless the other value is strictly less.
+            const bool loser_lower = l < w;
+            const T* lower = branchlessSelect(loser_lower, loser, key);
+            const T* upper = branchlessSelect(loser_lower, key, loser);
+            const bool loser_wins = comp_(*upper, *lower) != loser_lower;
+            tree_[p] = branchlessSelect(loser_wins, w, l);
+            w = branchlessSelect(loser_wins, l, w);
+            key = branchlessSelect(loser_wins, loser, key);
+        }
+        tree_[0] = w;
+        return true;
+    }
+
+private:
+    void build() {
+        k_ = std::uint32_t(sources_.size());
+        tree_.assign(k_, 0);
+        Vector<std::uint32_t> winners(2 * std::size_t(k_));
+        for (std::uint32_t i = 0; i < k_; ++i) {
+            winners[k_ + i] = i;
+        }
+        for (std::uint32_t p = k_ - 1; p > 0; --p) {
+            const std::uint32_t a = winners[2 * p];
+            const std::uint32_t b = winners[2 * p + 1];
+            const bool a_wins = beats(a, b);
+            winners[p] = a_wins ? a : b;
+            tree_[p] = a_wins ? b : a;
+        }
+        tree_[0] = winners[1];
+    }
+
+    bool beats(std::uint32_t i, std::uint32_t j) const {
+        const T& a = *sources_[i].cur;
+        const T& b = *sources_[j].cur;
+        return i < j ? !comp_(b, a) : comp_(a, b);
+    }
+
+private:
+    Vector<MergeSource<T>>& sources_;
+    Compare& comp_;
+    [[no_unique_address]] Refill refill_;
+    Vector<std::size_t> ids_;
+    Vector<std::uint32_t> tree_;
+    std::uint32_t k_ = 0;
+};
+
+// Merges the runs of `sources` into `out`, which has room for all of them.
+// Empty runs are dropped first so that the common cases of one or two runs
+// avoid the tree.
+template <typename T, typename Compare>
+void mergeRuns(Vector<MergeSource<T>> sources, T* out, Compare& comp) {
+    sources.erase(std::remove_if(sources.begin(), sources.end(),
+                                 [](const MergeSource<T>& s) {
+                                     return s.cur == s.end;
+                                 }),
+                  sources.end());
+    if (sources.empty()) {
+        return;
+    }
+    if (sources.size() == 1) {
+        std::copy(sources[0].cur, sources[0].end, out);
+        return;
+    }
+    if (sources.size() == 2) {
+        mergeTwo(sources[0].cur, sources[0].end, sources[1].cur,
+                 sources[1].end, out, comp);
+        return;
+    }
+
+    LoserTree<T, Compare> tree(sources, comp);
+    do {
+        *out++ = *tree.winner().cur++;
+    } while (tree.replay());
+}
+
+// Finds for every run the position where a stable merge of all runs has
+// emitted exactly `rank` values, the k-way generalization of a merge path
+// split.
+//
+// Each round bisects the largest remaining window at its middle value `v`
+// and counts the values below and up to `v` in every window. If `rank`
+// falls among the copies of `v`, they are handed out in run order, as the
+// merge would emit them.
+template <typename T, typename Compare>
+Vector<std::size_t> splitRuns(const Vector<MergeSource<T>>& runs,
+                              std::size_t rank, Compare& comp) {
+    const std::size_t k = runs.size();
+    Vector<std::size_t> lo(k, 0);
+    Vector<std::size_t> hi(k, 0);
+    Vector<std::size_t> lower(k, 0);
+    Vector<std::size_t> upper(k, 0);
+    for (std::size_t i = 0; i < k; ++i) {
+        hi[i] = std::size_t(runs[i].end - runs[i].cur);
+    }
+    for (;;) {
+        std::size_t widest = 0;
+        for (std::size_t i = 1; i < k; ++i) {
+            if (hi[i] - lo[i] > hi[widest] - lo[widest]) {
+                widest = i;
+            }
+        }
+        if (hi[widest] == lo[widest]) {
+            return lo;
+        }
+
+        const std::size_t mid = lo[widest] + (hi[widest] - lo[widest]) / 2;
+        const T& v = runs[widest].cur[mid];
+        std::size_t below = 0;
+        std::size_t through = 0;
+        for (std::size_t i = 0; i < k; ++i) {
+            const T* base = runs[i].cur;
+            lower[i] = std::size_t(
+                std::lower_bound(base + lo[i], base + hi[i], v, comp) - base);
+            upper[i] = std::size_t(
+                std::upper_bound(base + lower[i], base + hi[i], v, comp) -
+                base);
+            below += lower[i];
+            through += upper[i];
+        }
+        // The windows hold everything not yet known to be left or right of
+        // the split, so the counts outside them are already exact.
+        if (rank < below) {
+            hi = lower;
+        } else if (rank > through) {
+            lo = upper;
+        } else {
+            std::size_t left = rank - below;
+            for (std::size_t i = 0; i < k; ++i) {
+                const std::size_t take = std::min(left, upper[i] - lower[i]);
+                lower[i] += take;
+                left -= take;
+            }
+            return lower;
+        }
+    }
+}
+
+template <typename T, typename Alloc>
+Vector<MergeSource<T>> mergeSources(const Vector<T, Alloc>* runs,
+                                    std::size_t count,
+                                    const Vector<T, Alloc>& out) {
+    Vector<MergeSource<T>> sources;
+    sources.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        if (&runs[i] == &out) {
+            throw std::invalid_argument("kway_merge: output aliases a run");
+        }
+        sources.push_back({runs[i].data(), runs[i].data() + runs[i].size()});
+    }
+    return sources;
+}
+} // namespace detail
+
+/// Merges the `count` sorted `runs` into `out`, replacing its contents.
+///
+/// The merge is stable: equal values keep their order within a run and come
+/// from earlier runs first. Values are drawn from a loser tree, which costs
+/// one comparison per level of its `log2(count)` levels per value, half of
+/// what a binary heap of cursors needs. Two runs are merged without the tree
+/// by a branch-free loop.
+///
+/// Throws `std::invalid_argument` if `out` is one of the runs.
+///
+/// # Example
+///
+/// ```cpp
+/// Vector<Vector<int>> runs = {{1, 4, 7}, {2, 5}, {3, 6, 8}};
+/// Vector<int> out;
+/// kway_merge(runs, out);
+/// assert((out == Vector<int>{1, 2, 3, 4, 5, 6, 7, 8}));
+/// ```
+template <typename T, typename Alloc, typename Compare = std::less<T>>
+void kway_merge(const Vector<T, Alloc>* runs, std::size_t count,
+                Vector<T, Alloc>& out, Compare comp = Compare()) {
+    Vector<detail::MergeSource<T>> sources =
+        detail::mergeSources(runs, count, out);
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        total += runs[i].size();
+    }
+    out.clear();
+    out.resize(total);
+    detail::mergeRuns(std::move(sources), out.data(), comp);
+}
+
+/// Same as `kway_merge(runs.data(), runs.size(), out, comp)`.
+template <typename T, typename Alloc, typename OuterAlloc,
+          typename Compare = std::less<T>>
+void kway_merge(const Vector<Vector<T, Alloc>, OuterAlloc>& runs,
+                Vector<T, Alloc>& out, Compare comp = Compare()) {
+    algo::kway_merge(runs.data(), runs.size(), out, comp);
+}
+
+/// Merges the `count` sorted `runs` into `out` on all workers of `pool`,
+/// with the same result as `kway_merge()`.
+///
+/// The output is cut into one slice per worker and the runs are split where
+/// a merge would start each slice, so every worker merges its own part of
+/// all runs into its own slice with no coordination.
+template <typename T, typename Alloc, typename Compare = std::less<T>>
+void kway_merge_parallel(const Vector<T, Alloc>* runs, std::size_t count,
+                         Vector<T, Alloc>& out, ThreadPool& pool,
+                         Compare comp = Compare()) {
+    const Vector<detail::MergeSource<T>> sources =
+        detail::mergeSources(runs, count, out);
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        total += runs[i].size();
+    }
+    out.clear();
+    if (total == 0) {
+        // Also covers no runs at all, which `splitRuns()` cannot take.
+        return;
+    }
+    out.resize(total);
+
+    const std::size_t grain = 1 << 16;
+    const std::size_t parts =
+        std::clamp<std::size_t>(total / grain, 1, pool.size());
+    pool.parallel_for(0, parts, [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t p = lo; p < hi; ++p) {
+            const std::size_t first = total * p / parts;
+            const Vector<std::size_t> from =
+                detail::splitRuns(sources, first, comp);
+            const Vector<std::size_t> to =
+                detail::splitRuns(sources, total * (p + 1) / parts, comp);
+            Vector<detail::MergeSource<T>> slice(sources);
+            for (std::size_t i = 0; i < count; ++i) {
+                slice[i].end = slice[i].cur + to[i];
+                slice[i].cur += from[i];
+            }
+            detail::mergeRuns(std::move(slice), out.data() + first, comp);
+        }
+    });
+}
+
+/// Same as `kway_merge_parallel(runs.data(), runs.size(), out, pool, comp)`.
+template <typename T, typename Alloc, typename OuterAlloc,
+          typename Compare = std::less<T>>
+void kway_merge_parallel(const Vector<Vector<T, Alloc>, OuterAlloc>& runs,
+                         Vector<T, Alloc>& out, ThreadPool& pool,
+                         Compare comp = Compare()) {
+    algo::kway_merge_parallel(runs.data(), runs.size(), out, pool, comp);
+}
+} // namespace algo
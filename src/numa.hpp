@@ -0,0 +1,252 @@
+#pragma once
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include "thread_pool.hpp"
+
+namespace algo {
+namespace detail {
+// The memory policy modes and flags of <linux/mempolicy.h>.
+constexpr int mpol_bind = 2;
+constexpr int mpol_interleave = 3;
+constexpr unsigned long mpol_f_node = 1;
+constexpr unsigned long mpol_f_addr = 2;
+constexpr unsigned long mpol_f_mems_allowed = 4;
+// One bit more than the mask holds, as the system calls count it.
+constexpr unsigned long numa_max_node = 65;
+
+inline std::size_t pageSize() noexcept {
+    static const std::size_t size = std::size_t(::sysconf(_SC_PAGESIZE));
+    return size;
+}
+} // namespace detail
+
+/// Returns the mask of the NUMA nodes the process may allocate on, bit `i`
+/// standing for node `i`. Kernels built without NUMA support report node 0.
+inline std::uint64_t numa_nodes() noexcept {
+    unsigned long mask = 0;
+    if (::syscall(__NR_get_mempolicy, nullptr, &mask, detail::numa_max_node,
+                  nullptr, detail::mpol_f_mems_allowed) != 0 ||
+        mask == 0) {
+        return 1;
+    }
+    return std::uint64_t(mask);
+}
+
+/// Returns the number of NUMA nodes the process may allocate on.
+inline std::size_t numa_node_count() noexcept {
+    return std::size_t(__builtin_popcountll(numa_nodes()));
+}
+
+/// Returns the node holding the page of `p`, faulting it in if it has not
+/// been touched yet, or -1 if the kernel cannot tell.
+inline int numa_node_of(const void* p) noexcept {
+    int node = -1;
+    if (::syscall(__NR_get_mempolicy, &node, nullptr, 0UL, p,
+                  detail::mpol_f_node | detail::mpol_f_addr) != 0) {
+        return -1;
+    }
+    return node;
+}
+
+/// Where `NumaAllocator` places the pages of its allocations.
+///
+/// Only the first 64 nodes can be named.
+struct NumaPolicy {
+    enum class Placement : std::uint8_t {
+        /// On the node of the thread that first touches each page.
+        local,
+        /// Round robin over `nodes`, page by page.
+        interleave,
+        /// On `nodes` only, the lowest one first.
+        bind,
+    };
+
+    Placement placement = Placement::local;
+    /// The node mask of `interleave` and `bind`. Zero means every node the
+    /// process may allocate on.
+    std::uint64_t nodes = 0;
+    /// If set, the pages of every allocation are touched on the workers of
+    /// this pool before the allocation is returned.
+    ThreadPool* touch_pool = nullptr;
+
+    /// Places each page on the node of the thread that first touches it.
+    static NumaPolicy local() noexcept {
+        return NumaPolicy();
+    }
+
+    /// Spreads the pages round robin over `nodes`, or over every node, to
+    /// balance the bandwidth of data shared by all threads.
+    static NumaPolicy interleave(std::uint64_t nodes = 0) noexcept {
+        return {Placement::interleave, nodes, nullptr};
+    }
+
+    /// Places every page on `node`. Throws `std::invalid_argument` if `node`
+    /// is 64 or more.
+    static NumaPolicy bind(unsigned node) {
+        if (node >= 64) {
+            throw std::invalid_argument("NumaPolicy: node out of range");
+        }
+        return {Placement::bind, std::uint64_t(1) << node, nullptr};
+    }
+
+    /// Places each page on the node of the worker of `pool` that touches it
+    /// first, the pages being split over the workers in the contiguous
+    /// chunks of `ThreadPool::parallel_for_static()`. A later
+    /// `parallel_for_static()` over the elements with the same pool then
+    /// finds most of each worker's chunk on its node, as long as the
+    /// scheduler keeps the workers on their nodes.
+    static NumaPolicy first_touch(ThreadPool& pool) noexcept {
+        return {Placement::local, 0, &pool};
+    }
+};
+
+/// An allocator placing its storage on NUMA nodes after a `NumaPolicy`, for
+/// large arrays scanned by many threads.
+///
+/// Every allocation is mapped with `mmap()`, rounded up to whole pages, and
+/// given its policy with the `mbind()` system call; no library is needed.
+/// The kernel only places a page when it is first written to, which `local`
+/// placement relies on: with `NumaPolicy::first_touch()`, the pages are
+/// touched in parallel before `Vector` initializes the elements, so the
+/// elements a worker will process with `parallel_for_static()` live on its
+/// node. Small allocations still
+/// take a whole page, so the allocator suits big arrays, not small ones.
+///
+/// Allocators compare equal whatever their policy, since any of them can
+/// release the storage of another.
+///
+/// # Example
+///
+/// ```cpp
+/// ThreadPool pool;
+/// Vector<double, NumaAllocator<double>> v(
+///     1 << 26, 0.0, NumaAllocator<double>(NumaPolicy::first_touch(pool)));
+/// pool.parallel_for_static(0, v.size(), [&](std::size_t first,
+///                                           std::size_t last) {
+///     for (std::size_t i = first; i < last; ++i) {
+///         v[i] += 1; // mostly on the node of this worker
+///     }
+/// });
+///
+/// Vector<int, NumaAllocator<int>> shared(
+///     1 << 20, NumaAllocator<int>(NumaPolicy::interleave()));
+/// ```
+template <typename T>
+class NumaAllocator {
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    template <typename U>
+    struct rebind {
+        using other = NumaAllocator<U>;
+    };
+
+public:
+    NumaAllocator() noexcept = default;
+
+    explicit NumaAllocator(const NumaPolicy& policy) noexcept
+        : policy_(policy) {}
+
+    template <typename U>
+    NumaAllocator(const NumaAllocator<U>& other) noexcept
+        : policy_(other.policy()) {}
+
+    /// Returns the placement of the allocations.
+    [[nodiscard]] const NumaPolicy& policy() const noexcept {
+        return policy_;
+    }
+
+    /// Maps `n` elements and applies the policy to them. Throws
+    /// `std::bad_alloc` if the mapping fails and `std::system_error` if the
+    /// kernel rejects the policy, e.g. for nodes the process may not use.
+    T* allocate(std::size_t n) {
+        if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        const std::size_t bytes = mappedBytes(n);
+        void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        const int error = applyPolicy(p, bytes);
+        if (error != 0) {
+            ::munmap(p, bytes);
+            throw std::system_error(error, std::generic_category(), "mbind");
+        }
+        if (policy_.touch_pool != nullptr) {
+            touch(static_cast<char*>(p), bytes, *policy_.touch_pool);
+        }
+        return static_cast<T*>(p);
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        ::munmap(p, mappedBytes(n));
+    }
+
+    template <typename U>
+    bool operator==(const NumaAllocator<U>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const NumaAllocator<U>&) const noexcept {
+        return false;
+    }
+
+private:
+    static std::size_t mappedBytes(std::size_t n) noexcept {
+        const std::size_t page = detail::pageSize();
+        return (std::max<std::size_t>(n * sizeof(T), 1) + page - 1) / page *
+               page;
+    }
+
+    // Returns 0 or the `errno` of `mbind()`. Local placement is what the
+    // kernel does anyway, so it needs no call, which containers without
+    // `CAP_SYS_NICE` would refuse. Kernels without NUMA support have a
+    // single node, so there is nothing to place.
+    int applyPolicy(void* p, std::size_t bytes) const noexcept {
+        if (policy_.placement == NumaPolicy::Placement::local) {
+            return 0;
+        }
+        const int mode = policy_.placement == NumaPolicy::Placement::bind
+                             ? detail::mpol_bind
+                             : detail::mpol_interleave;
+        unsigned long mask = policy_.nodes != 0 ? policy_.nodes : numa_nodes();
+        if (::syscall(__NR_mbind, p, bytes, mode, &mask, detail::numa_max_node,
+                      0U) != 0 &&
+            errno != ENOSYS) {
+            return errno;
+        }
+        return 0;
+    }
+
+    // Writes the first byte of every page on the workers of `pool`, which
+    // faults the pages in where the policy says. Fresh mappings read as
+    // zero, so the write changes nothing.
+    static void touch(char* p, std::size_t bytes, ThreadPool& pool) {
+        const std::size_t page = detail::pageSize();
+        auto f = [p, page](std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; ++i) {
+                *static_cast<volatile char*>(p + i * page) = 0;
+            }
+        };
+        pool.parallel_for_static(0, bytes / page, f);
+    }
+
+private:
+    NumaPolicy policy_;
+};
+} // namespace algo
@@ -0,0 +1,899 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include "vector.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace algo {
+/// An ordered map from byte strings to `V`, implemented as an adaptive radix
+/// tree (ART).
+///
+/// Inner nodes come in four sizes, holding up to 4, 16, 48 and 256 children,
+/// and are grown as children are added, so sparse nodes stay small while dense
+/// nodes index their children directly. Chains of single-child nodes are
+/// collapsed into a prefix stored in the node (path compression), and a
+/// subtree holding one key is replaced by its leaf (lazy expansion). `Node16`
+/// searches its keys with SSE2 when available.
+///
+/// Nodes and leaves live in one `Vector` pool per node type and refer to each
+/// other by 32-bit indices, all key bytes live in a single byte `Vector`, and
+/// no node is allocated individually. Keys are ordered bytewise, with a key
+/// sorting before its extensions.
+///
+/// # Note
+///
+/// Pointers returned by `find()` are invalidated by `insert()`. Nodes are not
+/// shrunk and key bytes are not reclaimed by `erase()`; `clear()` releases
+/// everything.
+///
+/// # Example
+///
+/// ```cpp
+/// RadixTrie<int> routes;
+/// routes.insert("/api", 1);
+/// routes.insert("/api/users", 2);
+///
+/// assert(*routes.find("/api") == 1);
+/// assert(*routes.longest_prefix("/api/users/42") == 2);
+///
+/// routes.for_each_prefix("/api/", [](std::string_view key, const int& v) {
+///     // visits "/api/users"
+/// });
+/// ```
+template <typename V>
+class RadixTrie {
+    static_assert(std::is_copy_constructible_v<V>,
+                  "V must be copy constructible");
+
+public:
+    using KeyType = std::string_view;
+    using MappedType = V;
+    using SizeType = std::size_t;
+
+    /// Returns true if the trie is empty.
+    [[nodiscard]] bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    /// Returns the number of keys.
+    [[nodiscard]] SizeType size() const noexcept {
+        return size_;
+    }
+
+    /// Removes all keys and releases the pools.
+    void clear() noexcept {
+        Vector<Leaf>().swap(leaves_);
+        Vector<Node4>().swap(nodes4_);
+        Vector<Node16>().swap(nodes16_);
+        Vector<Node48>().swap(nodes48_);
+        Vector<Node256>().swap(nodes256_);
+        Vector<char>().swap(bytes_);
+        for (auto& list : free_) {
+            Vector<std::uint32_t>().swap(list);
+        }
+        root_ = empty_handle;
+        size_ = 0;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Modifiers
+    ////////////////////////////////////////////////////////////////////////////
+
+    /// Inserts `key` with `value` if `key` is absent. Returns true if the key
+    /// was inserted.
+    bool insert(std::string_view key, const V& value) {
+        return insertAux(key, value, false);
+    }
+
+    /// Inserts `key` with `value`, or assigns `value` if `key` is present.
+    /// Returns true if the key was inserted.
+    bool insert_or_assign(std::string_view key, const V& value) {
+        return insertAux(key, value, true);
+    }
+
+    /// Removes `key`. Returns true if it was present.
+    bool erase(std::string_view key) {
+        bool erased = false;
+        root_ = eraseAux(root_, key, 0, erased);
+        size_ -= erased;
+        return erased;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Lookup
+    ////////////////////////////////////////////////////////////////////////////
+
+    /// Returns a pointer to the value of `key`, or `nullptr` if absent.
+    const V* find(std::string_view key) const noexcept {
+        Handle node = root_;
+        SizeType depth = 0;
+        while (node != empty_handle) {
+            if (kind(node) == leaf_kind) {
+                const Leaf& leaf = leaves_[index(node)];
+                return leafKey(leaf) == key ? &leaf.value : nullptr;
+            }
+
+            const Header& h = header(node);
+            if (!matchPrefix(h, key, depth)) {
+                return nullptr;
+            }
+            depth += h.prefix_len;
+            if (depth == key.size()) {
+                node = h.terminal;
+                continue;
+            }
+            node = findChild(node, std::uint8_t(key[depth++]));
+        }
+        return nullptr;
+    }
+
+    /// Returns a pointer to the value of `key`, or `nullptr` if absent.
+    V* find(std::string_view key) noexcept {
+        return const_cast<V*>(std::as_const(*this).find(key));
+    }
+
+    /// Returns true if `key` is present.
+    bool contains(std::string_view key) const noexcept {
+        return find(key) != nullptr;
+    }
+
+    /// Returns the value of the longest key which is a prefix of `key`, or
+    /// `nullptr` if there is none.
+    const V* longest_prefix(std::string_view key) const noexcept {
+        const V* best = nullptr;
+        Handle node = root_;
+        SizeType depth = 0;
+        while (node != empty_handle) {
+            if (kind(node) == leaf_kind) {
+                const Leaf& leaf = leaves_[index(node)];
+                if (key.substr(0, leaf.key_len) == leafKey(leaf)) {
+                    best = &leaf.value;
+                }
+                break;
+            }
+
+            const Header& h = header(node);
+            if (!matchPrefix(h, key, depth)) {
+                break;
+            }
+            depth += h.prefix_len;
+            if (h.terminal != empty_handle) {
+                best = &leaves_[index(h.terminal)].value;
+            }
+            if (depth == key.size()) {
+                break;
+            }
+            node = findChild(node, std::uint8_t(key[depth++]));
+        }
+        return best;
+    }
+
+    /// Returns the value of the longest key which is a prefix of `key`, or
+    /// `nullptr` if there is none.
+    V* longest_prefix(std::string_view key) noexcept {
+        return const_cast<V*>(std::as_const(*this).longest_prefix(key));
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Ordered traversal
+    ////////////////////////////////////////////////////////////////////////////
+
+    /// Calls `f(key, value)` for every key in ascending order.
+    template <typename F>
+    void for_each(F&& f) const {
+        walk(root_, f);
+    }
+
+    /// Calls `f(key, value)` for every key starting with `prefix`, in
+    /// ascending order.
+    template <typename F>
+    void for_each_prefix(std::string_view prefix, F&& f) const {
+        Handle node = root_;
+        SizeType depth = 0;
+        while (node != empty_handle && depth < prefix.size()) {
+            if (kind(node) == leaf_kind) {
+                const Leaf& leaf = leaves_[index(node)];
+                if (leafKey(leaf).substr(0, prefix.size()) == prefix) {
+                    f(leafKey(leaf), static_cast<const V&>(leaf.value));
+                }
+                return;
+            }
+
+            // Every key below `node` shares its prefix, so the scan is done
+            // once `prefix` ends inside it.
+            const Header& h = header(node);
+            const SizeType rest = std::min<SizeType>(h.prefix_len,
+                                                     prefix.size() - depth);
+            if (prefix.substr(depth, rest) !=
+                std::string_view(bytes_.data() + h.prefix_off, rest)) {
+                return;
+            }
+            depth += h.prefix_len;
+            if (depth >= prefix.size()) {
+                break;
+            }
+            node = findChild(node, std::uint8_t(prefix[depth++]));
+        }
+        walk(node, f);
+    }
+
+private:
+    // A handle stores the node kind in its top 3 bits and the index into the
+    // pool of that kind in the others.
+    using Handle = std::uint32_t;
+
+    static constexpr Handle empty_handle = std::numeric_limits<Handle>::max();
+    static constexpr std::uint32_t kind_shift = 29;
+    static constexpr std::uint32_t leaf_kind = 0;
+    static constexpr std::uint32_t node4_kind = 1;
+    static constexpr std::uint32_t node16_kind = 2;
+    static constexpr std::uint32_t node48_kind = 3;
+    static constexpr std::uint32_t node256_kind = 4;
+
+    struct Leaf {
+        std::uint32_t key_off;
+        std::uint32_t key_len;
+        V value;
+    };
+
+    // The prefix bytes live in `bytes_`, inside the key of some leaf below
+    // the node. `terminal` is the leaf of the key ending right after the
+    // prefix, if any.
+    struct Header {
+        std::uint32_t prefix_off;
+        std::uint32_t prefix_len;
+        Handle terminal;
+        std::uint32_t count;
+    };
+
+    struct Node4 {
+        Header h;
+        std::uint8_t keys[4];
+        Handle children[4];
+    };
+
+    struct Node16 {
+        Header h;
+        alignas(16) std::uint8_t keys[16];
+        Handle children[16];
+    };
+
+    // `index[b]` is one plus the slot of the child for byte `b`, or zero.
+    struct Node48 {
+        Header h;
+        std::uint8_t index[256];
+        Handle children[48];
+    };
+
+    struct Node256 {
+        Header h;
+        Handle children[256];
+    };
+
+    static constexpr std::uint32_t kind(Handle h) noexcept {
+        return h >> kind_shift;
+    }
+
+    static constexpr std::uint32_t index(Handle h) noexcept {
+        return h & ((std::uint32_t(1) << kind_shift) - 1);
+    }
+
+    static constexpr Handle makeHandle(std::uint32_t k,
+                                       std::uint32_t i) noexcept {
+        return (k << kind_shift) | i;
+    }
+
+    std::string_view leafKey(const Leaf& leaf) const noexcept {
+        return std::string_view(bytes_.data() + leaf.key_off, leaf.key_len);
+    }
+
+    Header& header(Handle node) noexcept {
+        return const_cast<Header&>(std::as_const(*this).header(node));
+    }
+
+    const Header& header(Handle node) const noexcept {
+        switch (kind(node)) {
+        case node4_kind:
+            return nodes4_[index(node)].h;
+        case node16_kind:
+            return nodes16_[index(node)].h;
+        case node48_kind:
+            return nodes48_[index(node)].h;
+        default:
+            return nodes256_[index(node)].h;
+        }
+    }
+
+    // Returns true if the prefix of `h` matches `key` from `depth`.
+    bool matchPrefix(const Header& h, std::string_view key,
+                     SizeType depth) const noexcept {
+        return key.size() - depth >= h.prefix_len &&
+               key.substr(depth, h.prefix_len) ==
+                   std::string_view(bytes_.data() + h.prefix_off,
+                                    h.prefix_len);
+    }
+
+    // Returns the length of the common prefix of the node prefix and `key`
+    // from `depth`.
+    SizeType prefixMismatch(const Header& h, std::string_view key,
+                            SizeType depth) const noexcept {
+        const SizeType n = std::min<SizeType>(h.prefix_len, key.size() - depth);
+        const char* p = bytes_.data() + h.prefix_off;
+        SizeType i = 0;
+        while (i < n && p[i] == key[depth + i]) {
+            ++i;
+        }
+        return i;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Node16 search
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Returns the slot of `byte` in `node`, or `count` if it is absent.
+    static std::uint32_t findKey16(const Node16& node,
+                                   std::uint8_t byte) noexcept {
+#if defined(__SSE2__)
+        const __m128i keys = _mm_load_si128(
+            reinterpret_cast<const __m128i*>(node.keys));
+        const __m128i cmp = _mm_cmpeq_epi8(keys, _mm_set1_epi8(char(byte)));
+        const unsigned mask = unsigned(_mm_movemask_epi8(cmp)) &
+                              ((1u << node.h.count) - 1);
+        return mask ? unsigned(__builtin_ctz(mask)) : node.h.count;
+#else
+        for (std::uint32_t i = 0; i < node.h.count; ++i) {
+            if (node.keys[i] == byte) {
+                return i;
+            }
+        }
+        return node.h.count;
+#endif
+    }
+
+    // Returns the number of keys of `node` less than `byte`.
+    static std::uint32_t lowerBound16(const Node16& node,
+                                      std::uint8_t byte) noexcept {
+#if defined(__SSE2__)
+        // SSE2 only compares signed bytes, so flip the sign bits first.
+        const __m128i bias = _mm_set1_epi8(char(0x80));
+        const __m128i keys = _mm_xor_si128(
+            _mm_load_si128(reinterpret_cast<const __m128i*>(node.keys)), bias);
+        const __m128i cmp =
+            _mm_cmplt_epi8(keys, _mm_set1_epi8(char(byte ^ 0x80)));
+        const unsigned mask = unsigned(_mm_movemask_epi8(cmp)) &
+                              ((1u << node.h.count) - 1);
+        return unsigned(__builtin_popcount(mask));
+#else
+        std::uint32_t i = 0;
+        while (i < node.h.count && node.keys[i] < byte) {
+            ++i;
+        }
+        return i;
+#endif
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Children
+    ////////////////////////////////////////////////////////////////////////////
+
+    Handle findChild(Handle node, std::uint8_t byte) const noexcept {
+        switch (kind(node)) {
+        case node4_kind: {
+            const Node4& n = nodes4_[index(node)];
+            for (std::uint32_t i = 0; i < n.h.count; ++i) {
+                if (n.keys[i] == byte) {
+                    return n.children[i];
+                }
+            }
+            return empty_handle;
+        }
+        case node16_kind: {
+            const Node16& n = nodes16_[index(node)];
+            const std::uint32_t i = findKey16(n, byte);
+            return i < n.h.count ? n.children[i] : empty_handle;
+        }
+        case node48_kind: {
+            const Node48& n = nodes48_[index(node)];
+            return n.index[byte] ? n.children[n.index[byte] - 1]
+                                 : empty_handle;
+        }
+        default:
+            return nodes256_[index(node)].children[byte];
+        }
+    }
+
+    void replaceChild(Handle node, std::uint8_t byte, Handle child) noexcept {
+        switch (kind(node)) {
+        case node4_kind: {
+            Node4& n = nodes4_[index(node)];
+            n.children[std::find(n.keys, n.keys + n.h.count, byte) - n.keys] =
+                child;
+            break;
+        }
+        case node16_kind: {
+            Node16& n = nodes16_[index(node)];
+            n.children[findKey16(n, byte)] = child;
+            break;
+        }
+        case node48_kind: {
+            Node48& n = nodes48_[index(node)];
+            n.children[n.index[byte] - 1] = child;
+            break;
+        }
+        default:
+            nodes256_[index(node)].children[byte] = child;
+        }
+    }
+
+    // Adds `child` under `byte`, growing the node if it is full. Returns the
+    // handle of the node, which changes when the node grows.
+    Handle addChild(Handle node, std::uint8_t byte, Handle child) {
+        switch (kind(node)) {
+        case node4_kind: {
+            if (nodes4_[index(node)].h.count == 4) {
+                node = grow4(node);
+                return addChild(node, byte, child);
+            }
+            Node4& n = nodes4_[index(node)];
+            std::uint32_t i = 0;
+            while (i < n.h.count && n.keys[i] < byte) {
+                ++i;
+            }
+            std::copy_backward(n.keys + i, n.keys + n.h.count,
+                               n.keys + n.h.count + 1);
+            std::copy_backward(n.children + i, n.children + n.h.count,
+                               n.children + n.h.count + 1);
+            n.keys[i] = byte;
+            n.children[i] = child;
+            ++n.h.count;
+            return node;
+        }
+        case node16_kind: {
+            if (nodes16_[index(node)].h.count == 16) {
+                node = grow16(node);
+                return addChild(node, byte, child);
+            }
+            Node16& n = nodes16_[index(node)];
+            const std::uint32_t i = lowerBound16(n, byte);
+            std::copy_backward(n.keys + i, n.keys + n.h.count,
+                               n.keys + n.h.count + 1);
+            std::copy_backward(n.children + i, n.children + n.h.count,
+                               n.children + n.h.count + 1);
+            n.keys[i] = byte;
+            n.children[i] = child;
+            ++n.h.count;
+            return node;
+        }
+        case node48_kind: {
+            if (nodes48_[index(node)].h.count == 48) {
+                node = grow48(node);
+                return addChild(node, byte, child);
+            }
+            Node48& n = nodes48_[index(node)];
+            std::uint32_t slot = 0;
+            while (n.children[slot] != empty_handle) {
+                ++slot;
+            }
+            n.children[slot] = child;
+            n.index[byte] = std::uint8_t(slot + 1);
+            ++n.h.count;
+            return node;
+        }
+        default: {
+            Node256& n = nodes256_[index(node)];
+            n.children[byte] = child;
+            ++n.h.count;
+            return node;
+        }
+        }
+    }
+
+    void removeChild(Handle node, std::uint8_t byte) noexcept {
+        switch (kind(node)) {
+        case node4_kind: {
+            Node4& n = nodes4_[index(node)];
+            const std::uint32_t i =
+                std::uint32_t(std::find(n.keys, n.keys + n.h.count, byte) -
+                              n.keys);
+            std::copy(n.keys + i + 1, n.keys + n.h.count, n.keys + i);
+            std::copy(n.children + i + 1, n.children + n.h.count,
+                      n.children + i);
+            --n.h.count;
+            break;
+        }
+        case node16_kind: {
+            Node16& n = nodes16_[index(node)];
+            const std::uint32_t i = findKey16(n, byte);
+            std::copy(n.keys + i + 1, n.keys + n.h.count, n.keys + i);
+            std::copy(n.children + i + 1, n.children + n.h.count,
+                      n.children + i);
+            --n.h.count;
+            break;
+        }
+        case node48_kind: {
+            Node48& n = nodes48_[index(node)];
+            n.children[n.index[byte] - 1] = empty_handle;
+            n.index[byte] = 0;
+            --n.h.count;
+            break;
+        }
+        default: {
+            Node256& n = nodes256_[index(node)];
+            n.children[byte] = empty_handle;
+            --n.h.count;
+        }
+        }
+    }
+
+    // Returns the only child of `node`.
+    Handle onlyChild(Handle node) const noexcept {
+        switch (kind(node)) {
+        case node4_kind:
+            return nodes4_[index(node)].children[0];
+        case node16_kind:
+            return nodes16_[index(node)].children[0];
+        case node48_kind: {
+            const Node48& n = nodes48_[index(node)];
+            return *std::find_if(n.children, n.children + 48,
+                                 [](Handle c) { return c != empty_handle; });
+        }
+        default: {
+            const Node256& n = nodes256_[index(node)];
+            return *std::find_if(n.children, n.children + 256,
+                                 [](Handle c) { return c != empty_handle; });
+        }
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Pools
+    ////////////////////////////////////////////////////////////////////////////
+
+    template <typename T>
+    std::uint32_t allocate(Vector<T>& pool, std::uint32_t k, const T& init) {
+        Vector<std::uint32_t>& list = free_[k];
+        if (!list.empty()) {
+            const std::uint32_t i = list.back();
+            list.pop_back();
+            pool[i] = init;
+            return i;
+        }
+        if (pool.size() >= (std::size_t(1) << kind_shift)) {
+            throw std::length_error("RadixTrie: too many nodes");
+        }
+        pool.push_back(init);
+        return std::uint32_t(pool.size() - 1);
+    }
+
+    void release(Handle node) {
+        free_[kind(node)].push_back(index(node));
+    }
+
+    Handle newLeaf(std::string_view key, const V& value) {
+        constexpr SizeType max_bytes =
+            std::numeric_limits<std::uint32_t>::max();
+        if (bytes_.size() + key.size() > max_bytes) {
+            throw std::length_error("RadixTrie: too many key bytes");
+        }
+
+        // `key` may be a key of this trie, i.e. point into `bytes_` which
+        // is about to grow.
+        const auto off = std::uint32_t(bytes_.size());
+        const auto len = std::uint32_t(key.size());
+        const std::less<const char*> less;
+        const bool inside = !less(key.data(), bytes_.data()) &&
+                            less(key.data(), bytes_.data() + bytes_.size());
+        const SizeType src = inside ? key.data() - bytes_.data() : 0;
+        bytes_.resize(off + len);
+        const char* from = inside ? bytes_.data() + src : key.data();
+        std::copy(from, from + len, bytes_.data() + off);
+        const Leaf leaf{off, len, value};
+        return makeHandle(leaf_kind, allocate(leaves_, leaf_kind, leaf));
+    }
+
+    void freeLeaf(Handle leaf) {
+        if constexpr (std::is_default_constructible_v<V> &&
+                      std::is_copy_assignable_v<V>) {
+            leaves_[index(leaf)].value = V();
+        }
+        release(leaf);
+    }
+
+    Handle newNode4(std::uint32_t prefix_off, std::uint32_t prefix_len) {
+        Node4 n;
+        n.h = Header{prefix_off, prefix_len, empty_handle, 0};
+        std::fill(n.children, n.children + 4, empty_handle);
+        return makeHandle(node4_kind, allocate(nodes4_, node4_kind, n));
+    }
+
+    Handle grow4(Handle node) {
+        Node16 n;
+        std::fill(n.keys, n.keys + 16, 0);
+        std::fill(n.children, n.children + 16, empty_handle);
+        {
+            const Node4& old = nodes4_[index(node)];
+            n.h = old.h;
+            std::copy(old.keys, old.keys + 4, n.keys);
+            std::copy(old.children, old.children + 4, n.children);
+        }
+        release(node);
+        return makeHandle(node16_kind, allocate(nodes16_, node16_kind, n));
+    }
+
+    Handle grow16(Handle node) {
+        Node48 n;
+        std::fill(n.index, n.index + 256, 0);
+        std::fill(n.children, n.children + 48, empty_handle);
+        {
+            const Node16& old = nodes16_[index(node)];
+            n.h = old.h;
+            for (std::uint32_t i = 0; i < 16; ++i) {
+                n.index[old.keys[i]] = std::uint8_t(i + 1);
+                n.children[i] = old.children[i];
+            }
+        }
+        release(node);
+        return makeHandle(node48_kind, allocate(nodes48_, node48_kind, n));
+    }
+
+    Handle grow48(Handle node) {
+        Node256 n;
+        std::fill(n.children, n.children + 256, empty_handle);
+        {
+            const Node48& old = nodes48_[index(node)];
+            n.h = old.h;
+            for (std::uint32_t b = 0; b < 256; ++b) {
+                if (old.index[b]) {
+                    n.children[b] = old.children[old.index[b] - 1];
+                }
+            }
+        }
+        release(node);
+        return makeHandle(node256_kind, allocate(nodes256_, node256_kind, n));
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Insert and erase
+    ////////////////////////////////////////////////////////////////////////////
+
+    bool insertAux(std::string_view key, const V& value, bool assign) {
+        bool inserted = false;
+        root_ = insertAux(root_, key, 0, value, assign, inserted);
+        size_ += inserted;
+        return inserted;
+    }
+
+    // Inserts `key` into the subtree `node` whose keys agree with `key` on
+    // the first `depth` bytes. Returns the new root of the subtree.
+    Handle insertAux(Handle node, std::string_view key, SizeType depth,
+                     const V& value, bool assign, bool& inserted) {
+        if (node == empty_handle) {
+            inserted = true;
+            return newLeaf(key, value);
+        }
+
+        if (kind(node) == leaf_kind) {
+            const std::uint32_t old_off = leaves_[index(node)].key_off;
+            const std::string_view old_key = leafKey(leaves_[index(node)]);
+            if (old_key == key) {
+                if (assign) {
+                    leaves_[index(node)].value = value;
+                }
+                return node;
+            }
+
+            // Split the leaf into a node holding both keys.
+            const SizeType n = std::min(old_key.size(), key.size());
+            SizeType lcp = depth;
+            while (lcp < n && old_key[lcp] == key[lcp]) {
+                ++lcp;
+            }
+            Handle parent = newNode4(std::uint32_t(old_off + depth),
+                                     std::uint32_t(lcp - depth));
+            parent = attach(parent, old_key, lcp, node);
+            parent = attachLeaf(parent, key, lcp, value);
+            inserted = true;
+            return parent;
+        }
+
+        const Header h = header(node);
+        const SizeType p = prefixMismatch(h, key, depth);
+        if (p < h.prefix_len) {
+            // Split the prefix of `node` at the first mismatch.
+            Handle parent = newNode4(h.prefix_off, std::uint32_t(p));
+            header(node).prefix_off = h.prefix_off + std::uint32_t(p) + 1;
+            header(node).prefix_len = h.prefix_len - std::uint32_t(p) - 1;
+            parent = addChild(parent, std::uint8_t(bytes_[h.prefix_off + p]),
+                              node);
+            parent = attachLeaf(parent, key, depth + p, value);
+            inserted = true;
+            return parent;
+        }
+
+        depth += h.prefix_len;
+        if (depth == key.size()) {
+            if (h.terminal == empty_handle) {
+                const Handle leaf = newLeaf(key, value);
+                header(node).terminal = leaf;
+                inserted = true;
+            } else if (assign) {
+                leaves_[index(h.terminal)].value = value;
+            }
+            return node;
+        }
+
+        const auto byte = std::uint8_t(key[depth]);
+        const Handle child = findChild(node, byte);
+        if (child == empty_handle) {
+            const Handle leaf = newLeaf(key, value);
+            inserted = true;
+            return addChild(node, byte, leaf);
+        }
+
+        const Handle new_child =
+            insertAux(child, key, depth + 1, value, assign, inserted);
+        if (new_child != child) {
+            replaceChild(node, byte, new_child);
+        }
+        return node;
+    }
+
+    // Hangs `leaf` of `key` under `node` whose prefix ends at `depth`.
+    Handle attach(Handle node, std::string_view key, SizeType depth,
+                  Handle leaf) {
+        if (depth == key.size()) {
+            header(node).terminal = leaf;
+            return node;
+        }
+        return addChild(node, std::uint8_t(key[depth]), leaf);
+    }
+
+    // Hangs a new leaf of `key` under `node` whose prefix ends at `depth`.
+    // `key` is read before `newLeaf()`, which may move the bytes it points
+    // into.
+    Handle attachLeaf(Handle node, std::string_view key, SizeType depth,
+                      const V& value) {
+        if (depth == key.size()) {
+            const Handle leaf = newLeaf(key, value);
+            header(node).terminal = leaf;
+            return node;
+        }
+        const auto byte = std::uint8_t(key[depth]);
+        return addChild(node, byte, newLeaf(key, value));
+    }
+
+    // Removes `key` from the subtree `node`. Returns the new root of the
+    // subtree.
+    Handle eraseAux(Handle node, std::string_view key, SizeType depth,
+                    bool& erased) {
+        if (node == empty_handle) {
+            return node;
+        }
+
+        if (kind(node) == leaf_kind) {
+            if (leafKey(leaves_[index(node)]) != key) {
+                return node;
+            }
+            freeLeaf(node);
+            erased = true;
+            return empty_handle;
+        }
+
+        const Header& h = header(node);
+        if (!matchPrefix(h, key, depth)) {
+            return node;
+        }
+        depth += h.prefix_len;
+        if (depth == key.size()) {
+            if (h.terminal == empty_handle) {
+                return node;
+            }
+            freeLeaf(h.terminal);
+            header(node).terminal = empty_handle;
+            erased = true;
+        } else {
+            const auto byte = std::uint8_t(key[depth]);
+            const Handle child = findChild(node, byte);
+            if (child == empty_handle) {
+                return node;
+            }
+            const Handle new_child = eraseAux(child, key, depth + 1, erased);
+            if (new_child == child) {
+                return node;
+            } else if (new_child == empty_handle) {
+                removeChild(node, byte);
+            } else {
+                replaceChild(node, byte, new_child);
+            }
+        }
+
+        // A node left with a single leaf is replaced by that leaf.
+        const Header& after = header(node);
+        if (after.count == 0) {
+            const Handle terminal = after.terminal;
+            release(node);
+            return terminal;
+        }
+        if (after.count == 1 && after.terminal == empty_handle) {
+            const Handle child = onlyChild(node);
+            if (kind(child) == leaf_kind) {
+                release(node);
+                return child;
+            }
+        }
+        return node;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Traversal
+    ////////////////////////////////////////////////////////////////////////////
+
+    template <typename F>
+    void walk(Handle node, F& f) const {
+        if (node == empty_handle) {
+            return;
+        }
+
+        if (kind(node) == leaf_kind) {
+            const Leaf& leaf = leaves_[index(node)];
+            f(leafKey(leaf), static_cast<const V&>(leaf.value));
+            return;
+        }
+
+        walk(header(node).terminal, f);
+        switch (kind(node)) {
+        case node4_kind: {
+            const Node4& n = nodes4_[index(node)];
+            for (std::uint32_t i = 0; i < n.h.count; ++i) {
+                walk(n.children[i], f);
+            }
+            break;
+        }
+        case node16_kind: {
+            const Node16& n = nodes16_[index(node)];
+            for (std::uint32_t i = 0; i < n.h.count; ++i) {
+                walk(n.children[i], f);
+            }
+            break;
+        }
+        case node48_kind: {
+            const Node48& n = nodes48_[index(node)];
+            for (std::uint32_t b = 0; b < 256; ++b) {
+                if (n.index[b]) {
+                    walk(n.children[n.index[b] - 1], f);
+                }
+            }
+            break;
+        }
+        default: {
+            const Node256& n = nodes256_[index(node)];
+            for (std::uint32_t b = 0; b < 256; ++b) {
+                walk(n.children[b], f);
+            }
+        }
+        }
+    }
+
+private:
+    Vector<Leaf> leaves_;
+    Vector<Node4> nodes4_;
+    Vector<Node16> nodes16_;
+    Vector<Node48> nodes48_;
+    Vector<Node256> nodes256_;
+    Vector<std::uint32_t> free_[5];
+    Vector<char> bytes_;
+    Handle root_ = empty_handle;
+    SizeType size_ = 0;
+};
+} // namespace algo
@@ -0,0 +1,1171 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
+#include "bitset.hpp"
+#include "vector.hpp"
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
+namespace algo {
+namespace detail {
+// Little-endian loads and stores at any alignment.
+template <typename T>
+T loadLe(const unsigned char* p) noexcept {
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    if constexpr (sizeof(T) == 2) {
+        v = __builtin_bswap16(v);
+    } else if constexpr (sizeof(T) == 4) {
+        v = __builtin_bswap32(v);
+    } else if constexpr (sizeof(T) == 8) {
+        v = __builtin_bswap64(v);
+    }
+#endif
+    return v;
+}
+
+template <typename T>
+void storeLe(unsigned char* p, T v) noexcept {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    if constexpr (sizeof(T) == 2) {
+        v = __builtin_bswap16(v);
+    } else if constexpr (sizeof(T) == 4) {
+        v = __builtin_bswap32(v);
+    } else if constexpr (sizeof(T) == 8) {
+        v = __builtin_bswap64(v);
+    }
+#endif
+    std::memcpy(p, &v, sizeof(T));
+}
+
+#if defined(__SSE4_2__)
+// For every 8-bit mask of matching 16-bit lanes, the `pshufb` control moving
+// those lanes to the front.
+struct ShuffleMasks16 {
+    alignas(16) unsigned char masks[256][16];
+};
+
+constexpr ShuffleMasks16 makeShuffleMasks16() {
+    ShuffleMasks16 t{};
+    for (int r = 0; r < 256; ++r) {
+        int k = 0;
+        for (int lane = 0; lane < 8; ++lane) {
+            if (r >> lane & 1) {
+                t.masks[r][2 * k] = static_cast<unsigned char>(2 * lane);
+                t.masks[r][2 * k + 1] =
+                    static_cast<unsigned char>(2 * lane + 1);
+                ++k;
+            }
+        }
+        for (int i = 2 * k; i < 16; ++i) {
+            t.masks[r][i] = 0x80;
+        }
+    }
+    return t;
+}
+
+inline constexpr ShuffleMasks16 shuffle_masks16 = makeShuffleMasks16();
+#endif
+
+// Writes the intersection of the sorted sets `a` and `b` to `out`, which
+// must have room for `min(na, nb) + 8` values, and returns its size.
+inline std::size_t intersectSorted16(const std::uint16_t* a, std::size_t na,
+                                     const std::uint16_t* b, std::size_t nb,
+                                     std::uint16_t* out) noexcept {
+    if (na > nb) {
+        std::swap(a, b);
+        std::swap(na, nb);
+    }
+    std::size_t count = 0;
+
+    // Gallop through the larger set when the sizes are very different.
+    if (na * 64 < nb) {
+        const std::uint16_t* lo = b;
+        const std::uint16_t* const end = b + nb;
+        for (std::size_t i = 0; i < na && lo != end; ++i) {
+            std::size_t step = 1;
+            const std::uint16_t* hi = lo;
+            while (hi < end && *hi < a[i]) {
+                lo = hi;
+                hi = step < std::size_t(end - hi) ? hi + step : end;
+                step *= 2;
+            }
+            lo = std::lower_bound(lo, hi, a[i]);
+            if (lo != end && *lo == a[i]) {
+                out[count++] = a[i];
+            }
+        }
+        return count;
+    }
+
+    std::size_t i = 0;
+    std::size_t j = 0;
+#if defined(__SSE4_2__)
+    // Schlegel et al.: `pcmpestrm` compares 8 values of `a` with 8 values
+    // of `b` all-pairs, and the matches are compacted with `pshufb`.
+    const std::size_t ea = na / 8 * 8;
+    const std::size_t eb = nb / 8 * 8;
+    if (i < ea && j < eb) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+        for (;;) {
+            const __m128i res = _mm_cmpestrm(
+                vb, 8, va, 8,
+                _SIDD_UWORD_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_BIT_MASK);
+            const int r = _mm_cvtsi128_si32(res);
+            const __m128i shuffle = _mm_load_si128(
+                reinterpret_cast<const __m128i*>(shuffle_masks16.masks[r]));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + count),
+                             _mm_shuffle_epi8(va, shuffle));
+            count += std::size_t(__builtin_popcount(unsigned(r)));
+
+            const std::uint16_t a_max = a[i + 7];
+            const std::uint16_t b_max = b[j + 7];
+            if (a_max <= b_max) {
+                i += 8;
+                if (i == ea) {
+                    break;
+                }
+                va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+            }
+            if (b_max <= a_max) {
+                j += 8;
+                if (j == eb) {
+                    break;
+                }
+                vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+            }
+        }
+    }
+#endif
+    while (i < na && j < nb) {
+        if (a[i] < b[j]) {
+            ++i;
+        } else if (b[j] < a[i]) {
+            ++j;
+        } else {
+            out[count++] = a[i];
+            ++i;
+            ++j;
+        }
+    }
+    return count;
+}
+
+// A set of 16-bit values in one of three representations: a sorted array
+// of at most `array_max` values, a bitmap of 65536 bits, or sorted runs
+// stored as (start, length - 1) pairs.
+struct RoaringContainer {
+    enum Type : std::uint8_t { array_type, bitmap_type, run_type };
+
+    static constexpr std::uint32_t array_max = 4096;
+    static constexpr std::size_t bitmap_words = 1024;
+
+    Type type = array_type;
+    std::uint32_t card = 0;
+    Vector<std::uint16_t> values;
+    Vector<std::uint64_t> words;
+
+    bool contains(std::uint16_t v) const noexcept {
+        switch (type) {
+        case array_type:
+            return std::binary_search(values.begin(), values.end(), v);
+        case bitmap_type:
+            return words[v / 64] >> (v % 64) & 1;
+        default: {
+            const std::size_t r = runBefore(v);
+            return r != npos_run &&
+                   v <= std::uint32_t(values[2 * r]) + values[2 * r + 1];
+        }
+        }
+    }
+
+    bool add(std::uint16_t v) {
+        if (type == run_type) {
+            if (contains(v)) {
+                return false;
+            }
+            materialize();
+        }
+        if (type == bitmap_type) {
+            std::uint64_t& w = words[v / 64];
+            const std::uint64_t mask = std::uint64_t(1) << (v % 64);
+            if (w & mask) {
+                return false;
+            }
+            w |= mask;
+            ++card;
+            return true;
+        }
+
+        auto it = std::lower_bound(values.begin(), values.end(), v);
+        if (it != values.end() && *it == v) {
+            return false;
+        }
+        values.insert(it, v);
+        ++card;
+        if (card > array_max) {
+            toBitmap();
+        }
+        return true;
+    }
+
+    bool remove(std::uint16_t v) {
+        if (type == run_type) {
+            if (!contains(v)) {
+                return false;
+            }
+            materialize();
+        }
+        if (type == bitmap_type) {
+            std::uint64_t& w = words[v / 64];
+            const std::uint64_t mask = std::uint64_t(1) << (v % 64);
+            if (!(w & mask)) {
+                return false;
+            }
+            w &= ~mask;
+            if (--card <= array_max) {
+                toArray();
+            }
+            return true;
+        }
+
+        auto it = std::lower_bound(values.begin(), values.end(), v);
+        if (it == values.end() || *it != v) {
+            return false;
+        }
+        values.erase(it);
+        --card;
+        return true;
+    }
+
+    template <typename F>
+    void for_each(F& f) const {
+        switch (type) {
+        case array_type:
+            for (std::uint16_t v : values) {
+                f(v);
+            }
+            break;
+        case bitmap_type:
+            detail::forEachSetWords(words.data(), bitmap_words, f);
+            break;
+        default:
+            for (std::size_t r = 0; r < values.size(); r += 2) {
+                const std::uint32_t last =
+                    std::uint32_t(values[r]) + values[r + 1];
+                for (std::uint32_t v = values[r]; v <= last; ++v) {
+                    f(v);
+                }
+            }
+        }
+    }
+
+    // Converts to the array or bitmap representation.
+    void materialize() {
+        if (type == run_type) {
+            if (card <= array_max) {
+                toArray();
+            } else {
+                toBitmap();
+            }
+        }
+    }
+
+    void toBitmap() {
+        if (type == bitmap_type) {
+            return;
+        }
+        Vector<std::uint64_t> bits(bitmap_words, 0);
+        auto set = [&bits](std::size_t v) {
+            bits[v / 64] |= std::uint64_t(1) << (v % 64);
+        };
+        for_each(set);
+        words.swap(bits);
+        Vector<std::uint16_t>().swap(values);
+        type = bitmap_type;
+    }
+
+    void toArray() {
+        if (type == array_type) {
+            return;
+        }
+        Vector<std::uint16_t> array;
+        array.reserve(card);
+        auto push = [&array](std::size_t v) {
+            array.push_back(std::uint16_t(v));
+        };
+        for_each(push);
+        values.swap(array);
+        Vector<std::uint64_t>().swap(words);
+        type = array_type;
+    }
+
+    // Picks the representation of a bitmap by its cardinality.
+    void normalizeBitmap() {
+        card = std::uint32_t(detail::popcountWords(words.data(), bitmap_words));
+        if (card <= array_max) {
+            toArray();
+        }
+    }
+
+    std::size_t countRuns() const noexcept {
+        switch (type) {
+        case array_type: {
+            std::size_t runs = card == 0 ? 0 : 1;
+            for (std::size_t i = 1; i < values.size(); ++i) {
+                runs += values[i] != values[i - 1] + 1;
+            }
+            return runs;
+        }
+        case bitmap_type: {
+            // A run starts at every one bit whose lower neighbour is zero.
+            std::size_t runs = 0;
+            std::uint64_t carry = 0;
+            for (std::uint64_t w : words) {
+                runs += std::size_t(
+                    detail::popcount64(w & ~(w << 1 | carry)));
+                carry = w >> 63;
+            }
+            return runs;
+        }
+        default:
+            return values.size() / 2;
+        }
+    }
+
+    std::size_t payloadBytes() const noexcept {
+        return type == bitmap_type ? bitmap_words * 8 : values.size() * 2;
+    }
+
+    // Switches to runs if they are the smallest representation.
+    bool runOptimize() {
+        if (type == run_type) {
+            return false;
+        }
+        const std::size_t runs = countRuns();
+        if (runs * 4 >= payloadBytes()) {
+            return false;
+        }
+
+        Vector<std::uint16_t> pairs;
+        pairs.reserve(2 * runs);
+        std::uint32_t start = 0;
+        std::uint32_t prev = 0;
+        bool open = false;
+        auto push = [&](std::size_t v) {
+            if (open && v == prev + 1) {
+                prev = std::uint32_t(v);
+                return;
+            }
+            if (open) {
+                pairs.push_back(std::uint16_t(start));
+                pairs.push_back(std::uint16_t(prev - start));
+            }
+            start = prev = std::uint32_t(v);
+            open = true;
+        };
+        for_each(push);
+        if (open) {
+            pairs.push_back(std::uint16_t(start));
+            pairs.push_back(std::uint16_t(prev - start));
+        }
+        values.swap(pairs);
+        Vector<std::uint64_t>().swap(words);
+        type = run_type;
+        return true;
+    }
+
+    static RoaringContainer intersect(const RoaringContainer& x,
+                                      const RoaringContainer& y);
+    static RoaringContainer unite(const RoaringContainer& x,
+                                  const RoaringContainer& y);
+    static RoaringContainer difference(const RoaringContainer& x,
+                                       const RoaringContainer& y);
+    static std::size_t intersectCount(const RoaringContainer& x,
+                                      const RoaringContainer& y);
+
+private:
+    static constexpr std::size_t npos_run = ~std::size_t(0);
+
+    // Returns the last run starting at or before `v`, or `npos_run`.
+    std::size_t runBefore(std::uint16_t v) const noexcept {
+        std::size_t lo = 0;
+        std::size_t hi = values.size() / 2;
+        while (lo < hi) {
+            const std::size_t mid = (lo + hi) / 2;
+            if (values[2 * mid] <= v) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo == 0 ? npos_run : lo - 1;
+    }
+};
+
+// Binary operations work on the array and bitmap forms; run containers are
+// materialized into a temporary first.
+inline const RoaringContainer& materialized(const RoaringContainer& c,
+                                            RoaringContainer& tmp) {
+    if (c.type != RoaringContainer::run_type) {
+        return c;
+    }
+    tmp = c;
+    tmp.materialize();
+    return tmp;
+}
+
+inline RoaringContainer RoaringContainer::intersect(const RoaringContainer& x,
+                                                    const RoaringContainer& y) {
+    RoaringContainer tx, ty;
+    const RoaringContainer& a = materialized(x, tx);
+    const RoaringContainer& b = materialized(y, ty);
+
+    RoaringContainer r;
+    if (a.type == bitmap_type && b.type == bitmap_type) {
+        r.type = bitmap_type;
+        r.words = a.words;
+        detail::applyWords<detail::AndWords>(r.words.data(), b.words.data(),
+                                             bitmap_words);
+        r.normalizeBitmap();
+    } else if (a.type == array_type && b.type == array_type) {
+        r.values.resize(std::min(a.values.size(), b.values.size()) + 8);
+        const std::size_t n =
+            intersectSorted16(a.values.data(), a.values.size(),
+                              b.values.data(), b.values.size(),
+                              r.values.data());
+        r.values.resize(n);
+        r.card = std::uint32_t(n);
+    } else {
+        const RoaringContainer& array = a.type == array_type ? a : b;
+        const RoaringContainer& bitmap = a.type == array_type ? b : a;
+        for (std::uint16_t v : array.values) {
+            if (bitmap.words[v / 64] >> (v % 64) & 1) {
+                r.values.push_back(v);
+            }
+        }
+        r.card = std::uint32_t(r.values.size());
+    }
+    return r;
+}
+
+inline RoaringContainer RoaringContainer::unite(const RoaringContainer& x,
+                                                const RoaringContainer& y) {
+    RoaringContainer tx, ty;
+    const RoaringContainer& a = materialized(x, tx);
+    const RoaringContainer& b = materialized(y, ty);
+
+    RoaringContainer r;
+    if (a.type == array_type && b.type == array_type &&
+        a.card + b.card <= array_max) {
+        r.values.resize(a.values.size() + b.values.size());
+        const auto end =
+            std::set_union(a.values.begin(), a.values.end(), b.values.begin(),
+                           b.values.end(), r.values.begin());
+        r.values.resize(std::size_t(end - r.values.begin()));
+        r.card = std::uint32_t(r.values.size());
+        return r;
+    }
+
+    r.type = bitmap_type;
+    if (a.type == bitmap_type && b.type == bitmap_type) {
+        r.words = a.words;
+        detail::applyWords<detail::OrWords>(r.words.data(), b.words.data(),
+                                            bitmap_words);
+    } else {
+        const RoaringContainer& base = a.type == bitmap_type ? a : b;
+        const RoaringContainer& other = a.type == bitmap_type ? b : a;
+        if (base.type == bitmap_type) {
+            r.words = base.words;
+        } else {
+            r.words.assign(bitmap_words, 0);
+            for (std::uint16_t v : base.values) {
+                r.words[v / 64] |= std::uint64_t(1) << (v % 64);
+            }
+        }
+        for (std::uint16_t v : other.values) {
+            r.words[v / 64] |= std::uint64_t(1) << (v % 64);
+        }
+    }
+    r.normalizeBitmap();
+    return r;
+}
+
+inline RoaringContainer
+RoaringContainer::difference(const RoaringContainer& x,
+                             const RoaringContainer& y) {
+    RoaringContainer tx, ty;
+    const RoaringContainer& a = materialized(x, tx);
+    const RoaringContainer& b = materialized(y, ty);
+
+    RoaringContainer r;
+    if (a.type == array_type) {
+        for (std::uint16_t v : a.values) {
+            if (!b.contains(v)) {
+                r.values.push_back(v);
+            }
+        }
+        r.card = std::uint32_t(r.values.size());
+        return r;
+    }
+
+    r.type = bitmap_type;
+    r.words = a.words;
+    if (b.type == bitmap_type) {
+        detail::applyWords<detail::AndNotWords>(r.words.data(),
+                                                b.words.data(), bitmap_words);
+    } else {
+        for (std::uint16_t v : b.values) {
+            r.words[v / 64] &= ~(std::uint64_t(1) << (v % 64));
+        }
+    }
+    r.normalizeBitmap();
+    return r;
+}
+
+inline std::size_t RoaringContainer::intersectCount(const RoaringContainer& x,
+                                                    const RoaringContainer& y) {
+    RoaringContainer tx, ty;
+    const RoaringContainer& a = materialized(x, tx);
+    const RoaringContainer& b = materialized(y, ty);
+
+    std::size_t n = 0;
+    if (a.type == bitmap_type && b.type == bitmap_type) {
+        for (std::size_t i = 0; i < bitmap_words; ++i) {
+            n += std::size_t(detail::popcount64(a.words[i] & b.words[i]));
+        }
+    } else if (a.type == array_type && b.type == array_type) {
+        Vector<std::uint16_t> out(std::min(a.values.size(), b.values.size()) +
+                                  8);
+        n = intersectSorted16(a.values.data(), a.values.size(),
+                              b.values.data(), b.values.size(), out.data());
+    } else {
+        const RoaringContainer& array = a.type == array_type ? a : b;
+        const RoaringContainer& bitmap = a.type == array_type ? b : a;
+        for (std::uint16_t v : array.values) {
+            n += bitmap.words[v / 64] >> (v % 64) & 1;
+        }
+    }
+    return n;
+}
+} // namespace detail
+
+/// A compressed set of 32-bit integers.
+///
+/// The values are split by their high 16 bits into chunks of 65536, and each
+/// chunk picks the smallest of three containers: a sorted array of up to 4096
+/// values, a bitmap of 65536 bits, or a list of runs after `run_optimize()`.
+/// Sparse and dense parts of the same set are thus both compact, and set
+/// operations work container by container: array intersections use SSE4.2
+/// string compares (or galloping for skewed sizes), and bitmap operations and
+/// popcounts go through the vectorized `Bitset` kernels.
+///
+/// `serialize()` writes a portable little-endian format whose containers can
+/// be queried in place with `RoaringBitmapView`, e.g. from an `mmap()`ed
+/// file, without deserializing.
+///
+/// # Example
+///
+/// ```cpp
+/// RoaringBitmap a{1, 2, 3, 1000000};
+/// RoaringBitmap b{3, 1000000, 7};
+/// RoaringBitmap c = a & b;
+/// assert(c.cardinality() == 2 && c.contains(1000000));
+/// ```
+class RoaringBitmap {
+public:
+    using ValueType = std::uint32_t;
+    using SizeType = std::size_t;
+
+    /// Constructs an empty set.
+    RoaringBitmap() = default;
+
+    /// Constructs the set of `values`, in any order.
+    explicit RoaringBitmap(const Vector<std::uint32_t>& values) {
+        add_many(values.begin(), values.end());
+    }
+
+    /// Constructs the set of `values`, in any order.
+    RoaringBitmap(std::initializer_list<std::uint32_t> values) {
+        add_many(values.begin(), values.end());
+    }
+
+    /// Inserts the values in `[first, last)`. Sorted input is fastest.
+    template <typename InputIt>
+    void add_many(InputIt first, InputIt last) {
+        SizeType i = 0;
+        std::uint16_t key = 0;
+        bool cached = false;
+        for (; first != last; ++first) {
+            const std::uint32_t v = *first;
+            if (!cached || std::uint16_t(v >> 16) != key) {
+                key = std::uint16_t(v >> 16);
+                i = containerFor(key);
+                cached = true;
+            }
+            containers_[i].add(std::uint16_t(v));
+        }
+    }
+
+    /// Returns the number of values.
+    [[nodiscard]] SizeType cardinality() const noexcept {
+        SizeType n = 0;
+        for (const auto& c : containers_) {
+            n += c.card;
+        }
+        return n;
+    }
+
+    /// Returns true if the set is empty.
+    [[nodiscard]] bool empty() const noexcept {
+        return containers_.empty();
+    }
+
+    /// Returns the number of containers.
+    [[nodiscard]] SizeType container_count() const noexcept {
+        return containers_.size();
+    }
+
+    /// Returns the size of the output of `serialize()`.
+    [[nodiscard]] SizeType serialized_size() const noexcept {
+        SizeType bytes = header_bytes + entry_bytes * containers_.size();
+        for (const auto& c : containers_) {
+            bytes = (bytes + 7) / 8 * 8 + c.payloadBytes();
+        }
+        return bytes;
+    }
+
+    /// Removes all values.
+    void clear() noexcept {
+        keys_.clear();
+        containers_.clear();
+    }
+
+    /// Inserts `v`. Returns true if it was absent.
+    bool add(std::uint32_t v) {
+        return containers_[containerFor(std::uint16_t(v >> 16))].add(
+            std::uint16_t(v));
+    }
+
+    /// Removes `v`. Returns true if it was present.
+    bool remove(std::uint32_t v) {
+        const SizeType i = find(std::uint16_t(v >> 16));
+        if (i == npos || !containers_[i].remove(std::uint16_t(v))) {
+            return false;
+        }
+        if (containers_[i].card == 0) {
+            keys_.erase(keys_.begin() + i);
+            containers_.erase(containers_.begin() + i);
+        }
+        return true;
+    }
+
+    /// Returns true if `v` is in the set.
+    [[nodiscard]] bool contains(std::uint32_t v) const noexcept {
+        const SizeType i = find(std::uint16_t(v >> 16));
+        return i != npos && containers_[i].contains(std::uint16_t(v));
+    }
+
+    /// Calls `f(v)` for every value in ascending order.
+    template <typename F>
+    void for_each(F&& f) const {
+        for (SizeType i = 0; i < keys_.size(); ++i) {
+            const std::uint32_t high = std::uint32_t(keys_[i]) << 16;
+            auto g = [&](std::size_t low) { f(high | std::uint32_t(low)); };
+            containers_[i].for_each(g);
+        }
+    }
+
+    /// Returns the values in ascending order.
+    Vector<std::uint32_t> to_vector() const {
+        Vector<std::uint32_t> out;
+        out.reserve(cardinality());
+        for_each([&out](std::uint32_t v) { out.push_back(v); });
+        return out;
+    }
+
+    /// Converts the containers to runs wherever that is smaller. Returns true
+    /// if any container changed.
+    bool run_optimize() {
+        bool changed = false;
+        for (auto& c : containers_) {
+            changed |= c.runOptimize();
+        }
+        return changed;
+    }
+
+    /// Returns the size of the intersection without materializing it.
+    [[nodiscard]] SizeType and_cardinality(const RoaringBitmap& rhs) const {
+        SizeType n = 0;
+        SizeType i = 0;
+        SizeType j = 0;
+        while (i < keys_.size() && j < rhs.keys_.size()) {
+            if (keys_[i] < rhs.keys_[j]) {
+                ++i;
+            } else if (rhs.keys_[j] < keys_[i]) {
+                ++j;
+            } else {
+                n += detail::RoaringContainer::intersectCount(
+                    containers_[i++], rhs.containers_[j++]);
+            }
+        }
+        return n;
+    }
+
+    RoaringBitmap& operator&=(const RoaringBitmap& rhs) {
+        RoaringBitmap r;
+        SizeType i = 0;
+        SizeType j = 0;
+        while (i < keys_.size() && j < rhs.keys_.size()) {
+            if (keys_[i] < rhs.keys_[j]) {
+                ++i;
+            } else if (rhs.keys_[j] < keys_[i]) {
+                ++j;
+            } else {
+                r.append(keys_[i], detail::RoaringContainer::intersect(
+                                       containers_[i], rhs.containers_[j]));
+                ++i;
+                ++j;
+            }
+        }
+        swap(r);
+        return *this;
+    }
+
+    RoaringBitmap& operator|=(const RoaringBitmap& rhs) {
+        RoaringBitmap r;
+        SizeType i = 0;
+        SizeType j = 0;
+        while (i < keys_.size() || j < rhs.keys_.size()) {
+            if (j == rhs.keys_.size() ||
+                (i < keys_.size() && keys_[i] < rhs.keys_[j])) {
+                r.append(keys_[i], containers_[i]);
+                ++i;
+            } else if (i == keys_.size() || rhs.keys_[j] < keys_[i]) {
+                r.append(rhs.keys_[j], rhs.containers_[j]);
+                ++j;
+            } else {
+                r.append(keys_[i], detail::RoaringContainer::unite(
+                                       containers_[i], rhs.containers_[j]));
+                ++i;
+                ++j;
+            }
+        }
+        swap(r);
+        return *this;
+    }
+
+    /// Removes the values of `rhs`, i.e. the set difference.
+    RoaringBitmap& and_not(const RoaringBitmap& rhs) {
+        RoaringBitmap r;
+        SizeType j = 0;
+        for (SizeType i = 0; i < keys_.size(); ++i) {
+            while (j < rhs.keys_.size() && rhs.keys_[j] < keys_[i]) {
+                ++j;
+            }
+            if (j < rhs.keys_.size() && rhs.keys_[j] == keys_[i]) {
+                r.append(keys_[i], detail::RoaringContainer::difference(
+                                       containers_[i], rhs.containers_[j]));
+            } else {
+                r.append(keys_[i], containers_[i]);
+            }
+        }
+        swap(r);
+        return *this;
+    }
+
+    friend RoaringBitmap operator&(const RoaringBitmap& x,
+                                   const RoaringBitmap& y) {
+        RoaringBitmap r(x);
+        return r &= y;
+    }
+
+    friend RoaringBitmap operator|(const RoaringBitmap& x,
+                                   const RoaringBitmap& y) {
+        RoaringBitmap r(x);
+        return r |= y;
+    }
+
+    /// Compares the values, regardless of the container representations.
+    friend bool operator==(const RoaringBitmap& x, const RoaringBitmap& y) {
+        return x.keys_ == y.keys_ && x.cardinality() == y.cardinality() &&
+               x.and_cardinality(y) == x.cardinality();
+    }
+
+    friend bool operator!=(const RoaringBitmap& x, const RoaringBitmap& y) {
+        return !(x == y);
+    }
+
+    void swap(RoaringBitmap& rhs) noexcept {
+        keys_.swap(rhs.keys_);
+        containers_.swap(rhs.containers_);
+    }
+
+    /// Appends the serialized set to `out`.
+    ///
+    /// The format is little-endian: the magic `"RBM1"` and the container
+    /// count as 32-bit words, then a 16-byte entry per container with its
+    /// key (16 bits), type (8 bits), one byte of padding, cardinality,
+    /// payload offset and payload length in 16- or 64-bit elements (32 bits
+    /// each). Every payload starts at an 8-byte boundary: the sorted 16-bit
+    /// values of an array, the 1024 words of a bitmap, or the (start,
+    /// length - 1) 16-bit pairs of the runs.
+    void serialize(Vector<unsigned char>& out) const {
+        const SizeType base = out.size();
+        out.resize(base + serialized_size());
+        std::fill(out.begin() + base, out.end(), 0);
+        unsigned char* p = out.data() + base;
+
+        detail::storeLe<std::uint32_t>(p, magic);
+        detail::storeLe<std::uint32_t>(p + 4,
+                                       std::uint32_t(containers_.size()));
+        SizeType offset = header_bytes + entry_bytes * containers_.size();
+        for (SizeType i = 0; i < containers_.size(); ++i) {
+            const auto& c = containers_[i];
+            offset = (offset + 7) / 8 * 8;
+            const bool bitmap = c.type == detail::RoaringContainer::bitmap_type;
+            const SizeType length = bitmap ? c.words.size() : c.values.size();
+
+            unsigned char* e = p + header_bytes + entry_bytes * i;
+            detail::storeLe<std::uint16_t>(e, keys_[i]);
+            e[2] = c.type;
+            detail::storeLe<std::uint32_t>(e + 4, c.card);
+            detail::storeLe<std::uint32_t>(e + 8, std::uint32_t(offset));
+            detail::storeLe<std::uint32_t>(e + 12, std::uint32_t(length));
+
+            if (bitmap) {
+                for (SizeType k = 0; k < length; ++k) {
+                    detail::storeLe<std::uint64_t>(p + offset + 8 * k,
+                                                   c.words[k]);
+                }
+            } else {
+                for (SizeType k = 0; k < length; ++k) {
+                    detail::storeLe<std::uint16_t>(p + offset + 2 * k,
+                                                   c.values[k]);
+                }
+            }
+            offset += c.payloadBytes();
+        }
+    }
+
+    /// Reads a set written by `serialize()`.
+    ///
+    /// Throws `std::invalid_argument` if the data is malformed.
+    static RoaringBitmap deserialize(const void* data, SizeType size);
+
+private:
+    friend class RoaringBitmapView;
+
+    static constexpr SizeType npos = ~SizeType(0);
+    static constexpr std::uint32_t magic = 0x314d4252; // "RBM1"
+    static constexpr SizeType header_bytes = 8;
+    static constexpr SizeType entry_bytes = 16;
+
+    SizeType find(std::uint16_t key) const noexcept {
+        auto it = std::lower_bound(keys_.begin(), keys_.end(), key);
+        return it != keys_.end() && *it == key ? SizeType(it - keys_.begin())
+                                               : npos;
+    }
+
+    // Returns the container of `key`, inserting an empty one if needed.
+    SizeType containerFor(std::uint16_t key) {
+        auto it = std::lower_bound(keys_.begin(), keys_.end(), key);
+        const SizeType i = SizeType(it - keys_.begin());
+        if (it == keys_.end() || *it != key) {
+            keys_.insert(it, key);
+            containers_.insert(containers_.begin() + i,
+                               detail::RoaringContainer());
+        }
+        return i;
+    }
+
+    void append(std::uint16_t key, detail::RoaringContainer c) {
+        if (c.card != 0) {
+            keys_.push_back(key);
+            containers_.push_back(std::move(c));
+        }
+    }
+
+private:
+    Vector<std::uint16_t> keys_;
+    Vector<detail::RoaringContainer> containers_;
+};
+
+/// A read-only view of a serialized `RoaringBitmap`, queried in place.
+///
+/// Nothing is copied or decoded: the constructor checks every container in
+/// one pass over the buffer, and queries then touch only the containers they
+/// need. The buffer needs no particular alignment and must outlive the view.
+///
+/// # Example
+///
+/// ```cpp
+/// Vector<unsigned char> bytes;
+/// RoaringBitmap{1, 2, 3}.serialize(bytes);
+/// RoaringBitmapView view(bytes.data(), bytes.size());
+/// assert(view.contains(2) && view.cardinality() == 3);
+/// ```
+class RoaringBitmapView {
+public:
+    using SizeType = std::size_t;
+
+    /// Validates the `size` bytes at `data`: the header, the entry table and
+    /// the values of every container.
+    ///
+    /// Throws `std::invalid_argument` if they are malformed.
+    RoaringBitmapView(const void* data, SizeType size)
+        : data_(static_cast<const unsigned char*>(data)), size_(size) {
+        if (size < RoaringBitmap::header_bytes ||
+            detail::loadLe<std::uint32_t>(data_) != RoaringBitmap::magic) {
+            throw std::invalid_argument("RoaringBitmapView: bad header");
+        }
+        count_ = detail::loadLe<std::uint32_t>(data_ + 4);
+        if (count_ > (size - RoaringBitmap::header_bytes) /
+                         RoaringBitmap::entry_bytes) {
+            throw std::invalid_argument("RoaringBitmapView: truncated");
+        }
+        for (SizeType i = 0; i < count_; ++i) {
+            const Entry e = entry(i);
+            const SizeType unit =
+                e.type == detail::RoaringContainer::bitmap_type ? 8 : 2;
+            if (e.type > detail::RoaringContainer::run_type ||
+                (i > 0 && entry(i - 1).key >= e.key) ||
+                SizeType(e.offset) + SizeType(e.length) * unit > size_ ||
+                (e.type == detail::RoaringContainer::bitmap_type &&
+                 e.length != detail::RoaringContainer::bitmap_words) ||
+                (e.type == detail::RoaringContainer::array_type &&
+                 e.length != e.card) ||
+                (e.type == detail::RoaringContainer::run_type &&
+                 e.length % 2 != 0)) {
+                throw std::invalid_argument("RoaringBitmapView: bad entry");
+            }
+            if (!validPayload(e)) {
+                throw std::invalid_argument("RoaringBitmapView: bad container");
+            }
+        }
+    }
+
+    /// Returns the number of containers.
+    [[nodiscard]] SizeType container_count() const noexcept {
+        return count_;
+    }
+
+    /// Returns the number of values.
+    [[nodiscard]] SizeType cardinality() const noexcept {
+        SizeType n = 0;
+        for (SizeType i = 0; i < count_; ++i) {
+            n += entry(i).card;
+        }
+        return n;
+    }
+
+    /// Returns true if `v` is in the set.
+    [[nodiscard]] bool contains(std::uint32_t v) const noexcept {
+        const auto key = std::uint16_t(v >> 16);
+        const auto low = std::uint16_t(v);
+        SizeType lo = 0;
+        SizeType hi = count_;
+        while (lo < hi) {
+            const SizeType mid = (lo + hi) / 2;
+            if (entry(mid).key < key) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        if (lo == count_ || entry(lo).key != key) {
+            return false;
+        }
+
+        const Entry e = entry(lo);
+        const unsigned char* p = data_ + e.offset;
+        switch (e.type) {
+        case detail::RoaringContainer::bitmap_type:
+            return detail::loadLe<std::uint64_t>(p + 8 * (low / 64)) >>
+                       (low % 64) &
+                   1;
+        case detail::RoaringContainer::array_type: {
+            SizeType a = 0;
+            SizeType b = e.length;
+            while (a < b) {
+                const SizeType mid = (a + b) / 2;
+                if (detail::loadLe<std::uint16_t>(p + 2 * mid) < low) {
+                    a = mid + 1;
+                } else {
+                    b = mid;
+                }
+            }
+            return a < e.length &&
+                   detail::loadLe<std::uint16_t>(p + 2 * a) == low;
+        }
+        default: {
+            // Find the last run starting at or before `low`.
+            SizeType a = 0;
+            SizeType b = e.length / 2;
+            while (a < b) {
+                const SizeType mid = (a + b) / 2;
+                if (detail::loadLe<std::uint16_t>(p + 4 * mid) <= low) {
+                    a = mid + 1;
+                } else {
+                    b = mid;
+                }
+            }
+            if (a == 0) {
+                return false;
+            }
+            const std::uint32_t start =
+                detail::loadLe<std::uint16_t>(p + 4 * (a - 1));
+            const std::uint32_t length =
+                detail::loadLe<std::uint16_t>(p + 4 * (a - 1) + 2);
+            return low <= start + length;
+        }
+        }
+    }
+
+    /// Calls `f(v)` for every value in ascending order.
+    template <typename F>
+    void for_each(F&& f) const {
+        for (SizeType i = 0; i < count_; ++i) {
+            const Entry e = entry(i);
+            const std::uint32_t high = std::uint32_t(e.key) << 16;
+            const unsigned char* p = data_ + e.offset;
+            if (e.type == detail::RoaringContainer::bitmap_type) {
+                for (SizeType k = 0; k < e.length; ++k) {
+                    for (auto w = detail::loadLe<std::uint64_t>(p + 8 * k);
+                         w != 0; w &= w - 1) {
+                        f(high | std::uint32_t(k * 64 + __builtin_ctzll(w)));
+                    }
+                }
+            } else if (e.type == detail::RoaringContainer::array_type) {
+                for (SizeType k = 0; k < e.length; ++k) {
+                    f(high | detail::loadLe<std::uint16_t>(p + 2 * k));
+                }
+            } else {
+                for (SizeType k = 0; k < e.length; k += 2) {
+                    const std::uint32_t start =
+                        detail::loadLe<std::uint16_t>(p + 2 * k);
+                    const std::uint32_t last =
+                        start + detail::loadLe<std::uint16_t>(p + 2 * k + 2);
+                    for (std::uint32_t v = start; v <= last; ++v) {
+                        f(high | v);
+                    }
+                }
+            }
+        }
+    }
+
+    /// Decodes the view into a `RoaringBitmap`.
+    RoaringBitmap to_bitmap() const {
+        RoaringBitmap r;
+        for (SizeType i = 0; i < count_; ++i) {
+            const Entry e = entry(i);
+            const unsigned char* p = data_ + e.offset;
+            detail::RoaringContainer c;
+            c.type = detail::RoaringContainer::Type(e.type);
+            if (e.type == detail::RoaringContainer::bitmap_type) {
+                c.words.reserve(e.length);
+                for (SizeType k = 0; k < e.length; ++k) {
+                    c.words.push_back(detail::loadLe<std::uint64_t>(p + 8 * k));
+                }
+                c.card = std::uint32_t(
+                    detail::popcountWords(c.words.data(), c.words.size()));
+            } else {
+                c.values.reserve(e.length);
+                for (SizeType k = 0; k < e.length; ++k) {
+                    c.values.push_back(
+                        detail::loadLe<std::uint16_t>(p + 2 * k));
+                }
+                c.card = std::uint32_t(c.values.size());
+                if (e.type == detail::RoaringContainer::run_type) {
+                    c.card = 0;
+                    for (SizeType k = 0; k < e.length; k += 2) {
+                        c.card += std::uint32_t(c.values[k + 1]) + 1;
+                    }
+                }
+            }
+            r.append(e.key, std::move(c));
+        }
+        return r;
+    }
+
+private:
+    struct Entry {
+        std::uint16_t key;
+        std::uint8_t type;
+        std::uint32_t card;
+        std::uint32_t offset;
+        std::uint32_t length;
+    };
+
+    Entry entry(SizeType i) const noexcept {
+        const unsigned char* e = data_ + RoaringBitmap::header_bytes +
+                                 RoaringBitmap::entry_bytes * i;
+        return Entry{detail::loadLe<std::uint16_t>(e), e[2],
+                     detail::loadLe<std::uint32_t>(e + 4),
+                     detail::loadLe<std::uint32_t>(e + 8),
+                     detail::loadLe<std::uint32_t>(e + 12)};
+    }
+
+    // Returns whether the payload of `e` holds what the queries assume: at
+    // most `array_max` strictly ascending values in an array, runs in order
+    // that end within the 16 bits of the container, and `e.card` values.
+    bool validPayload(const Entry& e) const noexcept {
+        const unsigned char* p = data_ + e.offset;
+        if (e.type == detail::RoaringContainer::bitmap_type) {
+            SizeType card = 0;
+            for (SizeType k = 0; k < e.length; ++k) {
+                card += SizeType(
+                    __builtin_popcountll(detail::loadLe<std::uint64_t>(
+                        p + 8 * k)));
+            }
+            return card == e.card;
+        }
+        if (e.type == detail::RoaringContainer::array_type) {
+            if (e.length > detail::RoaringContainer::array_max) {
+                return false;
+            }
+            for (SizeType k = 1; k < e.length; ++k) {
+                if (detail::loadLe<std::uint16_t>(p + 2 * k) <=
+                    detail::loadLe<std::uint16_t>(p + 2 * k - 2)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        SizeType card = 0;
+        // The lowest value the next run may start at.
+        std::uint32_t next = 0;
+        for (SizeType k = 0; k < e.length; k += 2) {
+            const std::uint32_t start =
+                detail::loadLe<std::uint16_t>(p + 2 * k);
+            const std::uint32_t last =
+                start + detail::loadLe<std::uint16_t>(p + 2 * k + 2);
+            if (start < next || last > 0xFFFF) {
+                return false;
+            }
+            card += last - start + 1;
+            next = last + 1;
+        }
+        return card == e.card;
+    }
+
+private:
+    const unsigned char* data_;
+    SizeType size_;
+    SizeType count_ = 0;
+};
+
+inline RoaringBitmap RoaringBitmap::deserialize(const void* data,
+                                                SizeType size) {
+    return RoaringBitmapView(data, size).to_bitmap();
+}
+} // namespace algo
@@ -0,0 +1,483 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include "heap.hpp"
+#include "simd.hpp"
+#include "vector.hpp"
+
+namespace algo {
+namespace detail {
+template <typename T>
+inline constexpr bool is_simd_partitionable =
+    std::is_same_v<T, float> || std::is_same_v<T, std::int32_t> ||
+    std::is_same_v<T, std::uint32_t>;
+
+#if defined(ALGO_SIMD_X86)
+// Vector kernels splitting a register of 32-bit values by `< pivot`.
+// `split()` writes the values below the pivot to the front of `left` and the
+// others to the back of `[right_end - width, right_end)`; lanes outside
+// those ranges may be clobbered.
+template <typename T>
+struct PartitionLanesAvx512 {
+    static constexpr std::size_t width = 16;
+    using Reg = __m512i;
+
+    __attribute__((target("avx512f"))) static Reg load(const T* p) noexcept {
+        return _mm512_loadu_si512(p);
+    }
+    __attribute__((target("avx512f"))) static void store(T* p, Reg v) noexcept {
+        _mm512_storeu_si512(p, v);
+    }
+    __attribute__((target("avx512f"))) static Reg set1(T v) noexcept {
+        std::int32_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        return _mm512_set1_epi32(bits);
+    }
+    __attribute__((target("avx512f"))) static unsigned
+    less(Reg v, Reg pivot) noexcept {
+        if constexpr (std::is_same_v<T, float>) {
+            return _mm512_cmp_ps_mask(_mm512_castsi512_ps(v),
+                                      _mm512_castsi512_ps(pivot), _CMP_LT_OQ);
+        } else if constexpr (std::is_same_v<T, std::int32_t>) {
+            return _mm512_cmplt_epi32_mask(v, pivot);
+        } else {
+            return _mm512_cmplt_epu32_mask(v, pivot);
+        }
+    }
+    __attribute__((target("avx512f"))) static void
+    split(Reg v, unsigned mask, T* left, T* right_end) noexcept {
+        const unsigned rest = 16 - unsigned(__builtin_popcount(mask));
+        _mm512_storeu_si512(left,
+                            _mm512_maskz_compress_epi32(__mmask16(mask), v));
+        _mm512_mask_storeu_epi32(
+            right_end - rest, __mmask16((1u << rest) - 1),
+            _mm512_maskz_compress_epi32(__mmask16(~mask), v));
+    }
+};
+
+// For every 8-bit mask, the lanes whose bit is set followed by the others,
+// as 4-bit lane numbers.
+constexpr std::array<std::uint32_t, 256> makePartitionPermutations() noexcept {
+    std::array<std::uint32_t, 256> table{};
+    for (unsigned mask = 0; mask < 256; ++mask) {
+        std::uint32_t packed = 0;
+        unsigned out = 0;
+        for (unsigned pass = 0; pass < 2; ++pass) {
+            for (unsigned lane = 0; lane < 8; ++lane) {
+                if ((mask >> lane & 1) == (pass == 0 ? 1u : 0u)) {
+                    packed |= std::uint32_t(lane) << (4 * out++);
+                }
+            }
+        }
+        table[mask] = packed;
+    }
+    return table;
+}
+
+inline constexpr std::array<std::uint32_t, 256> partition_permutations =
+    makePartitionPermutations();
+
+template <typename T>
+struct PartitionLanesAvx2 {
+    static constexpr std::size_t width = 8;
+    using Reg = __m256i;
+
+    __attribute__((target("avx2"))) static Reg load(const T* p) noexcept {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    }
+    __attribute__((target("avx2"))) static void store(T* p, Reg v) noexcept {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+    }
+    __attribute__((target("avx2"))) static Reg set1(T v) noexcept {
+        std::int32_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        return _mm256_set1_epi32(bits);
+    }
+    __attribute__((target("avx2"))) static unsigned less(Reg v,
+                                                         Reg pivot) noexcept {
+        __m256i lt;
+        if constexpr (std::is_same_v<T, float>) {
+            lt = _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(v),
+                                                   _mm256_castsi256_ps(pivot),
+                                                   _CMP_LT_OQ));
+        } else if constexpr (std::is_same_v<T, std::int32_t>) {
+            lt = _mm256_cmpgt_epi32(pivot, v);
+        } else {
+            // Unsigned order is signed order with the sign bits flipped.
+            const __m256i sign = _mm256_set1_epi32(INT32_MIN);
+            lt = _mm256_cmpgt_epi32(_mm256_xor_si256(pivot, sign),
+                                    _mm256_xor_si256(v, sign));
+        }
+        return unsigned(_mm256_movemask_ps(_mm256_castsi256_ps(lt)));
+    }
+    __attribute__((target("avx2"))) static void
+    split(Reg v, unsigned mask, T* left, T* right_end) noexcept {
+        const __m256i shifts = _mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28);
+        const __m256i lanes = _mm256_and_si256(
+            _mm256_srlv_epi32(
+                _mm256_set1_epi32(int(partition_permutations[mask])), shifts),
+            _mm256_set1_epi32(7));
+        const __m256i p = _mm256_permutevar8x32_epi32(v, lanes);
+        store(left, p);
+        store(right_end - 8, p);
+    }
+};
+
+ALGO_SIMD_KERNELS_BEGIN
+// Moves the values below `pivot` to the front of `a[0, n)` and returns their
+// count.
+//
+// Two registers are read ahead from both ends, which leaves exactly two
+// registers of free space. Each step reads from the end with less free space
+// and writes its split to both ends, so neither end runs into unread values.
+template <typename Lanes, typename T>
+__attribute__((always_inline)) inline std::size_t
+simdPartition(T* a, std::size_t n, T pivot) noexcept {
+    constexpr std::size_t w = Lanes::width;
+    std::size_t wl = 0;
+    std::size_t wr = n;
+    if (n < 2 * w) {
+        T tmp[2 * w];
+        std::copy(a, a + n, tmp);
+        for (std::size_t i = 0; i < n; ++i) {
+            (tmp[i] < pivot ? a[wl++] : a[--wr]) = tmp[i];
+        }
+        return wl;
+    }
+
+    const typename Lanes::Reg vp = Lanes::set1(pivot);
+    T saved[3 * w];
+    Lanes::store(saved, Lanes::load(a));
+    Lanes::store(saved + w, Lanes::load(a + n - w));
+    std::size_t l = w;
+    std::size_t r = n - w;
+    while (r - l >= w) {
+        typename Lanes::Reg v;
+        if (l - wl <= wr - r) {
+            v = Lanes::load(a + l);
+            l += w;
+        } else {
+            r -= w;
+            v = Lanes::load(a + r);
+        }
+        const unsigned mask = Lanes::less(v, vp);
+        Lanes::split(v, mask, a + wl, a + wr);
+        const std::size_t count = std::size_t(__builtin_popcount(mask));
+        wl += count;
+        wr -= w - count;
+    }
+
+    // The unread remainder joins the saved registers, which then fill the
+    // free space exactly.
+    const std::size_t rest = r - l;
+    std::copy(a + l, a + r, saved + 2 * w);
+    for (std::size_t i = 0; i < 2 * w + rest; ++i) {
+        (saved[i] < pivot ? a[wl++] : a[--wr]) = saved[i];
+    }
+    assert(wl == wr);
+    return wl;
+}
+ALGO_SIMD_KERNELS_END
+
+template <typename T>
+__attribute__((target("avx2"))) std::size_t
+partitionLessAvx2(T* a, std::size_t n, T pivot) noexcept {
+    return simdPartition<PartitionLanesAvx2<T>>(a, n, pivot);
+}
+
+template <typename T>
+__attribute__((target("avx512f"))) std::size_t
+partitionLessAvx512(T* a, std::size_t n, T pivot) noexcept {
+    return simdPartition<PartitionLanesAvx512<T>>(a, n, pivot);
+}
+#endif
+
+// Moves the values satisfying `pred` to the front of `[first, last)`. For
+// trivially copyable values every step does the same two stores and the
+// predicate only decides whether the boundary advances, so there is nothing
+// to mispredict.
+template <typename RandomIt, typename Pred>
+RandomIt partitionBranchless(RandomIt first, RandomIt last, Pred pred) {
+    using T = typename std::iterator_traits<RandomIt>::value_type;
+    if constexpr (std::is_trivially_copyable_v<T>) {
+        RandomIt lo = first;
+        for (RandomIt it = first; it != last; ++it) {
+            const T v = *it;
+            const bool below = pred(v);
+            *it = *lo;
+            *lo = v;
+            lo += below;
+        }
+        return lo;
+    } else {
+        return std::partition(first, last, pred);
+    }
+}
+
+template <typename T>
+std::size_t partitionLessScalar(T* a, std::size_t n, T pivot) noexcept {
+    return std::size_t(partitionBranchless(
+                           a, a + n, [pivot](T x) { return x < pivot; }) -
+                       a);
+}
+
+// Moves the values below `pivot` to the front of `a[0, n)` and returns their
+// count, splitting whole registers on CPUs with AVX2 or AVX-512.
+#if defined(ALGO_SIMD_X86)
+template <typename T>
+inline const simd::Dispatch<std::size_t(T*, std::size_t, T)> partition_less(
+    partitionLessScalar<T>, nullptr, partitionLessAvx2<T>,
+    partitionLessAvx512<T>);
+#else
+template <typename T>
+inline const simd::Dispatch<std::size_t(T*, std::size_t, T)>
+    partition_less(partitionLessScalar<T>);
+#endif
+
+// Returns the median of `a`, `b` and `c`.
+template <typename T, typename Compare>
+const T& median3(const T& a, const T& b, const T& c, Compare& comp) {
+    if (comp(a, b)) {
+        return comp(b, c) ? b : (comp(a, c) ? c : a);
+    }
+    return comp(a, c) ? a : (comp(b, c) ? c : b);
+}
+
+template <typename RandomIt, typename Compare>
+void insertionSort(RandomIt first, RandomIt last, Compare& comp) {
+    if (first == last) {
+        return;
+    }
+    for (RandomIt i = first + 1; i != last; ++i) {
+        auto v = std::move(*i);
+        RandomIt j = i;
+        for (; j != first && comp(v, *(j - 1)); --j) {
+            *j = std::move(*(j - 1));
+        }
+        *j = std::move(v);
+    }
+}
+} // namespace detail
+
+/// Rearranges `[first, last)` so that `*nth` is the element a full sort would
+/// put there, with no element before it greater and none after it less.
+///
+/// This is introselect: quickselect with a median-of-3 pivot, or a ninther
+/// above 1024 elements, switching to heap selection after `2 log2(n)`
+/// rounds. Partitioning is branch-free. For contiguous `float`,
+/// `std::int32_t` and `std::uint32_t` ranges ordered by `std::less`, it
+/// instead splits whole AVX2 or AVX-512 registers with a permutation or
+/// compress instruction, whichever the running CPU supports.
+///
+/// # Example
+///
+/// ```cpp
+/// Vector<float> v = {5, 1, 4, 2, 3};
+/// algo::nth_element(v.begin(), v.begin() + 2, v.end());
+/// assert(v[2] == 3);
+/// ```
+template <typename RandomIt, typename Compare>
+void nth_element(RandomIt first, RandomIt nth, RandomIt last, Compare comp) {
+    using T = typename std::iterator_traits<RandomIt>::value_type;
+    constexpr bool simd =
+        std::is_pointer_v<RandomIt> && detail::is_simd_partitionable<T> &&
+        (std::is_same_v<Compare, std::less<T>> ||
+         std::is_same_v<Compare, std::less<>>);
+    if (nth == last) {
+        return;
+    }
+
+    std::size_t depth = 0;
+    for (auto n = last - first; n > 1; n /= 2) {
+        depth += 2;
+    }
+    while (last - first > 32) {
+        if (depth-- == 0) {
+            std::partial_sort(first, nth + 1, last, comp);
+            return;
+        }
+
+        const auto n = last - first;
+        const RandomIt m = first + n / 2;
+        T pivot = detail::median3(*first, *m, *(last - 1), comp);
+        if (n > 1024) {
+            const auto s = n / 8;
+            pivot = detail::median3(
+                detail::median3(*(first + s), *(first + 2 * s),
+                                *(first + 3 * s), comp),
+                pivot,
+                detail::median3(*(last - 3 * s), *(last - 2 * s),
+                                *(last - s), comp),
+                comp);
+        }
+
+        RandomIt mid;
+        if constexpr (simd) {
+            mid = first +
+                  detail::partition_less<T>(&*first, std::size_t(n), pivot);
+        } else {
+            mid = detail::partitionBranchless(
+                first, last, [&](const T& x) { return comp(x, pivot); });
+        }
+        if (mid == first) {
+            // The pivot is the minimum; split off its copies instead.
+            mid = detail::partitionBranchless(
+                first, last, [&](const T& x) { return !comp(pivot, x); });
+            if (nth < mid) {
+                return;
+            }
+        }
+        if (nth < mid) {
+            last = mid;
+        } else {
+            first = mid;
+        }
+    }
+    detail::insertionSort(first, last, comp);
+}
+
+/// Same as `nth_element(first, nth, last, std::less<>())`.
+template <typename RandomIt>
+void nth_element(RandomIt first, RandomIt nth, RandomIt last) {
+    algo::nth_element(first, nth, last, std::less<>());
+}
+
+/// Sorts the smallest `middle - first` elements of `[first, last)` into
+/// `[first, middle)`, leaving the rest in unspecified order.
+///
+/// Selects with `nth_element()` first, so only the prefix is sorted.
+template <typename RandomIt, typename Compare>
+void partial_sort(RandomIt first, RandomIt middle, RandomIt last,
+                  Compare comp) {
+    if (first == middle) {
+        return;
+    }
+    algo::nth_element(first, middle, last, comp);
+    std::sort(first, middle, comp);
+}
+
+/// Same as `partial_sort(first, middle, last, std::less<>())`.
+template <typename RandomIt>
+void partial_sort(RandomIt first, RandomIt middle, RandomIt last) {
+    algo::partial_sort(first, middle, last, std::less<>());
+}
+
+/// Keeps the `k` greatest values pushed so far, under `Compare`.
+///
+/// The values are kept in a `DaryHeap` with the smallest kept value on top,
+/// so a value that does not make the cut costs one comparison, which is the
+/// common case once the stream has warmed up.
+///
+/// # Example
+///
+/// ```cpp
+/// TopK<int> top(2);
+/// for (int x : {5, 1, 9, 7}) {
+///     top.push(x);
+/// }
+/// assert((top.sorted() == Vector<int>{9, 7}));
+/// ```
+template <typename T, typename Compare = std::less<T>>
+class TopK {
+public:
+    using ValueType = T;
+    using SizeType = std::size_t;
+
+    /// Constructs an empty selection of at most `k` values.
+    explicit TopK(SizeType k, const Compare& comp = Compare())
+        : heap_(comp), comp_(comp), k_(k) {
+        heap_.reserve(k);
+    }
+
+    /// Returns the number of kept values.
+    [[nodiscard]] SizeType size() const noexcept {
+        return heap_.size();
+    }
+
+    /// Returns the maximal number of kept values.
+    [[nodiscard]] SizeType k() const noexcept {
+        return k_;
+    }
+
+    /// Offers `value`.
+    void push(const T& value) {
+        if (heap_.size() < k_) {
+            heap_.push(value);
+        } else if (k_ != 0 && comp_(heap_.top(), value)) {
+            heap_.replace_top(value);
+        }
+    }
+
+    /// Offers every value in `[first, last)`.
+    template <
+        typename InputIt,
+        std::enable_if_t<std::is_convertible_v<typename std::iterator_traits<
+                                                   InputIt>::iterator_category,
+                                               std::input_iterator_tag>,
+                         int> = 0>
+    void push(InputIt first, InputIt last) {
+        for (; first != last && heap_.size() < k_; ++first) {
+            heap_.push(*first);
+        }
+        if (heap_.empty()) {
+            return;
+        }
+        // Once full, a value is kept only if it beats the smallest kept one.
+        for (; first != last; ++first) {
+            if (comp_(heap_.top(), *first)) {
+                heap_.replace_top(*first);
+            }
+        }
+    }
+
+    /// Returns the kept values, greatest first.
+    [[nodiscard]] Vector<T> sorted() const {
+        Vector<T> result(heap_.values());
+        std::sort(result.begin(), result.end(),
+                  [this](const T& a, const T& b) { return comp_(b, a); });
+        return result;
+    }
+
+    /// Forgets all values.
+    void clear() noexcept {
+        heap_.clear();
+    }
+
+private:
+    DaryHeap<T, 4, Compare> heap_;
+    [[no_unique_address]] Compare comp_;
+    SizeType k_;
+};
+
+/// Returns the `k` greatest values of `values` under `comp`, greatest first.
+///
+/// Small `k` streams through a `TopK`; larger `k` copies the values and runs
+/// `nth_element()`.
+template <typename T, typename Alloc, typename Compare = std::less<T>>
+Vector<T> top_k(const Vector<T, Alloc>& values, std::size_t k,
+                Compare comp = Compare()) {
+    const std::size_t n = values.size();
+    if (k <= 64 && k * 64 <= n) {
+        TopK<T, Compare> top(k, comp);
+        top.push(values.begin(), values.end());
+        return top.sorted();
+    }
+    Vector<T> result(values.begin(), values.end());
+    if (k < n) {
+        algo::nth_element(result.begin(), result.begin() + (n - k),
+                          result.end(), comp);
+        result.erase(result.begin(), result.begin() + (n - k));
+    }
+    std::sort(result.begin(), result.end(),
+              [&comp](const T& a, const T& b) { return comp(b, a); });
+    return result;
+}
+} // namespace algo
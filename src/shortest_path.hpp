@@ -0,0 +1,351 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "heap.hpp"
+#include "vector.hpp"
+
+namespace algo {
+/// A directed weighted graph in compressed sparse row (CSR) form.
+///
+/// The outgoing edges of vertex `u` occupy the index range
+/// `[edge_begin(u), edge_end(u))` of the `targets()` and `weights()` arrays,
+/// so scanning the neighbors of a vertex is a linear walk over two contiguous
+/// arrays.
+///
+/// # Example
+///
+/// ```cpp
+/// using Graph = CsrGraph<std::uint32_t>;
+/// Graph g(3, {{0, 1, 5}, {1, 2, 7}});
+/// assert(g.num_edges() == 2);
+/// assert(g.target(g.edge_begin(1)) == 2);
+/// ```
+template <typename Weight>
+class CsrGraph {
+public:
+    using VertexType = std::uint32_t;
+    using WeightType = Weight;
+    using SizeType = std::size_t;
+
+    struct Edge {
+        VertexType from;
+        VertexType to;
+        Weight weight;
+    };
+
+    /// Constructs an empty graph.
+    CsrGraph() = default;
+
+    /// Constructs a graph of `n` vertices from an unordered edge list. The
+    /// edges of one vertex keep their relative order.
+    ///
+    /// Throws `std::out_of_range` if an edge refers to a vertex `>= n`.
+    CsrGraph(SizeType n, const Vector<Edge>& edges) {
+        build(n, edges.begin(), edges.end());
+    }
+
+    /// Constructs a graph of `n` vertices from the edges in `ilist`.
+    CsrGraph(SizeType n, std::initializer_list<Edge> ilist) {
+        build(n, ilist.begin(), ilist.end());
+    }
+
+    /// Returns the number of vertices.
+    [[nodiscard]] SizeType num_vertices() const noexcept {
+        return offsets_.empty() ? 0 : offsets_.size() - 1;
+    }
+
+    /// Returns the number of edges.
+    [[nodiscard]] SizeType num_edges() const noexcept {
+        return targets_.size();
+    }
+
+    /// Returns the index of the first outgoing edge of `u`.
+    SizeType edge_begin(VertexType u) const noexcept {
+        return offsets_[u];
+    }
+
+    /// Returns the index one past the last outgoing edge of `u`.
+    SizeType edge_end(VertexType u) const noexcept {
+        return offsets_[u + 1];
+    }
+
+    /// Returns the number of outgoing edges of `u`.
+    SizeType degree(VertexType u) const noexcept {
+        return edge_end(u) - edge_begin(u);
+    }
+
+    /// Returns the head of edge `e`.
+    VertexType target(SizeType e) const noexcept {
+        return targets_[e];
+    }
+
+    /// Returns the weight of edge `e`.
+    const Weight& weight(SizeType e) const noexcept {
+        return weights_[e];
+    }
+
+    const Vector<SizeType>& offsets() const noexcept {
+        return offsets_;
+    }
+
+    const Vector<VertexType>& targets() const noexcept {
+        return targets_;
+    }
+
+    const Vector<Weight>& weights() const noexcept {
+        return weights_;
+    }
+
+private:
+    template <typename Iter>
+    void build(SizeType n, Iter first, Iter last) {
+        if (n >= std::numeric_limits<VertexType>::max()) {
+            throw std::length_error("CsrGraph: too many vertices");
+        }
+
+        offsets_.assign(n + 1, 0);
+        for (Iter it = first; it != last; ++it) {
+            if (it->from >= n || it->to >= n) {
+                throw std::out_of_range("CsrGraph: vertex out of range");
+            }
+            ++offsets_[it->from + 1];
+        }
+        for (SizeType u = 0; u < n; ++u) {
+            offsets_[u + 1] += offsets_[u];
+        }
+
+        const SizeType m = offsets_[n];
+        targets_.resize(m);
+        weights_.resize(m);
+
+        Vector<SizeType> cursor(offsets_.begin(), offsets_.end() - 1);
+        for (Iter it = first; it != last; ++it) {
+            const SizeType e = cursor[it->from]++;
+            targets_[e] = it->to;
+            weights_[e] = it->weight;
+        }
+    }
+
+private:
+    Vector<SizeType> offsets_;
+    Vector<VertexType> targets_;
+    Vector<Weight> weights_;
+};
+
+/// A reusable single-source shortest path engine over `CsrGraph`.
+///
+/// All per-vertex state (distances, parents and the heap positions) lives in
+/// the engine and is kept across queries. Instead of clearing the distance
+/// array before every query, each entry carries the timestamp of the query
+/// that wrote it; bumping the timestamp invalidates all entries at once. A
+/// query therefore costs time proportional to the part of the graph it
+/// explores, not to the size of the graph, and does no allocation once the
+/// engine has warmed up.
+///
+/// Edge weights must be non-negative.
+///
+/// # Example
+///
+/// ```cpp
+/// CsrGraph<std::uint32_t> g(3, {{0, 1, 5}, {1, 2, 7}, {0, 2, 20}});
+/// ShortestPaths<std::uint32_t> sp;
+///
+/// assert(sp.dijkstra(g, 0, 2) == 12);
+/// assert(sp.path_to(2) == Vector<std::uint32_t>({0, 1, 2}));
+/// ```
+template <typename Weight, std::size_t Arity = 4>
+class ShortestPaths {
+    static_assert(std::is_arithmetic_v<Weight>, "Weight must be arithmetic");
+
+public:
+    using VertexType = std::uint32_t;
+    using WeightType = Weight;
+    using SizeType = std::size_t;
+    using GraphType = CsrGraph<Weight>;
+
+    /// The distance of unreachable vertices.
+    static constexpr Weight infinity =
+        std::numeric_limits<Weight>::has_infinity
+            ? std::numeric_limits<Weight>::infinity()
+            : std::numeric_limits<Weight>::max();
+
+    /// Denotes "no vertex", e.g. the parent of the source.
+    static constexpr VertexType npos = std::numeric_limits<VertexType>::max();
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Queries
+    ////////////////////////////////////////////////////////////////////////////
+
+    /// Runs Dijkstra's algorithm from `source` with an indexed d-ary heap.
+    ///
+    /// The search stops as soon as `target` is settled. Pass `npos` to compute
+    /// the distances to all reachable vertices.
+    ///
+    /// Returns the distance to `target`, or `infinity` if it is unreachable or
+    /// `npos`.
+    Weight dijkstra(const GraphType& g, VertexType source,
+                    VertexType target = npos) {
+        return astar(g, source, target, [](VertexType) { return Weight(0); });
+    }
+
+    /// Runs A* from `source` towards `target` with an indexed d-ary heap.
+    ///
+    /// `heuristic(v)` must return a consistent lower bound of the distance
+    /// from `v` to `target`, in which case every vertex is settled at most
+    /// once.
+    template <typename Heuristic>
+    Weight astar(const GraphType& g, VertexType source, VertexType target,
+                 Heuristic&& heuristic) {
+        start(g, source, target);
+
+        heap_.push(source, heuristic(source));
+        while (!heap_.empty()) {
+            const VertexType u = heap_.top();
+            heap_.pop();
+            if (u == target) {
+                break;
+            }
+
+            const Weight du = dist_[u];
+            for (SizeType e = g.edge_begin(u), last = g.edge_end(u); e < last;
+                 ++e) {
+                const VertexType v = g.target(e);
+                const Weight dv = du + g.weight(e);
+                if (dv < distance(v)) {
+                    label(v, dv, u);
+                    heap_.update(v, dv + heuristic(v));
+                }
+            }
+        }
+        heap_.clear();
+
+        return target == npos ? infinity : distance(target);
+    }
+
+    /// Runs Dijkstra's algorithm from `source` with a radix heap, which only
+    /// works for unsigned integer weights.
+    ///
+    /// The radix heap has no `decrease_key()`, so a vertex may be queued more
+    /// than once and the stale entries are skipped when popped.
+    Weight dijkstra_radix(const GraphType& g, VertexType source,
+                          VertexType target = npos) {
+        static_assert(std::is_unsigned_v<Weight>,
+                      "dijkstra_radix requires unsigned integer weights");
+        start(g, source, target);
+
+        radix_.push(0, source);
+        while (!radix_.empty()) {
+            const Weight du = radix_.top_priority();
+            const VertexType u = radix_.top();
+            radix_.pop();
+            if (du != dist_[u]) {
+                continue;
+            }
+            if (u == target) {
+                break;
+            }
+
+            for (SizeType e = g.edge_begin(u), last = g.edge_end(u); e < last;
+                 ++e) {
+                const VertexType v = g.target(e);
+                const Weight dv = du + g.weight(e);
+                if (dv < distance(v)) {
+                    label(v, dv, u);
+                    radix_.push(dv, v);
+                }
+            }
+        }
+        radix_.clear();
+
+        return target == npos ? infinity : distance(target);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Results of the last query
+    ////////////////////////////////////////////////////////////////////////////
+
+    /// Returns the distance from the last source to `v`, or `infinity` if `v`
+    /// was not reached.
+    ///
+    /// When the query stopped early at its target, the distances of the other
+    /// vertices are upper bounds.
+    Weight distance(VertexType v) const noexcept {
+        return stamp_[v] == epoch_ ? dist_[v] : infinity;
+    }
+
+    /// Returns true if `v` was reached by the last query.
+    bool reached(VertexType v) const noexcept {
+        return stamp_[v] == epoch_;
+    }
+
+    /// Returns the predecessor of `v` on its shortest path, or `npos` for the
+    /// source and unreached vertices.
+    VertexType parent(VertexType v) const noexcept {
+        return stamp_[v] == epoch_ ? parent_[v] : npos;
+    }
+
+    /// Returns the vertices on the path from the last source to `v`, both
+    /// ends included, or an empty `Vector` if `v` was not reached.
+    Vector<VertexType> path_to(VertexType v) const {
+        Vector<VertexType> path;
+        if (!reached(v)) {
+            return path;
+        }
+        for (VertexType u = v; u != npos; u = parent_[u]) {
+            path.push_back(u);
+        }
+        std::reverse(path.begin(), path.end());
+        return path;
+    }
+
+private:
+    // Placeholder of `radix_` for the weights a radix heap cannot handle.
+    struct NoRadixHeap {};
+
+    // Prepares the per-vertex state for a new query and labels `source`.
+    void start(const GraphType& g, VertexType source, VertexType target) {
+        const SizeType n = g.num_vertices();
+        if (source >= n || (target != npos && target >= n)) {
+            throw std::out_of_range("ShortestPaths: vertex out of range");
+        }
+
+        if (n != stamp_.size()) {
+            dist_.resize(n);
+            parent_.resize(n);
+            stamp_.assign(n, 0);
+            heap_.reset(n);
+            epoch_ = 0;
+        }
+
+        // Clear the stamps only when the epoch counter wraps around.
+        if (++epoch_ == 0) {
+            std::fill(stamp_.begin(), stamp_.end(), 0);
+            epoch_ = 1;
+        }
+
+        label(source, Weight(0), npos);
+    }
+
+    void label(VertexType v, Weight d, VertexType p) noexcept {
+        dist_[v] = d;
+        parent_[v] = p;
+        stamp_[v] = epoch_;
+    }
+
+private:
+    Vector<Weight> dist_;
+    Vector<VertexType> parent_;
+    Vector<std::uint32_t> stamp_;
+    std::uint32_t epoch_ = 0;
+    IndexedDaryHeap<Weight, Arity> heap_;
+    std::conditional_t<std::is_unsigned_v<Weight>,
+                       RadixHeap<Weight, VertexType>, NoRadixHeap>
+        radix_;
+};
+} // namespace algo
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <string_view>
+#include <utility>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define ALGO_SIMD_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+// A kernel shared by several levels is written once, as an `always_inline`
+// template over a lanes type, and inlined into one `target` function per
+// level. Its vector values never cross a call of its own, so GCC's warning
+// that they would change the ABI without the instruction set is moot.
+#if defined(__GNUC__) && !defined(__clang__)
+#define ALGO_SIMD_KERNELS_BEGIN                                               \
+    _Pragma("GCC diagnostic push")                                            \
+    _Pragma("GCC diagnostic ignored \"-Wpsabi\"")
+#define ALGO_SIMD_KERNELS_END _Pragma("GCC diagnostic pop")
+#else
+#define ALGO_SIMD_KERNELS_BEGIN
+#define ALGO_SIMD_KERNELS_END
+#endif
+
+namespace algo {
+/// Run-time selection of SIMD kernels.
+///
+/// The compile-time paths of the library only use the instruction sets the
+/// build enables with `-m` flags. A kernel dispatched through this layer is
+/// instead compiled for every level with `target` attributes, and the best
+/// one the running CPU supports is picked on first use, so that one binary
+/// runs these kernels at full speed across CPU generations. They are:
+/// - the bit counts of `Bitset` and `DynamicBitset`;
+/// - the partition of `nth_element()` and `partial_sort()`;
+/// - the filters of `ColumnTable`;
+/// - the key hashing of `group_by()`;
+/// - the tiles of `gemm()` and `gemv()`.
+///
+/// Beyond the SSE2 of every x86-64 CPU, the following still depend on the
+/// build flags:
+/// - the AND, OR, XOR and AND-NOT loops of the bitsets (AVX2, AVX-512F) and
+///   inline bit counts (AVX512-VPOPCNTDQ);
+/// - the candidate filter of `find_substring()` (AVX2);
+/// - the array intersection of `RoaringBitmap` (SSE4.2);
+/// - the register merge of `HyperLogLog` (AVX2).
+///
+/// The `ALGO_SIMD` environment variable, one of `scalar`, `sse2`, `avx2` or
+/// `avx512`, caps the level, to test or benchmark every path on one machine.
+namespace simd {
+/// An instruction set level, each including those below it.
+///
+/// `avx2` includes FMA, as every CPU with AVX2 but a few early VIA ones
+/// does. `avx512` stands for the F, CD, BW, DQ and VL subsets of Skylake-SP
+/// and later, the x86-64-v4 baseline.
+enum class Level : std::uint8_t { scalar, sse2, avx2, avx512 };
+
+/// Returns the name of `level`, as `ALGO_SIMD` takes it.
+constexpr std::string_view name(Level level) noexcept {
+    switch (level) {
+    case Level::sse2:
+        return "sse2";
+    case Level::avx2:
+        return "avx2";
+    case Level::avx512:
+        return "avx512";
+    default:
+        return "scalar";
+    }
+}
+
+/// Returns the highest level both the CPU and the operating system support,
+/// the latter saving the wider registers on context switches.
+inline Level detect() noexcept {
+#if defined(ALGO_SIMD_X86)
+    unsigned a = 0, b = 0, c = 0, d = 0;
+    if (!__get_cpuid(1, &a, &b, &c, &d) || !(d & bit_SSE2)) {
+        return Level::scalar;
+    }
+    if (!(c & bit_OSXSAVE) || !(c & bit_AVX) || !(c & bit_FMA)) {
+        return Level::sse2;
+    }
+    unsigned lo = 0, hi = 0;
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    const std::uint64_t xcr0 = (std::uint64_t(hi) << 32) | lo;
+    // SSE and AVX state, then the opmask and upper ZMM states too.
+    constexpr std::uint64_t ymm_state = 0x6;
+    constexpr std::uint64_t zmm_state = 0xe6;
+    if ((xcr0 & ymm_state) != ymm_state ||
+        !__get_cpuid_count(7, 0, &a, &b, &c, &d) || !(b & bit_AVX2)) {
+        return Level::sse2;
+    }
+    constexpr unsigned avx512 = bit_AVX512F | bit_AVX512CD | bit_AVX512BW |
+                                bit_AVX512DQ | bit_AVX512VL;
+    if ((xcr0 & zmm_state) != zmm_state || (b & avx512) != avx512) {
+        return Level::avx2;
+    }
+    return Level::avx512;
+#else
+    return Level::scalar;
+#endif
+}
+
+/// Returns `detect()`, lowered to `ALGO_SIMD` if that is set to a lower
+/// level. Computed once.
+inline Level level() noexcept {
+    static const Level cached = [] {
+        const Level supported = detect();
+        const char* env = std::getenv("ALGO_SIMD");
+        if (env == nullptr) {
+            return supported;
+        }
+        for (Level l : {Level::scalar, Level::sse2, Level::avx2}) {
+            if (name(l) == env && l < supported) {
+                return l;
+            }
+        }
+        return supported;
+    }();
+    return cached;
+}
+
+template <typename Signature>
+class Dispatch;
+
+/// A function with one implementation per level, called through a pointer
+/// to the best one for `level()`, resolved on the first call.
+///
+/// Null implementations fall back to the next level down; the scalar one is
+/// required. The constructor is `constexpr`, so a `Dispatch` at namespace
+/// scope is initialized before any code runs.
+///
+/// # Example
+///
+/// ```cpp
+/// __attribute__((target("avx2"))) int sumAvx2(const int* p, size_t n);
+/// int sumScalar(const int* p, size_t n);
+///
+/// inline const simd::Dispatch<int(const int*, size_t)> sum(
+///     sumScalar, nullptr, sumAvx2);
+/// int s = sum(data, n);
+/// ```
+template <typename R, typename... Args>
+class Dispatch<R(Args...)> {
+public:
+    using Function = R (*)(Args...);
+
+public:
+    constexpr Dispatch(Function scalar, Function sse2 = nullptr,
+                       Function avx2 = nullptr,
+                       Function avx512 = nullptr) noexcept
+        : functions_{scalar, sse2, avx2, avx512} {}
+
+    Dispatch(const Dispatch&) = delete;
+    Dispatch& operator=(const Dispatch&) = delete;
+
+    /// Calls the implementation for `level()`.
+    R operator()(Args... args) const {
+        Function f = resolved_.load(std::memory_order_relaxed);
+        if (f == nullptr) {
+            // Racing threads store the same pointer.
+            f = get(level());
+            resolved_.store(f, std::memory_order_relaxed);
+        }
+        return f(std::forward<Args>(args)...);
+    }
+
+    /// Returns the implementation used at `l`: the one of the highest level
+    /// at most `l` that has one. Calling it is only safe if `l <= detect()`.
+    Function get(Level l) const noexcept {
+        for (int i = int(l); i > 0; --i) {
+            if (functions_[i] != nullptr) {
+                return functions_[i];
+            }
+        }
+        return functions_[0];
+    }
+
+private:
+    Function functions_[4];
+    mutable std::atomic<Function> resolved_{nullptr};
+};
+} // namespace simd
+} // namespace algo
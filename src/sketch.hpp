@@ -0,0 +1,589 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "cache.hpp"
+#include "heap.hpp"
+#include "vector.hpp"
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace algo {
+namespace detail {
+// Stores `max(dst[i], src[i])` into `dst[i]` for `i < n`.
+inline void maxBytes(std::uint8_t* dst, const std::uint8_t* src,
+                     std::size_t n) noexcept {
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 32 <= n; i += 32) {
+        const __m256i a =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        const __m256i b =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+                            _mm256_max_epu8(a, b));
+    }
+#elif defined(__SSE2__)
+    for (; i + 16 <= n; i += 16) {
+        const __m128i a =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        const __m128i b =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                         _mm_max_epu8(a, b));
+    }
+#endif
+    for (; i < n; ++i) {
+        dst[i] = std::max(dst[i], src[i]);
+    }
+}
+
+// The series of Ertl's improved HyperLogLog estimator: `sigma` corrects for
+// empty registers and `tau` for saturated ones.
+inline double hllSigma(double x) noexcept {
+    if (x == 1.0) {
+        return std::numeric_limits<double>::infinity();
+    }
+    double y = 1.0;
+    double z = x;
+    for (;;) {
+        x *= x;
+        const double prev = z;
+        z += x * y;
+        y += y;
+        if (z == prev) {
+            return z;
+        }
+    }
+}
+
+inline double hllTau(double x) noexcept {
+    if (x == 0.0 || x == 1.0) {
+        return 0.0;
+    }
+    double y = 1.0;
+    double z = 1.0 - x;
+    for (;;) {
+        x = std::sqrt(x);
+        const double prev = z;
+        y *= 0.5;
+        z -= (1.0 - x) * (1.0 - x) * y;
+        if (z == prev) {
+            return z / 3.0;
+        }
+    }
+}
+} // namespace detail
+
+/// A HyperLogLog counter estimating the number of distinct keys.
+///
+/// Each key is hashed to 64 bits; the top `precision` bits select one of the
+/// `2^precision` one-byte registers, which keeps the longest run of leading
+/// zeros seen in the remaining bits. The relative standard error is about
+/// `1.04 / sqrt(2^precision)`, e.g. 0.8% for the default 16 KiB.
+///
+/// Counters with the same precision merge by taking the register-wise
+/// maximum, 32 registers per instruction with AVX2. `estimate()` uses Ertl's
+/// improved estimator over the register histogram, which needs no empirical
+/// bias correction at any cardinality.
+///
+/// # Example
+///
+/// ```cpp
+/// HyperLogLog<std::string> users;
+/// users.add("alice");
+/// users.add("bob");
+/// users.add("alice");
+/// assert(std::round(users.estimate()) == 2);
+/// ```
+template <typename K, typename Hash = std::hash<K>>
+class HyperLogLog {
+public:
+    using KeyType = K;
+    using HasherType = Hash;
+    using SizeType = std::size_t;
+
+    /// The smallest and largest supported precisions.
+    static constexpr unsigned min_precision = 4;
+    static constexpr unsigned max_precision = 18;
+
+    /// Constructs an empty counter with `2^precision` registers.
+    ///
+    /// Throws `std::invalid_argument` if `precision` is outside
+    /// `[min_precision, max_precision]`.
+    explicit HyperLogLog(unsigned precision = 14, const Hash& hash = Hash())
+        : hash_(hash), precision_(precision) {
+        if (precision < min_precision || precision > max_precision) {
+            throw std::invalid_argument("HyperLogLog: precision out of range");
+        }
+        registers_.assign(SizeType(1) << precision, 0);
+    }
+
+    /// Returns the number of index bits.
+    [[nodiscard]] unsigned precision() const noexcept {
+        return precision_;
+    }
+
+    /// Returns the registers, one byte each.
+    const Vector<std::uint8_t>& registers() const noexcept {
+        return registers_;
+    }
+
+    /// Adds `key`.
+    void add(const K& key) {
+        add_hash(detail::mixHash(hash_(key)));
+    }
+
+    /// Adds every key in `[first, last)`.
+    template <
+        typename InputIt,
+        std::enable_if_t<std::is_convertible_v<typename std::iterator_traits<
+                                                   InputIt>::iterator_category,
+                                               std::input_iterator_tag>,
+                         int> = 0>
+    void add(InputIt first, InputIt last) {
+        for (; first != last; ++first) {
+            add(*first);
+        }
+    }
+
+    /// Adds a key by its well-mixed 64-bit hash.
+    void add_hash(std::uint64_t h) noexcept {
+        const std::uint64_t rest = h << precision_;
+        const std::uint8_t rank = std::uint8_t(
+            rest == 0 ? 64 - precision_ + 1 : __builtin_clzll(rest) + 1);
+        std::uint8_t& r = registers_[SizeType(h >> (64 - precision_))];
+        r = std::max(r, rank);
+    }
+
+    /// Returns the estimated number of distinct keys added.
+    [[nodiscard]] double estimate() const noexcept {
+        const unsigned q = 64 - precision_;
+        // Four interleaved histograms keep the increments independent.
+        SizeType hist[4][64 + 2] = {};
+        const SizeType m = registers_.size();
+        for (SizeType i = 0; i < m; i += 4) {
+            ++hist[0][registers_[i]];
+            ++hist[1][registers_[i + 1]];
+            ++hist[2][registers_[i + 2]];
+            ++hist[3][registers_[i + 3]];
+        }
+        double count[64 + 2];
+        for (unsigned k = 0; k <= q + 1; ++k) {
+            count[k] =
+                double(hist[0][k] + hist[1][k] + hist[2][k] + hist[3][k]);
+        }
+
+        const double md = double(m);
+        double z = md * detail::hllTau(1.0 - count[q + 1] / md);
+        for (unsigned k = q; k >= 1; --k) {
+            z = 0.5 * (z + count[k]);
+        }
+        z += md * detail::hllSigma(count[0] / md);
+        return md * md / (2.0 * std::log(2.0) * z);
+    }
+
+    /// Adds the keys counted by `other`.
+    ///
+    /// Throws `std::invalid_argument` if the precisions differ.
+    void merge(const HyperLogLog& other) {
+        if (other.precision_ != precision_) {
+            throw std::invalid_argument("HyperLogLog: precision mismatch");
+        }
+        detail::maxBytes(registers_.data(), other.registers_.data(),
+                         registers_.size());
+    }
+
+    /// Forgets all keys.
+    void clear() noexcept {
+        std::fill(registers_.begin(), registers_.end(), std::uint8_t(0));
+    }
+
+private:
+    Vector<std::uint8_t> registers_;
+    Hash hash_;
+    unsigned precision_;
+};
+
+/// A Count-Min sketch estimating how often each key was added.
+///
+/// The sketch has `depth` rows of `width` counters, and every key increments
+/// one counter per row chosen by double hashing. An estimate is the minimum
+/// over the rows, which never undercounts and overcounts by at most
+/// `e / width` of the total with probability `1 - exp(-depth)`.
+///
+/// Updates are conservative: only the counters below the new estimate are
+/// raised, which keeps the same guarantee with much smaller overcounts for
+/// skewed streams. Rows start on 64-byte boundaries, and the batch `add()`
+/// hashes a group of keys and prefetches all of their counters before
+/// updating any, so the cache misses overlap.
+///
+/// Sketches of the same shape merge by adding counters; the sum of
+/// conservatively updated sketches still never undercounts.
+///
+/// # Example
+///
+/// ```cpp
+/// CountMinSketch<std::string> sketch(1024, 4);
+/// sketch.add("GET /", 3);
+/// sketch.add("POST /login");
+/// assert(sketch.estimate("GET /") >= 3);
+/// ```
+template <typename K, typename Hash = std::hash<K>>
+class CountMinSketch {
+public:
+    using KeyType = K;
+    using HasherType = Hash;
+    using SizeType = std::size_t;
+
+    /// Constructs an empty sketch of `depth` rows of at least `width`
+    /// counters. The width is rounded up to a power of two no less than 8.
+    ///
+    /// Throws `std::invalid_argument` if `width` or `depth` is zero or
+    /// `width` exceeds `2^31`.
+    CountMinSketch(SizeType width, SizeType depth, const Hash& hash = Hash())
+        : hash_(hash), depth_(depth) {
+        if (width == 0 || depth == 0 || width > (SizeType(1) << 31)) {
+            throw std::invalid_argument("CountMinSketch: bad dimensions");
+        }
+        width_ = 8;
+        while (width_ < width) {
+            width_ *= 2;
+        }
+        lines_.assign(depth_ * width_ / 8, Line{});
+    }
+
+    /// Returns the number of counters per row.
+    [[nodiscard]] SizeType width() const noexcept {
+        return width_;
+    }
+
+    /// Returns the number of rows.
+    [[nodiscard]] SizeType depth() const noexcept {
+        return depth_;
+    }
+
+    /// Returns the sum of all added counts.
+    [[nodiscard]] std::uint64_t total() const noexcept {
+        return total_;
+    }
+
+    /// Adds `count` occurrences of `key`.
+    void add(const K& key, std::uint64_t count = 1) {
+        addHash(detail::mixHash(hash_(key)), count);
+    }
+
+    /// Adds one occurrence of every key in `[first, last)`.
+    template <
+        typename InputIt,
+        std::enable_if_t<std::is_convertible_v<typename std::iterator_traits<
+                                                   InputIt>::iterator_category,
+                                               std::input_iterator_tag>,
+                         int> = 0>
+    void add(InputIt first, InputIt last) {
+        constexpr SizeType group = 16;
+        std::uint64_t hashes[group];
+        while (first != last) {
+            SizeType n = 0;
+            for (; n < group && first != last; ++n, ++first) {
+                hashes[n] = detail::mixHash(hash_(*first));
+                for (SizeType row = 0; row < depth_; ++row) {
+                    __builtin_prefetch(&counter(row, column(hashes[n], row)),
+                                       1);
+                }
+            }
+            for (SizeType i = 0; i < n; ++i) {
+                addHash(hashes[i], 1);
+            }
+        }
+    }
+
+    /// Returns an upper bound on the occurrences of `key`.
+    [[nodiscard]] std::uint64_t estimate(const K& key) const {
+        const std::uint64_t h = detail::mixHash(hash_(key));
+        std::uint64_t result = std::numeric_limits<std::uint64_t>::max();
+        for (SizeType row = 0; row < depth_; ++row) {
+            result = std::min(result, counter(row, column(h, row)));
+        }
+        return result;
+    }
+
+    /// Adds the counts of `other`.
+    ///
+    /// Throws `std::invalid_argument` if the shapes differ.
+    void merge(const CountMinSketch& other) {
+        if (other.width_ != width_ || other.depth_ != depth_) {
+            throw std::invalid_argument("CountMinSketch: shape mismatch");
+        }
+        for (SizeType i = 0; i < lines_.size(); ++i) {
+            for (SizeType j = 0; j < 8; ++j) {
+                lines_[i].counts[j] += other.lines_[i].counts[j];
+            }
+        }
+        total_ += other.total_;
+    }
+
+    /// Resets all counters.
+    void clear() noexcept {
+        std::fill(lines_.begin(), lines_.end(), Line{});
+        total_ = 0;
+    }
+
+private:
+    SizeType column(std::uint64_t h, SizeType row) const noexcept {
+        const std::uint32_t h1 = std::uint32_t(h);
+        const std::uint32_t h2 = std::uint32_t(h >> 32) | 1;
+        return SizeType(h1 + std::uint32_t(row) * h2) & (width_ - 1);
+    }
+
+    std::uint64_t& counter(SizeType row, SizeType col) noexcept {
+        return lines_[(row * width_ + col) / 8].counts[col % 8];
+    }
+
+    const std::uint64_t& counter(SizeType row, SizeType col) const noexcept {
+        return lines_[(row * width_ + col) / 8].counts[col % 8];
+    }
+
+    void addHash(std::uint64_t h, std::uint64_t count) noexcept {
+        std::uint64_t low = std::numeric_limits<std::uint64_t>::max();
+        for (SizeType row = 0; row < depth_; ++row) {
+            low = std::min(low, counter(row, column(h, row)));
+        }
+        const std::uint64_t target = low + count;
+        for (SizeType row = 0; row < depth_; ++row) {
+            std::uint64_t& c = counter(row, column(h, row));
+            c = std::max(c, target);
+        }
+        total_ += count;
+    }
+
+private:
+    // One cache line of counters.
+    struct alignas(64) Line {
+        std::uint64_t counts[8];
+    };
+
+    Vector<Line> lines_;
+    Hash hash_;
+    SizeType width_ = 0;
+    SizeType depth_ = 0;
+    std::uint64_t total_ = 0;
+};
+
+/// The Space-Saving algorithm tracking the most frequent keys of a stream
+/// with a fixed number of counters.
+///
+/// While there is a free counter, every new key gets one. Once all are taken,
+/// a new key evicts the key with the smallest count and inherits that count,
+/// remembered as the overestimation `error`. Every key occurring more than
+/// `total() / capacity()` times is guaranteed to be tracked, and a tracked
+/// key's true count lies in `[count - error, count]`.
+///
+/// The counters live in a slab indexed by an open-addressing table, and an
+/// `IndexedDaryHeap` over the slots finds the smallest count in `O(1)` and
+/// re-sifts an incremented slot in `O(log k)`.
+///
+/// Summaries merge as described by Agarwal et al.: a key missing from one
+/// side is charged that side's minimum count, and the largest `capacity()`
+/// counts are kept.
+///
+/// # Example
+///
+/// ```cpp
+/// SpaceSaving<std::string> top(2);
+/// for (const char* k : {"a", "b", "a", "c", "a"}) {
+///     top.add(k);
+/// }
+/// assert(top.top(1)[0].key == "a");
+/// ```
+template <typename K, typename Hash = std::hash<K>,
+          typename KeyEqual = std::equal_to<K>>
+class SpaceSaving {
+public:
+    using KeyType = K;
+    using HasherType = Hash;
+    using SizeType = std::size_t;
+
+    /// A tracked key with its estimated count and maximal overestimation.
+    struct Item {
+        K key;
+        std::uint64_t count;
+        std::uint64_t error;
+    };
+
+    /// Constructs an empty summary of `capacity` counters.
+    ///
+    /// Throws `std::invalid_argument` unless `0 < capacity <= 2^30`.
+    explicit SpaceSaving(SizeType capacity, const Hash& hash = Hash(),
+                         const KeyEqual& equal = KeyEqual())
+        : index_(capacity), heap_(capacity), hash_(hash), equal_(equal),
+          capacity_(capacity) {
+        if (capacity == 0 || capacity > (SizeType(1) << 30)) {
+            throw std::invalid_argument("SpaceSaving: capacity out of range");
+        }
+        items_.reserve(capacity);
+        hashes_.reserve(capacity);
+    }
+
+    /// Returns the number of tracked keys.
+    [[nodiscard]] SizeType size() const noexcept {
+        return items_.size();
+    }
+
+    /// Returns the number of counters.
+    [[nodiscard]] SizeType capacity() const noexcept {
+        return capacity_;
+    }
+
+    /// Returns the sum of all added counts.
+    [[nodiscard]] std::uint64_t total() const noexcept {
+        return total_;
+    }
+
+    /// Adds `count` occurrences of `key`.
+    void add(const K& key, std::uint64_t count = 1) {
+        const std::uint32_t hash = hashOf(key);
+        std::uint32_t slot = lookup(key, hash);
+        if (slot == detail::SlotIndex::npos) {
+            if (items_.size() < capacity_) {
+                slot = std::uint32_t(items_.size());
+                items_.push_back(Item{key, 0, 0});
+                hashes_.push_back(hash);
+            } else {
+                // Take over the counter of the least frequent key.
+                slot = heap_.top();
+                Item& victim = items_[slot];
+                index_.erase(hashes_[slot], slot);
+                victim.key = key;
+                victim.error = victim.count;
+                hashes_[slot] = hash;
+            }
+            index_.insert(hash, slot);
+        }
+        items_[slot].count += count;
+        heap_.update(slot, items_[slot].count);
+        total_ += count;
+    }
+
+    /// Adds one occurrence of every key in `[first, last)`.
+    template <
+        typename InputIt,
+        std::enable_if_t<std::is_convertible_v<typename std::iterator_traits<
+                                                   InputIt>::iterator_category,
+                                               std::input_iterator_tag>,
+                         int> = 0>
+    void add(InputIt first, InputIt last) {
+        for (; first != last; ++first) {
+            add(*first);
+        }
+    }
+
+    /// Returns the estimated count of `key`, or zero if it is not tracked.
+    [[nodiscard]] std::uint64_t estimate(const K& key) const {
+        const std::uint32_t slot = lookup(key, hashOf(key));
+        return slot == detail::SlotIndex::npos ? 0 : items_[slot].count;
+    }
+
+    /// Returns the up to `n` tracked keys with the largest counts, largest
+    /// first.
+    [[nodiscard]] Vector<Item> top(SizeType n) const {
+        Vector<Item> result(items_);
+        sortByCount(result);
+        while (result.size() > n) {
+            result.pop_back();
+        }
+        return result;
+    }
+
+    /// Merges the summary of another stream into this one.
+    void merge(const SpaceSaving& other) {
+        const std::uint64_t own_min = minCount();
+        const std::uint64_t other_min = other.minCount();
+        Vector<Item> merged;
+        merged.reserve(items_.size() + other.items_.size());
+        for (const Item& item : items_) {
+            const std::uint32_t slot =
+                other.lookup(item.key, other.hashOf(item.key));
+            if (slot == detail::SlotIndex::npos) {
+                merged.push_back(Item{item.key, item.count + other_min,
+                                      item.error + other_min});
+            } else {
+                const Item& o = other.items_[slot];
+                merged.push_back(Item{item.key, item.count + o.count,
+                                      item.error + o.error});
+            }
+        }
+        for (const Item& o : other.items_) {
+            if (lookup(o.key, hashOf(o.key)) == detail::SlotIndex::npos) {
+                merged.push_back(
+                    Item{o.key, o.count + own_min, o.error + own_min});
+            }
+        }
+        sortByCount(merged);
+
+        const std::uint64_t total = total_ + other.total_;
+        clear();
+        for (SizeType i = 0; i < merged.size() && i < capacity_; ++i) {
+            const std::uint32_t hash = hashOf(merged[i].key);
+            const std::uint32_t slot = std::uint32_t(i);
+            items_.push_back(merged[i]);
+            hashes_.push_back(hash);
+            index_.insert(hash, slot);
+            heap_.push(slot, merged[i].count);
+        }
+        total_ = total;
+    }
+
+    /// Forgets all keys.
+    void clear() noexcept {
+        index_.clear();
+        heap_.clear();
+        items_.clear();
+        hashes_.clear();
+        total_ = 0;
+    }
+
+private:
+    std::uint32_t hashOf(const K& key) const {
+        return std::uint32_t(detail::mixHash(hash_(key)));
+    }
+
+    std::uint32_t lookup(const K& key, std::uint32_t hash) const {
+        return index_.find(hash, [&](std::uint32_t slot) {
+            return equal_(items_[slot].key, key);
+        });
+    }
+
+    // A key the summary has not seen may have occurred up to this often.
+    std::uint64_t minCount() const noexcept {
+        return items_.size() < capacity_ ? 0 : heap_.top_priority();
+    }
+
+    static void sortByCount(Vector<Item>& items) {
+        std::sort(items.begin(), items.end(),
+                  [](const Item& a, const Item& b) {
+                      return a.count > b.count;
+                  });
+    }
+
+private:
+    Vector<Item> items_;
+    Vector<std::uint32_t> hashes_;
+    detail::SlotIndex index_;
+    IndexedDaryHeap<std::uint64_t> heap_;
+    Hash hash_;
+    KeyEqual equal_;
+    SizeType capacity_;
+    std::uint64_t total_ = 0;
+};
+} // namespace algo
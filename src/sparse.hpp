@@ -0,0 +1,371 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include "vector.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace algo {
+/// A set of integers from `[0, universe())` with `O(1)` insertion, erasure,
+/// lookup and `clear()`.
+///
+/// The members are kept packed in a dense array, and a sparse array maps each
+/// possible member to its slot there. A value is a member only if the two
+/// arrays point at each other, so stale sparse entries left by `clear()` are
+/// harmless and the sparse array is never reset. Iteration walks the dense
+/// array in insertion order, except that `erase()` moves the last member into
+/// the hole.
+///
+/// # Example
+///
+/// ```cpp
+/// SparseSet visited(1000);
+/// visited.insert(42);
+/// visited.insert(7);
+/// assert(visited.contains(42));
+/// visited.clear(); // O(1)
+/// assert(!visited.contains(42));
+/// ```
+class SparseSet {
+public:
+    using ValueType = std::uint32_t;
+    using SizeType = std::size_t;
+    using ConstIterator = const ValueType*;
+
+    /// Constructs an empty set over `[0, universe)`.
+    ///
+    /// Throws `std::length_error` if `universe` exceeds `2^32`.
+    explicit SparseSet(SizeType universe = 0) {
+        reset(universe);
+    }
+
+    /// Empties the set and changes the universe to `[0, universe)` in
+    /// `O(universe)`.
+    ///
+    /// Throws `std::length_error` if `universe` exceeds `2^32`.
+    void reset(SizeType universe) {
+        if (universe > (SizeType(1) << 32)) {
+            throw std::length_error("SparseSet: universe too large");
+        }
+        sparse_.assign(universe, 0);
+        dense_.clear();
+        dense_.reserve(universe);
+    }
+
+    /// Returns the size of the universe.
+    [[nodiscard]] SizeType universe() const noexcept {
+        return sparse_.size();
+    }
+
+    /// Returns the number of members.
+    [[nodiscard]] SizeType size() const noexcept {
+        return dense_.size();
+    }
+
+    /// Returns true if the set is empty.
+    [[nodiscard]] bool empty() const noexcept {
+        return dense_.empty();
+    }
+
+    /// Returns true if `x` is a member.
+    [[nodiscard]] bool contains(ValueType x) const noexcept {
+        assert(x < universe());
+        const ValueType slot = sparse_[x];
+        return slot < dense_.size() && dense_[slot] == x;
+    }
+
+    /// Inserts `x`, returning false if it was already a member.
+    bool insert(ValueType x) noexcept {
+        if (contains(x)) {
+            return false;
+        }
+        sparse_[x] = ValueType(dense_.size());
+        // The dense array was reserved for the whole universe.
+        dense_.push_back(x);
+        return true;
+    }
+
+    /// Erases `x`, returning false if it was not a member.
+    bool erase(ValueType x) noexcept {
+        if (!contains(x)) {
+            return false;
+        }
+        const ValueType last = dense_.back();
+        dense_[sparse_[x]] = last;
+        sparse_[last] = sparse_[x];
+        dense_.pop_back();
+        return true;
+    }
+
+    /// Removes all members in `O(1)`.
+    void clear() noexcept {
+        dense_.clear();
+    }
+
+    /// Returns the members as a contiguous array.
+    const ValueType* data() const noexcept {
+        return dense_.data();
+    }
+
+    /// Returns an iterator to the first member.
+    ConstIterator begin() const noexcept {
+        return dense_.data();
+    }
+
+    /// Returns an iterator past the last member.
+    ConstIterator end() const noexcept {
+        return dense_.data() + dense_.size();
+    }
+
+private:
+    Vector<ValueType> dense_;
+    Vector<ValueType> sparse_;
+};
+
+/// A sparse vector of `T` stored as sorted indices and their values.
+///
+/// `dot()` of two sparse vectors intersects the index lists: when their
+/// lengths are similar, four indices of each side are compared all-pairs with
+/// SSE2 and the block with the smaller maximum advances; when one is much
+/// shorter, it gallops through the other. `axpy()` merges into a sparse or
+/// scatters into a dense vector.
+///
+/// # Example
+///
+/// ```cpp
+/// SparseVector<double> x, y;
+/// x.push_back(1, 2.0);
+/// x.push_back(5, 3.0);
+/// y.push_back(5, 4.0);
+/// assert(dot(x, y) == 12.0);
+/// axpy(2.0, x, y); // y = {1: 4, 5: 10}
+/// ```
+template <typename T>
+class SparseVector {
+public:
+    using ValueType = T;
+    using IndexType = std::uint32_t;
+    using SizeType = std::size_t;
+
+    /// Constructs a vector with no entries.
+    SparseVector() = default;
+
+    /// Constructs a vector from parallel arrays of indices and values.
+    ///
+    /// Throws `std::invalid_argument` if the arrays differ in length or the
+    /// indices are not strictly increasing.
+    SparseVector(Vector<IndexType> indices, Vector<T> values)
+        : indices_(std::move(indices)), values_(std::move(values)) {
+        if (indices_.size() != values_.size()) {
+            throw std::invalid_argument("SparseVector: length mismatch");
+        }
+        for (SizeType i = 1; i < indices_.size(); ++i) {
+            if (indices_[i] <= indices_[i - 1]) {
+                throw std::invalid_argument(
+                    "SparseVector: indices are not increasing");
+            }
+        }
+    }
+
+    /// Returns the number of stored entries.
+    [[nodiscard]] SizeType nnz() const noexcept {
+        return indices_.size();
+    }
+
+    /// Returns true if there are no stored entries.
+    [[nodiscard]] bool empty() const noexcept {
+        return indices_.empty();
+    }
+
+    /// Returns the sorted indices of the stored entries.
+    const Vector<IndexType>& indices() const noexcept {
+        return indices_;
+    }
+
+    /// Returns the values of the stored entries.
+    const Vector<T>& values() const noexcept {
+        return values_;
+    }
+
+    /// Appends the entry `(index, value)`.
+    ///
+    /// Throws `std::invalid_argument` unless `index` is greater than every
+    /// stored index.
+    void push_back(IndexType index, const T& value) {
+        if (!indices_.empty() && index <= indices_.back()) {
+            throw std::invalid_argument(
+                "SparseVector: indices are not increasing");
+        }
+        indices_.push_back(index);
+        values_.push_back(value);
+    }
+
+    /// Returns the value at `index`, which is zero unless stored.
+    [[nodiscard]] T get(IndexType index) const noexcept {
+        const auto it =
+            std::lower_bound(indices_.begin(), indices_.end(), index);
+        return it != indices_.end() && *it == index
+                   ? values_[SizeType(it - indices_.begin())]
+                   : T();
+    }
+
+    /// Removes all entries.
+    void clear() noexcept {
+        indices_.clear();
+        values_.clear();
+    }
+
+    /// Exchanges the contents with `other`.
+    void swap(SparseVector& other) noexcept {
+        indices_.swap(other.indices_);
+        values_.swap(other.values_);
+    }
+
+private:
+    Vector<IndexType> indices_;
+    Vector<T> values_;
+};
+
+namespace detail {
+// Calls `f(i, j)` for every pair with `a[i] == b[j]` of the strictly
+// increasing arrays `a` and `b`.
+template <typename F>
+void forEachCommon(const std::uint32_t* a, std::size_t na,
+                   const std::uint32_t* b, std::size_t nb, F&& f) {
+    // Gallop through the longer array when the sizes are very different.
+    if (na * 32 < nb || nb * 32 < na) {
+        const bool swapped = na > nb;
+        if (swapped) {
+            std::swap(a, b);
+            std::swap(na, nb);
+        }
+        std::size_t lo = 0;
+        for (std::size_t i = 0; i < na && lo < nb; ++i) {
+            std::size_t step = 1;
+            std::size_t hi = lo;
+            while (hi < nb && b[hi] < a[i]) {
+                lo = hi;
+                hi = std::min(hi + step, nb);
+                step *= 2;
+            }
+            lo = std::size_t(std::lower_bound(b + lo, b + hi, a[i]) - b);
+            if (lo < nb && b[lo] == a[i]) {
+                swapped ? f(lo, i) : f(i, lo);
+            }
+        }
+        return;
+    }
+
+    std::size_t i = 0;
+    std::size_t j = 0;
+#if defined(__SSE2__)
+    // Comparing `a` with the four rotations of `b` finds all equal pairs of
+    // two blocks of four.
+    const std::size_t ea = na / 4 * 4;
+    const std::size_t eb = nb / 4 * 4;
+    while (i < ea && j < eb) {
+        const __m128i va =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        const __m128i vb =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+        const __m128i rotated[4] = {
+            vb, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1)),
+            _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2)),
+            _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3))};
+        for (std::size_t r = 0; r < 4; ++r) {
+            unsigned mask = unsigned(_mm_movemask_ps(
+                _mm_castsi128_ps(_mm_cmpeq_epi32(va, rotated[r]))));
+            while (mask != 0) {
+                const std::size_t lane = std::size_t(__builtin_ctz(mask));
+                f(i + lane, j + ((lane + r) & 3));
+                mask &= mask - 1;
+            }
+        }
+        const std::uint32_t amax = a[i + 3];
+        const std::uint32_t bmax = b[j + 3];
+        i += amax <= bmax ? 4 : 0;
+        j += bmax <= amax ? 4 : 0;
+    }
+#endif
+    while (i < na && j < nb) {
+        if (a[i] < b[j]) {
+            ++i;
+        } else if (b[j] < a[i]) {
+            ++j;
+        } else {
+            f(i++, j++);
+        }
+    }
+}
+} // namespace detail
+
+/// Returns the dot product of two sparse vectors.
+template <typename T>
+T dot(const SparseVector<T>& x, const SparseVector<T>& y) {
+    const T* xv = x.values().data();
+    const T* yv = y.values().data();
+    T sum = T();
+    detail::forEachCommon(x.indices().data(), x.nnz(), y.indices().data(),
+                          y.nnz(), [&](std::size_t i, std::size_t j) {
+                              sum += xv[i] * yv[j];
+                          });
+    return sum;
+}
+
+/// Returns the dot product of `x` with the dense vector `y`, which must be
+/// longer than every index of `x`.
+template <typename T>
+T dot(const SparseVector<T>& x, const T* y) noexcept {
+    const std::uint32_t* idx = x.indices().data();
+    const T* xv = x.values().data();
+    T sum = T();
+    for (std::size_t i = 0; i < x.nnz(); ++i) {
+        sum += xv[i] * y[idx[i]];
+    }
+    return sum;
+}
+
+/// Computes `y = alpha * x + y`, adding entries to `y` where only `x` has
+/// them.
+template <typename T>
+void axpy(const T& alpha, const SparseVector<T>& x, SparseVector<T>& y) {
+    const Vector<std::uint32_t>& xi = x.indices();
+    const Vector<std::uint32_t>& yi = y.indices();
+    Vector<std::uint32_t> indices;
+    Vector<T> values;
+    indices.reserve(xi.size() + yi.size());
+    values.reserve(xi.size() + yi.size());
+    std::size_t i = 0;
+    std::size_t j = 0;
+    while (i < xi.size() || j < yi.size()) {
+        if (j == yi.size() || (i < xi.size() && xi[i] < yi[j])) {
+            indices.push_back(xi[i]);
+            values.push_back(alpha * x.values()[i++]);
+        } else if (i == xi.size() || yi[j] < xi[i]) {
+            indices.push_back(yi[j]);
+            values.push_back(y.values()[j++]);
+        } else {
+            indices.push_back(xi[i]);
+            values.push_back(alpha * x.values()[i++] + y.values()[j++]);
+        }
+    }
+    SparseVector<T>(std::move(indices), std::move(values)).swap(y);
+}
+
+/// Computes `y = alpha * x + y` for the dense vector `y`, which must be
+/// longer than every index of `x`.
+template <typename T>
+void axpy(const T& alpha, const SparseVector<T>& x, T* y) noexcept {
+    const std::uint32_t* idx = x.indices().data();
+    const T* xv = x.values().data();
+    for (std::size_t i = 0; i < x.nnz(); ++i) {
+        y[idx[i]] += alpha * xv[i];
+    }
+}
+} // namespace algo
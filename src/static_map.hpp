@@ -0,0 +1,351 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include "cache.hpp"
+#include "vector.hpp"
+
+namespace algo {
+/// The size argument of a `StaticMap` whose keys are only known at run time.
+inline constexpr std::size_t dynamic_size = std::size_t(-1);
+
+namespace detail {
+template <typename K>
+inline constexpr bool is_string_key_v =
+    std::is_convertible_v<const K&, std::string_view> && !std::is_pointer_v<K>;
+
+// Hashes a key in constant expressions too, where `std::hash` is not
+// available. Strings go through FNV-1a first.
+template <typename K>
+constexpr std::uint64_t staticHash(const K& key, std::uint64_t seed) noexcept {
+    if constexpr (is_string_key_v<K>) {
+        const std::string_view s = key;
+        std::uint64_t h = 0xcbf29ce484222325ULL ^ seed;
+        for (char c : s) {
+            h = (h ^ std::uint8_t(c)) * 0x100000001b3ULL;
+        }
+        return mixHash(std::size_t(h));
+    } else if constexpr (std::is_enum_v<K>) {
+        using U = std::make_unsigned_t<std::underlying_type_t<K>>;
+        return mixHash(std::size_t(U(key)) ^ seed);
+    } else {
+        return mixHash(std::size_t(std::make_unsigned_t<K>(key)) ^ seed);
+    }
+}
+
+// Slots per key and keys per bucket of a `StaticMap`: a table 80% full and
+// two keys per pilot leave every bucket many pilots that fit.
+constexpr std::size_t staticMapSlots(std::size_t n) noexcept {
+    return n + n / 4 + 1;
+}
+
+constexpr std::size_t staticMapBuckets(std::size_t n) noexcept {
+    return n / 2 + 1;
+}
+
+// The bucket of a key comes from the low half of its hash and the slot from
+// the high half, so that keys of a bucket move independently of each other
+// as the pilot changes.
+constexpr std::size_t staticMapBucket(std::uint64_t h,
+                                      std::size_t buckets) noexcept {
+    return std::size_t(((h & 0xFFFFFFFFULL) * buckets) >> 32);
+}
+
+constexpr std::size_t staticMapSlot(std::uint64_t h, std::uint8_t pilot,
+                                    std::size_t slots) noexcept {
+    const std::uint64_t x = h ^ (0x517cc1b727220a95ULL * pilot);
+    return std::size_t(((x >> 32) * slots) >> 32);
+}
+
+// Picks a pilot for every bucket so that the `n` keys with hashes `hashes`
+// land in distinct slots, placing the largest buckets first while the table
+// is emptiest. `order` and `starts` receive the keys grouped by bucket and
+// `taken` the occupied slots. Returns false if some bucket fits no pilot.
+// Throws `std::invalid_argument` if that is because `key(i)` repeats.
+template <typename KeyAt>
+constexpr bool findPilots(const std::uint64_t* hashes, std::size_t n,
+                          KeyAt key, std::size_t slots, std::size_t buckets,
+                          std::uint32_t* order, std::uint32_t* starts,
+                          bool* taken, std::uint8_t* pilots) {
+    for (std::size_t b = 0; b <= buckets; ++b) {
+        starts[b] = 0;
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+        ++starts[staticMapBucket(hashes[i], buckets) + 1];
+    }
+    std::uint32_t largest = 0;
+    for (std::size_t b = 0; b < buckets; ++b) {
+        largest = std::max(largest, starts[b + 1]);
+        starts[b + 1] += starts[b];
+    }
+    // Filling each bucket from its end moves `starts[b + 1]` back to the
+    // start of bucket `b`.
+    for (std::size_t i = 0; i < n; ++i) {
+        const std::size_t b = staticMapBucket(hashes[i], buckets);
+        order[--starts[b + 1]] = std::uint32_t(i);
+    }
+    for (std::size_t b = 0; b < buckets; ++b) {
+        starts[b] = starts[b + 1];
+    }
+    starts[buckets] = std::uint32_t(n);
+    for (std::size_t s = 0; s < slots; ++s) {
+        taken[s] = false;
+    }
+
+    for (std::uint32_t size = largest; size > 0; --size) {
+        for (std::size_t b = 0; b < buckets; ++b) {
+            const std::uint32_t first = starts[b];
+            const std::uint32_t last = starts[b + 1];
+            if (last - first != size) {
+                continue;
+            }
+            bool placed = false;
+            for (unsigned pilot = 0; pilot < 256 && !placed; ++pilot) {
+                std::uint32_t j = first;
+                while (j < last) {
+                    const std::size_t s = staticMapSlot(
+                        hashes[order[j]], std::uint8_t(pilot), slots);
+                    if (taken[s]) {
+                        break;
+                    }
+                    taken[s] = true;
+                    ++j;
+                }
+                placed = j == last;
+                while (!placed && j-- > first) {
+                    taken[staticMapSlot(hashes[order[j]], std::uint8_t(pilot),
+                                        slots)] = false;
+                }
+                if (placed) {
+                    pilots[b] = std::uint8_t(pilot);
+                }
+            }
+            if (placed) {
+                continue;
+            }
+            for (std::uint32_t i = first; i < last; ++i) {
+                for (std::uint32_t j = i + 1; j < last; ++j) {
+                    if (hashes[order[i]] == hashes[order[j]] &&
+                        key(order[i]) == key(order[j])) {
+                        throw std::invalid_argument("StaticMap: duplicate key");
+                    }
+                }
+            }
+            return false;
+        }
+    }
+    return true;
+}
+} // namespace detail
+
+/// An immutable hash map whose lookups take one hash, one probe and one key
+/// comparison, and never collide.
+///
+/// The map is a perfect hash table in the manner of PtrHash: keys are split
+/// into buckets of about two by hash, and every bucket gets a one byte pilot
+/// which, mixed into the hash of its keys, sends each of them to a slot of
+/// its own. A lookup hashes the key, reads the pilot of its bucket and
+/// compares the one entry it selects. The entries sit in a flat array 25%
+/// larger than the key set, next to a pilot array of half a byte per key.
+///
+/// `StaticMap<K, V, N>` holds `N` keys in `std::array`s and is built in a
+/// constant expression from an initializer list, so the table is computed at
+/// compile time. `StaticMap<K, V>` is built at run time from `Vector`s of keys
+/// and values, for large sets that rarely change.
+///
+/// Keys are integers, enumerations or strings, `std::string_view` for
+/// `constexpr` maps; string keys are looked up by `std::string_view`.
+///
+/// # Example
+///
+/// ```cpp
+/// constexpr StaticMap<std::string_view, int, 3> methods = {
+///     {"GET", 1}, {"PUT", 2}, {"HEAD", 3}};
+/// static_assert(*methods.find("PUT") == 2);
+/// static_assert(!methods.contains("POST"));
+///
+/// StaticMap<std::uint64_t, std::uint32_t> ids(keys, values);
+/// const std::uint32_t* v = ids.find(42);
+/// ```
+template <typename K, typename V, std::size_t N = dynamic_size>
+class StaticMap {
+    static_assert(std::is_integral_v<K> || std::is_enum_v<K> ||
+                      detail::is_string_key_v<K>,
+                  "StaticMap needs integer, enum or string keys");
+
+    static constexpr bool dynamic = N == dynamic_size;
+    static constexpr std::size_t slot_count =
+        dynamic ? 0 : detail::staticMapSlots(N);
+    static constexpr std::size_t bucket_count =
+        dynamic ? 0 : detail::staticMapBuckets(N);
+    static constexpr std::size_t key_count = dynamic ? 0 : N;
+
+    template <typename T, std::size_t Size>
+    using Storage =
+        std::conditional_t<dynamic, Vector<T>, std::array<T, Size>>;
+
+public:
+    using KeyType = K;
+    using MappedType = V;
+    using SizeType = std::size_t;
+    using LookupType =
+        std::conditional_t<detail::is_string_key_v<K>, std::string_view, K>;
+
+    /// A key and its value.
+    struct Entry {
+        K key;
+        V value;
+    };
+
+public:
+    /// Builds the map of `entries`.
+    ///
+    /// Throws `std::invalid_argument` if a key repeats or, for a fixed `N`,
+    /// if there are not `N` entries. In a constant expression either is a
+    /// compile error.
+    constexpr StaticMap(std::initializer_list<Entry> entries) {
+        const Entry* first = entries.begin();
+        build(
+            entries.size(),
+            [first](std::size_t i) -> const K& { return first[i].key; },
+            [first](std::size_t i) -> const V& { return first[i].value; });
+    }
+
+    /// Builds the map of `entries`, which may be generated by a `constexpr`
+    /// function.
+    ///
+    /// Throws `std::invalid_argument` as the initializer list constructor.
+    template <std::size_t M>
+    constexpr explicit StaticMap(const std::array<Entry, M>& entries) {
+        const Entry* first = entries.data();
+        build(
+            M, [first](std::size_t i) -> const K& { return first[i].key; },
+            [first](std::size_t i) -> const V& { return first[i].value; });
+    }
+
+    /// Builds the map of `keys[i]` to `values[i]`.
+    ///
+    /// Throws `std::invalid_argument` if the sizes differ, a key repeats or,
+    /// for a fixed `N`, there are not `N` keys, and `std::length_error` if
+    /// there are more than 2^32 / 1.25 keys.
+    StaticMap(const Vector<K>& keys, const Vector<V>& values) {
+        if (keys.size() != values.size()) {
+            throw std::invalid_argument("StaticMap: size mismatch");
+        }
+        build(
+            keys.size(), [&keys](std::size_t i) -> const K& { return keys[i]; },
+            [&values](std::size_t i) -> const V& { return values[i]; });
+    }
+
+    /// Returns the value of `key`, or null if `key` is not in the map.
+    constexpr const V* find(const LookupType& key) const noexcept {
+        if (size_ == 0) {
+            return nullptr;
+        }
+        const std::uint64_t h = detail::staticHash(key, seed_);
+        const std::size_t bucket = detail::staticMapBucket(h, pilots_.size());
+        const Entry& e = entries_[detail::staticMapSlot(h, pilots_[bucket],
+                                                        entries_.size())];
+        return e.key == key ? &e.value : nullptr;
+    }
+
+    /// Returns true if `key` is in the map.
+    constexpr bool contains(const LookupType& key) const noexcept {
+        return find(key) != nullptr;
+    }
+
+    /// Returns the value of `key`.
+    ///
+    /// Throws `std::out_of_range` if `key` is not in the map.
+    constexpr const V& at(const LookupType& key) const {
+        const V* v = find(key);
+        if (v == nullptr) {
+            throw std::out_of_range("StaticMap::at: no such key");
+        }
+        return *v;
+    }
+
+    /// Returns the number of keys.
+    constexpr SizeType size() const noexcept {
+        return size_;
+    }
+
+    /// Returns true if the map has no keys.
+    constexpr bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+private:
+    template <typename T, std::size_t Size>
+    static constexpr Storage<T, Size> makeStorage(std::size_t n) {
+        if constexpr (dynamic) {
+            return Vector<T>(n, T());
+        } else {
+            return Storage<T, Size>{};
+        }
+    }
+
+    template <typename KeyAt, typename ValueAt>
+    constexpr void build(std::size_t n, KeyAt key, ValueAt value) {
+        if (!dynamic && n != N) {
+            throw std::invalid_argument("StaticMap: wrong number of keys");
+        }
+        const std::size_t slots = detail::staticMapSlots(n);
+        if (slots > std::numeric_limits<std::uint32_t>::max()) {
+            throw std::length_error("StaticMap: too many keys");
+        }
+        const std::size_t buckets = detail::staticMapBuckets(n);
+        auto hashes = makeStorage<std::uint64_t, key_count>(n);
+        auto order = makeStorage<std::uint32_t, key_count>(n);
+        auto starts = makeStorage<std::uint32_t, bucket_count + 1>(buckets + 1);
+        auto taken = makeStorage<bool, slot_count>(slots);
+        entries_ = makeStorage<Entry, slot_count>(slots);
+        pilots_ = makeStorage<std::uint8_t, bucket_count>(buckets);
+        size_ = n;
+
+        // A seed fails only if two keys of a bucket share the high half of
+        // their hashes, or the pilots run out; each try is independent.
+        constexpr std::uint64_t max_seeds = 64;
+        for (std::uint64_t attempt = 1;; ++attempt) {
+            if (attempt > max_seeds) {
+                throw std::runtime_error("StaticMap: no perfect hash found");
+            }
+            seed_ = detail::mixHash(std::size_t(attempt));
+            for (std::size_t i = 0; i < n; ++i) {
+                hashes[i] = detail::staticHash(LookupType(key(i)), seed_);
+            }
+            if (detail::findPilots(hashes.data(), n, key, slots, buckets,
+                                   order.data(), starts.data(), taken.data(),
+                                   pilots_.data())) {
+                break;
+            }
+        }
+
+        // Free slots repeat the first entry, whose key only ever looks up
+        // its own slot, so that every lookup is a single comparison.
+        for (std::size_t s = 0; s < slots && n != 0; ++s) {
+            if (!taken[s]) {
+                entries_[s] = Entry{key(0), value(0)};
+            }
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::size_t bucket =
+                detail::staticMapBucket(hashes[i], buckets);
+            entries_[detail::staticMapSlot(hashes[i], pilots_[bucket],
+                                           slots)] = Entry{key(i), value(i)};
+        }
+    }
+
+private:
+    Storage<Entry, slot_count> entries_{};
+    Storage<std::uint8_t, bucket_count> pilots_{};
+    std::uint64_t seed_ = 0;
+    SizeType size_ = 0;
+};
+} // namespace algo
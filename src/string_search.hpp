@@ -0,0 +1,462 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include "vector.hpp"
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace algo {
+namespace detail {
+// Finds `needle` of length `k >= 2` by jumping between occurrences of its
+// first byte and checking the last byte before comparing the rest.
+inline std::size_t findSubstringScalar(const char* h, std::size_t n,
+                                       const char* needle,
+                                       std::size_t k) noexcept {
+    if (n < k) {
+        return std::string_view::npos;
+    }
+    const char* const begin = h;
+    const char* const last = h + (n - k);
+    while (h <= last) {
+        const auto* p = static_cast<const char*>(
+            std::memchr(h, needle[0], std::size_t(last - h) + 1));
+        if (!p) {
+            break;
+        }
+        if (p[k - 1] == needle[k - 1] &&
+            std::memcmp(p + 1, needle + 1, k - 2) == 0) {
+            return std::size_t(p - begin);
+        }
+        h = p + 1;
+    }
+    return std::string_view::npos;
+}
+
+#if defined(__AVX2__)
+// Mula's SIMD filter: compares 32 candidate positions at once against the
+// first and the last byte of the needle, and verifies the survivors.
+inline std::size_t findSubstringSimd(const char* h, std::size_t n,
+                                     const char* needle,
+                                     std::size_t k) noexcept {
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[k - 1]);
+    std::size_t i = 0;
+    for (; n >= k && i + k - 1 + 32 <= n; i += 32) {
+        const __m256i block_first =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + i));
+        const __m256i block_last =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + i + k - 1));
+        auto mask = std::uint32_t(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(first, block_first),
+                             _mm256_cmpeq_epi8(last, block_last))));
+        while (mask != 0) {
+            const auto bit = std::size_t(__builtin_ctz(mask));
+            if (std::memcmp(h + i + bit + 1, needle + 1, k - 2) == 0) {
+                return i + bit;
+            }
+            mask &= mask - 1;
+        }
+    }
+    const std::size_t r = findSubstringScalar(h + i, n - i, needle, k);
+    return r == std::string_view::npos ? r : i + r;
+}
+#elif defined(__SSE2__)
+// Mula's SIMD filter: compares 16 candidate positions at once against the
+// first and the last byte of the needle, and verifies the survivors.
+inline std::size_t findSubstringSimd(const char* h, std::size_t n,
+                                     const char* needle,
+                                     std::size_t k) noexcept {
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[k - 1]);
+    std::size_t i = 0;
+    for (; n >= k && i + k - 1 + 16 <= n; i += 16) {
+        const __m128i block_first =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + i));
+        const __m128i block_last =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + i + k - 1));
+        auto mask = std::uint32_t(
+            _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, block_first),
+                                            _mm_cmpeq_epi8(last, block_last))));
+        while (mask != 0) {
+            const auto bit = std::size_t(__builtin_ctz(mask));
+            if (std::memcmp(h + i + bit + 1, needle + 1, k - 2) == 0) {
+                return i + bit;
+            }
+            mask &= mask - 1;
+        }
+    }
+    const std::size_t r = findSubstringScalar(h + i, n - i, needle, k);
+    return r == std::string_view::npos ? r : i + r;
+}
+#else
+inline std::size_t findSubstringSimd(const char* h, std::size_t n,
+                                     const char* needle,
+                                     std::size_t k) noexcept {
+    return findSubstringScalar(h, n, needle, k);
+}
+#endif
+} // namespace detail
+
+/// Returns the position of the first occurrence of `needle` in `haystack` at
+/// or after `pos`, or `std::string_view::npos`, with the semantics of
+/// `std::string_view::find()`.
+///
+/// Candidate positions are filtered 16 or 32 at a time by comparing the
+/// first and the last byte of the needle with SIMD, and only the survivors
+/// are compared in full. Builds without SSE2 fall back to a `memchr()` loop.
+///
+/// # Example
+///
+/// ```cpp
+/// assert(find_substring("hello world", "o w") == 4);
+/// assert(find_substring("hello world", "xyz") == std::string_view::npos);
+/// ```
+inline std::size_t find_substring(std::string_view haystack,
+                                  std::string_view needle,
+                                  std::size_t pos = 0) noexcept {
+    if (pos > haystack.size()) {
+        return std::string_view::npos;
+    }
+    if (needle.empty()) {
+        return pos;
+    }
+
+    const char* h = haystack.data() + pos;
+    const std::size_t n = haystack.size() - pos;
+    std::size_t r;
+    if (needle.size() == 1) {
+        const auto* p = static_cast<const char*>(std::memchr(h, needle[0], n));
+        r = p ? std::size_t(p - h) : std::string_view::npos;
+    } else {
+        r = detail::findSubstringSimd(h, n, needle.data(), needle.size());
+    }
+    return r == std::string_view::npos ? r : pos + r;
+}
+
+/// Returns the position of the first occurrence of `needle` in `haystack` at
+/// or after `pos`, or `std::string_view::npos`.
+template <typename Alloc>
+std::size_t find_substring(const Vector<char, Alloc>& haystack,
+                           std::string_view needle,
+                           std::size_t pos = 0) noexcept {
+    return find_substring(std::string_view(haystack.data(), haystack.size()),
+                          needle, pos);
+}
+
+/// A multi-pattern matcher reporting every occurrence of a set of byte
+/// strings in one pass over the text.
+///
+/// The automaton is a complete DFA: the failure links are resolved at build
+/// time, so scanning costs exactly one table load per input byte. Bytes that
+/// occur in no pattern share one equivalence class, and the transitions are
+/// stored row by row in a single `Vector<uint32_t>` of `states * classes`
+/// entries. State numbers are premultiplied by the row length and the top
+/// bit of every transition tells whether the target state reports a match,
+/// hence the hot loop is a load, a mask and a rarely taken branch.
+///
+/// Scanning many short inputs, e.g. log lines, is latency-bound on the table
+/// loads, so `for_each_match()` over a batch of inputs interleaves several of
+/// them to keep multiple loads in flight.
+///
+/// # Example
+///
+/// ```cpp
+/// AhoCorasick ac{"he", "she", "hers"};
+/// ac.for_each_match("ushers", [](std::uint32_t pattern, std::size_t pos) {
+///     // (1, 1) "she", (0, 2) "he", (2, 2) "hers"
+/// });
+/// ```
+class AhoCorasick {
+public:
+    using SizeType = std::size_t;
+    using PatternId = std::uint32_t;
+
+    /// Number of inputs scanned together by the batched `for_each_match()`.
+    static constexpr SizeType batch_lanes = 8;
+
+    /// Constructs a matcher without patterns.
+    AhoCorasick() {
+        build(static_cast<const std::string_view*>(nullptr),
+              static_cast<const std::string_view*>(nullptr));
+    }
+
+    /// Constructs a matcher for `patterns`, identified by their positions.
+    explicit AhoCorasick(const Vector<std::string_view>& patterns) {
+        build(patterns.begin(), patterns.end());
+    }
+
+    /// Constructs a matcher for `patterns`, identified by their positions.
+    AhoCorasick(std::initializer_list<std::string_view> patterns) {
+        build(patterns.begin(), patterns.end());
+    }
+
+    /// Rebuilds the matcher for the patterns in `[first, last)`, which must be
+    /// convertible to `std::string_view`.
+    ///
+    /// Throws `std::invalid_argument` for an empty pattern and
+    /// `std::length_error` if the automaton would be too large.
+    template <typename InputIt>
+    void build(InputIt first, InputIt last);
+
+    /// Returns the number of patterns.
+    [[nodiscard]] SizeType pattern_count() const noexcept {
+        return lengths_.size();
+    }
+
+    /// Returns the number of states of the automaton.
+    [[nodiscard]] SizeType state_count() const noexcept {
+        return dict_.size();
+    }
+
+    /// Returns the length of the pattern `id`.
+    [[nodiscard]] SizeType pattern_length(PatternId id) const noexcept {
+        return lengths_[id];
+    }
+
+    /// Returns the bytes used by the transition table.
+    [[nodiscard]] SizeType table_bytes() const noexcept {
+        return table_.size() * sizeof(std::uint32_t);
+    }
+
+    /// Calls `f(pattern, pos)` for every occurrence of every pattern in
+    /// `text`, where `pos` is the start of the occurrence. Occurrences are
+    /// reported in order of their end, overlapping ones included.
+    template <typename F>
+    void for_each_match(std::string_view text, F&& f) const {
+        std::uint32_t state = 0;
+        for (SizeType i = 0; i < text.size(); ++i) {
+            state = step(state, text[i], i, f);
+        }
+    }
+
+    /// Calls `f(input, pattern, pos)` for every occurrence in every text of
+    /// `texts`, where `input` is the index of the text. The occurrences in
+    /// one text are reported in order, but the texts are interleaved.
+    template <typename F>
+    void for_each_match(const Vector<std::string_view>& texts, F&& f) const;
+
+    /// Returns true if any pattern occurs in `text`.
+    bool contains_any(std::string_view text) const noexcept {
+        std::uint32_t state = 0;
+        for (const char c : text) {
+            const std::uint32_t e = table_[state + classes_[std::uint8_t(c)]];
+            if (e & match_bit) {
+                return true;
+            }
+            state = e;
+        }
+        return false;
+    }
+
+    /// Returns the number of occurrences of all patterns in `text`.
+    SizeType count_matches(std::string_view text) const {
+        SizeType n = 0;
+        for_each_match(text, [&n](PatternId, SizeType) { ++n; });
+        return n;
+    }
+
+private:
+    static constexpr std::uint32_t match_bit = std::uint32_t(1) << 31;
+    static constexpr std::uint32_t none =
+        std::numeric_limits<std::uint32_t>::max();
+
+    // Advances from `state` over `c`, the byte at `pos`, and reports the
+    // matches ending there.
+    template <typename F>
+    std::uint32_t step(std::uint32_t state, char c, SizeType pos,
+                       F& f) const {
+        const std::uint32_t e = table_[state + classes_[std::uint8_t(c)]];
+        if (e & match_bit) {
+            state = e & ~match_bit;
+            report(state / stride_, pos, f);
+            return state;
+        }
+        return e;
+    }
+
+    template <typename F>
+    void report(std::uint32_t s, SizeType pos, F& f) const {
+        if (out_offsets_[s] == out_offsets_[s + 1]) {
+            s = dict_[s];
+        }
+        for (; s != none; s = dict_[s]) {
+            for (std::uint32_t i = out_offsets_[s]; i < out_offsets_[s + 1];
+                 ++i) {
+                const PatternId id = out_patterns_[i];
+                f(id, pos + 1 - lengths_[id]);
+            }
+        }
+    }
+
+    std::uint32_t addState() {
+        const std::size_t state = table_.size();
+        if (state + stride_ >= match_bit) {
+            throw std::length_error("AhoCorasick: too many states");
+        }
+        for (std::uint32_t c = 0; c < stride_; ++c) {
+            table_.push_back(none);
+        }
+        return std::uint32_t(state);
+    }
+
+private:
+    // Byte to equivalence class.
+    std::array<std::uint8_t, 256> classes_{};
+    // Number of classes, the length of a row of `table_`.
+    std::uint32_t stride_ = 1;
+    // Transitions from premultiplied states, with `match_bit` set if the
+    // target reports any pattern.
+    Vector<std::uint32_t> table_;
+    // The patterns ending at each state, by plain state number.
+    Vector<std::uint32_t> out_offsets_;
+    Vector<PatternId> out_patterns_;
+    // The nearest proper suffix state with patterns of its own, or `none`.
+    Vector<std::uint32_t> dict_;
+    Vector<std::uint32_t> lengths_;
+};
+
+template <typename InputIt>
+void AhoCorasick::build(InputIt first, InputIt last) {
+    Vector<std::string_view> patterns;
+    for (; first != last; ++first) {
+        const std::string_view p = *first;
+        if (p.empty()) {
+            throw std::invalid_argument("AhoCorasick: empty pattern");
+        }
+        patterns.push_back(p);
+    }
+    if (patterns.size() >= none) {
+        throw std::length_error("AhoCorasick: too many patterns");
+    }
+
+    // Bytes absent from every pattern behave alike and share class 0.
+    std::array<bool, 256> used{};
+    for (std::string_view p : patterns) {
+        for (char c : p) {
+            used[std::uint8_t(c)] = true;
+        }
+    }
+    const bool all_used =
+        std::all_of(used.begin(), used.end(), [](bool u) { return u; });
+    std::uint32_t classes = all_used ? 0 : 1;
+    for (std::size_t b = 0; b < 256; ++b) {
+        classes_[b] = used[b] ? std::uint8_t(classes++) : 0;
+    }
+    stride_ = classes;
+
+    // The trie, with `none` for missing edges.
+    table_.clear();
+    addState();
+    Vector<std::uint32_t> terminal;
+    lengths_.clear();
+    for (std::string_view p : patterns) {
+        std::uint32_t s = 0;
+        for (char c : p) {
+            std::uint32_t& next = table_[s + classes_[std::uint8_t(c)]];
+            if (next == none) {
+                const std::uint32_t t = addState();
+                table_[s + classes_[std::uint8_t(c)]] = t;
+                s = t;
+            } else {
+                s = next;
+            }
+        }
+        terminal.push_back(s / stride_);
+        lengths_.push_back(std::uint32_t(p.size()));
+    }
+
+    const std::uint32_t states = std::uint32_t(table_.size() / stride_);
+    out_offsets_.assign(states + 1, 0);
+    for (std::uint32_t s : terminal) {
+        ++out_offsets_[s + 1];
+    }
+    for (std::uint32_t s = 0; s < states; ++s) {
+        out_offsets_[s + 1] += out_offsets_[s];
+    }
+    out_patterns_.assign(patterns.size(), 0);
+    {
+        Vector<std::uint32_t> next(out_offsets_.begin(),
+                                   out_offsets_.end() - 1);
+        for (PatternId id = 0; id < terminal.size(); ++id) {
+            out_patterns_[next[terminal[id]]++] = id;
+        }
+    }
+
+    // Breadth-first, so that the failure state of every state, being
+    // shallower, has its row completed first.
+    Vector<std::uint32_t> fail(states, 0);
+    Vector<std::uint32_t> queue;
+    queue.reserve(states);
+    dict_.assign(states, none);
+    for (std::uint32_t c = 0; c < stride_; ++c) {
+        if (table_[c] == none) {
+            table_[c] = 0;
+        } else {
+            queue.push_back(table_[c]);
+        }
+    }
+    for (std::size_t head = 0; head < queue.size(); ++head) {
+        const std::uint32_t s = queue[head];
+        const std::uint32_t f = fail[s / stride_];
+        const std::uint32_t fs = f / stride_;
+        dict_[s / stride_] =
+            out_offsets_[fs] != out_offsets_[fs + 1] ? fs : dict_[fs];
+        for (std::uint32_t c = 0; c < stride_; ++c) {
+            const std::uint32_t t = table_[s + c];
+            if (t == none) {
+                table_[s + c] = table_[f + c];
+            } else {
+                fail[t / stride_] = table_[f + c];
+                queue.push_back(t);
+            }
+        }
+    }
+    // The root has no patterns, so the root's entry in `dict_` stays `none`.
+    for (std::uint32_t& e : table_) {
+        const std::uint32_t t = e / stride_;
+        if (out_offsets_[t] != out_offsets_[t + 1] || dict_[t] != none) {
+            e |= match_bit;
+        }
+    }
+}
+
+template <typename F>
+void AhoCorasick::for_each_match(const Vector<std::string_view>& texts,
+                                 F&& f) const {
+    for (SizeType base = 0; base < texts.size(); base += batch_lanes) {
+        const SizeType lanes = std::min(batch_lanes, texts.size() - base);
+        std::uint32_t states[batch_lanes] = {};
+        SizeType common = texts[base].size();
+        for (SizeType l = 1; l < lanes; ++l) {
+            common = std::min(common, texts[base + l].size());
+        }
+
+        // The lanes advance in lockstep over their common length, so the
+        // table loads of different inputs overlap.
+        for (SizeType i = 0; i < common; ++i) {
+            for (SizeType l = 0; l < lanes; ++l) {
+                auto g = [&](PatternId id, SizeType pos) {
+                    f(base + l, id, pos);
+                };
+                states[l] = step(states[l], texts[base + l][i], i, g);
+            }
+        }
+        for (SizeType l = 0; l < lanes; ++l) {
+            auto g = [&](PatternId id, SizeType pos) { f(base + l, id, pos); };
+            const std::string_view text = texts[base + l];
+            for (SizeType i = common; i < text.size(); ++i) {
+                states[l] = step(states[l], text[i], i, g);
+            }
+        }
+    }
+}
+} // namespace algo
@@ -0,0 +1,372 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "thread_pool.hpp"
+#include "vector.hpp"
+
+namespace algo {
+namespace detail {
+// The SA-IS algorithm of Nong, Zhang and Chan. `s` is a string over the
+// alphabet `[0, upper]` and `sa` must have room for `n` entries.
+template <typename Index, typename Symbol>
+void saIs(const Symbol* s, std::size_t n, std::size_t upper, Index* sa) {
+    constexpr Index npos = std::numeric_limits<Index>::max();
+
+    if (n == 0) {
+        return;
+    } else if (n == 1) {
+        sa[0] = 0;
+        return;
+    } else if (n == 2) {
+        sa[0] = s[0] < s[1] ? 0 : 1;
+        sa[1] = 1 - sa[0];
+        return;
+    }
+
+    // `ls[i]` is true if suffix `i` is S-type, i.e. smaller than suffix `i+1`.
+    Vector<std::uint8_t> ls(n, 0);
+    for (std::size_t i = n - 1; i-- > 0;) {
+        ls[i] = s[i] == s[i + 1] ? ls[i + 1] : s[i] < s[i + 1];
+    }
+
+    // Bucket heads of the L-type and S-type suffixes of every symbol.
+    Vector<Index> sum_l(upper + 1, 0), sum_s(upper + 1, 0);
+    for (std::size_t i = 0; i < n; ++i) {
+        if (!ls[i]) {
+            ++sum_s[s[i]];
+        } else {
+            ++sum_l[s[i] + 1];
+        }
+    }
+    for (std::size_t i = 0; i <= upper; ++i) {
+        sum_s[i] += sum_l[i];
+        if (i < upper) {
+            sum_l[i + 1] += sum_s[i];
+        }
+    }
+
+    Vector<Index> buf(upper + 1);
+    auto induce = [&](const Vector<Index>& lms) {
+        std::fill(sa, sa + n, npos);
+
+        std::copy(sum_s.begin(), sum_s.end(), buf.begin());
+        for (Index d : lms) {
+            if (d != n) {
+                sa[buf[s[d]]++] = d;
+            }
+        }
+
+        std::copy(sum_l.begin(), sum_l.end(), buf.begin());
+        sa[buf[s[n - 1]]++] = Index(n - 1);
+        for (std::size_t i = 0; i < n; ++i) {
+            const Index v = sa[i];
+            if (v != npos && v >= 1 && !ls[v - 1]) {
+                sa[buf[s[v - 1]]++] = v - 1;
+            }
+        }
+
+        std::copy(sum_l.begin(), sum_l.end(), buf.begin());
+        for (std::size_t i = n; i-- > 0;) {
+            const Index v = sa[i];
+            if (v != npos && v >= 1 && ls[v - 1]) {
+                sa[--buf[s[v - 1] + 1]] = v - 1;
+            }
+        }
+    };
+
+    // Leftmost S-type positions, in text order.
+    Vector<Index> lms_map(n + 1, npos);
+    Vector<Index> lms;
+    for (std::size_t i = 1; i < n; ++i) {
+        if (!ls[i - 1] && ls[i]) {
+            lms_map[i] = Index(lms.size());
+            lms.push_back(Index(i));
+        }
+    }
+    const std::size_t m = lms.size();
+
+    induce(lms);
+    if (m == 0) {
+        return;
+    }
+
+    Vector<Index> sorted_lms;
+    sorted_lms.reserve(m);
+    for (std::size_t i = 0; i < n; ++i) {
+        if (lms_map[sa[i]] != npos) {
+            sorted_lms.push_back(sa[i]);
+        }
+    }
+
+    // Name the LMS substrings and sort the reduced string recursively.
+    Vector<Index> rec_s(m);
+    std::size_t rec_upper = 0;
+    rec_s[lms_map[sorted_lms[0]]] = 0;
+    for (std::size_t i = 1; i < m; ++i) {
+        std::size_t l = sorted_lms[i - 1], r = sorted_lms[i];
+        const std::size_t end_l = lms_map[l] + 1 < m ? lms[lms_map[l] + 1] : n;
+        const std::size_t end_r = lms_map[r] + 1 < m ? lms[lms_map[r] + 1] : n;
+        bool same = true;
+        if (end_l - l != end_r - r) {
+            same = false;
+        } else {
+            while (l < end_l && s[l] == s[r]) {
+                ++l;
+                ++r;
+            }
+            if (l == n || s[l] != s[r]) {
+                same = false;
+            }
+        }
+        if (!same) {
+            ++rec_upper;
+        }
+        rec_s[lms_map[sorted_lms[i]]] = Index(rec_upper);
+    }
+
+    Vector<Index> rec_sa(m);
+    saIs(rec_s.data(), m, rec_upper, rec_sa.data());
+    for (std::size_t i = 0; i < m; ++i) {
+        sorted_lms[i] = lms[rec_sa[i]];
+    }
+    induce(sorted_lms);
+}
+
+template <typename Index>
+void checkTextSize(std::size_t n) {
+    if (n >= std::numeric_limits<Index>::max()) {
+        throw std::length_error("suffix_array: text too long for Index");
+    }
+}
+
+// Sorts `[first, last)` by sorting one chunk per worker and merging the
+// sorted chunks pairwise in parallel.
+template <typename T, typename Compare>
+void parallelSort(ThreadPool& pool, T* first, T* last, Compare comp) {
+    const std::size_t n = last - first;
+    const std::size_t chunks = pool.size();
+    if (chunks == 1 || n < (std::size_t(1) << 16)) {
+        std::sort(first, last, comp);
+        return;
+    }
+
+    Vector<std::size_t> bounds(chunks + 1);
+    for (std::size_t c = 0; c <= chunks; ++c) {
+        bounds[c] = n * c / chunks;
+    }
+    pool.parallel_for(0, chunks, [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t c = lo; c < hi; ++c) {
+            std::sort(first + bounds[c], first + bounds[c + 1], comp);
+        }
+    });
+
+    Vector<T> tmp(n);
+    T* src = first;
+    T* dst = tmp.data();
+    for (std::size_t width = 1; width < chunks; width *= 2) {
+        const std::size_t pairs = (chunks + 2 * width - 1) / (2 * width);
+        pool.parallel_for(0, pairs, [&](std::size_t lo, std::size_t hi) {
+            for (std::size_t p = lo; p < hi; ++p) {
+                const std::size_t a = bounds[2 * width * p];
+                const std::size_t b =
+                    bounds[std::min(2 * width * p + width, chunks)];
+                const std::size_t c =
+                    bounds[std::min(2 * width * (p + 1), chunks)];
+                std::merge(src + a, src + b, src + b, src + c, dst + a, comp);
+            }
+        });
+        std::swap(src, dst);
+    }
+    if (src != first) {
+        pool.parallel_for(0, n, [&](std::size_t lo, std::size_t hi) {
+            std::copy(src + lo, src + hi, first + lo);
+        });
+    }
+}
+} // namespace detail
+
+/// Builds the suffix array of `text` into `sa` in linear time with SA-IS.
+///
+/// `sa[i]` is the starting position of the `i`-th smallest suffix of `text`,
+/// where a proper prefix compares less than the longer string.
+///
+/// Throws `std::length_error` if `text.size()` does not fit in `Index`.
+template <typename Index>
+void suffix_array(const Vector<std::uint8_t>& text, Vector<Index>& sa) {
+    static_assert(std::is_unsigned_v<Index>, "Index must be unsigned");
+    detail::checkTextSize<Index>(text.size());
+
+    sa.resize(text.size());
+    detail::saIs(text.data(), text.size(), 255, sa.data());
+}
+
+/// Returns the suffix array of `text`, built in linear time with SA-IS.
+///
+/// # Example
+///
+/// ```cpp
+/// const char* s = "banana";
+/// Vector<std::uint8_t> text(s, s + 6);
+/// auto sa = suffix_array(text);
+/// assert(sa == Vector<std::uint32_t>({5, 3, 1, 0, 4, 2}));
+/// ```
+template <typename Index = std::uint32_t>
+Vector<Index> suffix_array(const Vector<std::uint8_t>& text) {
+    Vector<Index> sa;
+    suffix_array(text, sa);
+    return sa;
+}
+
+/// Returns the LCP array of `text` with Kasai's algorithm in linear time.
+///
+/// `lcp[i]` is the length of the longest common prefix of the suffixes
+/// `sa[i - 1]` and `sa[i]`, and `lcp[0]` is zero.
+///
+/// # Example
+///
+/// ```cpp
+/// const char* s = "banana";
+/// Vector<std::uint8_t> text(s, s + 6);
+/// auto lcp = lcp_array(text, suffix_array(text));
+/// assert(lcp == Vector<std::uint32_t>({0, 1, 3, 0, 0, 2}));
+/// ```
+template <typename Index>
+Vector<Index> lcp_array(const Vector<std::uint8_t>& text,
+                        const Vector<Index>& sa) {
+    const std::size_t n = text.size();
+    if (sa.size() != n) {
+        throw std::invalid_argument("lcp_array: sa does not match text");
+    }
+
+    Vector<Index> rank(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        rank[sa[i]] = Index(i);
+    }
+
+    Vector<Index> lcp(n, 0);
+    std::size_t h = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (rank[i] == 0) {
+            h = 0;
+            continue;
+        }
+        const std::size_t j = sa[rank[i] - 1];
+        while (i + h < n && j + h < n && text[i + h] == text[j + h]) {
+            ++h;
+        }
+        lcp[rank[i]] = Index(h);
+        if (h > 0) {
+            --h;
+        }
+    }
+    return lcp;
+}
+
+/// Returns the suffix array of `text` with parallel prefix doubling.
+///
+/// Suffixes are first sorted by their leading 8 bytes, then by pairs of ranks
+/// of doubling length until all ranks are distinct. Every round sorts and
+/// re-ranks on all workers of `pool`. This does `O(n log n)` work per round,
+/// more than `suffix_array()`, but scales with the number of cores, which pays
+/// off for very large inputs.
+template <typename Index = std::uint32_t>
+Vector<Index> suffix_array_parallel(const Vector<std::uint8_t>& text,
+                                    ThreadPool& pool) {
+    static_assert(std::is_unsigned_v<Index>, "Index must be unsigned");
+    detail::checkTextSize<Index>(text.size());
+
+    const std::size_t n = text.size();
+    const std::size_t grain = 1 << 14;
+    Vector<Index> sa(n), rank(n), next(n);
+    if (n == 0) {
+        return sa;
+    }
+
+    // Round zero: the first 8 bytes, big-endian, tie-broken by the length of
+    // short suffixes which are zero-padded.
+    Vector<std::uint64_t> prefix(n);
+    pool.parallel_for(0, n, [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t i = lo; i < hi; ++i) {
+            std::uint64_t key = 0;
+            for (std::size_t j = 0; j < 8; ++j) {
+                key = (key << 8) | (i + j < n ? text[i + j] : 0);
+            }
+            prefix[i] = key;
+            sa[i] = Index(i);
+        }
+    }, grain);
+
+    auto less0 = [&](Index a, Index b) {
+        if (prefix[a] != prefix[b]) {
+            return prefix[a] < prefix[b];
+        }
+        return std::min<std::size_t>(n - a, 8) <
+               std::min<std::size_t>(n - b, 8);
+    };
+    auto equal0 = [&](Index a, Index b) {
+        return !less0(a, b) && !less0(b, a);
+    };
+
+    // Assigns `rank[sa[i]]` one plus the number of distinct keys before `i`
+    // and returns the number of distinct keys.
+    const std::size_t chunks =
+        std::min<std::size_t>(pool.size(), n / grain + 1);
+    Vector<std::size_t> counts(chunks + 1);
+    auto rerank = [&](auto&& equal) {
+        pool.parallel_for(0, chunks, [&](std::size_t lo, std::size_t hi) {
+            for (std::size_t c = lo; c < hi; ++c) {
+                std::size_t distinct = 0;
+                for (std::size_t i = n * c / chunks, e = n * (c + 1) / chunks;
+                     i < e; ++i) {
+                    distinct += i == 0 || !equal(sa[i - 1], sa[i]);
+                }
+                counts[c + 1] = distinct;
+            }
+        });
+        counts[0] = 0;
+        std::partial_sum(counts.begin(), counts.end(), counts.begin());
+
+        pool.parallel_for(0, chunks, [&](std::size_t lo, std::size_t hi) {
+            for (std::size_t c = lo; c < hi; ++c) {
+                std::size_t r = counts[c];
+                for (std::size_t i = n * c / chunks, e = n * (c + 1) / chunks;
+                     i < e; ++i) {
+                    r += i == 0 || !equal(sa[i - 1], sa[i]);
+                    next[sa[i]] = Index(r);
+                }
+            }
+        });
+        rank.swap(next);
+        return counts[chunks];
+    };
+
+    detail::parallelSort(pool, sa.data(), sa.data() + n, less0);
+    std::size_t distinct = rerank(equal0);
+    Vector<std::uint64_t>().swap(prefix);
+
+    for (std::size_t k = 8; distinct < n; k *= 2) {
+        auto second = [&](Index a) -> Index {
+            return a + k < n ? rank[a + k] : 0;
+        };
+        auto less = [&](Index a, Index b) {
+            if (rank[a] != rank[b]) {
+                return rank[a] < rank[b];
+            }
+            return second(a) < second(b);
+        };
+        auto equal = [&](Index a, Index b) {
+            return rank[a] == rank[b] && second(a) == second(b);
+        };
+
+        detail::parallelSort(pool, sa.data(), sa.data() + n, less);
+        distinct = rerank(equal);
+    }
+    return sa;
+}
+} // namespace algo
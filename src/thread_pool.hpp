@@ -0,0 +1,220 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace algo {
+/// A fixed-size pool of worker threads executing submitted tasks in FIFO
+/// order.
+///
+/// The pool is used by the parallel algorithms of the library. Tasks must not
+/// block on other tasks of the same pool, e.g. `parallel_for()` must not be
+/// called from inside a task.
+///
+/// # Example
+///
+/// ```cpp
+/// ThreadPool pool(4);
+/// auto fut = pool.submit([] { return 42; });
+/// assert(fut.get() == 42);
+///
+/// Vector<int> v(1000, 1);
+/// pool.parallel_for(0, v.size(), [&](std::size_t first, std::size_t last) {
+///     for (std::size_t i = first; i < last; ++i) {
+///         v[i] *= 2;
+///     }
+/// });
+/// ```
+class ThreadPool {
+public:
+    using SizeType = std::size_t;
+
+    /// Starts `threads` workers, at least one.
+    explicit ThreadPool(
+        SizeType threads = std::thread::hardware_concurrency()) {
+        threads = std::max<SizeType>(threads, 1);
+        pinned_.resize(threads);
+        workers_.reserve(threads);
+        for (SizeType i = 0; i < threads; ++i) {
+            workers_.emplace_back([this, i] { run(i); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// Finishes all queued tasks and joins the workers.
+    ~ThreadPool() noexcept {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_all();
+        for (std::thread& t : workers_) {
+            t.join();
+        }
+    }
+
+    /// Returns the number of worker threads.
+    [[nodiscard]] SizeType size() const noexcept {
+        return workers_.size();
+    }
+
+    /// Queues `f` and returns a future of its result. Exceptions thrown by `f`
+    /// are rethrown by `std::future::get()`.
+    template <typename F>
+    auto submit(F&& f) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        auto fut = enqueue(tasks_, std::forward<F>(f));
+        cv_.notify_one();
+        return fut;
+    }
+
+    /// Splits `[first, last)` into at most `size()` contiguous chunks of at
+    /// least `grain` indices and calls `f(chunk_first, chunk_last)` for each
+    /// of them in parallel. The calling thread runs the first chunk and waits
+    /// for the rest.
+    template <typename F>
+    void parallel_for(SizeType first, SizeType last, F&& f,
+                      SizeType grain = 1) {
+        if (first >= last) {
+            return;
+        }
+
+        const SizeType n = last - first;
+        const SizeType chunks =
+            std::clamp<SizeType>(n / std::max<SizeType>(grain, 1), 1, size());
+        if (chunks == 1) {
+            f(first, last);
+            return;
+        }
+
+        std::vector<std::future<void>> futs;
+        futs.reserve(chunks - 1);
+        for (SizeType c = 1; c < chunks; ++c) {
+            const SizeType lo = first + n * c / chunks;
+            const SizeType hi = first + n * (c + 1) / chunks;
+            futs.push_back(submit([&f, lo, hi] { f(lo, hi); }));
+        }
+
+        // Wait for every chunk before leaving, since they all refer to `f`.
+        std::exception_ptr error;
+        try {
+            f(first, first + n / chunks);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        for (auto& fut : futs) {
+            try {
+                fut.get();
+            } catch (...) {
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    /// Splits `[first, last)` into `size()` contiguous chunks, or one per
+    /// index if there are fewer, and calls `f(chunk_first, chunk_last)` for
+    /// chunk `i` on worker `i`, while the calling thread waits.
+    ///
+    /// The same range is always split the same way, so each worker gets the
+    /// same indices on every call, e.g. the ones whose pages it touched
+    /// first and which the kernel therefore placed on its NUMA node.
+    template <typename F>
+    void parallel_for_static(SizeType first, SizeType last, F&& f) {
+        if (first >= last) {
+            return;
+        }
+
+        const SizeType n = last - first;
+        const SizeType chunks = std::min(n, size());
+        std::vector<std::future<void>> futs;
+        futs.reserve(chunks);
+        for (SizeType c = 0; c < chunks; ++c) {
+            const SizeType lo = first + n * c / chunks;
+            const SizeType hi = first + n * (c + 1) / chunks;
+            futs.push_back(enqueue(pinned_[c], [&f, lo, hi] { f(lo, hi); }));
+        }
+        cv_.notify_all();
+
+        // Wait for every chunk before leaving, since they all refer to `f`.
+        std::exception_ptr error;
+        for (auto& fut : futs) {
+            try {
+                fut.get();
+            } catch (...) {
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    using Queue = std::deque<std::function<void()>>;
+
+    // Appends `f` to `queue` and returns the future of its result. The
+    // caller wakes the workers.
+    template <typename F>
+    auto enqueue(Queue& queue, F&& f)
+        -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        using R = std::invoke_result_t<std::decay_t<F>>;
+        auto task =
+            std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+        std::future<R> fut = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue.emplace_back([task] { (*task)(); });
+        }
+        return fut;
+    }
+
+    // Runs the tasks pinned to worker `index` before the shared ones.
+    void run(SizeType index) {
+        Queue& pinned = pinned_[index];
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [&] {
+                    return stopping_ || !pinned.empty() || !tasks_.empty();
+                });
+                Queue& queue = !pinned.empty() ? pinned : tasks_;
+                if (queue.empty()) {
+                    return;
+                }
+                task = std::move(queue.front());
+                queue.pop_front();
+            }
+            task();
+        }
+    }
+
+private:
+    std::vector<std::thread> workers_;
+    Queue tasks_;
+    // The tasks each worker must run itself.
+    std::vector<Queue> pinned_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_ = false;
+};
+} // namespace algo
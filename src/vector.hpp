@@ -1,5 +1,9 @@
+#pragma once
+
 #include <algorithm>
+#include <array>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <initializer_list>
 #include <iterator>
@@ -9,6 +13,14 @@
 #include <type_traits>
 #include <utility>
 
+// Under C++20 `Vector` is usable in constant expressions, with storage that
+// lives only as long as the evaluation. See `to_array()`.
+#if defined(__cpp_lib_constexpr_dynamic_alloc)
+#define ALGO_CONSTEXPR20 constexpr
+#else
+#define ALGO_CONSTEXPR20
+#endif
+
 namespace algo {
 /// A standard-like container which offers fixed time access to individual
 /// elements in any order.
@@ -48,8 +60,11 @@ class Vector {
     static constexpr bool using_std_allocator =
         std::is_same_v<Allocator, std::allocator<T>>;
 
+    // `malloc()` and `realloc()` only guarantee the fundamental alignment, so
+    // over-aligned types go through the allocator.
     static constexpr bool relocatable =
-        std::is_trivially_copyable_v<T> && using_std_allocator;
+        std::is_trivially_copyable_v<T> && using_std_allocator &&
+        alignof(T) <= alignof(std::max_align_t);
 
     using AllocTraits = std::allocator_traits<Allocator>;
 
@@ -74,7 +89,8 @@ public:
         default;
 
     /// Constructs an empty container with the given allocator.
-    explicit Vector(const AllocatorType& a) noexcept : allocator_(a) {}
+    explicit ALGO_CONSTEXPR20 Vector(const AllocatorType& a) noexcept
+        : allocator_(a) {}
 
     /// Constructs the container with `count` copies of elements with `value`.
     ///
@@ -86,22 +102,24 @@ public:
     /// assert(words.front() == "Mo");
     /// assert(words.back() == "Mo")
     /// ```
-    explicit Vector(SizeType count, const T& value,
-                    const AllocatorType& alloc = AllocatorType())
+    explicit ALGO_CONSTEXPR20 Vector(SizeType count, const T& value,
+                                     const AllocatorType& alloc =
+                                         AllocatorType())
         : allocator_(alloc) {
         create(count);
-        finish_ = std::uninitialized_fill_n(start_, count, value);
+        finish_ = uninitializedFillN(start_, count, value);
     }
 
     /// Constructs the container with `count` **default-inserted** instances of
     /// `T`. No copies are made.
-    explicit Vector(SizeType count,
-                    const AllocatorType& alloc = AllocatorType())
+    explicit ALGO_CONSTEXPR20 Vector(SizeType count,
+                                     const AllocatorType& alloc =
+                                         AllocatorType())
         : allocator_(alloc) {
         static_assert(std::is_default_constructible_v<T>,
                       "T cannot be default constructible");
         create(count);
-        finish_ = std::uninitialized_default_construct_n(start_, count);
+        finish_ = uninitializedDefaultN(start_, count);
     }
 
     /// Constructs the container with the contents of the range `[first, last)`.
@@ -119,29 +137,32 @@ public:
                                                    Iter>::iterator_category,
                                                std::input_iterator_tag>,
                          int> = 0>
-    Vector(Iter first, Iter last, const AllocatorType& alloc = AllocatorType())
+    ALGO_CONSTEXPR20 Vector(Iter first, Iter last,
+                            const AllocatorType& alloc = AllocatorType())
         : allocator_(alloc) {
         create(std::distance(first, last));
-        finish_ = std::uninitialized_copy(first, last, start_);
+        finish_ = uninitializedCopy(first, last, start_);
     }
 
     /// Constructs the container with the contents of `rhs`.
-    Vector(const Vector& rhs) : Vector(rhs.begin(), rhs.end()) {}
+    ALGO_CONSTEXPR20 Vector(const Vector& rhs)
+        : Vector(rhs.begin(), rhs.end()) {}
 
     /// Constructs the container with the contents of `rhs`.
-    Vector(const Vector& rhs, const AllocatorType& alloc)
+    ALGO_CONSTEXPR20 Vector(const Vector& rhs, const AllocatorType& alloc)
         : Vector(rhs.begin(), rhs.end(), alloc) {}
 
     /// Move constructor.
     ///
     /// Leaving the `rhs` empty.
-    Vector(Vector&& rhs) noexcept
+    ALGO_CONSTEXPR20 Vector(Vector&& rhs) noexcept
         : start_(rhs.start_), finish_(rhs.finish_),
           end_of_storage_(rhs.end_of_storage_) {
         rhs.start_ = rhs.finish_ = rhs.end_of_storage_ = nullptr;
     }
 
     /// Move constructor with alternative allocator.
+    ALGO_CONSTEXPR20
     Vector(Vector&& rhs, const AllocatorType& alloc) noexcept(noexcept(
         Vector(std::declval<Vector&&>(), std::declval<const AllocatorType&>(),
                std::declval<typename AllocTraits::is_always_equal>())))
@@ -157,27 +178,27 @@ public:
     /// Vector<std::string> words = {"the", "frogurt", "is", "also", "cursed"};
     /// assert(words.back() == "cursed");
     /// ```
-    Vector(std::initializer_list<T> init,
-           const AllocatorType& alloc = AllocatorType())
+    ALGO_CONSTEXPR20 Vector(std::initializer_list<T> init,
+                            const AllocatorType& alloc = AllocatorType())
         : Vector(init.begin(), init.end(), alloc) {}
 
     /// Destructs all elements and free the memory.
-    ~Vector() noexcept {
+    ALGO_CONSTEXPR20 ~Vector() noexcept {
         std::destroy(start_, finish_);
         deallocate(start_, capacity());
     }
 
     /// Copy assignment operator. Replaces the contents with a copy of the
     /// contents of `rhs`.
-    Vector& operator=(const Vector& rhs) {
+    ALGO_CONSTEXPR20 Vector& operator=(const Vector& rhs) {
         const SizeType len = rhs.size();
         if (len > capacity()) {
             Vector tmp(rhs);
             tmp.swap(*this);
         } else if (len > size()) {
             std::copy(rhs.start_, rhs.start_ + size(), start_);
-            finish_ = std::uninitialized_copy(rhs.start_ + size(), rhs.finish_,
-                                              finish_);
+            finish_ =
+                uninitializedCopy(rhs.start_ + size(), rhs.finish_, finish_);
         } else {
             auto iter = std::copy(rhs.start_, rhs.finish_, start_);
             std::destroy(iter, finish_);
@@ -189,15 +210,15 @@ public:
 
     /// Move assignment operator. Replaces the contents with `rhs` using move
     /// semantics.
-    Vector& operator=(Vector&& rhs) noexcept {
+    ALGO_CONSTEXPR20 Vector& operator=(Vector&& rhs) noexcept {
         const SizeType len = rhs.size();
         if (len > capacity()) {
             Vector tmp(std::move(rhs));
             tmp.swap(*this);
         } else if (len > size()) {
             std::move(rhs.start_, rhs.start_ + size(), start_);
-            finish_ = std::uninitialized_move(rhs.start_ + size(), rhs.finish_,
-                                              finish_);
+            finish_ =
+                uninitializedMove(rhs.start_ + size(), rhs.finish_, finish_);
         } else {
             auto iter = std::move(rhs.start_, rhs.finish_, start_);
             std::destroy(iter, finish_);
@@ -208,7 +229,7 @@ public:
     }
 
     /// Replaces the contents with those identified by initializer list `ilist`.
-    Vector& operator=(std::initializer_list<T> ilist) {
+    ALGO_CONSTEXPR20 Vector& operator=(std::initializer_list<T> ilist) {
         assign(ilist);
         return *this;
     }
@@ -217,14 +238,14 @@ public:
     ///
     /// All iterators, pointers and references to the elements of the container
     /// are invalidated. The past-the-end iterator is also invalidated.
-    void assign(SizeType count, const T& value) {
+    ALGO_CONSTEXPR20 void assign(SizeType count, const T& value) {
         if (count > capacity()) {
             Vector tmp(count, value, get_allocator());
             tmp.swap(*this);
         } else if (count > size()) {
             std::fill(start_, finish_, value);
             const SizeType added = count - size();
-            std::uninitialized_fill_n(finish_, added, value);
+            uninitializedFillN(finish_, added, value);
             finish_ += added;
         } else {
             auto iter = std::fill_n(start_, count, value);
@@ -243,7 +264,7 @@ public:
                                                    Iter>::iterator_category,
                                                std::input_iterator_tag>,
                          int> = 0>
-    void assign(Iter first, Iter last) {
+    ALGO_CONSTEXPR20 void assign(Iter first, Iter last) {
         if constexpr (std::is_convertible_v<typename std::iterator_traits<
                                                 Iter>::iterator_category,
                                             std::forward_iterator_tag>) {
@@ -255,7 +276,7 @@ public:
                 auto p = std::next(first, size());
                 const SizeType added = count - size();
                 std::copy(first, p, start_);
-                std::uninitialized_copy(p, last, finish_);
+                uninitializedCopy(p, last, finish_);
                 finish_ += added;
             } else {
                 auto iter = std::copy(first, last, start_);
@@ -279,15 +300,14 @@ public:
     ///
     /// All iterators, pointers and references to the elements of the container
     /// are invalidated. The past-the-end iterator is also invalidated.
-    void assign(std::initializer_list<T> ilist) {
+    ALGO_CONSTEXPR20 void assign(std::initializer_list<T> ilist) {
         if (ilist.size() > capacity()) {
             Vector tmp(ilist.begin(), ilist.end(), get_allocator());
             tmp.swap(*this);
         } else if (ilist.size() > size()) {
             std::copy_n(ilist.begin(), size(), start_);
             const SizeType added = ilist.size() - size();
-            std::uninitialized_copy_n(ilist.begin() + size(), added,
-                                      start_ + size());
+            uninitializedCopy(ilist.begin() + size(), ilist.end(), finish_);
             finish_ += added;
         } else {
             auto iter = std::copy(ilist.begin(), ilist.end(), start_);
@@ -296,7 +316,7 @@ public:
     }
 
     /// Returns the allocator associated with the container.
-    AllocatorType get_allocator() const {
+    ALGO_CONSTEXPR20 AllocatorType get_allocator() const {
         return allocator_;
     }
 
@@ -314,7 +334,7 @@ public:
     /// lookups are not defined.
     ///
     /// For checked lookups see `at()`.
-    Reference operator[](SizeType n) noexcept {
+    ALGO_CONSTEXPR20 Reference operator[](SizeType n) noexcept {
         return *(start_ + n);
     }
 
@@ -328,14 +348,14 @@ public:
     /// lookups are not defined.
     ///
     /// For checked lookups see `at()`.
-    ConstReference operator[](SizeType n) const noexcept {
+    ALGO_CONSTEXPR20 ConstReference operator[](SizeType n) const noexcept {
         return *(start_ + n);
     }
 
     /// This function provides for safer data access. The parameter is first
     /// checked that it is in the range of the `Vector`. The function throws
     /// `out_of_range` if the check fails.
-    Reference at(SizeType n) {
+    ALGO_CONSTEXPR20 Reference at(SizeType n) {
         rangeCheck(n);
         return (*this)[n];
     }
@@ -343,44 +363,44 @@ public:
     /// This function provides for safer data access. The parameter is first
     /// checked that it is in the range of the `Vector`. The function throws
     /// `out_of_range` if the check fails.
-    ConstReference at(SizeType n) const {
+    ALGO_CONSTEXPR20 ConstReference at(SizeType n) const {
         rangeCheck(n);
         return (*this)[n];
     }
 
     /// Returns a read/write reference to the data at the first element of the
     /// `Vector`.
-    Reference front() noexcept {
+    ALGO_CONSTEXPR20 Reference front() noexcept {
         return *start_;
     }
 
     /// Returns a read-onlye reference to the data at the first element of the
     /// `Vector`.
-    ConstReference front() const noexcept {
+    ALGO_CONSTEXPR20 ConstReference front() const noexcept {
         return *start_;
     }
 
     /// Returns a read/write reference to the data at the last element of the
     /// `Vector`.
-    Reference back() noexcept {
+    ALGO_CONSTEXPR20 Reference back() noexcept {
         return *(finish_ - 1);
     }
 
     /// Returns a read-only reference to the data at the last element of the
     /// `Vector`.
-    ConstReference back() const noexcept {
+    ALGO_CONSTEXPR20 ConstReference back() const noexcept {
         return *(finish_ - 1);
     }
 
     /// Returns a pointer such that `[data(), data() + size())` is a valid
     /// range. For a non-empty `Vector`, `data() == &front()`.
-    T* data() noexcept {
+    ALGO_CONSTEXPR20 T* data() noexcept {
         return start_;
     }
 
     /// Returns a const pointer such that `[data(), data() + size())` is a valid
     /// range. For a non-empty `Vector`, `data() == &front()`.
-    const T* data() const noexcept {
+    ALGO_CONSTEXPR20 const T* data() const noexcept {
         return start_;
     }
 
@@ -393,7 +413,7 @@ public:
     ///
     /// If the `Vector` is empty, the returned iterator will be equal to
     /// `end()`.
-    Iterator begin() noexcept {
+    ALGO_CONSTEXPR20 Iterator begin() noexcept {
         return start_;
     }
 
@@ -402,7 +422,7 @@ public:
     ///
     /// If the `Vector` is empty, the returned iterator will be equal to
     /// `cend()`.
-    ConstIterator begin() const noexcept {
+    ALGO_CONSTEXPR20 ConstIterator begin() const noexcept {
         return start_;
     }
 
@@ -411,7 +431,7 @@ public:
     ///
     /// If the `Vector` is empty, the returned iterator will be equal to
     /// `cend()`.
-    ConstIterator cbegin() const noexcept {
+    ALGO_CONSTEXPR20 ConstIterator cbegin() const noexcept {
         return start_;
     }
 
@@ -419,7 +439,7 @@ public:
     /// the `Vector`. Iteration is done in ordinary element order.
     ///
     /// Attempting to access it will result in **undefined** behavior.
-    Iterator end() noexcept {
+    ALGO_CONSTEXPR20 Iterator end() noexcept {
         return finish_;
     }
 
@@ -427,7 +447,7 @@ public:
     /// the `Vector`. Iteration is done in ordinary element order.
     ///
     /// Attempting to access it will result in **undefined** behavior.
-    ConstIterator end() const noexcept {
+    ALGO_CONSTEXPR20 ConstIterator end() const noexcept {
         return finish_;
     }
 
@@ -435,7 +455,7 @@ public:
     /// the `Vector`. Iteration is done in ordinary element order.
     ///
     /// Attempting to access it will result in **undefined** behavior.
-    ConstIterator cend() const noexcept {
+    ALGO_CONSTEXPR20 ConstIterator cend() const noexcept {
         return finish_;
     }
 
@@ -443,7 +463,7 @@ public:
     /// the `Vector`. Iteration is done in reverse element order.
     ///
     /// If the `Vector` is empty, the returned iterator is equal to `rend()`.
-    ReverseIterator rbegin() noexcept {
+    ALGO_CONSTEXPR20 ReverseIterator rbegin() noexcept {
         return ReverseIterator(end());
     }
 
@@ -451,7 +471,7 @@ public:
     /// the `Vector`. Iteration is done in reverse element order.
     ///
     /// If the `Vector` is empty, the returned iterator is equal to `rend()`.
-    ConstReverseIterator rbegin() const noexcept {
+    ALGO_CONSTEXPR20 ConstReverseIterator rbegin() const noexcept {
         return ConstReverseIterator(end());
     }
 
@@ -459,7 +479,7 @@ public:
     /// the `Vector`. Iteration is done in reverse element order.
     ///
     /// If the `Vector` is empty, the returned iterator is equal to `rend()`.
-    ConstReverseIterator crbegin() const noexcept {
+    ALGO_CONSTEXPR20 ConstReverseIterator crbegin() const noexcept {
         return ConstReverseIterator(end());
     }
 
@@ -468,7 +488,7 @@ public:
     /// order.
     ///
     /// Attempting to access it will result in **undefined** behavior.
-    ReverseIterator rend() noexcept {
+    ALGO_CONSTEXPR20 ReverseIterator rend() noexcept {
         return ReverseIterator(begin());
     }
 
@@ -477,7 +497,7 @@ public:
     /// order.
     ///
     /// Attempting to access it will result in **undefined** behavior.
-    ConstReverseIterator rend() const noexcept {
+    ALGO_CONSTEXPR20 ConstReverseIterator rend() const noexcept {
         return ConstReverseIterator(begin());
     }
 
@@ -486,7 +506,7 @@ public:
     /// order.
     ///
     /// Attempting to access it will result in **undefined** behavior.
-    ConstReverseIterator crend() const noexcept {
+    ALGO_CONSTEXPR20 ConstReverseIterator crend() const noexcept {
         return ConstReverseIterator(begin());
     }
 
@@ -495,17 +515,17 @@ public:
     ////////////////////////////////////////////////////////////////////////////
 
     /// Returns true if the `Vector` is empty.
-    [[nodiscard]] bool empty() const noexcept {
+    [[nodiscard]] ALGO_CONSTEXPR20 bool empty() const noexcept {
         return size() == 0;
     }
 
     /// Returns the number of elements in the `Vector`.
-    [[nodiscard]] SizeType size() const noexcept {
+    [[nodiscard]] ALGO_CONSTEXPR20 SizeType size() const noexcept {
         return static_cast<SizeType>(finish_ - start_);
     }
 
     /// Returns the size() of the largest possible `Vector`.
-    [[nodiscard]] SizeType max_size() const noexcept {
+    [[nodiscard]] ALGO_CONSTEXPR20 SizeType max_size() const noexcept {
         return SizeType(-1) / 2 / sizeof(ValueType);
     }
 
@@ -518,7 +538,7 @@ public:
     /// If `new_cap` is greater than `capacity()`, all iterators, including the
     /// pass the end iterator, and all references to the elements are
     /// invalidated. Otherwise, no iterators or references are invalidated.
-    void reserve(SizeType new_cap) {
+    ALGO_CONSTEXPR20 void reserve(SizeType new_cap) {
         if (new_cap > max_size()) {
             throw std::length_error("Vector::reserve too large capacity");
         }
@@ -529,7 +549,7 @@ public:
 
     /// Returns the total number of elements that `Vector` can hold before
     /// needing to allocate more memory.
-    [[nodiscard]] SizeType capacity() const noexcept {
+    [[nodiscard]] ALGO_CONSTEXPR20 SizeType capacity() const noexcept {
         return static_cast<SizeType>(end_of_storage_ - start_);
     }
 
@@ -539,7 +559,7 @@ public:
     /// reallocation occurs, all iterators, including the past the end iterator,
     /// and all references to the elements are invalidated. If no reallocation
     /// takes place, no iterators or references are invalidated.
-    void shrink_to_fit() {
+    ALGO_CONSTEXPR20 void shrink_to_fit() {
         const SizeType old_size = size();
         growShrinkAux(old_size);
     }
@@ -555,7 +575,7 @@ public:
     /// contained elements. Any past the end iterators are also invalidated.
     ///
     /// Leaving the `capacity()` of the `Vector` unchanged.
-    void clear() noexcept {
+    ALGO_CONSTEXPR20 void clear() noexcept {
         std::destroy(start_, finish_);
         finish_ = start_;
     }
@@ -566,7 +586,7 @@ public:
     ///
     /// This kind of operation could be expensive for a `Vector` and if it is
     /// frequently used then user should consider using `List`.
-    Iterator insert(ConstIterator pos, const T& value) {
+    ALGO_CONSTEXPR20 Iterator insert(ConstIterator pos, const T& value) {
         // Guarantee that `value` is not a reference to an element of this
         // `Vector`
         addressCheck(std::addressof(value));
@@ -574,10 +594,10 @@ public:
         Iterator p = begin() + (pos - cbegin());
         if (finish_ != end_of_storage_) {
             if (p == finish_) {
-                new (finish_) T(value);
+                constructAt(finish_, value);
                 ++finish_;
             } else {
-                new (finish_) T(std::move(*(finish_ - 1)));
+                constructAt(finish_, std::move(*(finish_ - 1)));
                 ++finish_;
                 std::move_backward(p, finish_ - 2, finish_ - 1);
                 *p = value;
@@ -594,14 +614,14 @@ public:
     ///
     /// This kind of operation could be expensive for a `Vector` and if it is
     /// frequently used then user should consider using `List`.
-    Iterator insert(ConstIterator pos, T&& value) {
+    ALGO_CONSTEXPR20 Iterator insert(ConstIterator pos, T&& value) {
         Iterator p = begin() + (pos - cbegin());
         if (finish_ != end_of_storage_) {
             if (p == finish_) {
-                new (finish_) T(std::move(value));
+                constructAt(finish_, std::move(value));
                 ++finish_;
             } else {
-                new (finish_) T(std::move(*(finish_ - 1)));
+                constructAt(finish_, std::move(*(finish_ - 1)));
                 ++finish_;
                 std::move_backward(p, finish_ - 2, finish_ - 1);
                 *p = std::move(value);
@@ -613,7 +633,8 @@ public:
     }
 
     /// Inserts `count` copies of the `value` before pos.
-    Iterator insert(ConstIterator pos, SizeType count, const T& value) {
+    ALGO_CONSTEXPR20 Iterator insert(ConstIterator pos, SizeType count,
+                                     const T& value) {
         Iterator p = begin() + (pos - begin());
         if (count == 0) {
             return p;
@@ -623,20 +644,20 @@ public:
 
         if (finish_ + count <= end_of_storage_) {
             if (p == finish_) {
-                std::uninitialized_fill_n(finish_, count, value);
+                uninitializedFillN(finish_, count, value);
             } else {
                 const SizeType m = finish_ - p;
                 if (count == m) {
-                    std::uninitialized_move(p, finish_, finish_);
+                    uninitializedMove(p, finish_, finish_);
                     std::fill_n(p, count, value);
                 } else if (count < m) {
-                    std::uninitialized_move(finish_ - count, finish_, finish_);
+                    uninitializedMove(finish_ - count, finish_, finish_);
                     std::move_backward(p, finish_ - count, finish_);
                     std::fill(p, finish_ - count, value);
                 } else {
-                    std::uninitialized_move(p, finish_, finish_ + (count - m));
+                    uninitializedMove(p, finish_, finish_ + (count - m));
                     std::fill(p, finish_, value);
-                    std::uninitialized_fill_n(finish_, count - m, value);
+                    uninitializedFillN(finish_, count - m, value);
                 }
             }
             finish_ += count;
@@ -653,7 +674,7 @@ public:
                                                    Iter>::iterator_category,
                                                std::input_iterator_tag>,
                          int> = 0>
-    Iterator insert(ConstIterator pos, Iter first, Iter last) {
+    ALGO_CONSTEXPR20 Iterator insert(ConstIterator pos, Iter first, Iter last) {
         if (first == last) {
             return begin() + (pos - cbegin());
         }
@@ -666,7 +687,8 @@ public:
     }
 
     /// Inserts elements from initializer list `ilist` before pos.
-    Iterator insert(ConstIterator pos, std::initializer_list<T> ilist) {
+    ALGO_CONSTEXPR20 Iterator insert(ConstIterator pos,
+                                     std::initializer_list<T> ilist) {
         return insert(pos, ilist.begin(), ilist.end());
     }
 
@@ -679,14 +701,14 @@ public:
     /// before the insertion point remain valid. The past-the-end iterator is
     /// also invalidated.
     template <typename... Args>
-    Iterator emplace(ConstIterator pos, Args&&... args) {
+    ALGO_CONSTEXPR20 Iterator emplace(ConstIterator pos, Args&&... args) {
         Iterator p = begin() + (pos - cbegin());
         if (finish_ != end_of_storage_) {
             if (p == finish_) {
-                new (finish_) T(std::forward<Args>(args)...);
+                constructAt(finish_, std::forward<Args>(args)...);
                 ++finish_;
             } else {
-                new (finish_) T(std::move(*(finish_ - 1)));
+                constructAt(finish_, std::move(*(finish_ - 1)));
                 ++finish_;
                 std::move_backward(p, finish_ - 2, finish_ - 1);
                 *p = T(std::forward<Args>(args)...);
@@ -705,7 +727,7 @@ public:
     ///
     /// Iterator following the last removed element is returned. If `pos` refers
     /// to the last element, then the `end()` iterator is returned.
-    Iterator erase(ConstIterator pos) {
+    ALGO_CONSTEXPR20 Iterator erase(ConstIterator pos) {
         Iterator p = begin() + (pos - cbegin());
         if (p + 1 != end()) {
             std::move(p + 1, end(), p);
@@ -724,7 +746,7 @@ public:
     /// Iterator following the last removed element is returned. If `last ==
     /// end()` prior to removal, then the updated `end()` iterator is returned.
     /// If `[first, last)` is an empty range, the `last` is returned.
-    Iterator erase(ConstIterator first, ConstIterator last) {
+    ALGO_CONSTEXPR20 Iterator erase(ConstIterator first, ConstIterator last) {
         Iterator pfirst = begin() + (first - cbegin()),
                  plast = begin() + (last - cbegin());
         if (pfirst != plast) {
@@ -746,22 +768,22 @@ public:
     /// the end of the `Vector` and assigns the given data to it. Due to the
     /// nature of a `Vector` this operation can be done in constant time if the
     /// `Vector` has preallocated space available.
-    void push_back(const ValueType& e) {
+    ALGO_CONSTEXPR20 void push_back(const ValueType& e) {
         if (finish_ == end_of_storage_) {
             growShrinkAux(next_size(capacity()));
         }
 
-        new (finish_) T(e);
+        constructAt(finish_, e);
         ++finish_;
     }
 
     /// Move version of `push_back()`.
-    void push_back(ValueType&& e) {
+    ALGO_CONSTEXPR20 void push_back(ValueType&& e) {
         if (finish_ == end_of_storage_) {
             growShrinkAux(next_size(capacity()));
         }
 
-        new (finish_) T(std::move(e));
+        constructAt(finish_, std::move(e));
         ++finish_;
     }
 
@@ -775,12 +797,12 @@ public:
     /// references (including the past-the-end iterator) are invalidated.
     /// Otherwise only pass-the-end iterator is invalidated.
     template <typename... Args>
-    Reference emplace_back(Args&&... args) {
+    ALGO_CONSTEXPR20 Reference emplace_back(Args&&... args) {
         if (finish_ == end_of_storage_) {
             growShrinkAux(next_size(capacity()));
         }
 
-        new (finish_) T(std::forward<Args>(args)...);
+        constructAt(finish_, std::forward<Args>(args)...);
         ++finish_;
         return back();
     }
@@ -793,7 +815,7 @@ public:
     ///
     /// No data is returned, and if the last element's data is needed, it should
     /// be retrieved before `pop_back()` is called.
-    void pop_back() noexcept {
+    ALGO_CONSTEXPR20 void pop_back() noexcept {
         --finish_;
         std::destroy_at(finish_);
     }
@@ -801,19 +823,55 @@ public:
     /// Resizes the `Vector` to the specified number of elements. If the number
     /// is smaller than the `Vector`'s current size the `Vector` is truncated,
     /// otherwise default constructed elements are appended.
-    void resize(SizeType new_size) {
+    ALGO_CONSTEXPR20 void resize(SizeType new_size) {
         if (new_size == size()) {
             return;
         } else if (new_size < size()) {
             std::destroy(start_ + new_size, finish_);
         } else if (new_size > size() && new_size < capacity()) {
-            std::uninitialized_default_construct_n(finish_, new_size - size());
+            uninitializedDefaultN(finish_, new_size - size());
         } else {
             const SizeType old_size = size();
             growShrinkAux(new_size);
-            std::uninitialized_default_construct_n(finish_,
-                                                   new_size - old_size);
+            uninitializedDefaultN(finish_, new_size - old_size);
+        }
+        finish_ = start_ + new_size;
+    }
+
+    /// Resizes the `Vector` to the size returned by `op(data(), count)`,
+    /// which writes the elements directly, like
+    /// `std::string::resize_and_overwrite()` in C++23.
+    ///
+    /// The capacity is raised to at least `count` first, growing
+    /// geometrically so that repeated appends stay amortized `O(1)`. `op` may
+    /// read and modify the existing elements and write to the uninitialized
+    /// storage up to `count`, and returns the new size, at most `count`. This
+    /// lets a reader fill the `Vector` without zeroing it or going through a
+    /// staging buffer. If `op` throws, the size is unchanged.
+    ///
+    /// Only trivially copyable `T` can be left uninitialized this way.
+    ///
+    /// # Example
+    ///
+    /// ```cpp
+    /// Vector<char> buf;
+    /// buf.resize_and_overwrite(4096, [&](char* p, std::size_t n) {
+    ///     return std::size_t(std::max<ssize_t>(::read(fd, p, n), 0));
+    /// });
+    /// ```
+    template <typename Operation>
+    void resize_and_overwrite(SizeType count, Operation op) {
+        static_assert(std::is_trivially_copyable_v<T>,
+                      "resize_and_overwrite needs trivially copyable values");
+        if (count > capacity()) {
+            if (count > max_size()) {
+                throw std::length_error(
+                    "Vector::resize_and_overwrite too large size");
+            }
+            growShrinkAux(std::max(count, next_size(capacity())));
         }
+        const SizeType new_size = std::move(op)(start_, count);
+        assert(new_size <= count);
         finish_ = start_ + new_size;
     }
 
@@ -826,7 +884,7 @@ public:
     ///
     /// The global `std::swap()` function is specialized such that
     /// `std::swap(v1, v2)` will feed to this function.
-    void swap(Vector& rhs) noexcept {
+    ALGO_CONSTEXPR20 void swap(Vector& rhs) noexcept {
         using std::swap;
         swap(start_, rhs.start_);
         swap(finish_, rhs.finish_);
@@ -835,7 +893,8 @@ public:
 
 private:
     // Called by `Vector(Vector&&, const AllocatorType& alloc)`
-    Vector(Vector&& rhs, const AllocatorType& alloc, std::true_type) noexcept
+    ALGO_CONSTEXPR20 Vector(Vector&& rhs, const AllocatorType& alloc,
+                            std::true_type) noexcept
         : allocator_(alloc) {
         start_ = rhs.start_;
         finish_ = rhs.finish_;
@@ -843,7 +902,8 @@ private:
         rhs.start_ = rhs.finish_ = rhs.end_of_storage_ = nullptr;
     }
 
-    Vector(Vector&& rhs, const AllocatorType& alloc, std::false_type)
+    ALGO_CONSTEXPR20 Vector(Vector&& rhs, const AllocatorType& alloc,
+                            std::false_type)
         : allocator_(alloc) {
         if (rhs.get_allocator() == alloc) {
             start_ = rhs.start_;
@@ -852,7 +912,7 @@ private:
             rhs.start_ = rhs.finish_ = rhs.end_of_storage_ = nullptr;
         } else if (!rhs.empty()) {
             create(rhs.size());
-            finish_ = std::uninitialized_move(rhs.begin(), rhs.end(), start_);
+            finish_ = uninitializedMove(rhs.begin(), rhs.end(), start_);
             rhs.clear();
         }
     }
@@ -861,21 +921,86 @@ private:
         return sz * 3 / 2 + 1;
     }
 
-    void addressCheck(ConstIterator p) const {
-        if (p >= start_ && p < finish_) {
+    static constexpr bool constantEvaluated() noexcept {
+#if defined(__cpp_lib_constexpr_dynamic_alloc)
+        return std::is_constant_evaluated();
+#else
+        return false;
+#endif
+    }
+
+    template <typename... Args>
+    static ALGO_CONSTEXPR20 void constructAt(Pointer p, Args&&... args) {
+#if defined(__cpp_lib_constexpr_dynamic_alloc)
+        std::construct_at(p, std::forward<Args>(args)...);
+#else
+        ::new (static_cast<void*>(p)) T(std::forward<Args>(args)...);
+#endif
+    }
+
+    // The `std::uninitialized_*` algorithms are not `constexpr`, so constant
+    // evaluation constructs the elements one at a time.
+    template <typename Iter>
+    static ALGO_CONSTEXPR20 Pointer uninitializedCopy(Iter first, Iter last,
+                                                      Pointer out) {
+        if (constantEvaluated()) {
+            for (; first != last; ++first, ++out) {
+                constructAt(out, *first);
+            }
+            return out;
+        }
+        return std::uninitialized_copy(first, last, out);
+    }
+
+    static ALGO_CONSTEXPR20 Pointer uninitializedMove(Pointer first,
+                                                      Pointer last,
+                                                      Pointer out) {
+        return uninitializedCopy(std::make_move_iterator(first),
+                                 std::make_move_iterator(last), out);
+    }
+
+    static ALGO_CONSTEXPR20 Pointer uninitializedFillN(Pointer out,
+                                                       SizeType n,
+                                                       const T& value) {
+        if (constantEvaluated()) {
+            for (; n != 0; --n, ++out) {
+                constructAt(out, value);
+            }
+            return out;
+        }
+        return std::uninitialized_fill_n(out, n, value);
+    }
+
+    // Constant evaluation cannot leave trivial types uninitialized, so they
+    // are value-initialized there.
+    static ALGO_CONSTEXPR20 Pointer uninitializedDefaultN(Pointer out,
+                                                          SizeType n) {
+        if (constantEvaluated()) {
+            for (; n != 0; --n, ++out) {
+                constructAt(out);
+            }
+            return out;
+        }
+        return std::uninitialized_default_construct_n(out, n);
+    }
+
+    ALGO_CONSTEXPR20 void addressCheck(ConstIterator p) const {
+        // Pointers into unrelated objects do not compare in constant
+        // expressions, where `p` cannot alias anyway.
+        if (!constantEvaluated() && p >= start_ && p < finish_) {
             throw std::range_error("Vector:addressCheck failed");
         }
     }
 
-    void rangeCheck(SizeType n) const {
+    ALGO_CONSTEXPR20 void rangeCheck(SizeType n) const {
         if (n >= size()) {
             throw std::out_of_range("Vector::rangeCheck failed");
         }
     }
 
-    void deallocate(Pointer p, SizeType sz) {
+    ALGO_CONSTEXPR20 void deallocate(Pointer p, SizeType sz) {
         if (p) {
-            if constexpr (relocatable) {
+            if (relocatable && !constantEvaluated()) {
                 std::free(p);
             } else {
                 allocator_.deallocate(p, sz);
@@ -883,54 +1008,67 @@ private:
         }
     }
 
-    Pointer allocate(SizeType sz) {
-        if constexpr (relocatable) {
-            if (sz == 0) {
-                return Pointer();
-            }
-
+    // Constant evaluation allocates through `std::allocator` only.
+    ALGO_CONSTEXPR20 Pointer allocate(SizeType sz) {
+        if (sz == 0) {
+            return Pointer();
+        }
+        if (relocatable && !constantEvaluated()) {
             // consistent with the behavior of allocator
             auto p = (Pointer)std::malloc(sz * sizeof(T));
             if (!p) {
                 throw std::bad_alloc();
             }
             return p;
-        } else {
-            return sz != 0 ? allocator_.allocate(sz) : Pointer();
         }
+        return allocator_.allocate(sz);
     }
 
-    void create(SizeType sz) {
+    ALGO_CONSTEXPR20 void create(SizeType sz) {
         start_ = allocate(sz);
         finish_ = start_;
         end_of_storage_ = start_ + sz;
     }
 
+    // Copies `n` trivially copyable elements. Empty ranges may come from a
+    // `Vector` without storage, whose pointers are null.
+    static ALGO_CONSTEXPR20 void moveBytes(Pointer dst, const T* src,
+                                           SizeType n) noexcept {
+        if (constantEvaluated()) {
+            for (SizeType i = 0; i < n; ++i) {
+                constructAt(dst + i, src[i]);
+            }
+        } else if (n != 0) {
+            __builtin_memmove(static_cast<void*>(dst), src, n * sizeof(T));
+        }
+    }
+
     // When calling `push_back()` and `emplace_back()`, `size()` may already be
     // equal to `capacity()`. The memory region expands and pushes the new
     // element at the end.
     //
     // When calling `shrinkToFit()`, the memory should be shrinked to `size()`.
-    void growShrinkAux(SizeType sz) {
+    ALGO_CONSTEXPR20 void growShrinkAux(SizeType sz) {
         assert(sz >= size());
 
         const SizeType old_size = size();
         Pointer tmp;
-        if constexpr (relocatable) {
-            tmp = (Pointer)std::realloc(start_, sz * sizeof(T));
-            if (!tmp) {
-                throw std::bad_alloc();
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            if (relocatable && !constantEvaluated()) {
+                tmp = (Pointer)std::realloc(start_, sz * sizeof(T));
+                if (!tmp) {
+                    throw std::bad_alloc();
+                }
+            } else {
+                tmp = allocate(sz);
+                moveBytes(tmp, start_, old_size);
+                deallocate(start_, end_of_storage_ - start_);
             }
-        } else if constexpr (std::is_trivially_copyable_v<T>) {
-            tmp = allocate(sz);
-            __builtin_memmove(tmp, start_, old_size * sizeof(T));
-            deallocate(start_, end_of_storage_ - start_);
         } else {
             tmp = allocate(sz);
             try {
-                std::uninitialized_copy(make_move_if_noexcept_iterator(start_),
-                                        make_move_if_noexcept_iterator(finish_),
-                                        tmp);
+                uninitializedCopy(make_move_if_noexcept_iterator(start_),
+                                  make_move_if_noexcept_iterator(finish_), tmp);
             } catch (...) {
                 deallocate(tmp, sz);
                 throw;
@@ -945,25 +1083,24 @@ private:
     }
 
     template <typename... Args>
-    Iterator insertExpandAux(Iterator pos, Args&&... args) {
+    ALGO_CONSTEXPR20 Iterator insertExpandAux(Iterator pos, Args&&... args) {
         const SizeType offset = pos - begin();
         const SizeType old_size = size(); // equal to capacity()
         const SizeType sz = next_size(old_size);
 
         Pointer tmp = allocate(sz);
         if constexpr (std::is_trivially_copyable_v<T>) {
-            __builtin_memmove(tmp, start_, offset * sizeof(T));
-            tmp[offset] = T(std::forward<Args>(args)...);
-            __builtin_memmove(tmp + offset + 1, start_ + offset,
-                              (old_size - offset) * sizeof(T));
+            moveBytes(tmp, start_, offset);
+            constructAt(tmp + offset, std::forward<Args>(args)...);
+            moveBytes(tmp + offset + 1, start_ + offset, old_size - offset);
             deallocate(start_, old_size);
         } else {
             try {
-                std::uninitialized_copy(
+                uninitializedCopy(
                     make_move_if_noexcept_iterator(start_),
                     make_move_if_noexcept_iterator(start_ + offset), tmp);
-                new (tmp + offset) T(std::forward<Args>(args)...);
-                std::uninitialized_copy(
+                constructAt(tmp + offset, std::forward<Args>(args)...);
+                uninitializedCopy(
                     make_move_if_noexcept_iterator(start_ + offset),
                     make_move_if_noexcept_iterator(finish_), tmp + offset + 1);
             } catch (...) {
@@ -980,26 +1117,26 @@ private:
         return start_ + offset;
     }
 
-    Iterator insertRangeExpandAux(Iterator pos, SizeType count,
-                                  const T& value) {
+    ALGO_CONSTEXPR20 Iterator insertRangeExpandAux(Iterator pos,
+                                                   SizeType count,
+                                                   const T& value) {
         const SizeType offset = pos - begin();
         const SizeType old_size = size();
         const SizeType sz = old_size + std::max(count, old_size) + 1;
 
         Pointer tmp = allocate(sz);
         if constexpr (std::is_trivially_copyable_v<T>) {
-            __builtin_memmove(tmp, start_, offset * sizeof(T));
-            std::fill_n(tmp + offset, count, value);
-            __builtin_memmove(tmp + offset + count, start_ + offset,
-                              (old_size - offset) * sizeof(T));
-            deallocate(start_, old_size);
+            moveBytes(tmp, start_, offset);
+            uninitializedFillN(tmp + offset, count, value);
+            moveBytes(tmp + offset + count, start_ + offset, old_size - offset);
+            deallocate(start_, end_of_storage_ - start_);
         } else {
             try {
-                std::uninitialized_copy(
+                uninitializedCopy(
                     make_move_if_noexcept_iterator(start_),
                     make_move_if_noexcept_iterator(start_ + offset), tmp);
-                std::uninitialized_fill_n(tmp + offset, count, value);
-                std::uninitialized_copy(
+                uninitializedFillN(tmp + offset, count, value);
+                uninitializedCopy(
                     make_move_if_noexcept_iterator(start_ + offset),
                     make_move_if_noexcept_iterator(finish_),
                     tmp + offset + count);
@@ -1018,26 +1155,26 @@ private:
     }
 
     template <typename Iter>
-    Iterator insertRangeExpandAux(Iterator pos, SizeType count, Iter first,
-                                  Iter last) {
+    ALGO_CONSTEXPR20 Iterator insertRangeExpandAux(Iterator pos,
+                                                   SizeType count, Iter first,
+                                                   Iter last) {
         const SizeType offset = pos - begin();
         const SizeType old_size = size();
         const SizeType sz = old_size + std::max(count, old_size) + 1;
 
         Pointer tmp = allocate(sz);
         if constexpr (std::is_trivially_copyable_v<T>) {
-            __builtin_memmove(tmp, start_, offset * sizeof(T));
-            std::copy(first, last, tmp + offset);
-            __builtin_memmove(tmp + offset + count, start_ + offset,
-                              (old_size - offset) * sizeof(T));
-            deallocate(start_, old_size);
+            moveBytes(tmp, start_, offset);
+            uninitializedCopy(first, last, tmp + offset);
+            moveBytes(tmp + offset + count, start_ + offset, old_size - offset);
+            deallocate(start_, end_of_storage_ - start_);
         } else {
             try {
-                std::uninitialized_copy(
+                uninitializedCopy(
                     make_move_if_noexcept_iterator(start_),
                     make_move_if_noexcept_iterator(start_ + offset), tmp);
-                std::uninitialized_copy(first, last, tmp + offset);
-                std::uninitialized_copy(
+                uninitializedCopy(first, last, tmp + offset);
+                uninitializedCopy(
                     make_move_if_noexcept_iterator(start_ + offset),
                     make_move_if_noexcept_iterator(finish_),
                     tmp + offset + count);
@@ -1056,8 +1193,8 @@ private:
     }
 
     template <typename Iter>
-    void insertRangeAux(Iterator pos, Iter first, Iter last,
-                        std::input_iterator_tag) {
+    ALGO_CONSTEXPR20 void insertRangeAux(Iterator pos, Iter first, Iter last,
+                                         std::input_iterator_tag) {
         if (pos == finish_) {
             while (first != last) {
                 insert(end(), *first++);
@@ -1070,27 +1207,26 @@ private:
     }
 
     template <typename Iter>
-    void insertRangeAux(Iterator pos, Iter first, Iter last,
-                        std::forward_iterator_tag) {
+    ALGO_CONSTEXPR20 void insertRangeAux(Iterator pos, Iter first, Iter last,
+                                         std::forward_iterator_tag) {
         const SizeType count = std::distance(first, last);
         if (finish_ + count <= end_of_storage_) {
             if (pos == finish_) {
-                std::uninitialized_copy(first, last, finish_);
+                uninitializedCopy(first, last, finish_);
             } else {
                 const SizeType m = finish_ - pos;
                 if (count == m) {
-                    std::uninitialized_move(pos, finish_, finish_);
+                    uninitializedMove(pos, finish_, finish_);
                     std::copy(first, last, finish_);
                 } else if (count < m) {
-                    std::uninitialized_move(finish_ - count, finish_, finish_);
+                    uninitializedMove(finish_ - count, finish_, finish_);
                     std::move_backward(pos, finish_ - count, finish_);
                     std::copy(first, last, pos);
                 } else {
-                    std::uninitialized_move(pos, finish_,
-                                            finish_ + (count - m));
+                    uninitializedMove(pos, finish_, finish_ + (count - m));
                     auto p1 = std::next(first, m);
                     std::copy(first, p1, pos);
-                    std::uninitialized_copy(p1, last, finish_);
+                    uninitializedCopy(p1, last, finish_);
                 }
             }
             finish_ += count;
@@ -1128,15 +1264,15 @@ private:
 /// `Vector`s are considered equaivalent if their sizes are equal, and if
 /// corresponding elements compare equal.
 template <typename T, typename Allocator>
-inline bool operator==(const Vector<T, Allocator>& x,
-                       const Vector<T, Allocator>& y) {
+inline ALGO_CONSTEXPR20 bool operator==(const Vector<T, Allocator>& x,
+                                        const Vector<T, Allocator>& y) {
     return x.size() == y.size() && std::equal(x.begin(), x.end(), y.begin());
 }
 
 /// Based on operator==
 template <typename T, typename Allocator>
-inline bool operator!=(const Vector<T, Allocator>& x,
-                       const Vector<T, Allocator>& y) {
+inline ALGO_CONSTEXPR20 bool operator!=(const Vector<T, Allocator>& x,
+                                        const Vector<T, Allocator>& y) {
     return !(x == y);
 }
 
@@ -1144,29 +1280,29 @@ inline bool operator!=(const Vector<T, Allocator>& x,
 ///
 /// This is a total ordering relation.
 template <typename T, typename Allocator>
-inline bool operator<(const Vector<T, Allocator>& x,
-                      const Vector<T, Allocator>& y) {
+inline ALGO_CONSTEXPR20 bool operator<(const Vector<T, Allocator>& x,
+                                       const Vector<T, Allocator>& y) {
     return std::lexicographical_compare(x.begin(), x.end(), y.begin(), y.end());
 }
 
 /// Based on operator<
 template <typename T, typename Allocator>
-inline bool operator>(const Vector<T, Allocator>& x,
-                      const Vector<T, Allocator>& y) {
+inline ALGO_CONSTEXPR20 bool operator>(const Vector<T, Allocator>& x,
+                                       const Vector<T, Allocator>& y) {
     return y < x;
 }
 
 /// Based on operator<
 template <typename T, typename Allocator>
-inline bool operator>=(const Vector<T, Allocator>& x,
-                       const Vector<T, Allocator>& y) {
+inline ALGO_CONSTEXPR20 bool operator>=(const Vector<T, Allocator>& x,
+                                        const Vector<T, Allocator>& y) {
     return !(x < y);
 }
 
 /// Based on operator<
 template <typename T, typename Allocator>
-inline bool operator<=(const Vector<T, Allocator>& x,
-                       const Vector<T, Allocator>& y) {
+inline ALGO_CONSTEXPR20 bool operator<=(const Vector<T, Allocator>& x,
+                                        const Vector<T, Allocator>& y) {
     return !(y < x);
 }
 
@@ -1174,7 +1310,68 @@ inline bool operator<=(const Vector<T, Allocator>& x,
 ///
 /// See `Vector::swap` for more information.
 template <typename T, typename Allocator>
-inline void swap(Vector<T, Allocator>& x, Vector<T, Allocator>& y) noexcept {
+inline ALGO_CONSTEXPR20 void swap(Vector<T, Allocator>& x,
+                                  Vector<T, Allocator>& y) noexcept {
     x.swap(y);
 }
+
+/// Copies the `N` elements of `v` into a `std::array`.
+///
+/// A `Vector` built in a constant expression cannot outlive it, so a table
+/// computed at compile time is frozen into an array to be kept. Throws
+/// `std::length_error`, a compile error in a constant expression, if
+/// `v.size() != N`.
+///
+/// # Example
+///
+/// ```cpp
+/// constexpr auto squares = [] {
+///     Vector<int> v;
+///     for (int i = 0; i < 4; ++i) {
+///         v.push_back(i * i);
+///     }
+///     return v;
+/// };
+/// constexpr std::array<int, 4> table = to_array<4>(squares());
+/// static_assert(table[3] == 9);
+/// ```
+template <std::size_t N, typename T, typename Allocator>
+ALGO_CONSTEXPR20 std::array<T, N> to_array(const Vector<T, Allocator>& v) {
+    if (v.size() != N) {
+        throw std::length_error("to_array: size mismatch");
+    }
+    std::array<T, N> out{};
+    for (std::size_t i = 0; i < N; ++i) {
+        out[i] = v[i];
+    }
+    return out;
+}
+
+#if defined(__cpp_lib_constexpr_dynamic_alloc)
+/// Evaluates `Make()`, which returns a `Vector`, into a `std::array` of its
+/// size, all at compile time. `Make` is a `constexpr` function or a lambda
+/// without captures.
+///
+/// # Example
+///
+/// ```cpp
+/// constexpr auto primes = [] {
+///     Vector<int> v;
+///     for (int n = 2; n < 100; ++n) {
+///         if (std::none_of(v.begin(), v.end(),
+///                          [n](int p) { return n % p == 0; })) {
+///             v.push_back(n);
+///         }
+///     }
+///     return v;
+/// };
+/// constexpr auto table = to_array<primes>();
+/// static_assert(table.size() == 25);
+/// ```
+template <auto Make>
+constexpr auto to_array() {
+    constexpr std::size_t n = Make().size();
+    return to_array<n>(Make());
+}
+#endif
 } // namespace algo
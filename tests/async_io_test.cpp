@@ -0,0 +1,143 @@
+#define CATCH_CONFIG_MAIN
+#include "async_io.hpp"
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include "aligned_allocator.hpp"
+
+using namespace algo;
+
+static const std::string path = "/tmp/algo_async_io_test.bin";
+
+static Vector<std::uint64_t> makeValues(std::size_t n) {
+    Vector<std::uint64_t> values;
+    for (std::size_t i = 0; i < n; ++i) {
+        values.push_back(i * 0x9E3779B97F4A7C15ull);
+    }
+    return values;
+}
+
+TEST_CASE("AsyncIo reads and writes with callbacks") {
+    for (AsyncIo::Backend b :
+         {AsyncIo::Backend::io_uring, AsyncIo::Backend::thread_pool}) {
+        AsyncIo io(4, b);
+        if (b == AsyncIo::Backend::thread_pool) {
+            REQUIRE(io.backend() == AsyncIo::Backend::thread_pool);
+        }
+        detail::FileDescriptor fd(path, O_RDWR | O_CREAT | O_TRUNC);
+
+        Vector<std::uint32_t> blocks[16];
+        std::size_t written = 0;
+        for (std::uint32_t i = 0; i < 16; ++i) {
+            blocks[i] = Vector<std::uint32_t>(1000, i);
+            io.write(fd.get(), blocks[i].data(), 4000, i * 4000,
+                     [&](std::int64_t r) {
+                         REQUIRE(r == 4000);
+                         ++written;
+                     });
+            REQUIRE(io.in_flight() <= 4);
+        }
+        io.wait();
+        REQUIRE(written == 16);
+        REQUIRE(io.in_flight() == 0);
+
+        Vector<std::uint32_t> read(16000);
+        std::size_t done = 0;
+        for (std::uint32_t i = 0; i < 16; ++i) {
+            io.read(fd.get(), read.data() + i * 1000, 4000, i * 4000,
+                    [&](std::int64_t r) {
+                        REQUIRE(r == 4000);
+                        ++done;
+                    });
+        }
+        while (done < 16) {
+            io.poll();
+        }
+        for (std::uint32_t i = 0; i < 16000; ++i) {
+            REQUIRE(read[i] == i / 1000);
+        }
+
+        // Reads past the end are short, and errors come back as `-errno`.
+        std::int64_t result = 0;
+        io.read(fd.get(), read.data(), 4000, 62000,
+                [&](std::int64_t r) { result = r; });
+        io.wait();
+        REQUIRE(result == 2000);
+        io.read(-1, read.data(), 4000, 0, [&](std::int64_t r) { result = r; });
+        io.wait();
+        REQUIRE(result == -EBADF);
+    }
+}
+
+TEST_CASE("AsyncIo rethrows the first callback exception") {
+    AsyncIo io(8, AsyncIo::Backend::thread_pool);
+    detail::FileDescriptor fd(path, O_RDWR | O_CREAT | O_TRUNC);
+    char buf[16] = {};
+    std::size_t ran = 0;
+    for (int i = 0; i < 4; ++i) {
+        io.write(fd.get(), buf, sizeof(buf), 0, [&](std::int64_t) {
+            ++ran;
+            throw std::runtime_error("callback");
+        });
+    }
+    while (io.in_flight() > 0) {
+        REQUIRE_THROWS_AS(io.wait(), std::runtime_error);
+    }
+    REQUIRE(ran == 4);
+}
+
+TEST_CASE("AsyncIo loads and stores vectors") {
+    for (AsyncIo::Backend b :
+         {AsyncIo::Backend::io_uring, AsyncIo::Backend::thread_pool}) {
+        AsyncIo io(8, b);
+        for (std::size_t n : {0, 1, 511, 512, 513, 300000}) {
+            const Vector<std::uint64_t> values = makeValues(n);
+            io.store(path, values);
+            Vector<std::uint64_t> read = {1, 2, 3};
+            io.load(path, read);
+            REQUIRE(read == values);
+        }
+    }
+}
+
+TEST_CASE("AsyncIo loads and stores with direct I/O") {
+    using Aligned =
+        Vector<std::uint64_t, AlignedAllocator<std::uint64_t, 4096>>;
+    for (AsyncIo::Backend b :
+         {AsyncIo::Backend::io_uring, AsyncIo::Backend::thread_pool}) {
+        AsyncIo io(8, b);
+        for (std::size_t n : {0, 1, 511, 512, 513, 300000}) {
+            const Vector<std::uint64_t> values = makeValues(n);
+            Aligned aligned;
+            for (std::uint64_t v : values) {
+                aligned.push_back(v);
+            }
+            io.store(path, aligned, true);
+            Aligned read;
+            io.load(path, read, true);
+            REQUIRE(read.size() == n);
+            REQUIRE(std::equal(read.begin(), read.end(), values.begin()));
+        }
+    }
+}
+
+TEST_CASE("AsyncIo reports errors") {
+    AsyncIo io;
+    Vector<std::uint64_t> values;
+    REQUIRE_THROWS_AS(io.load("/tmp/algo_async_io_missing.bin", values),
+                      std::system_error);
+
+    const Vector<char> odd(13, 'x');
+    io.store(path, odd);
+    REQUIRE_THROWS_AS(io.load(path, values), std::runtime_error);
+
+    // A plain `Vector` is only aligned to `alignof(T)`.
+    const Vector<std::uint64_t> plain(2000, 7);
+    if (reinterpret_cast<std::uintptr_t>(plain.data()) % 4096 != 0) {
+        REQUIRE_THROWS_AS(io.store(path, plain, true), std::invalid_argument);
+    }
+    std::remove(path.c_str());
+}
@@ -0,0 +1,198 @@
+#define CATCH_CONFIG_MAIN
+#include "bitset.hpp"
+#include <catch2/catch.hpp>
+#include <bitset>
+#include <random>
+#include <vector>
+
+using namespace algo;
+
+TEST_CASE("bitset basic operations") {
+    Bitset<130> bits;
+    REQUIRE(bits.size() == 130);
+    REQUIRE(bits.none());
+    REQUIRE(bits.find_first() == Bitset<130>::npos);
+
+    bits.set(0).set(64).set(129);
+    REQUIRE(bits.test(64));
+    REQUIRE(!bits.test(63));
+    REQUIRE(bits.count() == 3);
+    REQUIRE(bits.find_first() == 0);
+    REQUIRE(bits.find_next(0) == 64);
+    REQUIRE(bits.find_next(64) == 129);
+    REQUIRE(bits.find_next(129) == Bitset<130>::npos);
+
+    bits.reset(64).flip(1);
+    std::vector<std::size_t> set;
+    bits.for_each_set([&](std::size_t pos) { set.push_back(pos); });
+    REQUIRE(set == std::vector<std::size_t>{0, 1, 129});
+
+    bits.set();
+    REQUIRE(bits.all());
+    REQUIRE(bits.count() == 130);
+    REQUIRE((~bits).none());
+    bits.reset();
+    REQUIRE(bits.none());
+
+    REQUIRE_THROWS_AS(bits.at(130), std::out_of_range);
+}
+
+TEST_CASE("bitset set algebra matches std::bitset") {
+    std::mt19937_64 gen(5);
+    std::bitset<1000> sa, sb;
+    Bitset<1000> a, b;
+    for (std::size_t i = 0; i < 1000; ++i) {
+        if (gen() % 3 == 0) {
+            sa.set(i);
+            a.set(i);
+        }
+        if (gen() % 2 == 0) {
+            sb.set(i);
+            b.set(i);
+        }
+    }
+
+    auto same = [](const Bitset<1000>& x, const std::bitset<1000>& y) {
+        for (std::size_t i = 0; i < 1000; ++i) {
+            if (x.test(i) != y.test(i)) {
+                return false;
+            }
+        }
+        return x.count() == y.count();
+    };
+    REQUIRE(same(a & b, sa & sb));
+    REQUIRE(same(a | b, sa | sb));
+    REQUIRE(same(a ^ b, sa ^ sb));
+    REQUIRE(same(Bitset<1000>(a).and_not(b), sa & ~sb));
+    REQUIRE(same(~a, ~sa));
+    REQUIRE((a & b) == (b & a));
+    REQUIRE(a != b);
+}
+
+TEST_CASE("dynamic bitset") {
+    DynamicBitset bits(100);
+    REQUIRE(bits.size() == 100);
+    REQUIRE(bits.word_count() == 2);
+    bits.set(10).set(99);
+    REQUIRE(bits.count() == 2);
+
+    bits.resize(200, true);
+    REQUIRE(bits.count() == 102);
+    REQUIRE(bits.test(150));
+    REQUIRE(!bits.test(98));
+    REQUIRE(bits.find_next(99) == 100);
+
+    bits.resize(64);
+    REQUIRE(bits.count() == 1);
+    bits.resize(70);
+    REQUIRE(bits.count() == 1);
+
+    bits.push_back(true);
+    REQUIRE(bits.size() == 71);
+    REQUIRE(bits.test(70));
+
+    DynamicBitset ones(71, true);
+    REQUIRE(ones.all());
+    REQUIRE((bits & ones) == bits);
+    REQUIRE((~ones).none());
+    REQUIRE(DynamicBitset(ones).and_not(bits).count() == 69);
+
+    REQUIRE_THROWS_AS(bits &= DynamicBitset(5), std::invalid_argument);
+    REQUIRE_THROWS_AS(bits.at(71), std::out_of_range);
+
+    bits.clear();
+    REQUIRE(bits.empty());
+    REQUIRE(bits.none());
+}
+
+TEST_CASE("dynamic bitset large operations") {
+    std::mt19937_64 gen(9);
+    const std::size_t n = 10007;
+    DynamicBitset a(n), b(n);
+    std::vector<bool> va(n), vb(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        va[i] = gen() % 2;
+        vb[i] = gen() % 5 == 0;
+        a.set(i, va[i]);
+        b.set(i, vb[i]);
+    }
+
+    DynamicBitset x = a ^ b;
+    DynamicBitset y = DynamicBitset(a).and_not(b);
+    std::size_t cx = 0;
+    std::size_t cy = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        REQUIRE(x.test(i) == (va[i] != vb[i]));
+        REQUIRE(y.test(i) == (va[i] && !vb[i]));
+        cx += x.test(i);
+        cy += y.test(i);
+    }
+    REQUIRE(x.count() == cx);
+    REQUIRE(y.count() == cy);
+
+    std::size_t visited = 0;
+    std::size_t prev = DynamicBitset::npos;
+    for (std::size_t i = x.find_first(); i != DynamicBitset::npos;
+         i = x.find_next(i)) {
+        REQUIRE(x.test(i));
+        REQUIRE((prev == DynamicBitset::npos || prev < i));
+        prev = i;
+        ++visited;
+    }
+    REQUIRE(visited == cx);
+}
+
+TEST_CASE("rank select") {
+    DynamicBitset bits(100);
+    bits.set(3).set(50).set(99);
+    RankSelect rs(std::move(bits));
+    REQUIRE(rs.ones() == 3);
+    REQUIRE(rs.rank1(0) == 0);
+    REQUIRE(rs.rank1(4) == 1);
+    REQUIRE(rs.rank1(51) == 2);
+    REQUIRE(rs.rank1(100) == 3);
+    REQUIRE(rs.rank0(100) == 97);
+    REQUIRE(rs.select1(0) == 3);
+    REQUIRE(rs.select1(1) == 50);
+    REQUIRE(rs.select1(2) == 99);
+    REQUIRE(rs.select0(0) == 0);
+    REQUIRE(rs.select0(3) == 4);
+    REQUIRE(rs.select0(96) == 98);
+
+    RankSelect empty;
+    REQUIRE(empty.size() == 0);
+    REQUIRE(empty.rank1(0) == 0);
+}
+
+TEST_CASE("rank select matches brute force") {
+    std::mt19937_64 gen(21);
+    for (std::size_t n : {1u, 63u, 64u, 511u, 512u, 513u, 4096u, 100000u}) {
+        for (int density : {1, 2, 50, 1000}) {
+            DynamicBitset bits(n);
+            for (std::size_t i = 0; i < n; ++i) {
+                bits.set(i, gen() % std::uint64_t(density) == 0);
+            }
+            std::vector<std::size_t> positions;
+            std::vector<std::size_t> zeros;
+            for (std::size_t i = 0; i < n; ++i) {
+                (bits.test(i) ? positions : zeros).push_back(i);
+            }
+
+            RankSelect rs(bits);
+            REQUIRE(rs.ones() == positions.size());
+            std::size_t rank = 0;
+            for (std::size_t i = 0; i <= n; ++i) {
+                REQUIRE(rs.rank1(i) == rank);
+                if (i < n && bits.test(i)) {
+                    ++rank;
+                }
+            }
+            for (std::size_t k = 0; k < positions.size(); ++k) {
+                REQUIRE(rs.select1(k) == positions[k]);
+            }
+            for (std::size_t k = 0; k < zeros.size(); ++k) {
+                REQUIRE(rs.select0(k) == zeros[k]);
+            }
+        }
+    }
+}
@@ -0,0 +1,254 @@
+#define CATCH_CONFIG_MAIN
+#include "cache.hpp"
+#include <catch2/catch.hpp>
+#include <atomic>
+#include <list>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace algo;
+
+TEST_CASE("lru cache evicts the least recently used") {
+    LruCache<int, std::string> cache(2);
+    REQUIRE(cache.empty());
+    REQUIRE(cache.capacity() == 2);
+
+    REQUIRE(cache.put(1, "one"));
+    REQUIRE(cache.put(2, "two"));
+    REQUIRE(*cache.find(1) == "one");
+    REQUIRE(cache.put(3, "three"));
+
+    REQUIRE(cache.size() == 2);
+    REQUIRE(cache.find(2) == nullptr);
+    REQUIRE(*cache.find(1) == "one");
+    REQUIRE(*cache.find(3) == "three");
+
+    REQUIRE(!cache.put(1, "uno"));
+    REQUIRE(*cache.peek(1) == "uno");
+
+    std::vector<int> order;
+    cache.for_each([&](int k, const std::string&) { order.push_back(k); });
+    REQUIRE(order == std::vector<int>{1, 3});
+}
+
+TEST_CASE("lru cache erase and clear") {
+    LruCache<int, int> cache(3);
+    cache.put(1, 10);
+    cache.put(2, 20);
+    cache.put(3, 30);
+
+    REQUIRE(cache.erase(2));
+    REQUIRE(!cache.erase(2));
+    REQUIRE(!cache.contains(2));
+    REQUIRE(cache.size() == 2);
+
+    // The freed slot is reused before anything is evicted.
+    cache.put(4, 40);
+    REQUIRE(cache.contains(1));
+    REQUIRE(cache.contains(3));
+    REQUIRE(cache.contains(4));
+
+    cache.clear();
+    REQUIRE(cache.empty());
+    REQUIRE(!cache.contains(1));
+    cache.put(5, 50);
+    REQUIRE(*cache.find(5) == 50);
+}
+
+TEST_CASE("lru cache matches a reference model") {
+    const std::size_t capacity = 64;
+    LruCache<int, int> cache(capacity);
+    std::list<std::pair<int, int>> model;
+    std::unordered_map<int, std::list<std::pair<int, int>>::iterator> where;
+
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> key(0, 200);
+    std::uniform_int_distribution<int> op(0, 9);
+    for (int i = 0; i < 100000; ++i) {
+        const int k = key(gen);
+        const int kind = op(gen);
+        auto it = where.find(k);
+        if (kind < 5) {
+            int* v = cache.find(k);
+            REQUIRE((v != nullptr) == (it != where.end()));
+            if (v) {
+                REQUIRE(*v == it->second->second);
+                model.splice(model.begin(), model, it->second);
+            }
+        } else if (kind < 9) {
+            REQUIRE(cache.put(k, i) == (it == where.end()));
+            if (it != where.end()) {
+                it->second->second = i;
+                model.splice(model.begin(), model, it->second);
+            } else {
+                if (model.size() == capacity) {
+                    where.erase(model.back().first);
+                    model.pop_back();
+                }
+                model.emplace_front(k, i);
+                where[k] = model.begin();
+            }
+        } else {
+            REQUIRE(cache.erase(k) == (it != where.end()));
+            if (it != where.end()) {
+                model.erase(it->second);
+                where.erase(it);
+            }
+        }
+        REQUIRE(cache.size() == model.size());
+    }
+}
+
+TEST_CASE("lru cache rejects zero capacity") {
+    REQUIRE_THROWS_AS((LruCache<int, int>(0)), std::invalid_argument);
+    REQUIRE_THROWS_AS((ClockProCache<int, int>(0)), std::invalid_argument);
+}
+
+TEST_CASE("clock-pro cache basic operations") {
+    ClockProCache<int, std::string> cache(3);
+    REQUIRE(cache.put(1, "one"));
+    REQUIRE(cache.put(2, "two"));
+    REQUIRE(cache.put(3, "three"));
+    REQUIRE(cache.size() == 3);
+    REQUIRE(*cache.find(2) == "two");
+
+    REQUIRE(!cache.put(2, "deux"));
+    REQUIRE(*cache.peek(2) == "deux");
+
+    cache.put(4, "four");
+    REQUIRE(cache.size() == 3);
+    REQUIRE(cache.contains(4));
+
+    REQUIRE(cache.erase(4));
+    REQUIRE(!cache.contains(4));
+    REQUIRE(cache.size() == 2);
+
+    cache.clear();
+    REQUIRE(cache.empty());
+    REQUIRE(cache.find(2) == nullptr);
+}
+
+TEST_CASE("clock-pro cache never exceeds its capacity") {
+    const std::size_t capacity = 50;
+    ClockProCache<int, int> cache(capacity);
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> key(0, 500);
+    for (int i = 0; i < 100000; ++i) {
+        const int k = key(gen);
+        if (int* v = cache.find(k)) {
+            REQUIRE(*v == k * 3);
+        } else if (i % 17 == 0) {
+            cache.erase(k);
+        } else {
+            cache.put(k, k * 3);
+        }
+        REQUIRE(cache.size() <= capacity);
+    }
+}
+
+TEST_CASE("clock-pro cache resists scans") {
+    const int capacity = 100;
+    const int hot = 50;
+    ClockProCache<int, int> clock(capacity);
+    LruCache<int, int> lru(capacity);
+
+    auto access = [](auto& cache, int k) {
+        if (!cache.find(k)) {
+            cache.put(k, k);
+            return false;
+        }
+        return true;
+    };
+
+    int clock_hits = 0;
+    int lru_hits = 0;
+    int next_scan = 1000;
+    for (int round = 0; round < 200; ++round) {
+        for (int k = 0; k < hot; ++k) {
+            clock_hits += access(clock, k);
+            lru_hits += access(lru, k);
+        }
+        // A one-off scan over more keys than the cache holds.
+        for (int i = 0; i < capacity; ++i, ++next_scan) {
+            access(clock, next_scan);
+            access(lru, next_scan);
+        }
+    }
+    REQUIRE(lru_hits == 0);
+    REQUIRE(clock_hits > 150 * hot);
+}
+
+TEST_CASE("sharded cache") {
+    ShardedCache<int, int> cache(1024, 8);
+    REQUIRE(cache.shard_count() == 8);
+
+    for (int i = 0; i < 500; ++i) {
+        REQUIRE(cache.put(i, i * 2));
+    }
+    REQUIRE(cache.size() == 500);
+    REQUIRE(cache.get(7) == 14);
+    REQUIRE(!cache.get(1000));
+    REQUIRE(cache.erase(7));
+    REQUIRE(!cache.get(7));
+
+    cache.clear();
+    REQUIRE(cache.size() == 0);
+
+    ShardedCache<int, int> tiny(3, 16);
+    REQUIRE(tiny.shard_count() == 4);
+}
+
+// Hashes every key to `value`, or to itself if `value` is 0.
+struct FixedHash {
+    std::size_t value = 0;
+
+    std::size_t operator()(int key) const noexcept {
+        return value != 0 ? value : std::size_t(key);
+    }
+};
+
+TEST_CASE("sharded cache routes keys with its own hasher") {
+    using Cache = ShardedCache<int, int, LruCache<int, int, FixedHash>>;
+    Cache spread(64, 8);
+    Cache fixed(64, 8, FixedHash{12345});
+    for (int i = 0; i < 64; ++i) {
+        spread.put(i, i);
+        fixed.put(i, i);
+    }
+    REQUIRE(spread.size() > 8);
+    // Every key lands in the one shard of 8 entries the hash picks.
+    REQUIRE(fixed.size() == 8);
+    for (int i = 56; i < 64; ++i) {
+        REQUIRE(fixed.get(i) == i);
+    }
+}
+
+TEST_CASE("sharded cache concurrent access") {
+    ShardedCache<int, int, ClockProCache<int, int>> cache(256, 16);
+    std::atomic<bool> ok{true};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            std::mt19937 gen(t);
+            std::uniform_int_distribution<int> key(0, 1000);
+            for (int i = 0; i < 20000; ++i) {
+                const int k = key(gen);
+                if (auto v = cache.get(k)) {
+                    if (*v != k + 1) {
+                        ok = false;
+                    }
+                } else {
+                    cache.put(k, k + 1);
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    REQUIRE(ok);
+    REQUIRE(cache.size() <= 256);
+}
@@ -0,0 +1,237 @@
+#define CATCH_CONFIG_MAIN
+#include "column_table.hpp"
+#include <catch2/catch.hpp>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+using namespace algo;
+
+template <typename T>
+static bool compare(const T& a, CompareOp op, const T& b) {
+    switch (op) {
+    case CompareOp::equal:
+        return a == b;
+    case CompareOp::not_equal:
+        return a != b;
+    case CompareOp::less:
+        return a < b;
+    case CompareOp::less_equal:
+        return a <= b;
+    case CompareOp::greater:
+        return a > b;
+    case CompareOp::greater_equal:
+        return a >= b;
+    }
+    return false;
+}
+
+static const CompareOp ops[] = {CompareOp::equal,   CompareOp::not_equal,
+                                CompareOp::less,    CompareOp::less_equal,
+                                CompareOp::greater, CompareOp::greater_equal};
+
+// Checks the compare kernel of every level the CPU supports against the
+// scalar one.
+template <CompareOp Op, typename T>
+static void checkKernelLevels(const Vector<T>& values, T probe) {
+    const std::size_t words = (values.size() + 63) / 64;
+    Vector<std::uint64_t> expected(words, 0);
+    detail::compareWordsScalar<Op>(values.data(), values.size(), probe,
+                                   expected.data());
+    for (int l = 0; l <= int(simd::detect()); ++l) {
+        Vector<std::uint64_t> got(words, 0);
+        const auto kernel = detail::compare_words<Op, T>.get(simd::Level(l));
+        kernel(values.data(), values.size(), probe, got.data());
+        REQUIRE(got == expected);
+    }
+}
+
+template <typename T>
+static void checkFilter(const Vector<T>& values, const Vector<T>& probes) {
+    ColumnTable t;
+    t.add_column<T>("x") = values;
+    for (CompareOp op : ops) {
+        for (const T& probe : probes) {
+            const DynamicBitset hits = t.filter<T>("x", op, probe);
+            REQUIRE(hits.size() == values.size());
+            for (std::size_t i = 0; i < values.size(); ++i) {
+                REQUIRE(hits.test(i) == compare(values[i], op, probe));
+            }
+        }
+    }
+    for (const T& probe : probes) {
+        checkKernelLevels<CompareOp::equal>(values, probe);
+        checkKernelLevels<CompareOp::not_equal>(values, probe);
+        checkKernelLevels<CompareOp::less>(values, probe);
+        checkKernelLevels<CompareOp::less_equal>(values, probe);
+        checkKernelLevels<CompareOp::greater>(values, probe);
+        checkKernelLevels<CompareOp::greater_equal>(values, probe);
+    }
+}
+
+TEST_CASE("DictionaryColumn encodes strings") {
+    DictionaryColumn c;
+    REQUIRE(c.empty());
+    REQUIRE(c.find("a") == DictionaryColumn::npos);
+
+    for (int i = 0; i < 1000; ++i) {
+        c.push_back("key" + std::to_string(i % 37));
+    }
+    c.push_back("");
+    REQUIRE(c.size() == 1001);
+    REQUIRE(c.dictionary_size() == 38);
+    for (int i = 0; i < 1000; ++i) {
+        REQUIRE(c[std::size_t(i)] == "key" + std::to_string(i % 37));
+        REQUIRE(c.code(std::size_t(i)) == std::uint32_t(i % 37));
+    }
+    REQUIRE(c[1000].empty());
+    REQUIRE(c.find("key5") == 5);
+    REQUIRE(c.find("key37") == DictionaryColumn::npos);
+    REQUIRE(c.encode("key5") == 5);
+    REQUIRE(c.size() == 1001);
+
+    const DictionaryColumn g = c.gather({0, 5, 1000});
+    REQUIRE(g.size() == 3);
+    REQUIRE(g[1] == "key5");
+    REQUIRE(g[2].empty());
+    REQUIRE(g.dictionary_size() == 38);
+    REQUIRE(g.value(5).data() == c.value(5).data());
+
+    // A shared dictionary is copied before a string is added to it.
+    DictionaryColumn h = g;
+    h.push_back("key5");
+    REQUIRE(h.value(5).data() == c.value(5).data());
+    h.push_back("new");
+    REQUIRE(h.dictionary_size() == 39);
+    REQUIRE(h[4] == "new");
+    REQUIRE(g.dictionary_size() == 38);
+    REQUIRE(g.find("new") == DictionaryColumn::npos);
+    REQUIRE(c.find("new") == DictionaryColumn::npos);
+
+    c.clear();
+    REQUIRE(c.empty());
+    REQUIRE(c.dictionary_size() == 0);
+    c.push_back("x");
+    REQUIRE(c.find("x") == 0);
+    REQUIRE(g[1] == "key5");
+    REQUIRE(g.find("x") == DictionaryColumn::npos);
+
+    DictionaryColumn moved = std::move(h);
+    REQUIRE(moved.find("new") == 38);
+    h = DictionaryColumn();
+    REQUIRE(h.find("new") == DictionaryColumn::npos);
+    h.push_back("y");
+    REQUIRE(h[0] == "y");
+}
+
+TEST_CASE("ColumnTable manages named columns") {
+    ColumnTable t;
+    REQUIRE(t.rows() == 0);
+    t.add_column<std::int64_t>("id");
+    t.add_string_column("name");
+    REQUIRE(t.column_count() == 2);
+    REQUIRE(t.contains("id"));
+    REQUIRE_FALSE(t.contains("price"));
+    REQUIRE(t.names() == Vector<std::string>{"id", "name"});
+
+    for (std::int64_t i = 0; i < 10; ++i) {
+        t.column<std::int64_t>("id").push_back(i);
+        t.string_column("name").push_back(i % 2 ? "odd" : "even");
+    }
+    REQUIRE(t.rows() == 10);
+
+    REQUIRE_THROWS_AS(t.add_column<double>("id"), std::invalid_argument);
+    REQUIRE_THROWS_AS(t.column<double>("id"), std::invalid_argument);
+    REQUIRE_THROWS_AS(t.column<double>("price"), std::out_of_range);
+    REQUIRE_THROWS_AS(t.string_column("id"), std::invalid_argument);
+    REQUIRE_THROWS_AS(t.filter<std::int32_t>("id", CompareOp::less, 3),
+                      std::invalid_argument);
+}
+
+TEST_CASE("ColumnTable filters numeric columns") {
+    std::mt19937_64 gen(7);
+    for (std::size_t n : {0, 1, 63, 64, 65, 1000}) {
+        Vector<std::int32_t> i32;
+        Vector<std::uint32_t> u32;
+        Vector<std::int64_t> i64;
+        Vector<std::uint64_t> u64;
+        Vector<float> f32;
+        Vector<double> f64;
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::uint64_t r = gen() % 9;
+            i32.push_back(std::int32_t(r) - 4);
+            u32.push_back(std::uint32_t(r) + 0x7FFFFFFCu);
+            i64.push_back(std::int64_t(r) - 4);
+            u64.push_back(r + 0x7FFFFFFFFFFFFFFCull);
+            f32.push_back(float(r) - 4.0f);
+            f64.push_back(i % 17 == 0 ? std::nan("") : double(r) / 2);
+        }
+        checkFilter(i32, {-4, 0, 3, INT32_MIN});
+        checkFilter(u32, {0x7FFFFFFCu, 0x80000000u, 0xFFFFFFFFu});
+        checkFilter(i64, {-5, 0, 4});
+        checkFilter(u64, {0x7FFFFFFFFFFFFFFFull, 0x8000000000000001ull});
+        checkFilter(f32, {-4.0f, 0.5f, 4.0f});
+        checkFilter(f64, {0.0, 2.0, std::nan("")});
+    }
+}
+
+TEST_CASE("ColumnTable filters string columns") {
+    const char* cities[] = {"Oslo", "Paris", "Berlin", "Rome", "Lima"};
+    ColumnTable t;
+    DictionaryColumn& c = t.add_string_column("city");
+    for (std::size_t i = 0; i < 300; ++i) {
+        c.push_back(cities[(i * 7) % 5]);
+    }
+    for (CompareOp op : ops) {
+        for (std::string_view probe : {"Paris", "Madrid", "A", "Z", "Oslo"}) {
+            const DynamicBitset hits = t.filter("city", op, probe);
+            REQUIRE(hits.size() == 300);
+            for (std::size_t i = 0; i < 300; ++i) {
+                REQUIRE(hits.test(i) == compare(c[i], op, probe));
+            }
+        }
+    }
+    REQUIRE_THROWS_AS(t.filter("nope", CompareOp::equal, "x"),
+                      std::out_of_range);
+}
+
+TEST_CASE("ColumnTable gathers selected rows") {
+    ColumnTable t;
+    auto& id = t.add_column<std::uint32_t>("id");
+    auto& price = t.add_column<double>("price");
+    auto& city = t.add_string_column("city");
+    for (std::uint32_t i = 0; i < 200; ++i) {
+        id.push_back(i);
+        price.push_back(i * 1.5);
+        city.push_back(i % 3 == 0 ? "Paris" : "Oslo");
+    }
+
+    DynamicBitset hits = t.filter<double>("price", CompareOp::less, 150.0);
+    hits &= t.filter("city", CompareOp::equal, "Paris");
+    const ColumnTable all = t.gather(hits);
+    REQUIRE(all.column_count() == 3);
+    REQUIRE(all.rows() == 34);
+    for (std::size_t i = 0; i < all.rows(); ++i) {
+        const std::uint32_t row = all.column<std::uint32_t>("id")[i];
+        REQUIRE(row == i * 3);
+        REQUIRE(all.column<double>("price")[i] == row * 1.5);
+        REQUIRE(all.string_column("city")[i] == "Paris");
+    }
+
+    ColumnTable copy = all;
+    copy.column<double>("price")[0] = -1.0;
+    REQUIRE(all.column<double>("price")[0] == 0.0);
+
+    const ColumnTable some = t.gather(hits, {"city", "id"});
+    REQUIRE(some.names() == Vector<std::string>{"city", "id"});
+    REQUIRE(some.rows() == 34);
+    REQUIRE(some.column<std::uint32_t>("id")[33] == 99);
+
+    REQUIRE(t.gather(DynamicBitset(200)).rows() == 0);
+    REQUIRE_THROWS_AS(t.gather(DynamicBitset(10)), std::invalid_argument);
+    REQUIRE_THROWS_AS(t.gather(hits, {"nope"}), std::out_of_range);
+    id.push_back(200);
+    REQUIRE_THROWS_AS(t.gather(hits), std::invalid_argument);
+}
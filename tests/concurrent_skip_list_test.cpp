@@ -0,0 +1,116 @@
+#define CATCH_CONFIG_MAIN
+#include "concurrent_skip_list.hpp"
+#include <catch2/catch.hpp>
+#include <atomic>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace algo;
+
+TEST_CASE("insert and find") {
+    ConcurrentSkipList<int, std::string> list;
+    REQUIRE(list.empty());
+    REQUIRE(list.begin() == list.end());
+
+    REQUIRE(list.insert(3, "three"));
+    REQUIRE(list.insert(1, "one"));
+    REQUIRE(list.insert(2, "two"));
+    REQUIRE(!list.insert(2, "deux"));
+    REQUIRE(list.size() == 3);
+
+    REQUIRE(*list.find(2) == "two");
+    REQUIRE(list.find(4) == nullptr);
+    REQUIRE(list.contains(1));
+
+    std::vector<int> keys;
+    for (auto kv : list) {
+        keys.push_back(kv.first);
+    }
+    REQUIRE(keys == std::vector<int>{1, 2, 3});
+
+    REQUIRE(list.lower_bound(2).value() == "two");
+    REQUIRE(list.lower_bound(4) == list.end());
+}
+
+TEST_CASE("matches std::map") {
+    ConcurrentSkipList<std::uint64_t, std::uint64_t> list(
+        std::less<std::uint64_t>(), 4096);
+    std::map<std::uint64_t, std::uint64_t> map;
+    std::mt19937_64 rng(1);
+    for (int i = 0; i < 20000; ++i) {
+        const std::uint64_t key = rng() % 10000;
+        REQUIRE(list.insert(key, i) == map.emplace(key, i).second);
+    }
+    REQUIRE(list.size() == map.size());
+    REQUIRE(std::equal(map.begin(), map.end(), list.begin(), list.end(),
+                       [](const auto& x, const auto& y) {
+                           return x.first == y.first && x.second == y.second;
+                       }));
+
+    std::vector<std::uint64_t> range;
+    list.for_each_range(100, 200, [&](std::uint64_t key, std::uint64_t) {
+        range.push_back(key);
+    });
+    std::vector<std::uint64_t> expected;
+    for (auto it = map.lower_bound(100); it != map.lower_bound(200); ++it) {
+        expected.push_back(it->first);
+    }
+    REQUIRE(range == expected);
+    REQUIRE(list.memory_usage() > 0);
+}
+
+TEST_CASE("concurrent inserts") {
+    ConcurrentSkipList<int, int> list;
+    const int threads = 8, per_thread = 5000;
+    std::atomic<int> inserted{0};
+    std::atomic<bool> done{false};
+    std::atomic<bool> sorted{true};
+
+    // A reader iterating while writers insert always sees sorted keys.
+    std::thread reader([&] {
+        while (!done.load()) {
+            int prev = -1;
+            for (auto it = list.begin(); it != list.end(); ++it) {
+                if (it.key() <= prev || it.value() != it.key() * 2) {
+                    sorted = false;
+                }
+                prev = it.key();
+            }
+        }
+    });
+
+    std::vector<std::thread> writers;
+    for (int t = 0; t < threads; ++t) {
+        writers.emplace_back([&, t] {
+            std::mt19937 rng(t);
+            for (int i = 0; i < per_thread; ++i) {
+                // Half of the keys collide across threads.
+                const int key = i % 2 ? int(rng() % 20000)
+                                      : 20000 + t * per_thread + i;
+                inserted += list.insert(key, key * 2);
+            }
+        });
+    }
+    for (auto& w : writers) {
+        w.join();
+    }
+    done = true;
+    reader.join();
+    REQUIRE(sorted);
+
+    REQUIRE(list.size() == std::size_t(inserted.load()));
+    std::size_t count = 0;
+    int prev = -1;
+    for (auto it = list.begin(); it != list.end(); ++it, ++count) {
+        REQUIRE(it.key() > prev);
+        prev = it.key();
+    }
+    REQUIRE(count == list.size());
+    for (int t = 0; t < threads; ++t) {
+        REQUIRE(*list.find(20000 + t * per_thread) ==
+                2 * (20000 + t * per_thread));
+    }
+}
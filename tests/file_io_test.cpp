@@ -0,0 +1,115 @@
+#define CATCH_CONFIG_MAIN
+#include "file_io.hpp"
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+using namespace algo;
+
+static const std::string path = "/tmp/algo_file_io_test.bin";
+
+static void writeBytes(const std::string& p, const void* data,
+                       std::size_t bytes) {
+    std::FILE* f = std::fopen(p.c_str(), "wb");
+    REQUIRE(f != nullptr);
+    REQUIRE(std::fwrite(data, 1, bytes, f) == bytes);
+    std::fclose(f);
+}
+
+TEST_CASE("read_file_into reads a whole file") {
+    Vector<std::uint32_t> values;
+    for (std::uint32_t i = 0; i < 100000; ++i) {
+        values.push_back(i * 7);
+    }
+    writeBytes(path, values.data(), values.size() * sizeof(std::uint32_t));
+
+    Vector<std::uint32_t> read = {1, 2, 3};
+    read_file_into(read, path);
+    REQUIRE(read == values);
+    REQUIRE(read.capacity() == values.size());
+
+    // Existing capacity is not grown geometrically past the file size.
+    Vector<std::uint32_t> reused;
+    reused.reserve(values.size() - 1000);
+    read_file_into(reused, path);
+    REQUIRE(reused == values);
+    REQUIRE(reused.capacity() == values.size());
+
+    writeBytes(path, "", 0);
+    read_file_into(read, path);
+    REQUIRE(read.empty());
+
+    writeBytes(path, "abcde", 5);
+    REQUIRE_THROWS_AS(read_file_into(read, path), std::runtime_error);
+    REQUIRE_THROWS_AS(read_file_into(read, path + ".missing"),
+                      std::system_error);
+    std::remove(path.c_str());
+}
+
+TEST_CASE("read_file_into reads pseudo-files that report no size") {
+    Vector<char> status;
+    read_file_into(status, "/proc/self/status");
+    REQUIRE(std::string(status.data(), status.size()).find("Name:") !=
+            std::string::npos);
+}
+
+TEST_CASE("append_from_fd honors the offset and the limit") {
+    const char text[] = "0123456789";
+    writeBytes(path, text, 10);
+    detail::FileDescriptor fd(path, O_RDONLY);
+    REQUIRE(::lseek(fd.get(), 2, SEEK_SET) == 2);
+
+    Vector<char> v = {'x'};
+    REQUIRE(append_from_fd(v, fd.get(), 3) == 3);
+    REQUIRE(std::string(v.begin(), v.end()) == "x234");
+    REQUIRE(append_from_fd(v, fd.get()) == 5);
+    REQUIRE(std::string(v.begin(), v.end()) == "x23456789");
+    REQUIRE(append_from_fd(v, fd.get()) == 0);
+
+    // Only whole values count against the limit.
+    REQUIRE(::lseek(fd.get(), 0, SEEK_SET) == 0);
+    Vector<std::uint16_t> pairs;
+    REQUIRE(append_from_fd(pairs, fd.get(), 5) == 2);
+    REQUIRE(pairs.size() == 2);
+    std::remove(path.c_str());
+}
+
+TEST_CASE("append_from_fd streams a pipe") {
+    int fds[2];
+    REQUIRE(::pipe(fds) == 0);
+    const std::size_t n = 300000;
+    // Writes in pieces that split values, then closes the pipe.
+    std::thread writer([&] {
+        Vector<std::uint64_t> values;
+        for (std::uint64_t i = 0; i < n; ++i) {
+            values.push_back(i * i);
+        }
+        const char* p = reinterpret_cast<const char*>(values.data());
+        std::size_t left = n * sizeof(std::uint64_t);
+        for (std::size_t piece = 1; left > 0; piece = piece * 3 + 1) {
+            const std::size_t bytes = std::min(piece % 10007, left);
+            REQUIRE(::write(fds[1], p, bytes) == ssize_t(bytes));
+            p += bytes;
+            left -= bytes;
+        }
+        ::close(fds[1]);
+    });
+
+    Vector<std::uint64_t> v;
+    REQUIRE(append_from_fd(v, fds[0]) == n);
+    writer.join();
+    ::close(fds[0]);
+    REQUIRE(v.size() == n);
+    for (std::uint64_t i = 0; i < n; ++i) {
+        REQUIRE(v[i] == i * i);
+    }
+
+    REQUIRE(::pipe(fds) == 0);
+    REQUIRE(::write(fds[1], "abcdefghij", 10) == 10);
+    ::close(fds[1]);
+    Vector<std::uint32_t> words;
+    REQUIRE_THROWS_AS(append_from_fd(words, fds[0]), std::runtime_error);
+    ::close(fds[0]);
+}
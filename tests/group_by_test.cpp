@@ -0,0 +1,164 @@
+#define CATCH_CONFIG_MAIN
+#include "group_by.hpp"
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <stdexcept>
+
+using namespace algo;
+
+namespace {
+template <typename V>
+struct Expected {
+    std::uint64_t count = 0;
+    typename GroupByResult<int, V>::SumType sum = 0;
+    V min = 0;
+    V max = 0;
+};
+
+template <typename K, typename V>
+std::map<K, Expected<V>> reference(const Vector<K>& keys,
+                                   const Vector<V>& values) {
+    std::map<K, Expected<V>> groups;
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        Expected<V>& e = groups[keys[i]];
+        e.min = e.count == 0 ? values[i] : std::min(e.min, values[i]);
+        e.max = e.count == 0 ? values[i] : std::max(e.max, values[i]);
+        e.sum += values[i];
+        ++e.count;
+    }
+    return groups;
+}
+
+template <typename K, typename V>
+void checkGroups(const GroupByResult<K, V>& r, const Vector<K>& keys,
+                 const Vector<V>& values) {
+    const std::map<K, Expected<V>> expected = reference(keys, values);
+    REQUIRE(r.keys.size() == expected.size());
+    REQUIRE(r.count.size() == expected.size());
+    REQUIRE(r.sum.size() == expected.size());
+    REQUIRE(r.min.size() == expected.size());
+    REQUIRE(r.max.size() == expected.size());
+    REQUIRE(r.avg.size() == expected.size());
+    for (std::size_t g = 0; g < r.keys.size(); ++g) {
+        const auto it = expected.find(r.keys[g]);
+        REQUIRE(it != expected.end());
+        const Expected<V>& e = it->second;
+        REQUIRE(r.count[g] == e.count);
+        REQUIRE(r.sum[g] == Approx(e.sum));
+        REQUIRE(r.min[g] == e.min);
+        REQUIRE(r.max[g] == e.max);
+        REQUIRE(r.avg[g] == Approx(double(e.sum) / double(e.count)));
+    }
+}
+
+// Checks every level of `mixHashes()` against `mixHash()` for keys of type
+// `K`, negative ones included.
+template <typename K>
+void checkHashLevels(std::mt19937_64& gen) {
+    for (std::size_t n : {0, 3, 4, 8, 17, 100}) {
+        Vector<K> keys;
+        Vector<std::uint64_t> expected;
+        for (std::size_t i = 0; i < n; ++i) {
+            keys.push_back(K(gen()));
+            expected.push_back(detail::mixHash(std::size_t(keys.back())));
+        }
+        for (int l = 0; l <= int(simd::detect()); ++l) {
+            Vector<std::uint64_t> hashes(n, 0);
+            detail::mix_hashes<K>.get(simd::Level(l))(keys.data(), n,
+                                                      hashes.data());
+            REQUIRE(hashes == expected);
+        }
+    }
+}
+
+const Vector<Aggregate> all = {Aggregate::sum, Aggregate::count,
+                               Aggregate::min, Aggregate::max,
+                               Aggregate::avg};
+} // namespace
+
+TEST_CASE("group_by computes every aggregate") {
+    Vector<std::uint32_t> store = {1, 2, 1, 1};
+    Vector<double> amount = {10, 5, 20, 30};
+    auto r = group_by(store, amount, {Aggregate::sum, Aggregate::max});
+    REQUIRE(r.keys == Vector<std::uint32_t>({1, 2}));
+    REQUIRE(r.sum == Vector<double>({60, 5}));
+    REQUIRE(r.max == Vector<double>({30, 5}));
+    REQUIRE(r.count.empty());
+    REQUIRE(r.min.empty());
+    REQUIRE(r.avg.empty());
+
+    r = group_by(store, amount, {Aggregate::avg});
+    REQUIRE(r.avg == Vector<double>({20, 5}));
+    REQUIRE(r.sum.empty());
+    REQUIRE(r.count.empty());
+
+    const auto empty = group_by(Vector<int>(), Vector<int>(), all);
+    REQUIRE(empty.keys.empty());
+    REQUIRE_THROWS_AS(group_by(store, Vector<double>(3), all),
+                      std::invalid_argument);
+}
+
+TEST_CASE("group_by matches a reference on random data") {
+    std::mt19937_64 gen(3);
+    for (std::size_t n : {1, 1023, 1024, 1025, 100000}) {
+        for (std::uint64_t distinct : {1, 7, 1000, 1000000}) {
+            Vector<std::int32_t> keys;
+            Vector<std::int64_t> values;
+            for (std::size_t i = 0; i < n; ++i) {
+                keys.push_back(std::int32_t(gen() % distinct) - 3);
+                values.push_back(std::int64_t(gen() % 2001) - 1000);
+            }
+            checkGroups(group_by(keys, values, all), keys, values);
+        }
+    }
+
+    Vector<std::uint64_t> keys;
+    Vector<float> values;
+    for (std::size_t i = 0; i < 50000; ++i) {
+        keys.push_back(gen() % 5000 * 0x100000001ull);
+        values.push_back(float(gen() % 1000) / 8);
+    }
+    const auto r = group_by(keys, values, all);
+    checkGroups(r, keys, values);
+    // Groups come in the order of their first rows.
+    REQUIRE(r.keys[0] == keys[0]);
+}
+
+TEST_CASE("group_by_parallel matches group_by") {
+    std::mt19937_64 gen(4);
+    ThreadPool pool(4);
+    for (std::size_t n : {1000, 300000}) {
+        for (std::uint64_t distinct : {3, 5000, 1000000}) {
+            Vector<std::uint64_t> keys;
+            Vector<double> values;
+            for (std::size_t i = 0; i < n; ++i) {
+                keys.push_back(gen() % distinct);
+                values.push_back(double(gen() % 100));
+            }
+            checkGroups(group_by_parallel(keys, values, all, pool), keys,
+                        values);
+        }
+    }
+
+    Vector<std::int16_t> keys(200000);
+    Vector<std::uint8_t> values(200000);
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        keys[i] = std::int16_t(gen() % 300) - 150;
+        values[i] = std::uint8_t(gen());
+    }
+    checkGroups(group_by_parallel(keys, values, all, pool), keys, values);
+    REQUIRE_THROWS_AS(group_by_parallel(keys, Vector<std::uint8_t>(), all,
+                                        pool),
+                      std::invalid_argument);
+}
+
+TEST_CASE("hash kernels agree on every supported level") {
+    std::mt19937_64 gen(5);
+    checkHashLevels<std::int32_t>(gen);
+    checkHashLevels<std::uint32_t>(gen);
+    checkHashLevels<std::int64_t>(gen);
+    checkHashLevels<std::uint64_t>(gen);
+}
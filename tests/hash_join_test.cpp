@@ -0,0 +1,92 @@
+#define CATCH_CONFIG_MAIN
+#include "hash_join.hpp"
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using namespace algo;
+
+using Pairs = std::vector<std::pair<std::uint32_t, std::uint32_t>>;
+
+static Pairs sorted(const HashJoinResult& r) {
+    REQUIRE(r.build.size() == r.probe.size());
+    Pairs pairs;
+    for (std::size_t i = 0; i < r.build.size(); ++i) {
+        pairs.emplace_back(r.build[i], r.probe[i]);
+    }
+    std::sort(pairs.begin(), pairs.end());
+    return pairs;
+}
+
+template <typename K>
+static Pairs reference(const Vector<K>& build, const Vector<K>& probe) {
+    std::unordered_multimap<K, std::uint32_t> table;
+    for (std::uint32_t i = 0; i < build.size(); ++i) {
+        table.emplace(build[i], i);
+    }
+    Pairs pairs;
+    for (std::uint32_t j = 0; j < probe.size(); ++j) {
+        const auto range = table.equal_range(probe[j]);
+        for (auto it = range.first; it != range.second; ++it) {
+            pairs.emplace_back(it->second, j);
+        }
+    }
+    std::sort(pairs.begin(), pairs.end());
+    return pairs;
+}
+
+TEST_CASE("hash_join matches equal keys") {
+    const Vector<std::uint64_t> customers = {7, 3, 9};
+    const Vector<std::uint64_t> orders = {3, 3, 5, 9};
+    REQUIRE(sorted(hash_join(customers, orders)) ==
+            Pairs{{1, 0}, {1, 1}, {2, 3}});
+    REQUIRE(sorted(hash_join(orders, customers)) ==
+            Pairs{{0, 1}, {1, 1}, {3, 2}});
+
+    REQUIRE(hash_join(customers, Vector<std::uint64_t>()).build.empty());
+    REQUIRE(hash_join(Vector<std::uint64_t>(), orders).probe.empty());
+    REQUIRE(hash_join(customers, Vector<std::uint64_t>{1, 2}).build.empty());
+}
+
+TEST_CASE("hash_join matches a reference on random data") {
+    std::mt19937_64 gen(5);
+    ThreadPool pool(4);
+    for (std::size_t n : {10, 5000, 100000, 400000}) {
+        for (std::uint64_t distinct : {n / 4 + 1, 4 * n}) {
+            Vector<std::int32_t> build;
+            Vector<std::int32_t> probe;
+            for (std::size_t i = 0; i < n; ++i) {
+                build.push_back(std::int32_t(gen() % distinct) - 100);
+            }
+            for (std::size_t i = 0; i < n / 2 + 3; ++i) {
+                probe.push_back(std::int32_t(gen() % distinct) - 100);
+            }
+            const Pairs expected = reference(build, probe);
+            REQUIRE(sorted(hash_join(build, probe)) == expected);
+            REQUIRE(sorted(hash_join_parallel(build, probe, pool)) ==
+                    expected);
+        }
+    }
+
+    // Duplicates on both sides, and enough rows for two partitioning
+    // passes.
+    Vector<std::uint64_t> build;
+    Vector<std::uint64_t> probe;
+    for (std::size_t i = 0; i < 20000; ++i) {
+        build.push_back(gen() % 1000 << 40);
+        probe.push_back(gen() % 2000 << 40);
+    }
+    for (std::size_t i = 0; i < 3000000; ++i) {
+        build.push_back(gen() | 1);
+    }
+    for (std::size_t i = 0; i < 100000; ++i) {
+        probe.push_back(build[gen() % build.size()]);
+    }
+    const Pairs expected = reference(build, probe);
+    REQUIRE(sorted(hash_join(build, probe)) == expected);
+    REQUIRE(sorted(hash_join_parallel(build, probe, pool)) == expected);
+}
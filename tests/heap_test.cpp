@@ -0,0 +1,186 @@
+#define CATCH_CONFIG_MAIN
+#include "heap.hpp"
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <queue>
+#include <random>
+#include <vector>
+
+using namespace algo;
+
+TEST_CASE("dary heap matches priority queue") {
+    std::mt19937 gen(12);
+    DaryHeap<int> heap;
+    DaryHeap<int, 2, std::greater<int>> max_heap;
+    std::priority_queue<int, std::vector<int>, std::greater<int>> expected;
+    std::priority_queue<int> expected_max;
+    for (int i = 0; i < 5000; ++i) {
+        const int v = int(gen() % 1000);
+        switch (gen() % 3) {
+        case 0:
+            if (!heap.empty()) {
+                REQUIRE(heap.top() == expected.top());
+                heap.pop();
+                expected.pop();
+                max_heap.pop();
+                expected_max.pop();
+                break;
+            }
+            [[fallthrough]];
+        case 1:
+            heap.push(v);
+            expected.push(v);
+            max_heap.push(v);
+            expected_max.push(v);
+            break;
+        default:
+            if (!heap.empty()) {
+                heap.replace_top(v);
+                expected.pop();
+                expected.push(v);
+            }
+        }
+        REQUIRE(heap.size() == expected.size());
+        if (!heap.empty()) {
+            REQUIRE(heap.top() == expected.top());
+            REQUIRE(max_heap.top() == expected_max.top());
+        }
+    }
+    heap.clear();
+    REQUIRE(heap.empty());
+}
+
+TEST_CASE("indexed heap push and pop") {
+    IndexedDaryHeap<int> heap(10);
+    REQUIRE(heap.empty());
+
+    heap.push(3, 30);
+    heap.push(1, 10);
+    heap.push(7, 70);
+    heap.push(2, 20);
+
+    REQUIRE(heap.size() == 4);
+    REQUIRE(heap.contains(7));
+    REQUIRE(!heap.contains(4));
+    REQUIRE(heap.priority(7) == 70);
+
+    const int expected[] = {1, 2, 3, 7};
+    for (int key : expected) {
+        REQUIRE(heap.top() == std::uint32_t(key));
+        heap.pop();
+        REQUIRE(!heap.contains(key));
+    }
+    REQUIRE(heap.empty());
+}
+
+TEST_CASE("indexed heap decrease key") {
+    IndexedDaryHeap<int, 2> heap(4);
+    heap.push(0, 100);
+    heap.push(1, 50);
+    heap.push(2, 75);
+
+    heap.decrease_key(0, 10);
+    REQUIRE(heap.top() == 0);
+    REQUIRE(heap.top_priority() == 10);
+
+    heap.update(0, 80);
+    REQUIRE(heap.top() == 1);
+
+    heap.update(3, 1);
+    REQUIRE(heap.top() == 3);
+}
+
+TEST_CASE("indexed heap clear") {
+    IndexedDaryHeap<int> heap(8);
+    for (std::uint32_t i = 0; i < 8; ++i) {
+        heap.push(i, int(8 - i));
+    }
+    heap.pop();
+    heap.clear();
+    REQUIRE(heap.empty());
+    for (std::uint32_t i = 0; i < 8; ++i) {
+        REQUIRE(!heap.contains(i));
+    }
+
+    heap.reset(16);
+    REQUIRE(heap.capacity() == 16);
+    heap.push(15, 1);
+    REQUIRE(heap.top() == 15);
+}
+
+TEST_CASE("indexed heap random updates") {
+    const std::uint32_t n = 500;
+    IndexedDaryHeap<std::uint64_t, 4> heap(n);
+    std::vector<std::uint64_t> prio(n);
+    std::vector<bool> in(n, false);
+
+    std::mt19937 rng(42);
+    for (int round = 0; round < 5000; ++round) {
+        const std::uint32_t key = rng() % n;
+        const std::uint64_t p = rng() % 1000;
+        heap.update(key, p);
+        prio[key] = p;
+        in[key] = true;
+    }
+
+    std::uint64_t last = 0;
+    std::size_t popped = 0;
+    while (!heap.empty()) {
+        const std::uint32_t key = heap.top();
+        REQUIRE(in[key]);
+        REQUIRE(heap.top_priority() == prio[key]);
+        REQUIRE(prio[key] >= last);
+        last = prio[key];
+        heap.pop();
+        ++popped;
+    }
+    REQUIRE(popped == std::size_t(std::count(in.begin(), in.end(), true)));
+}
+
+TEST_CASE("radix heap") {
+    RadixHeap<std::uint32_t, int> heap;
+    heap.push(7, 70);
+    heap.push(3, 30);
+    heap.push(5, 50);
+    REQUIRE(heap.size() == 3);
+
+    REQUIRE(heap.top_priority() == 3);
+    REQUIRE(heap.top() == 30);
+    heap.pop();
+
+    heap.push(4, 40);
+    REQUIRE(heap.top_priority() == 4);
+    heap.pop();
+    REQUIRE(heap.top_priority() == 5);
+    heap.pop();
+    REQUIRE(heap.top_priority() == 7);
+    heap.pop();
+    REQUIRE(heap.empty());
+
+    heap.clear();
+    heap.push(1, 10);
+    REQUIRE(heap.top() == 10);
+}
+
+TEST_CASE("radix heap matches priority queue") {
+    using Entry = std::pair<std::uint64_t, int>;
+    RadixHeap<std::uint64_t, int> heap;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> pq;
+
+    std::mt19937_64 rng(7);
+    std::uint64_t last = 0;
+    for (int round = 0; round < 10000; ++round) {
+        if (pq.empty() || rng() % 3 != 0) {
+            const std::uint64_t p = last + rng() % (std::uint64_t(1) << 40);
+            heap.push(p, round);
+            pq.emplace(p, round);
+        } else {
+            REQUIRE(heap.top_priority() == pq.top().first);
+            last = pq.top().first;
+            heap.pop();
+            pq.pop();
+        }
+    }
+    REQUIRE(heap.size() == pq.size());
+}
@@ -0,0 +1,169 @@
+#define CATCH_CONFIG_MAIN
+#include "integer_codec.hpp"
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace algo;
+
+template <typename T>
+static Vector<T> makeSorted(std::size_t n, T max_gap, std::mt19937_64& gen) {
+    Vector<T> values;
+    T v = T(gen() % 1000);
+    for (std::size_t i = 0; i < n; ++i) {
+        values.push_back(v);
+        v = T(v + T(gen() % (std::uint64_t(max_gap) + 1)));
+    }
+    return values;
+}
+
+// Checks `next_geq()` against `std::lower_bound` around every value.
+template <typename Seq, typename T>
+static void checkNextGeq(const Seq& seq, const Vector<T>& values) {
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        for (T x : {T(values[i] - 1), values[i], T(values[i] + 1)}) {
+            const std::size_t expected = std::size_t(
+                std::lower_bound(values.begin(), values.end(), x) -
+                values.begin());
+            REQUIRE(seq.next_geq(x) == expected);
+        }
+    }
+}
+
+TEST_CASE("elias fano basic operations") {
+    Vector<std::uint32_t> ids = {3, 4, 7, 13, 14, 15, 21, 43};
+    EliasFanoVector ef(ids);
+    REQUIRE(ef.size() == 8);
+    REQUIRE(ef.back() == 43);
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+        REQUIRE(ef[i] == ids[i]);
+    }
+    REQUIRE(ef.next_geq(0) == 0);
+    REQUIRE(ef.next_geq(16) == 6);
+    REQUIRE(ef.next_geq(43) == 7);
+    REQUIRE(ef.next_geq(44) == 8);
+
+    std::vector<std::uint64_t> visited;
+    ef.for_each([&](std::uint64_t v) { visited.push_back(v); });
+    REQUIRE(visited == std::vector<std::uint64_t>(ids.begin(), ids.end()));
+
+    REQUIRE_THROWS_AS(ef.at(8), std::out_of_range);
+    Vector<std::uint32_t> unsorted = {1, 3, 2};
+    REQUIRE_THROWS_AS(EliasFanoVector(unsorted), std::invalid_argument);
+
+    ef.clear();
+    REQUIRE(ef.empty());
+    REQUIRE(ef.next_geq(0) == 0);
+}
+
+TEST_CASE("elias fano matches the input") {
+    std::mt19937_64 gen(11);
+    for (std::size_t n : {1u, 2u, 63u, 64u, 65u, 1000u, 20000u}) {
+        for (std::uint32_t gap : {0u, 1u, 3u, 100u, 100000u}) {
+            const Vector<std::uint32_t> values = makeSorted(n, gap, gen);
+            EliasFanoVector ef(values);
+            REQUIRE(ef.size() == n);
+            for (std::size_t i = 0; i < n; ++i) {
+                REQUIRE(ef[i] == values[i]);
+            }
+            checkNextGeq(ef, values);
+        }
+    }
+
+    // Values up to the top of the range.
+    Vector<std::uint64_t> wide = {0, 1, std::uint64_t(1) << 40,
+                                  std::numeric_limits<std::uint64_t>::max()};
+    EliasFanoVector ef(wide);
+    for (std::size_t i = 0; i < wide.size(); ++i) {
+        REQUIRE(ef[i] == wide[i]);
+    }
+    REQUIRE(ef.next_geq(2) == 2);
+    REQUIRE(ef.next_geq(std::numeric_limits<std::uint64_t>::max()) == 3);
+}
+
+TEST_CASE("elias fano is compact") {
+    std::mt19937_64 gen(3);
+    const Vector<std::uint32_t> values = makeSorted(100000, 20u, gen);
+    EliasFanoVector ef(values);
+    // About 2 + log2(10) bits per value, plus the select index.
+    REQUIRE(ef.size_in_bytes() * 8 < 8 * values.size());
+}
+
+TEST_CASE("delta bitpacked round trips") {
+    std::mt19937_64 gen(5);
+    for (std::size_t n : {0u, 1u, 5u, 127u, 128u, 129u, 1000u, 10000u}) {
+        for (std::uint64_t gap : {0ull, 1ull, 7ull, 100000ull,
+                                  0xffffffffull}) {
+            const auto narrow = makeSorted(n, std::uint32_t(gap / 100000), gen);
+            DeltaBitpacked<std::uint32_t> p32(narrow);
+            Vector<std::uint32_t> out32;
+            p32.decode(out32);
+            REQUIRE(out32 == narrow);
+            checkNextGeq(p32, narrow);
+
+            const auto wide = makeSorted(n, gap << 12, gen);
+            DeltaBitpacked<std::uint64_t> p64(wide);
+            Vector<std::uint64_t> out64;
+            p64.decode(out64);
+            REQUIRE(out64 == wide);
+            checkNextGeq(p64, wide);
+            for (std::size_t i = 0; i < n; i += 37) {
+                REQUIRE(p64.at(i) == wide[i]);
+            }
+        }
+    }
+
+    // Full-width differences within a frame.
+    const std::uint32_t top = std::numeric_limits<std::uint32_t>::max();
+    Vector<std::uint32_t> extremes = {0, 0, 0, 0, top};
+    DeltaBitpacked<std::uint32_t> p(extremes);
+    Vector<std::uint32_t> out;
+    p.decode(out);
+    REQUIRE(out == extremes);
+
+    REQUIRE_THROWS_AS(p.at(5), std::out_of_range);
+    Vector<std::uint32_t> unsorted = {2, 1};
+    REQUIRE_THROWS_AS(DeltaBitpacked<std::uint32_t>(unsorted),
+                      std::invalid_argument);
+}
+
+TEST_CASE("delta bitpacked is compact") {
+    std::mt19937_64 gen(8);
+    const Vector<std::uint32_t> values = makeSorted(100000, 15u, gen);
+    DeltaBitpacked<std::uint32_t> packed(values);
+    REQUIRE(packed.block_count() == (values.size() + 127) / 128);
+    // Four-lane differences below 64 take 6 bits each.
+    REQUIRE(packed.size_in_bytes() * 8 < 7 * values.size());
+}
+
+TEST_CASE("delta bitpacked frames do not depend on the instruction set") {
+    std::mt19937_64 gen(13);
+    for (unsigned b = 0; b <= 32; ++b) {
+        std::uint32_t in[128];
+        for (auto& v : in) {
+            v = b == 0 ? 0 : std::uint32_t(gen() >> (64 - b));
+        }
+        std::uint32_t fast[128] = {};
+        std::uint32_t slow[128] = {};
+        detail::packFrame(in, b, fast);
+        detail::packFrame<std::uint32_t, detail::ScalarLanes<std::uint32_t>>(
+            in, b, slow);
+        REQUIRE(std::equal(fast, fast + 128, slow));
+
+        std::uint32_t a[128];
+        std::uint32_t c[128];
+        detail::unpackFrame(fast, b, 7u, a);
+        detail::unpackFrame<std::uint32_t,
+                            detail::ScalarLanes<std::uint32_t>>(slow, b, 7u,
+                                                                c);
+        REQUIRE(std::equal(a, a + 128, c));
+        // Rows accumulate: value `i` is the sum of its lane's deltas.
+        std::uint32_t sum[4] = {7, 7, 7, 7};
+        for (std::size_t i = 0; i < 128; ++i) {
+            sum[i % 4] += in[i];
+            REQUIRE(a[i] == sum[i % 4]);
+        }
+    }
+}
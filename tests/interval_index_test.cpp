@@ -0,0 +1,124 @@
+#define CATCH_CONFIG_MAIN
+#include "interval_index.hpp"
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace algo;
+
+TEST_CASE("interval index overlap") {
+    IntervalIndex<int> index;
+    REQUIRE(index.add(10, 20) == 0);
+    REQUIRE(index.add(15, 30) == 1);
+    REQUIRE(index.add(40, 50) == 2);
+    REQUIRE(index.add(0, 5) == 3);
+    REQUIRE(!index.indexed());
+    index.build();
+    REQUIRE(index.indexed());
+    REQUIRE(index.size() == 4);
+
+    Vector<std::uint32_t> ids;
+    REQUIRE(index.overlap(18, 42, ids) == 3);
+    REQUIRE(ids.size() == 3);
+    REQUIRE(ids[0] == 0);
+    REQUIRE(ids[1] == 1);
+    REQUIRE(ids[2] == 2);
+
+    // Half-open: touching intervals do not overlap.
+    ids.clear();
+    REQUIRE(index.overlap(30, 40, ids) == 0);
+    REQUIRE(index.count_overlaps(30, 40) == 0);
+    REQUIRE(index.count_overlaps(18, 42) == 3);
+
+    REQUIRE(index.stab_count(16) == 2);
+    REQUIRE(index.stab_count(20) == 1);
+    REQUIRE(index.stab_count(35) == 0);
+
+    std::vector<int> starts;
+    index.stab(4, [&](int s, int e, std::uint32_t id) {
+        REQUIRE(s == 0);
+        REQUIRE(e == 5);
+        REQUIRE(id == 3);
+        starts.push_back(s);
+    });
+    REQUIRE(starts.size() == 1);
+}
+
+TEST_CASE("interval index bulk build") {
+    IntervalIndex<double> index{{1.0, 2.0}, {1.5, 1.75}, {3.0, 4.0}};
+    REQUIRE(index.indexed());
+    REQUIRE(index.stab_count(1.6) == 2);
+
+    Vector<IntervalIndex<double>::Interval> intervals;
+    intervals.push_back({0.0, 10.0});
+    IntervalIndex<double> other(intervals);
+    REQUIRE(other.count_overlaps(9.5, 20.0) == 1);
+}
+
+TEST_CASE("interval index rejects reversed intervals") {
+    IntervalIndex<int> index;
+    REQUIRE_THROWS_AS(index.add(5, 4), std::invalid_argument);
+}
+
+TEST_CASE("interval index empty") {
+    IntervalIndex<int> index;
+    index.build();
+    Vector<std::uint32_t> ids;
+    REQUIRE(index.overlap(0, 100, ids) == 0);
+    REQUIRE(index.count_overlaps(0, 100) == 0);
+    REQUIRE(index.stab_count(0) == 0);
+}
+
+TEST_CASE("interval index matches brute force") {
+    std::mt19937 gen(1234);
+    std::vector<int> sizes;
+    for (int n = 1; n <= 70; ++n) {
+        sizes.push_back(n);
+    }
+    sizes.insert(sizes.end(), {100, 1000, 4097});
+    for (int n : sizes) {
+        std::uniform_int_distribution<int> pos(0, 10 * n);
+        std::uniform_int_distribution<int> len(0, n % 2 ? 50 : 5 * n);
+
+        IntervalIndex<int> index;
+        std::vector<std::pair<int, int>> intervals;
+        for (int i = 0; i < n; ++i) {
+            const int s = pos(gen);
+            // Occasional long intervals make the subtree maxima matter.
+            const int e = s + (i % 10 == 0 ? 20 * len(gen) : len(gen));
+            intervals.emplace_back(s, e);
+            index.add(s, e);
+        }
+        index.build();
+
+        for (int q = 0; q < 50; ++q) {
+            const int s = pos(gen);
+            const int e = s + 1 + len(gen);
+
+            std::vector<std::uint32_t> expected;
+            for (std::size_t i = 0; i < intervals.size(); ++i) {
+                if (intervals[i].first < e && s < intervals[i].second) {
+                    expected.push_back(std::uint32_t(i));
+                }
+            }
+
+            Vector<std::uint32_t> ids;
+            index.overlap(s, e, ids);
+            std::vector<std::uint32_t> got(ids.begin(), ids.end());
+            std::sort(got.begin(), got.end());
+            REQUIRE(got == expected);
+            REQUIRE(index.count_overlaps(s, e) == expected.size());
+
+            std::size_t stabbed = 0;
+            for (const auto& iv : intervals) {
+                stabbed += iv.first <= s && s < iv.second;
+            }
+            std::size_t visited = 0;
+            index.stab(s, [&](int, int, std::uint32_t) { ++visited; });
+            REQUIRE(visited == stabbed);
+            REQUIRE(index.stab_count(s) == stabbed);
+        }
+    }
+}
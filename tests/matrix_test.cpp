@@ -0,0 +1,220 @@
+#define CATCH_CONFIG_MAIN
+#include "matrix.hpp"
+#include <catch2/catch.hpp>
+#include <cmath>
+#include <cstdint>
+#include <random>
+
+using namespace algo;
+
+template <typename T>
+static Matrix<T> randomMatrix(std::size_t rows, std::size_t cols,
+                              std::mt19937& gen) {
+    Matrix<T> m(rows, cols);
+    for (std::size_t i = 0; i < rows; ++i) {
+        for (std::size_t j = 0; j < cols; ++j) {
+            m(i, j) = T(int(gen() % 19) - 9);
+        }
+    }
+    return m;
+}
+
+TEST_CASE("matrix basic operations") {
+    Matrix<double> m(3, 5, 1.5);
+    REQUIRE(m.rows() == 3);
+    REQUIRE(m.cols() == 5);
+    REQUIRE(m.stride() == 8);
+    for (std::size_t i = 0; i < m.rows(); ++i) {
+        REQUIRE(reinterpret_cast<std::uintptr_t>(m.row(i)) % 64 == 0);
+        REQUIRE(m.row(i)[5] == 0.0); // Padding stays zero.
+    }
+    REQUIRE(m(2, 4) == 1.5);
+
+    m.at(1, 2) = 7;
+    REQUIRE(m(1, 2) == 7);
+    REQUIRE_THROWS_AS(m.at(3, 0), std::out_of_range);
+    REQUIRE_THROWS_AS(m.at(0, 5), std::out_of_range);
+
+    Matrix<double> copy = m;
+    REQUIRE(copy == m);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(copy.data()) % 64 == 0);
+    copy(0, 0) = 2;
+    REQUIRE(copy != m);
+
+    REQUIRE_THROWS_AS((Matrix<int>{{1, 2}, {3}}), std::invalid_argument);
+    REQUIRE(Matrix<int>().rows() == 0);
+}
+
+TEST_CASE("matrix views share storage") {
+    Matrix<int> m(4, 6);
+    MatrixView<int> block = m.block(1, 2, 2, 3);
+    REQUIRE(block.rows() == 2);
+    REQUIRE(block.cols() == 3);
+    REQUIRE(block.stride() == m.stride());
+    block.fill(9);
+    block(1, 2) = 5;
+    REQUIRE(m(1, 2) == 9);
+    REQUIRE(m(2, 4) == 5);
+    REQUIRE(m(0, 2) == 0);
+    REQUIRE(m(1, 5) == 0);
+
+    MatrixView<const int> inner = block.block(1, 1, 1, 2);
+    REQUIRE(inner(0, 1) == 5);
+    REQUIRE_THROWS_AS(block.block(1, 1, 2, 1), std::out_of_range);
+    REQUIRE_THROWS_AS(m.block(0, 0, 5, 1), std::out_of_range);
+}
+
+TEST_CASE("matrix transpose") {
+    std::mt19937 gen(2);
+    for (std::size_t rows : {1u, 7u, 16u, 33u}) {
+        for (std::size_t cols : {1u, 5u, 17u, 40u}) {
+            const Matrix<float> m = randomMatrix<float>(rows, cols, gen);
+            const Matrix<float> t = m.transposed();
+            REQUIRE(t.rows() == cols);
+            REQUIRE(t.cols() == rows);
+            for (std::size_t i = 0; i < rows; ++i) {
+                for (std::size_t j = 0; j < cols; ++j) {
+                    REQUIRE(t(j, i) == m(i, j));
+                }
+            }
+            REQUIRE(t.transposed() == m);
+        }
+    }
+    Matrix<float> wrong(2, 2);
+    REQUIRE_THROWS_AS(transpose(Matrix<float>(2, 3).view(), wrong.view()),
+                      std::invalid_argument);
+}
+
+template <typename T>
+static void checkGemm(std::mt19937& gen) {
+    for (std::size_t m : {1u, 4u, 9u, 70u}) {
+        for (std::size_t k : {0u, 1u, 8u, 300u}) {
+            for (std::size_t n : {1u, 16u, 19u, 270u}) {
+                const Matrix<T> a = randomMatrix<T>(m, k, gen);
+                const Matrix<T> b = randomMatrix<T>(k, n, gen);
+                Matrix<T> c = randomMatrix<T>(m, n, gen);
+                Matrix<T> expected = c;
+                for (std::size_t i = 0; i < m; ++i) {
+                    for (std::size_t j = 0; j < n; ++j) {
+                        T sum = T(0);
+                        for (std::size_t p = 0; p < k; ++p) {
+                            sum += a(i, p) * b(p, j);
+                        }
+                        expected(i, j) = T(2) * sum + T(3) * expected(i, j);
+                    }
+                }
+                gemm(T(2), a.view(), b.view(), T(3), c.view());
+                // Small integers keep every sum exact.
+                REQUIRE(c == expected);
+            }
+        }
+    }
+}
+
+TEST_CASE("matrix gemm matches the naive product") {
+    std::mt19937 gen(3);
+    checkGemm<double>(gen);
+    checkGemm<float>(gen);
+    checkGemm<int>(gen);
+
+    const Matrix<double> a = {{1, 2}, {3, 4}};
+    const Matrix<double> b = {{5, 6}, {7, 8}};
+    REQUIRE(a * b == (Matrix<double>{{19, 22}, {43, 50}}));
+    REQUIRE_THROWS_AS(a * Matrix<double>(3, 1), std::invalid_argument);
+}
+
+TEST_CASE("matrix gemm on views") {
+    std::mt19937 gen(4);
+    const Matrix<double> a = randomMatrix<double>(20, 30, gen);
+    const Matrix<double> b = randomMatrix<double>(30, 20, gen);
+    Matrix<double> c(25, 25, -1.0);
+    gemm(1.0, a.block(2, 3, 10, 12), b.block(5, 1, 12, 9), 0.0,
+         c.block(4, 6, 10, 9));
+    for (std::size_t i = 0; i < 25; ++i) {
+        for (std::size_t j = 0; j < 25; ++j) {
+            if (i < 4 || i >= 14 || j < 6 || j >= 15) {
+                REQUIRE(c(i, j) == -1.0);
+                continue;
+            }
+            double sum = 0;
+            for (std::size_t p = 0; p < 12; ++p) {
+                sum += a(i - 4 + 2, p + 3) * b(p + 5, j - 6 + 1);
+            }
+            REQUIRE(c(i, j) == sum);
+        }
+    }
+}
+
+TEST_CASE("matrix gemv") {
+    std::mt19937 gen(5);
+    for (std::size_t m : {1u, 4u, 11u}) {
+        for (std::size_t n : {1u, 3u, 8u, 37u}) {
+            const Matrix<double> a = randomMatrix<double>(m, n, gen);
+            Vector<double> x(n, 0.0);
+            Vector<double> y(m, 1.0);
+            for (auto& v : x) {
+                v = double(gen() % 7);
+            }
+            gemv(2.0, a.view(), x, 0.5, y);
+            for (std::size_t i = 0; i < m; ++i) {
+                double dot = 0;
+                for (std::size_t j = 0; j < n; ++j) {
+                    dot += a(i, j) * x[j];
+                }
+                REQUIRE(y[i] == 2.0 * dot + 0.5);
+            }
+        }
+    }
+    Vector<double> x(3, 0.0), y(2, 0.0);
+    REQUIRE_THROWS_AS(gemv(1.0, Matrix<double>(2, 2).view(), x, 0.0, y),
+                      std::invalid_argument);
+}
+
+template <typename T>
+static void checkMatrixLevels(std::mt19937& gen) {
+    for (std::size_t m : {1u, 4u, 9u}) {
+        for (std::size_t k : {0u, 1u, 13u}) {
+            for (std::size_t n : {1u, 7u, 32u, 45u}) {
+                const Matrix<T> a = randomMatrix<T>(m, k, gen);
+                const Matrix<T> b = randomMatrix<T>(k, n, gen);
+                const Matrix<T> c = randomMatrix<T>(m, n, gen);
+                const Matrix<T> x = randomMatrix<T>(1, k, gen);
+                Matrix<T> product = c;
+                Matrix<T> y = randomMatrix<T>(1, m, gen);
+                Matrix<T> image = y;
+                for (std::size_t i = 0; i < m; ++i) {
+                    for (std::size_t j = 0; j < n; ++j) {
+                        for (std::size_t p = 0; p < k; ++p) {
+                            product(i, j) += T(2) * a(i, p) * b(p, j);
+                        }
+                    }
+                    T dot = T(0);
+                    for (std::size_t p = 0; p < k; ++p) {
+                        dot += a(i, p) * x(0, p);
+                    }
+                    image(0, i) = T(2) * dot + T(3) * y(0, i);
+                }
+                for (int l = 0; l <= int(simd::detect()); ++l) {
+                    const auto level = simd::Level(l);
+                    Matrix<T> out = c;
+                    detail::gemm_block<T>.get(level)(
+                        m, n, k, a.data(), a.stride(), b.data(), b.stride(),
+                        T(2), out.data(), out.stride());
+                    // Small integers keep every sum exact.
+                    REQUIRE(out == product);
+                    Matrix<T> z = y;
+                    detail::gemv_rows<T>.get(level)(m, k, a.data(),
+                                                    a.stride(), x.data(),
+                                                    T(2), T(3), z.data());
+                    REQUIRE(z == image);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("matrix kernels agree on every supported level") {
+    std::mt19937 gen(6);
+    checkMatrixLevels<double>(gen);
+    checkMatrixLevels<float>(gen);
+}
@@ -0,0 +1,113 @@
+#define CATCH_CONFIG_MAIN
+#include "merge.hpp"
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+
+using namespace algo;
+
+namespace {
+struct Record {
+    std::uint32_t key;
+    std::uint32_t run;
+    std::uint32_t pos;
+
+    bool operator==(const Record& other) const {
+        return key == other.key && run == other.run && pos == other.pos;
+    }
+};
+
+struct KeyLess {
+    bool operator()(const Record& a, const Record& b) const {
+        return a.key < b.key;
+    }
+};
+} // namespace
+
+static Vector<Vector<Record>> randomRuns(std::size_t count,
+                                         std::size_t max_length,
+                                         std::uint32_t range,
+                                         std::mt19937& gen) {
+    Vector<Vector<Record>> runs(count);
+    for (std::uint32_t r = 0; r < count; ++r) {
+        const std::size_t n = max_length == 0 ? 0 : gen() % (max_length + 1);
+        for (std::uint32_t i = 0; i < n; ++i) {
+            runs[r].push_back({std::uint32_t(gen() % range), r, 0});
+        }
+        std::sort(runs[r].begin(), runs[r].end(), KeyLess());
+        for (std::uint32_t i = 0; i < n; ++i) {
+            runs[r][i].pos = i;
+        }
+    }
+    return runs;
+}
+
+// A stable sort of the concatenation is a stable merge.
+static Vector<Record> expectedMerge(const Vector<Vector<Record>>& runs) {
+    Vector<Record> all;
+    for (const Vector<Record>& run : runs) {
+        for (const Record& r : run) {
+            all.push_back(r);
+        }
+    }
+    std::stable_sort(all.begin(), all.end(), KeyLess());
+    return all;
+}
+
+TEST_CASE("kway_merge is a stable merge") {
+    std::mt19937 gen(1);
+    for (std::size_t count : {0u, 1u, 2u, 3u, 7u, 64u, 300u}) {
+        for (std::size_t length : {0u, 1u, 20u, 500u}) {
+            for (std::uint32_t range : {1u, 10u, 1u << 30}) {
+                const Vector<Vector<Record>> runs =
+                    randomRuns(count, length, range, gen);
+                Vector<Record> out(3, Record{7, 7, 7});
+                kway_merge(runs, out, KeyLess());
+                REQUIRE(out == expectedMerge(runs));
+            }
+        }
+    }
+}
+
+TEST_CASE("kway_merge with the default order") {
+    const Vector<Vector<int>> runs = {{1, 4, 7}, {}, {2, 5}, {3, 6, 8}};
+    Vector<int> out;
+    kway_merge(runs, out);
+    REQUIRE(out == (Vector<int>{1, 2, 3, 4, 5, 6, 7, 8}));
+
+    const Vector<std::string> a = {"b", "d"};
+    const Vector<std::string> b = {"a", "c", "e"};
+    const Vector<std::string> pair[] = {a, b};
+    Vector<std::string> words;
+    kway_merge(pair, 2, words);
+    REQUIRE(words == (Vector<std::string>{"a", "b", "c", "d", "e"}));
+
+    Vector<Vector<int>> self = {{1, 2}, {3}};
+    REQUIRE_THROWS_AS(kway_merge(self.data(), 2, self[1]),
+                      std::invalid_argument);
+}
+
+TEST_CASE("kway_merge_parallel matches kway_merge") {
+    ThreadPool pool(4);
+    std::mt19937 gen(2);
+    for (std::size_t count : {1u, 2u, 5u, 40u}) {
+        for (std::uint32_t range : {1u, 3u, 100u, 1u << 30}) {
+            const Vector<Vector<Record>> runs =
+                randomRuns(count, 400000 / count, range, gen);
+            Vector<Record> out;
+            kway_merge_parallel(runs, out, pool, KeyLess());
+            REQUIRE(out == expectedMerge(runs));
+        }
+    }
+
+    Vector<Vector<Record>> empty(3);
+    Vector<Record> out(2, Record{1, 1, 1});
+    kway_merge_parallel(empty, out, pool, KeyLess());
+    REQUIRE(out.empty());
+
+    out.push_back(Record{1, 1, 1});
+    kway_merge_parallel(Vector<Vector<Record>>{}, out, pool, KeyLess());
+    REQUIRE(out.empty());
+}
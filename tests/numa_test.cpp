@@ -0,0 +1,116 @@
+#define CATCH_CONFIG_MAIN
+#include "numa.hpp"
+#include "vector.hpp"
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <system_error>
+
+using namespace algo;
+
+template <typename T>
+using NumaVector = Vector<T, NumaAllocator<T>>;
+
+// Checks that every page of `v` is on a node of `nodes`, unless the kernel
+// cannot tell where pages are.
+template <typename T>
+static void requirePagesOn(const NumaVector<T>& v, std::uint64_t nodes) {
+    const char* p = reinterpret_cast<const char*>(v.data());
+    for (std::size_t i = 0; i < v.size() * sizeof(T); i += 4096) {
+        const int node = numa_node_of(p + i);
+        if (node < 0) {
+            return;
+        }
+        REQUIRE((nodes >> node & 1) == 1);
+    }
+}
+
+// Returns whether the kernel lets the process place pages, which containers
+// without `CAP_SYS_NICE` forbid.
+static bool canPlacePages() {
+    NumaAllocator<char> alloc(NumaPolicy::interleave());
+    try {
+        alloc.deallocate(alloc.allocate(1), 1);
+    } catch (const std::system_error&) {
+        return false;
+    }
+    return true;
+}
+
+TEST_CASE("numa_nodes lists at least one node") {
+    const std::uint64_t nodes = numa_nodes();
+    REQUIRE(nodes != 0);
+    REQUIRE(numa_node_count() >= 1);
+    int x = 0;
+    const int node = numa_node_of(&x);
+    if (node >= 0) {
+        REQUIRE((nodes >> node & 1) == 1);
+    }
+}
+
+TEST_CASE("NumaAllocator backs a Vector") {
+    NumaVector<int> v;
+    for (int i = 0; i < 100000; ++i) {
+        v.push_back(i);
+    }
+    REQUIRE(v.size() == 100000);
+    REQUIRE(std::accumulate(v.begin(), v.end(), 0LL) == 4999950000LL);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(v.data()) % 4096 == 0);
+    requirePagesOn(v, numa_nodes());
+
+    NumaVector<int> w = v;
+    REQUIRE(w == v);
+    v.clear();
+    v.shrink_to_fit();
+    REQUIRE(w.back() == 99999);
+
+    NumaVector<char> small(1, 'a');
+    REQUIRE(small[0] == 'a');
+}
+
+TEST_CASE("NumaAllocator places pages after its policy") {
+    REQUIRE_THROWS_AS(NumaPolicy::bind(64), std::invalid_argument);
+    if (!canPlacePages()) {
+        return;
+    }
+    const std::uint64_t nodes = numa_nodes();
+    const unsigned first = unsigned(__builtin_ctzll(nodes));
+
+    NumaVector<std::uint64_t> interleaved(
+        1 << 18, 7, NumaAllocator<std::uint64_t>(NumaPolicy::interleave()));
+    REQUIRE(interleaved[12345] == 7);
+    requirePagesOn(interleaved, nodes);
+
+    NumaVector<std::uint64_t> bound(
+        1 << 18, 7, NumaAllocator<std::uint64_t>(NumaPolicy::bind(first)));
+    REQUIRE(bound.get_allocator().policy().placement ==
+            NumaPolicy::Placement::bind);
+    requirePagesOn(bound, std::uint64_t(1) << first);
+
+    if (nodes >> 63 == 0) {
+        NumaAllocator<int> alloc(NumaPolicy::bind(63));
+        REQUIRE_THROWS_AS(alloc.allocate(10), std::system_error);
+    }
+}
+
+TEST_CASE("NumaPolicy::first_touch touches pages on the pool") {
+    ThreadPool pool(4);
+    NumaVector<double> v(1 << 20, 1.5,
+                         NumaAllocator<double>(NumaPolicy::first_touch(pool)));
+    REQUIRE(v.size() == 1 << 20);
+    auto add = [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            v[i] += double(i);
+        }
+    };
+    pool.parallel_for_static(0, v.size(), add);
+    REQUIRE(v[0] == 1.5);
+    REQUIRE(v[1000] == 1001.5);
+    requirePagesOn(v, numa_nodes());
+
+    v.insert(v.end(), 2 << 20, 2.0);
+    REQUIRE(v.size() == 3 << 20);
+    REQUIRE(v.back() == 2.0);
+    REQUIRE(v[1000] == 1001.5);
+}
@@ -0,0 +1,267 @@
+#define CATCH_CONFIG_MAIN
+#include "radix_trie.hpp"
+#include <catch2/catch.hpp>
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace algo;
+
+namespace {
+using Entries = std::vector<std::pair<std::string, int>>;
+
+Entries collect(const RadixTrie<int>& trie) {
+    Entries out;
+    trie.for_each([&](std::string_view key, const int& v) {
+        out.emplace_back(std::string(key), v);
+    });
+    return out;
+}
+
+Entries collect(const std::map<std::string, int>& map) {
+    return Entries(map.begin(), map.end());
+}
+
+std::string randomKey(std::mt19937& rng, const char* alphabet,
+                      std::size_t sigma, std::size_t max_len) {
+    std::string key(rng() % (max_len + 1), ' ');
+    for (char& c : key) {
+        c = alphabet[rng() % sigma];
+    }
+    return key;
+}
+} // namespace
+
+TEST_CASE("insert and find") {
+    RadixTrie<int> trie;
+    REQUIRE(trie.empty());
+    REQUIRE(trie.find("a") == nullptr);
+
+    REQUIRE(trie.insert("romane", 1));
+    REQUIRE(trie.insert("romanus", 2));
+    REQUIRE(trie.insert("romulus", 3));
+    REQUIRE(trie.insert("rubens", 4));
+    REQUIRE(trie.insert("ruber", 5));
+    REQUIRE(trie.insert("rubicon", 6));
+    REQUIRE(trie.insert("rubicundus", 7));
+    REQUIRE(trie.insert("rom", 8));
+    REQUIRE(trie.insert("", 9));
+    REQUIRE(!trie.insert("rom", 80));
+    REQUIRE(trie.size() == 9);
+
+    REQUIRE(*trie.find("romane") == 1);
+    REQUIRE(*trie.find("rubicundus") == 7);
+    REQUIRE(*trie.find("rom") == 8);
+    REQUIRE(*trie.find("") == 9);
+    REQUIRE(trie.find("roman") == nullptr);
+    REQUIRE(trie.find("rubiconx") == nullptr);
+    REQUIRE(!trie.contains("r"));
+
+    REQUIRE(!trie.insert_or_assign("rom", 80));
+    REQUIRE(*trie.find("rom") == 80);
+    *trie.find("ruber") = 50;
+    REQUIRE(*trie.find("ruber") == 50);
+}
+
+TEST_CASE("ordered iteration and prefix scans") {
+    RadixTrie<int> trie;
+    const char* keys[] = {"b", "a", "abc", "ab", "abd", "ac", "b\xff", "b\x01"};
+    for (int i = 0; i < 8; ++i) {
+        trie.insert(keys[i], i);
+    }
+
+    std::vector<std::string> order;
+    trie.for_each([&](std::string_view key, const int&) {
+        order.emplace_back(key);
+    });
+    REQUIRE(order == std::vector<std::string>{"a", "ab", "abc", "abd", "ac",
+                                              "b", "b\x01", "b\xff"});
+
+    std::vector<std::string> scanned;
+    auto scan = [&](std::string_view prefix) {
+        scanned.clear();
+        trie.for_each_prefix(prefix, [&](std::string_view key, const int&) {
+            scanned.emplace_back(key);
+        });
+        return scanned;
+    };
+    REQUIRE(scan("ab") == std::vector<std::string>{"ab", "abc", "abd"});
+    REQUIRE(scan("abc") == std::vector<std::string>{"abc"});
+    REQUIRE(scan("b\x01") == std::vector<std::string>{"b\x01"});
+    REQUIRE(scan("abz").empty());
+    REQUIRE(scan("").size() == 8);
+}
+
+TEST_CASE("longest prefix match") {
+    RadixTrie<int> routes;
+    routes.insert("10.", 1);
+    routes.insert("10.1.", 2);
+    routes.insert("10.1.2.", 3);
+    routes.insert("192.168.", 4);
+
+    REQUIRE(*routes.longest_prefix("10.1.2.3") == 3);
+    REQUIRE(*routes.longest_prefix("10.1.9.9") == 2);
+    REQUIRE(*routes.longest_prefix("10.200.0.1") == 1);
+    REQUIRE(*routes.longest_prefix("192.168.0.1") == 4);
+    REQUIRE(routes.longest_prefix("192.169.0.1") == nullptr);
+    REQUIRE(routes.longest_prefix("1") == nullptr);
+}
+
+TEST_CASE("dense nodes") {
+    RadixTrie<int> trie;
+    for (int b = 0; b < 256; ++b) {
+        trie.insert(std::string("x") + char(b), b);
+        trie.insert(std::string("x") + char(b) + "tail", b + 1000);
+    }
+    REQUIRE(trie.size() == 512);
+    for (int b = 0; b < 256; ++b) {
+        REQUIRE(*trie.find(std::string("x") + char(b)) == b);
+        REQUIRE(*trie.find(std::string("x") + char(b) + "tail") == b + 1000);
+    }
+
+    int prev = -1;
+    trie.for_each([&](std::string_view key, const int& v) {
+        if (key.size() == 2) {
+            REQUIRE(v > prev);
+            prev = v;
+        }
+    });
+    REQUIRE(prev == 255);
+}
+
+TEST_CASE("erase") {
+    RadixTrie<int> trie;
+    trie.insert("abc", 1);
+    trie.insert("abd", 2);
+    trie.insert("ab", 3);
+
+    REQUIRE(!trie.erase("a"));
+    REQUIRE(trie.erase("abc"));
+    REQUIRE(!trie.contains("abc"));
+    REQUIRE(*trie.find("abd") == 2);
+    REQUIRE(trie.erase("ab"));
+    REQUIRE(*trie.find("abd") == 2);
+    REQUIRE(trie.erase("abd"));
+    REQUIRE(trie.empty());
+    REQUIRE(collect(trie).empty());
+
+    trie.insert("abc", 4);
+    REQUIRE(*trie.find("abc") == 4);
+    trie.clear();
+    REQUIRE(trie.empty());
+    REQUIRE(trie.find("abc") == nullptr);
+}
+
+TEST_CASE("keys of the trie can be reinserted") {
+    RadixTrie<int> trie;
+    for (int i = 0; i < 100; ++i) {
+        trie.insert("key" + std::to_string(i), i);
+    }
+    std::vector<std::string_view> keys;
+    trie.for_each([&](std::string_view key, const int&) {
+        keys.push_back(key);
+    });
+    RadixTrie<int> copy;
+    for (std::string_view key : keys) {
+        REQUIRE(!trie.insert(key, -1));
+        copy.insert(key.substr(1), 0);
+    }
+    REQUIRE(copy.size() == 100);
+}
+
+TEST_CASE("parts of keys of the trie can be inserted into it") {
+    RadixTrie<int> trie;
+    std::map<std::string, int> map;
+    std::vector<std::string> stored;
+    for (int i = 0; i < 200; ++i) {
+        stored.push_back("key/" + std::to_string(i * 7919) + "/x");
+        trie.insert(stored.back(), i);
+        map.emplace(stored.back(), i);
+    }
+    // The key bytes that `key` points into may grow on every insertion, so
+    // the key is looked up again each time.
+    auto inTrie = [&](const std::string& s) {
+        std::string_view found;
+        trie.for_each_prefix(s, [&](std::string_view key, const int&) {
+            if (key == s) {
+                found = key;
+            }
+        });
+        REQUIRE(found == s);
+        return found;
+    };
+    for (const std::string& s : stored) {
+        for (std::size_t len = 1; len < s.size(); ++len) {
+            trie.insert(inTrie(s).substr(0, len), int(len));
+            map.emplace(s.substr(0, len), int(len));
+            trie.insert(inTrie(s).substr(len), -int(len));
+            map.emplace(s.substr(len), -int(len));
+        }
+    }
+    REQUIRE(trie.size() == map.size());
+    REQUIRE(collect(trie) == collect(map));
+}
+
+TEST_CASE("random operations match std::map") {
+    std::mt19937 rng(2020);
+    for (const char* alphabet : {"ab", "abcdefghijklmnopqrstuvwxyz0123"}) {
+        const std::size_t sigma = std::string(alphabet).size();
+        RadixTrie<int> trie;
+        std::map<std::string, int> map;
+
+        for (int round = 0; round < 20000; ++round) {
+            const std::string key = randomKey(rng, alphabet, sigma, 12);
+            switch (rng() % 4) {
+            case 0:
+            case 1:
+                REQUIRE(trie.insert(key, round) ==
+                        map.emplace(key, round).second);
+                break;
+            case 2:
+                REQUIRE(trie.erase(key) == (map.erase(key) == 1));
+                break;
+            default: {
+                const int* v = trie.find(key);
+                const auto it = map.find(key);
+                REQUIRE((v != nullptr) == (it != map.end()));
+                if (v) {
+                    REQUIRE(*v == it->second);
+                }
+            }
+            }
+        }
+        REQUIRE(trie.size() == map.size());
+        REQUIRE(collect(trie) == collect(map));
+
+        for (int round = 0; round < 200; ++round) {
+            const std::string key = randomKey(rng, alphabet, sigma, 14);
+
+            Entries scanned;
+            trie.for_each_prefix(key, [&](std::string_view k, const int& v) {
+                scanned.emplace_back(std::string(k), v);
+            });
+            Entries expected;
+            for (auto it = map.lower_bound(key);
+                 it != map.end() && it->first.compare(0, key.size(), key) == 0;
+                 ++it) {
+                expected.push_back(*it);
+            }
+            REQUIRE(scanned == expected);
+
+            const int* best = trie.longest_prefix(key);
+            const int* naive = nullptr;
+            for (std::size_t len = 0; len <= key.size(); ++len) {
+                const auto it = map.find(key.substr(0, len));
+                if (it != map.end()) {
+                    naive = &it->second;
+                }
+            }
+            REQUIRE((best != nullptr) == (naive != nullptr));
+            if (best) {
+                REQUIRE(*best == *naive);
+            }
+        }
+    }
+}
@@ -0,0 +1,261 @@
+#define CATCH_CONFIG_MAIN
+#include "roaring_bitmap.hpp"
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace algo;
+
+static std::vector<std::uint32_t> toStd(const RoaringBitmap& r) {
+    const Vector<std::uint32_t> v = r.to_vector();
+    return std::vector<std::uint32_t>(v.begin(), v.end());
+}
+
+// A mix of sparse, dense and run-heavy chunks.
+static std::set<std::uint32_t> makeSet(std::mt19937& gen) {
+    std::set<std::uint32_t> s;
+    std::uniform_int_distribution<std::uint32_t> any;
+    for (int i = 0; i < 2000; ++i) {
+        s.insert(any(gen));
+    }
+    for (int i = 0; i < 20000; ++i) {
+        s.insert(0x50000 + gen() % 30000);
+    }
+    const std::uint32_t start = 0x90000 + gen() % 1000;
+    for (std::uint32_t v = start; v < start + 70000; ++v) {
+        s.insert(v);
+    }
+    for (int i = 0; i < 3000; ++i) {
+        s.insert(0x1000000 + gen() % 65536);
+    }
+    return s;
+}
+
+TEST_CASE("roaring bitmap basic operations") {
+    RoaringBitmap r;
+    REQUIRE(r.empty());
+    REQUIRE(r.add(5));
+    REQUIRE(!r.add(5));
+    REQUIRE(r.add(1000000));
+    REQUIRE(r.add(0xffffffff));
+    REQUIRE(r.cardinality() == 3);
+    REQUIRE(r.container_count() == 3);
+    REQUIRE(r.contains(1000000));
+    REQUIRE(!r.contains(6));
+
+    REQUIRE(r.remove(1000000));
+    REQUIRE(!r.remove(1000000));
+    REQUIRE(r.container_count() == 2);
+    REQUIRE(toStd(r) == std::vector<std::uint32_t>{5, 0xffffffff});
+
+    r.clear();
+    REQUIRE(r.empty());
+}
+
+TEST_CASE("roaring bitmap switches containers") {
+    RoaringBitmap r;
+    for (std::uint32_t v = 0; v < 10000; v += 2) {
+        r.add(v);
+    }
+    REQUIRE(r.cardinality() == 5000);
+    for (std::uint32_t v = 0; v < 10000; v += 2) {
+        REQUIRE(r.contains(v));
+        REQUIRE(!r.contains(v + 1));
+    }
+    for (std::uint32_t v = 0; v < 4000; v += 2) {
+        r.remove(v);
+    }
+    REQUIRE(r.cardinality() == 3000);
+    REQUIRE(r.contains(4000));
+    REQUIRE(!r.contains(3998));
+
+    RoaringBitmap runs;
+    for (std::uint32_t v = 100; v < 60000; ++v) {
+        runs.add(v);
+    }
+    const auto before = toStd(runs);
+    const auto bytes_before = runs.serialized_size();
+    REQUIRE(runs.run_optimize());
+    REQUIRE(!runs.run_optimize());
+    REQUIRE(runs.serialized_size() < bytes_before / 100);
+    REQUIRE(toStd(runs) == before);
+    REQUIRE(runs.contains(100));
+    REQUIRE(runs.contains(59999));
+    REQUIRE(!runs.contains(99));
+    REQUIRE(!runs.contains(60000));
+
+    // Mutating a run container falls back to the other representations.
+    REQUIRE(runs.remove(500));
+    REQUIRE(!runs.contains(500));
+    REQUIRE(runs.add(60000));
+    REQUIRE(runs.cardinality() == 59900);
+}
+
+TEST_CASE("roaring bitmap set operations match std::set") {
+    std::mt19937 gen(17);
+    for (int round = 0; round < 4; ++round) {
+        const auto sa = makeSet(gen);
+        const auto sb = makeSet(gen);
+        RoaringBitmap a, b;
+        a.add_many(sa.begin(), sa.end());
+        b.add_many(sb.begin(), sb.end());
+        if (round % 2 == 1) {
+            a.run_optimize();
+        }
+        if (round >= 2) {
+            b.run_optimize();
+        }
+        REQUIRE(a.cardinality() == sa.size());
+        REQUIRE(toStd(a) == std::vector<std::uint32_t>(sa.begin(), sa.end()));
+
+        std::vector<std::uint32_t> expected;
+        std::set_intersection(sa.begin(), sa.end(), sb.begin(), sb.end(),
+                              std::back_inserter(expected));
+        REQUIRE(toStd(a & b) == expected);
+        REQUIRE(a.and_cardinality(b) == expected.size());
+
+        expected.clear();
+        std::set_union(sa.begin(), sa.end(), sb.begin(), sb.end(),
+                       std::back_inserter(expected));
+        REQUIRE(toStd(a | b) == expected);
+
+        expected.clear();
+        std::set_difference(sa.begin(), sa.end(), sb.begin(), sb.end(),
+                            std::back_inserter(expected));
+        RoaringBitmap d(a);
+        d.and_not(b);
+        REQUIRE(toStd(d) == expected);
+
+        REQUIRE((a & b) == (b & a));
+        REQUIRE(a != b);
+    }
+}
+
+TEST_CASE("roaring array intersection") {
+    std::mt19937 gen(3);
+    for (std::uint32_t n : {5u, 8u, 100u, 4000u}) {
+        for (std::uint32_t m : {3u, 9u, 300u, 4096u}) {
+            std::set<std::uint32_t> sa, sb;
+            while (sa.size() < n) {
+                sa.insert(gen() % 8192);
+            }
+            while (sb.size() < m) {
+                sb.insert(gen() % 8192);
+            }
+            // Zeros must not be mistaken for string terminators.
+            sa.insert(0);
+            sb.insert(0);
+            RoaringBitmap a, b;
+            a.add_many(sa.begin(), sa.end());
+            b.add_many(sb.begin(), sb.end());
+
+            std::vector<std::uint32_t> expected;
+            std::set_intersection(sa.begin(), sa.end(), sb.begin(), sb.end(),
+                                  std::back_inserter(expected));
+            REQUIRE(toStd(a & b) == expected);
+        }
+    }
+}
+
+TEST_CASE("roaring bitmap serialization") {
+    std::mt19937 gen(99);
+    const auto s = makeSet(gen);
+    RoaringBitmap r;
+    r.add_many(s.begin(), s.end());
+    r.run_optimize();
+
+    Vector<unsigned char> bytes;
+    bytes.push_back(0xAB); // Payloads need no alignment.
+    r.serialize(bytes);
+    REQUIRE(bytes.size() == 1 + r.serialized_size());
+
+    RoaringBitmapView view(bytes.data() + 1, bytes.size() - 1);
+    REQUIRE(view.container_count() == r.container_count());
+    REQUIRE(view.cardinality() == r.cardinality());
+    for (std::uint32_t v : s) {
+        REQUIRE(view.contains(v));
+    }
+    std::uniform_int_distribution<std::uint32_t> any;
+    for (int i = 0; i < 10000; ++i) {
+        const std::uint32_t v = any(gen);
+        REQUIRE(view.contains(v) == (s.count(v) != 0));
+    }
+
+    std::vector<std::uint32_t> visited;
+    view.for_each([&](std::uint32_t v) { visited.push_back(v); });
+    REQUIRE(visited == std::vector<std::uint32_t>(s.begin(), s.end()));
+
+    const RoaringBitmap copy =
+        RoaringBitmap::deserialize(bytes.data() + 1, bytes.size() - 1);
+    REQUIRE(copy == r);
+    REQUIRE(toStd(copy) == visited);
+
+    REQUIRE_THROWS_AS(RoaringBitmap::deserialize(bytes.data(), 4),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(RoaringBitmap::deserialize(bytes.data(), bytes.size()),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(RoaringBitmapView(bytes.data() + 1, 100),
+                      std::invalid_argument);
+
+    Vector<unsigned char> empty;
+    RoaringBitmap().serialize(empty);
+    REQUIRE(RoaringBitmapView(empty.data(), empty.size()).cardinality() == 0);
+}
+
+TEST_CASE("roaring bitmap view rejects malformed containers") {
+    // One container, so its entry is at byte 8 and its values at byte 24.
+    auto bytesOf = [](const RoaringBitmap& r) {
+        Vector<unsigned char> bytes;
+        r.serialize(bytes);
+        return bytes;
+    };
+    auto valid = [](const Vector<unsigned char>& bytes) {
+        try {
+            RoaringBitmapView(bytes.data(), bytes.size());
+            return true;
+        } catch (const std::invalid_argument&) {
+            return false;
+        }
+    };
+
+    Vector<unsigned char> array = bytesOf(RoaringBitmap{5, 6, 7});
+    REQUIRE(valid(array));
+    detail::storeLe<std::uint16_t>(array.data() + 26, 5);
+    REQUIRE_FALSE(valid(array));
+    detail::storeLe<std::uint16_t>(array.data() + 26, 4);
+    REQUIRE_FALSE(valid(array));
+
+    RoaringBitmap runs;
+    for (std::uint32_t v = 100; v < 200; ++v) {
+        runs.add(0x10000 + v);
+        runs.add(0x10000 + v + 200);
+    }
+    REQUIRE(runs.run_optimize());
+    Vector<unsigned char> run = bytesOf(runs);
+    REQUIRE(valid(run));
+    // A run past 0xFFFF would spill into the next key.
+    Vector<unsigned char> spill = run;
+    detail::storeLe<std::uint16_t>(spill.data() + 30, 0xFFFF);
+    REQUIRE_FALSE(valid(spill));
+    // Overlapping runs.
+    Vector<unsigned char> overlap = run;
+    detail::storeLe<std::uint16_t>(overlap.data() + 28, 150);
+    REQUIRE_FALSE(valid(overlap));
+    // A cardinality that does not match the runs.
+    Vector<unsigned char> card = run;
+    detail::storeLe<std::uint32_t>(card.data() + 12, 5);
+    REQUIRE_FALSE(valid(card));
+
+    RoaringBitmap dense;
+    for (std::uint32_t v = 0; v < 10000; ++v) {
+        dense.add(v);
+    }
+    dense.remove(5000);
+    Vector<unsigned char> bitmap = bytesOf(dense);
+    REQUIRE(valid(bitmap));
+    detail::storeLe<std::uint32_t>(bitmap.data() + 12, 10000);
+    REQUIRE_FALSE(valid(bitmap));
+}
@@ -0,0 +1,176 @@
+#define CATCH_CONFIG_MAIN
+#include "selection.hpp"
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+
+using namespace algo;
+
+template <typename T>
+static Vector<T> randomValues(std::size_t n, std::uint32_t range,
+                              std::mt19937& gen) {
+    Vector<T> v;
+    for (std::size_t i = 0; i < n; ++i) {
+        v.push_back(T(gen() % range));
+    }
+    return v;
+}
+
+template <typename T, typename Compare = std::less<>>
+static void checkNthElement(Vector<T> v, std::size_t nth,
+                            Compare comp = Compare()) {
+    Vector<T> sorted = v;
+    std::sort(sorted.begin(), sorted.end(), comp);
+    algo::nth_element(v.begin(), v.begin() + nth, v.end(), comp);
+    REQUIRE(v[nth] == sorted[nth]);
+    for (std::size_t i = 0; i < nth; ++i) {
+        REQUIRE(!comp(v[nth], v[i]));
+    }
+    for (std::size_t i = nth + 1; i < v.size(); ++i) {
+        REQUIRE(!comp(v[i], v[nth]));
+    }
+    std::sort(v.begin(), v.end(), comp);
+    REQUIRE(v == sorted);
+}
+
+TEST_CASE("nth_element matches a full sort") {
+    std::mt19937 gen(1);
+    for (std::size_t n : {1u, 2u, 17u, 33u, 100u, 1000u, 5000u}) {
+        for (std::uint32_t range : {1u, 3u, 1000u, 1u << 30}) {
+            for (std::size_t nth : {std::size_t(0), n / 3, n - 1}) {
+                checkNthElement(randomValues<float>(n, range, gen), nth);
+                checkNthElement(randomValues<std::int32_t>(n, range, gen),
+                                nth);
+                checkNthElement(randomValues<std::uint32_t>(n, range, gen),
+                                nth);
+                checkNthElement(randomValues<double>(n, range, gen), nth);
+                checkNthElement(randomValues<int>(n, range, gen), nth,
+                                std::greater<>());
+            }
+        }
+    }
+}
+
+TEST_CASE("nth_element on adversarial inputs") {
+    std::mt19937 gen(2);
+    Vector<std::int32_t> v;
+    for (std::int32_t i = 0; i < 4000; ++i) {
+        v.push_back(i);
+    }
+    checkNthElement(v, 1234);
+    std::reverse(v.begin(), v.end());
+    checkNthElement(v, 3999);
+
+    // Signed and unsigned extremes must not be confused.
+    Vector<std::int32_t> signs = {INT32_MIN, -1, 0, 1, INT32_MAX};
+    Vector<std::uint32_t> sorted_extremes = {0, 1, 1u << 31, UINT32_MAX};
+    for (std::size_t i = 0; i < 100; ++i) {
+        const std::int32_t s = signs[i % 5];
+        const std::uint32_t u = sorted_extremes[i % 4];
+        signs.push_back(s);
+        sorted_extremes.push_back(u);
+    }
+    checkNthElement(signs, 50);
+    checkNthElement(sorted_extremes, 60);
+
+    // Organ pipe with many copies of the minimum.
+    Vector<float> pipe;
+    for (int i = 0; i < 3000; ++i) {
+        pipe.push_back(i < 1000 ? 0.0f : float(std::min(i, 6000 - i)));
+    }
+    for (std::size_t nth : {0u, 999u, 1000u, 2999u}) {
+        checkNthElement(pipe, nth);
+    }
+
+    Vector<std::string> words;
+    for (std::size_t i = 0; i < 300; ++i) {
+        words.push_back(std::to_string(gen() % 50));
+    }
+    checkNthElement(words, 150);
+}
+
+template <typename T>
+static void checkPartitionLevels(const Vector<T>& v, T pivot) {
+    const auto below = std::size_t(
+        std::count_if(v.begin(), v.end(), [&](T x) { return x < pivot; }));
+    for (int l = 0; l <= int(simd::detect()); ++l) {
+        Vector<T> a = v;
+        const auto kernel = detail::partition_less<T>.get(simd::Level(l));
+        REQUIRE(kernel(a.data(), a.size(), pivot) == below);
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            REQUIRE((a[i] < pivot) == (i < below));
+        }
+        std::sort(a.begin(), a.end());
+        Vector<T> sorted = v;
+        std::sort(sorted.begin(), sorted.end());
+        REQUIRE(a == sorted);
+    }
+}
+
+TEST_CASE("partition kernels agree on every supported level") {
+    std::mt19937 gen(3);
+    for (std::size_t n : {0u, 5u, 16u, 31u, 32u, 33u, 100u, 1000u}) {
+        for (std::uint32_t range : {1u, 10u, 1u << 31}) {
+            const std::uint32_t pivot = gen() % range;
+            checkPartitionLevels(randomValues<float>(n, range, gen),
+                                 float(pivot));
+            checkPartitionLevels(randomValues<std::int32_t>(n, range, gen),
+                                 std::int32_t(pivot) - 5);
+            checkPartitionLevels(randomValues<std::uint32_t>(n, range, gen),
+                                 pivot);
+        }
+    }
+}
+
+TEST_CASE("partial_sort sorts the prefix") {
+    std::mt19937 gen(3);
+    for (std::size_t k : {0u, 1u, 10u, 500u, 2000u}) {
+        Vector<float> v = randomValues<float>(2000, 100, gen);
+        Vector<float> sorted = v;
+        std::sort(sorted.begin(), sorted.end());
+        algo::partial_sort(v.begin(), v.begin() + k, v.end());
+        REQUIRE(std::equal(v.begin(), v.begin() + k, sorted.begin()));
+    }
+}
+
+TEST_CASE("top_k returns the greatest values") {
+    std::mt19937 gen(4);
+    for (std::size_t n : {0u, 5u, 100u, 10000u}) {
+        for (std::size_t k : {0u, 1u, 7u, 100u, 20000u}) {
+            const Vector<std::int32_t> v =
+                randomValues<std::int32_t>(n, 1000, gen);
+            Vector<std::int32_t> expected = v;
+            std::sort(expected.begin(), expected.end(), std::greater<>());
+            expected.resize(std::min(k, n));
+            REQUIRE(top_k(v, k) == expected);
+
+            // The smallest values under the reversed order.
+            Vector<std::int32_t> smallest = v;
+            std::sort(smallest.begin(), smallest.end());
+            smallest.resize(std::min(k, n));
+            REQUIRE(top_k(v, k, std::greater<std::int32_t>()) == smallest);
+        }
+    }
+}
+
+TEST_CASE("top k of a stream") {
+    TopK<int> top(3);
+    REQUIRE(top.sorted().empty());
+    top.push(5);
+    REQUIRE(top.sorted() == Vector<int>{5});
+    const Vector<int> stream = {1, 9, 7, 3, 9, 2};
+    top.push(stream.begin(), stream.end());
+    REQUIRE(top.size() == 3);
+    REQUIRE(top.sorted() == (Vector<int>{9, 9, 7}));
+
+    top.clear();
+    top.push(4);
+    REQUIRE(top.sorted() == Vector<int>{4});
+
+    TopK<int> none(0);
+    none.push(1);
+    REQUIRE(none.size() == 0);
+}
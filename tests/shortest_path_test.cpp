@@ -0,0 +1,146 @@
+#define CATCH_CONFIG_MAIN
+#include "shortest_path.hpp"
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+
+using namespace algo;
+
+using Graph = CsrGraph<std::uint32_t>;
+
+namespace {
+Graph randomGraph(std::uint32_t n, std::size_t m, std::uint32_t seed) {
+    std::mt19937 rng(seed);
+    Vector<Graph::Edge> edges;
+    for (std::size_t i = 0; i < m; ++i) {
+        edges.push_back({std::uint32_t(rng() % n), std::uint32_t(rng() % n),
+                         std::uint32_t(rng() % 100)});
+    }
+    return Graph(n, edges);
+}
+
+// Bellman-Ford as the reference.
+Vector<std::uint64_t> reference(const Graph& g, std::uint32_t source) {
+    const std::uint64_t inf = ~std::uint64_t(0);
+    Vector<std::uint64_t> dist(g.num_vertices(), inf);
+    dist[source] = 0;
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (std::uint32_t u = 0; u < g.num_vertices(); ++u) {
+            if (dist[u] == inf) {
+                continue;
+            }
+            for (auto e = g.edge_begin(u); e < g.edge_end(u); ++e) {
+                if (dist[u] + g.weight(e) < dist[g.target(e)]) {
+                    dist[g.target(e)] = dist[u] + g.weight(e);
+                    changed = true;
+                }
+            }
+        }
+    }
+    return dist;
+}
+} // namespace
+
+TEST_CASE("csr graph") {
+    Graph g(4, {{2, 3, 1}, {0, 1, 5}, {0, 2, 6}, {2, 0, 7}});
+    REQUIRE(g.num_vertices() == 4);
+    REQUIRE(g.num_edges() == 4);
+    REQUIRE(g.degree(0) == 2);
+    REQUIRE(g.degree(1) == 0);
+    REQUIRE(g.degree(2) == 2);
+    REQUIRE(g.target(g.edge_begin(0)) == 1);
+    REQUIRE(g.weight(g.edge_begin(0) + 1) == 6);
+    REQUIRE(g.target(g.edge_begin(2)) == 3);
+
+    REQUIRE_THROWS_AS(Graph(2, {{0, 2, 1}}), std::out_of_range);
+}
+
+TEST_CASE("dijkstra on a small graph") {
+    Graph g(5, {{0, 1, 5}, {1, 2, 7}, {0, 2, 20}, {2, 3, 1}});
+    ShortestPaths<std::uint32_t> sp;
+
+    REQUIRE(sp.dijkstra(g, 0, 2) == 12);
+    REQUIRE(sp.path_to(2) == Vector<std::uint32_t>({0, 1, 2}));
+
+    sp.dijkstra(g, 0);
+    REQUIRE(sp.distance(3) == 13);
+    REQUIRE(sp.parent(0) == sp.npos);
+    REQUIRE(!sp.reached(4));
+    REQUIRE(sp.distance(4) == sp.infinity);
+    REQUIRE(sp.path_to(4).empty());
+
+    REQUIRE(sp.dijkstra_radix(g, 1, 3) == 8);
+    REQUIRE(!sp.reached(0));
+
+    REQUIRE_THROWS_AS(sp.dijkstra(g, 5), std::out_of_range);
+}
+
+TEST_CASE("dijkstra with floating point weights") {
+    CsrGraph<double> g(3, {{0, 1, 0.5}, {1, 2, 0.25}, {0, 2, 1.0}});
+    ShortestPaths<double> sp;
+    REQUIRE(sp.dijkstra(g, 0, 2) == Approx(0.75));
+    REQUIRE(sp.dijkstra(g, 2, 0) == sp.infinity);
+}
+
+TEST_CASE("repeated queries match bellman-ford") {
+    const Graph g = randomGraph(300, 1500, 1);
+    ShortestPaths<std::uint32_t> sp;
+
+    for (std::uint32_t source = 0; source < 300; source += 17) {
+        const auto expected = reference(g, source);
+
+        sp.dijkstra(g, source);
+        for (std::uint32_t v = 0; v < 300; ++v) {
+            if (expected[v] == ~std::uint64_t(0)) {
+                REQUIRE(!sp.reached(v));
+            } else {
+                REQUIRE(sp.distance(v) == expected[v]);
+            }
+        }
+
+        sp.dijkstra_radix(g, source);
+        for (std::uint32_t v = 0; v < 300; ++v) {
+            if (expected[v] != ~std::uint64_t(0)) {
+                REQUIRE(sp.distance(v) == expected[v]);
+            }
+        }
+
+        const std::uint32_t target = (source * 7 + 3) % 300;
+        if (expected[target] != ~std::uint64_t(0)) {
+            REQUIRE(sp.dijkstra(g, source, target) == expected[target]);
+            const auto path = sp.path_to(target);
+            REQUIRE(path.front() == source);
+            REQUIRE(path.back() == target);
+        }
+    }
+}
+
+TEST_CASE("astar on a grid") {
+    const std::uint32_t w = 20, h = 20;
+    Vector<Graph::Edge> edges;
+    auto id = [&](std::uint32_t x, std::uint32_t y) { return y * w + x; };
+    for (std::uint32_t y = 0; y < h; ++y) {
+        for (std::uint32_t x = 0; x < w; ++x) {
+            if (x + 1 < w) {
+                edges.push_back({id(x, y), id(x + 1, y), 1});
+                edges.push_back({id(x + 1, y), id(x, y), 1});
+            }
+            if (y + 1 < h) {
+                edges.push_back({id(x, y), id(x, y + 1), 1});
+                edges.push_back({id(x, y + 1), id(x, y), 1});
+            }
+        }
+    }
+    const Graph g(w * h, edges);
+    ShortestPaths<std::uint32_t> sp;
+
+    const std::uint32_t target = id(w - 1, h - 1);
+    auto manhattan = [&](std::uint32_t v) {
+        return (w - 1 - v % w) + (h - 1 - v / w);
+    };
+    REQUIRE(sp.astar(g, id(0, 0), target, manhattan) == w + h - 2);
+    REQUIRE(sp.path_to(target).size() == w + h - 1);
+    REQUIRE(sp.dijkstra(g, id(3, 4), target) == (w - 4) + (h - 5));
+}
@@ -0,0 +1,65 @@
+#define CATCH_CONFIG_MAIN
+#include "simd.hpp"
+#include "bitset.hpp"
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace algo;
+
+static int one(int) { return 1; }
+static int two(int) { return 2; }
+static int four(int) { return 4; }
+
+TEST_CASE("simd level is supported by the CPU") {
+    REQUIRE(simd::level() <= simd::detect());
+    REQUIRE(simd::level() == simd::level());
+    REQUIRE(simd::name(simd::Level::scalar) == "scalar");
+    REQUIRE(simd::name(simd::Level::sse2) == "sse2");
+    REQUIRE(simd::name(simd::Level::avx2) == "avx2");
+    REQUIRE(simd::name(simd::Level::avx512) == "avx512");
+#if defined(__x86_64__)
+    REQUIRE(simd::detect() >= simd::Level::sse2);
+#endif
+}
+
+TEST_CASE("Dispatch falls back to the next level down") {
+    static constexpr simd::Dispatch<int(int)> f(one, nullptr, two);
+    REQUIRE(f.get(simd::Level::scalar) == &one);
+    REQUIRE(f.get(simd::Level::sse2) == &one);
+    REQUIRE(f.get(simd::Level::avx2) == &two);
+    REQUIRE(f.get(simd::Level::avx512) == &two);
+    REQUIRE(f(0) == (simd::level() >= simd::Level::avx2 ? 2 : 1));
+
+    const simd::Dispatch<int(int)> g(one, nullptr, nullptr, four);
+    REQUIRE(g.get(simd::Level::avx2) == &one);
+    REQUIRE(g.get(simd::Level::avx512) == &four);
+}
+
+TEST_CASE("popcount kernels agree on every supported level") {
+    std::mt19937_64 gen(11);
+    for (std::size_t n : {0, 1, 2, 3, 7, 8, 9, 31, 64, 65, 1000, 4099}) {
+        std::vector<std::uint64_t> words(n);
+        std::size_t expected = 0;
+        for (std::uint64_t& w : words) {
+            w = gen() & gen();
+            expected += std::size_t(__builtin_popcountll(w));
+        }
+        for (int l = 0; l <= int(simd::detect()); ++l) {
+            const auto kernel = detail::popcount_words.get(simd::Level(l));
+            REQUIRE(kernel(words.data(), n) == expected);
+        }
+        REQUIRE(detail::popcountWords(words.data(), n) == expected);
+    }
+    std::vector<std::uint64_t> ones(100, ~std::uint64_t(0));
+    REQUIRE(detail::popcountWords(ones.data(), ones.size()) == 6400);
+}
+
+TEST_CASE("DynamicBitset count uses the dispatched kernel") {
+    DynamicBitset b(5000);
+    for (std::size_t i = 0; i < 5000; i += 3) {
+        b.set(i);
+    }
+    REQUIRE(b.count() == 1667);
+}
@@ -0,0 +1,152 @@
+#define CATCH_CONFIG_MAIN
+#include "sketch.hpp"
+#include <catch2/catch.hpp>
+#include <cmath>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace algo;
+
+TEST_CASE("hyperloglog estimates small and large cardinalities") {
+    HyperLogLog<std::uint64_t> hll(12);
+    REQUIRE(hll.precision() == 12);
+    REQUIRE(hll.registers().size() == 4096);
+    REQUIRE(hll.estimate() == 0.0);
+
+    hll.add(42);
+    hll.add(42);
+    REQUIRE(std::round(hll.estimate()) == 1);
+
+    std::uint64_t added = 1;
+    for (std::uint64_t target : {100u, 1000u, 10000u, 100000u, 1000000u}) {
+        for (; added < target; ++added) {
+            hll.add(added * 7919);
+        }
+        // 1.04 / sqrt(4096) is 1.6%; allow four standard errors.
+        REQUIRE(std::abs(hll.estimate() - double(target)) <
+                0.065 * double(target));
+    }
+
+    hll.clear();
+    REQUIRE(hll.estimate() == 0.0);
+    REQUIRE_THROWS_AS(HyperLogLog<int>(3), std::invalid_argument);
+    REQUIRE_THROWS_AS(HyperLogLog<int>(19), std::invalid_argument);
+}
+
+TEST_CASE("hyperloglog merges") {
+    HyperLogLog<std::string> a(10), b(10), both(10);
+    std::vector<std::string> keys;
+    for (int i = 0; i < 20000; ++i) {
+        keys.push_back("user-" + std::to_string(i));
+    }
+    a.add(keys.begin(), keys.begin() + 12000);
+    b.add(keys.begin() + 8000, keys.end());
+    both.add(keys.begin(), keys.end());
+
+    a.merge(b);
+    REQUIRE(a.registers() == both.registers());
+    REQUIRE(std::abs(a.estimate() - 20000.0) < 0.15 * 20000.0);
+
+    REQUIRE_THROWS_AS(a.merge(HyperLogLog<std::string>(11)),
+                      std::invalid_argument);
+}
+
+TEST_CASE("count-min sketch never undercounts") {
+    CountMinSketch<std::uint32_t> sketch(1000, 4);
+    REQUIRE(sketch.width() == 1024);
+    REQUIRE(sketch.depth() == 4);
+
+    std::mt19937 gen(1);
+    std::map<std::uint32_t, std::uint64_t> exact;
+    std::vector<std::uint32_t> stream;
+    for (int i = 0; i < 100000; ++i) {
+        // Zipf-like: small keys are much more frequent.
+        const std::uint32_t key = std::uint32_t(gen() % (1 + gen() % 5000));
+        stream.push_back(key);
+        ++exact[key];
+    }
+    sketch.add(stream.begin(), stream.end());
+    sketch.add(7, 5);
+    exact[7] += 5;
+    REQUIRE(sketch.total() == 100005);
+
+    std::size_t close = 0;
+    for (const auto& [key, count] : exact) {
+        const std::uint64_t estimate = sketch.estimate(key);
+        REQUIRE(estimate >= count);
+        close += estimate - count <= sketch.total() / sketch.width() * 3;
+    }
+    REQUIRE(close > exact.size() * 95 / 100);
+
+    CountMinSketch<std::uint32_t> other(1000, 4);
+    other.add(7, 10);
+    sketch.merge(other);
+    REQUIRE(sketch.estimate(7) >= exact[7] + 10);
+    REQUIRE(sketch.total() == 100015);
+    REQUIRE_THROWS_AS(sketch.merge(CountMinSketch<std::uint32_t>(1000, 3)),
+                      std::invalid_argument);
+
+    sketch.clear();
+    REQUIRE(sketch.estimate(7) == 0);
+    REQUIRE_THROWS_AS(CountMinSketch<int>(0, 4), std::invalid_argument);
+}
+
+TEST_CASE("space saving basic operations") {
+    SpaceSaving<std::string> top(2);
+    for (const char* k : {"a", "b", "a", "c", "a"}) {
+        top.add(k);
+    }
+    REQUIRE(top.size() == 2);
+    REQUIRE(top.total() == 5);
+    const auto items = top.top(2);
+    REQUIRE(items.size() == 2);
+    REQUIRE(items[0].key == "a");
+    REQUIRE(items[0].count == 3);
+    REQUIRE(items[0].error == 0);
+    // "c" took over the counter of "b".
+    REQUIRE(items[1].key == "c");
+    REQUIRE(items[1].count == 2);
+    REQUIRE(items[1].error == 1);
+    REQUIRE(top.estimate("b") == 0);
+
+    top.clear();
+    REQUIRE(top.size() == 0);
+    REQUIRE(top.top(5).empty());
+    REQUIRE_THROWS_AS(SpaceSaving<int>(0), std::invalid_argument);
+}
+
+TEST_CASE("space saving finds the heavy hitters") {
+    std::mt19937 gen(4);
+    std::map<int, std::uint64_t> exact;
+    std::vector<int> stream;
+    for (int i = 0; i < 200000; ++i) {
+        const int key = gen() % 4 == 0 ? int(gen() % 10) : int(gen() % 100000);
+        stream.push_back(key);
+        ++exact[key];
+    }
+
+    SpaceSaving<int> whole(100), left(100), right(100);
+    whole.add(stream.begin(), stream.end());
+    left.add(stream.begin(), stream.begin() + 70000);
+    right.add(stream.begin() + 70000, stream.end());
+    left.merge(right);
+    REQUIRE(left.total() == whole.total());
+
+    for (const SpaceSaving<int>* summary : {&whole, &left}) {
+        const auto items = summary->top(10);
+        REQUIRE(items.size() == 10);
+        for (const auto& item : items) {
+            REQUIRE(item.key < 10);
+            REQUIRE(item.count >= exact[item.key]);
+            REQUIRE(item.count - item.error <= exact[item.key]);
+        }
+        // Every key above `total / capacity` is tracked.
+        for (const auto& [key, count] : exact) {
+            if (count > summary->total() / summary->capacity()) {
+                REQUIRE(summary->estimate(key) >= count);
+            }
+        }
+    }
+}
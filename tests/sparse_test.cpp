@@ -0,0 +1,136 @@
+#define CATCH_CONFIG_MAIN
+#include "sparse.hpp"
+#include <catch2/catch.hpp>
+#include <map>
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace algo;
+
+TEST_CASE("sparse set basic operations") {
+    SparseSet s(100);
+    REQUIRE(s.universe() == 100);
+    REQUIRE(s.empty());
+    REQUIRE(s.insert(42));
+    REQUIRE(!s.insert(42));
+    REQUIRE(s.insert(7));
+    REQUIRE(s.insert(99));
+    REQUIRE(s.size() == 3);
+    REQUIRE(s.contains(7));
+    REQUIRE(!s.contains(8));
+    REQUIRE(std::vector<std::uint32_t>(s.begin(), s.end()) ==
+            std::vector<std::uint32_t>{42, 7, 99});
+
+    REQUIRE(s.erase(42));
+    REQUIRE(!s.erase(42));
+    REQUIRE(std::vector<std::uint32_t>(s.begin(), s.end()) ==
+            std::vector<std::uint32_t>{99, 7});
+
+    s.clear();
+    REQUIRE(s.empty());
+    REQUIRE(!s.contains(7));
+    REQUIRE(!s.contains(99));
+    REQUIRE(s.insert(99));
+    REQUIRE(!s.contains(7));
+
+    s.reset(10);
+    REQUIRE(s.universe() == 10);
+    REQUIRE(s.empty());
+}
+
+TEST_CASE("sparse set matches std::set") {
+    std::mt19937 gen(6);
+    SparseSet s(500);
+    std::set<std::uint32_t> expected;
+    for (int round = 0; round < 50; ++round) {
+        for (int i = 0; i < 300; ++i) {
+            const std::uint32_t x = gen() % 500;
+            if (gen() % 3 == 0) {
+                REQUIRE(s.erase(x) == (expected.erase(x) == 1));
+            } else {
+                REQUIRE(s.insert(x) == expected.insert(x).second);
+            }
+        }
+        REQUIRE(s.size() == expected.size());
+        REQUIRE(std::set<std::uint32_t>(s.begin(), s.end()) == expected);
+        for (std::uint32_t x = 0; x < 500; ++x) {
+            REQUIRE(s.contains(x) == (expected.count(x) == 1));
+        }
+        if (round % 5 == 0) {
+            s.clear();
+            expected.clear();
+        }
+    }
+}
+
+TEST_CASE("sparse vector basic operations") {
+    SparseVector<double> x, y;
+    x.push_back(1, 2.0);
+    x.push_back(5, 3.0);
+    y.push_back(5, 4.0);
+    REQUIRE(x.nnz() == 2);
+    REQUIRE(x.get(5) == 3.0);
+    REQUIRE(x.get(4) == 0.0);
+    REQUIRE(dot(x, y) == 12.0);
+    REQUIRE_THROWS_AS(x.push_back(5, 1.0), std::invalid_argument);
+
+    axpy(2.0, x, y);
+    REQUIRE(y.indices() == Vector<std::uint32_t>{1, 5});
+    REQUIRE(y.values() == Vector<double>{4.0, 10.0});
+
+    double dense[8] = {};
+    axpy(1.0, x, dense);
+    REQUIRE(dense[1] == 2.0);
+    REQUIRE(dense[5] == 3.0);
+    REQUIRE(dot(x, dense) == 13.0);
+
+    REQUIRE_THROWS_AS(SparseVector<int>({1, 1}, {1, 2}),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(SparseVector<int>({1}, {1, 2}), std::invalid_argument);
+}
+
+static SparseVector<long> randomSparse(std::size_t nnz, std::uint32_t range,
+                                       std::mt19937& gen,
+                                       std::map<std::uint32_t, long>& dense) {
+    std::set<std::uint32_t> idx;
+    while (idx.size() < nnz) {
+        idx.insert(gen() % range);
+    }
+    SparseVector<long> v;
+    for (std::uint32_t i : idx) {
+        const long value = long(gen() % 100) - 50;
+        v.push_back(i, value);
+        dense[i] = value;
+    }
+    return v;
+}
+
+TEST_CASE("sparse vector dot and axpy match dense math") {
+    std::mt19937 gen(8);
+    for (std::size_t na : {0u, 1u, 3u, 17u, 400u, 2000u}) {
+        for (std::size_t nb : {0u, 2u, 5u, 64u, 1000u}) {
+            std::map<std::uint32_t, long> da, db;
+            const auto a = randomSparse(na, 3000, gen, da);
+            auto b = randomSparse(nb, 3000, gen, db);
+
+            long expected = 0;
+            for (const auto& [i, v] : da) {
+                if (db.count(i)) {
+                    expected += v * db[i];
+                }
+            }
+            REQUIRE(dot(a, b) == expected);
+            REQUIRE(dot(b, a) == expected);
+
+            for (const auto& [i, v] : da) {
+                db[i] += 3 * v;
+            }
+            axpy(3L, a, b);
+            REQUIRE(b.nnz() == db.size());
+            for (std::size_t k = 0; k < b.nnz(); ++k) {
+                REQUIRE(b.values()[k] == db[b.indices()[k]]);
+            }
+        }
+    }
+}
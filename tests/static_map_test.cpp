@@ -0,0 +1,113 @@
+#define CATCH_CONFIG_MAIN
+#include "static_map.hpp"
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+using namespace algo;
+
+namespace {
+enum class Field : std::uint16_t { host = 1, accept = 7, cookie = 300 };
+
+constexpr StaticMap<std::string_view, int, 6> methods = {
+    {"GET", 1},    {"PUT", 2},    {"POST", 3},
+    {"HEAD", 4},   {"DELETE", 5}, {"", 6}};
+static_assert(methods.size() == 6);
+static_assert(*methods.find("GET") == 1);
+static_assert(methods.at("DELETE") == 5);
+static_assert(methods.at("") == 6);
+static_assert(!methods.contains("PATCH"));
+static_assert(!methods.contains("get"));
+
+constexpr StaticMap<Field, std::string_view, 3> fields = {
+    {Field::host, "Host"},
+    {Field::accept, "Accept"},
+    {Field::cookie, "Cookie"}};
+static_assert(fields.at(Field::cookie) == "Cookie");
+static_assert(!fields.contains(Field(2)));
+
+constexpr StaticMap<std::int32_t, std::int32_t, 0> none = {};
+static_assert(none.empty());
+static_assert(!none.contains(0));
+} // namespace
+
+TEST_CASE("StaticMap finds constexpr keys") {
+    REQUIRE(*methods.find(std::string("POST")) == 3);
+    REQUIRE(methods.find("OPTIONS") == nullptr);
+    REQUIRE_THROWS_AS(methods.at("OPTIONS"), std::out_of_range);
+    REQUIRE(fields.at(Field::host) == "Host");
+
+    // Enough keys for many buckets, built at compile time.
+    using Squares = StaticMap<std::int32_t, std::int32_t, 500>;
+    constexpr Squares squares([] {
+        std::array<Squares::Entry, 500> entries{};
+        for (std::int32_t i = 0; i < 500; ++i) {
+            entries[std::size_t(i)] = {i * 7 - 1000, i * i};
+        }
+        return entries;
+    }());
+    static_assert(squares.at(-1000) == 0);
+    static_assert(squares.at(2493) == 499 * 499);
+    static_assert(!squares.contains(-999));
+    for (std::int32_t k = -1100; k < 2600; ++k) {
+        const std::int32_t* v = squares.find(k);
+        const bool present = k >= -1000 && k <= 2493 && (k + 1000) % 7 == 0;
+        REQUIRE((v != nullptr) == present);
+        if (present) {
+            REQUIRE(*v == (k + 1000) / 7 * ((k + 1000) / 7));
+        }
+    }
+}
+
+TEST_CASE("StaticMap builds at run time") {
+    std::mt19937_64 gen(9);
+    for (std::size_t n : {0, 1, 2, 17, 1000, 200000}) {
+        Vector<std::uint64_t> keys;
+        Vector<std::uint32_t> values;
+        std::unordered_map<std::uint64_t, std::uint32_t> expected;
+        while (keys.size() < n) {
+            const std::uint64_t k = gen() % (4 * n + 1);
+            if (expected.emplace(k, std::uint32_t(keys.size())).second) {
+                keys.push_back(k);
+                values.push_back(std::uint32_t(keys.size() - 1));
+            }
+        }
+        const StaticMap<std::uint64_t, std::uint32_t> m(keys, values);
+        REQUIRE(m.size() == n);
+        for (std::uint64_t k = 0; k < 4 * n + 10; ++k) {
+            const auto it = expected.find(k);
+            const std::uint32_t* v = m.find(k);
+            REQUIRE((v == nullptr) == (it == expected.end()));
+            if (v != nullptr) {
+                REQUIRE(*v == it->second);
+            }
+        }
+    }
+
+    Vector<std::string> words;
+    Vector<int> ids;
+    for (int i = 0; i < 5000; ++i) {
+        words.push_back("word" + std::to_string(i));
+        ids.push_back(i);
+    }
+    const StaticMap<std::string, int> dictionary(words, ids);
+    for (int i = 0; i < 5000; ++i) {
+        REQUIRE(dictionary.at("word" + std::to_string(i)) == i);
+    }
+    REQUIRE_FALSE(dictionary.contains("word5000"));
+    REQUIRE_FALSE(dictionary.contains("word"));
+
+    words.push_back("word17");
+    ids.push_back(0);
+    REQUIRE_THROWS_AS((StaticMap<std::string, int>(words, ids)),
+                      std::invalid_argument);
+    ids.pop_back();
+    REQUIRE_THROWS_AS((StaticMap<std::string, int>(words, ids)),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS((StaticMap<std::uint64_t, int, 2>({{1, 1}})),
+                      std::invalid_argument);
+}
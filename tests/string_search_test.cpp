@@ -0,0 +1,166 @@
+#define CATCH_CONFIG_MAIN
+#include "string_search.hpp"
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace algo;
+
+TEST_CASE("find substring") {
+    REQUIRE(find_substring("hello world", "o w") == 4);
+    REQUIRE(find_substring("hello world", "world") == 6);
+    REQUIRE(find_substring("hello world", "xyz") == std::string_view::npos);
+    REQUIRE(find_substring("hello world", "o") == 4);
+    REQUIRE(find_substring("hello world", "o", 5) == 7);
+    REQUIRE(find_substring("hello world", "") == 0);
+    REQUIRE(find_substring("hello world", "", 11) == 11);
+    REQUIRE(find_substring("hello world", "", 12) == std::string_view::npos);
+    REQUIRE(find_substring("", "a") == std::string_view::npos);
+    REQUIRE(find_substring("ab", "abc") == std::string_view::npos);
+
+    Vector<char> text;
+    for (char c : std::string_view("the quick brown fox")) {
+        text.push_back(c);
+    }
+    REQUIRE(find_substring(text, "brown") == 10);
+    REQUIRE(find_substring(text, "fox", 17) == std::string_view::npos);
+}
+
+TEST_CASE("find substring matches std::string::find") {
+    std::mt19937 gen(3);
+    for (int round = 0; round < 300; ++round) {
+        // A small alphabet produces many false candidates for the filter.
+        std::uniform_int_distribution<int> letter('a', round % 2 ? 'b' : 'e');
+        std::uniform_int_distribution<std::size_t> length(0, 300);
+        std::string text(length(gen), ' ');
+        for (char& c : text) {
+            c = char(letter(gen));
+        }
+
+        for (std::size_t k = 1; k <= 70; k += 3) {
+            std::string needle(k, ' ');
+            if (k <= text.size() && round % 3 == 0) {
+                std::uniform_int_distribution<std::size_t> at(0,
+                                                             text.size() - k);
+                needle = text.substr(at(gen), k);
+            } else {
+                for (char& c : needle) {
+                    c = char(letter(gen));
+                }
+            }
+            for (std::size_t pos : {std::size_t(0), std::size_t(17)}) {
+                REQUIRE(find_substring(text, needle, pos) ==
+                        text.find(needle, pos));
+            }
+        }
+    }
+}
+
+TEST_CASE("aho corasick classic example") {
+    AhoCorasick ac{"he", "she", "hers", "his"};
+    REQUIRE(ac.pattern_count() == 4);
+    REQUIRE(ac.pattern_length(2) == 4);
+
+    std::vector<std::pair<std::uint32_t, std::size_t>> matches;
+    ac.for_each_match("ushers", [&](std::uint32_t id, std::size_t pos) {
+        matches.emplace_back(id, pos);
+    });
+    std::sort(matches.begin(), matches.end());
+    REQUIRE(matches == std::vector<std::pair<std::uint32_t, std::size_t>>{
+                           {0, 2}, {1, 1}, {2, 2}});
+
+    REQUIRE(ac.contains_any("this"));
+    REQUIRE(!ac.contains_any("tree"));
+    REQUIRE(ac.count_matches("hehehe") == 3);
+}
+
+TEST_CASE("aho corasick duplicate and nested patterns") {
+    AhoCorasick ac{"a", "aa", "a", "aaa"};
+    // "aaaa": 4 * 2 for the two "a", 3 "aa", 2 "aaa".
+    REQUIRE(ac.count_matches("aaaa") == 13);
+}
+
+TEST_CASE("aho corasick rejects empty patterns") {
+    REQUIRE_THROWS_AS((AhoCorasick{"a", ""}), std::invalid_argument);
+
+    AhoCorasick none;
+    REQUIRE(none.pattern_count() == 0);
+    REQUIRE(none.count_matches("anything") == 0);
+}
+
+TEST_CASE("aho corasick with every byte value") {
+    std::string all;
+    for (int b = 0; b < 256; ++b) {
+        all.push_back(char(b));
+    }
+    Vector<std::string_view> patterns;
+    patterns.push_back(std::string_view(all).substr(250));
+    patterns.push_back(std::string_view(all).substr(0, 1));
+    AhoCorasick ac(patterns);
+    REQUIRE(ac.count_matches(all + all) == 4);
+}
+
+TEST_CASE("aho corasick matches brute force") {
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<int> letter('a', 'd');
+    std::uniform_int_distribution<int> length(1, 6);
+    std::vector<std::string> owned;
+    for (int i = 0; i < 200; ++i) {
+        std::string p(std::size_t(length(gen)), ' ');
+        for (char& c : p) {
+            c = char(letter(gen));
+        }
+        owned.push_back(p);
+    }
+    Vector<std::string_view> patterns;
+    for (const auto& p : owned) {
+        patterns.push_back(p);
+    }
+    AhoCorasick ac(patterns);
+
+    std::vector<std::string> texts;
+    Vector<std::string_view> views;
+    for (int t = 0; t < 21; ++t) {
+        std::string s(std::size_t(t * 13 % 97), ' ');
+        for (char& c : s) {
+            c = char(letter(gen));
+        }
+        texts.push_back(s);
+    }
+    for (const auto& s : texts) {
+        views.push_back(s);
+    }
+
+    using Match = std::tuple<std::size_t, std::uint32_t, std::size_t>;
+    std::vector<Match> expected;
+    for (std::size_t t = 0; t < texts.size(); ++t) {
+        for (std::uint32_t id = 0; id < owned.size(); ++id) {
+            for (std::size_t pos = texts[t].find(owned[id]);
+                 pos != std::string::npos;
+                 pos = texts[t].find(owned[id], pos + 1)) {
+                expected.emplace_back(t, id, pos);
+            }
+        }
+    }
+    std::sort(expected.begin(), expected.end());
+
+    std::vector<Match> single;
+    for (std::size_t t = 0; t < texts.size(); ++t) {
+        ac.for_each_match(texts[t], [&](std::uint32_t id, std::size_t pos) {
+            single.emplace_back(t, id, pos);
+        });
+    }
+    std::sort(single.begin(), single.end());
+    REQUIRE(single == expected);
+
+    std::vector<Match> batched;
+    ac.for_each_match(views,
+                      [&](std::size_t t, std::uint32_t id, std::size_t pos) {
+                          batched.emplace_back(t, id, pos);
+                      });
+    std::sort(batched.begin(), batched.end());
+    REQUIRE(batched == expected);
+}
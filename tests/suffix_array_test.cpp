@@ -0,0 +1,105 @@
+#define CATCH_CONFIG_MAIN
+#include "suffix_array.hpp"
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <random>
+
+using namespace algo;
+
+namespace {
+Vector<std::uint8_t> bytes(const char* s) {
+    return Vector<std::uint8_t>(s, s + std::strlen(s));
+}
+
+Vector<std::uint8_t> randomText(std::size_t n, unsigned sigma,
+                                std::uint32_t seed) {
+    std::mt19937 rng(seed);
+    Vector<std::uint8_t> text(n);
+    for (auto& c : text) {
+        c = std::uint8_t(rng() % sigma);
+    }
+    return text;
+}
+
+Vector<std::uint32_t> naive(const Vector<std::uint8_t>& text) {
+    Vector<std::uint32_t> sa(text.size());
+    for (std::uint32_t i = 0; i < sa.size(); ++i) {
+        sa[i] = i;
+    }
+    std::sort(sa.begin(), sa.end(), [&](std::uint32_t a, std::uint32_t b) {
+        return std::lexicographical_compare(text.begin() + a, text.end(),
+                                            text.begin() + b, text.end());
+    });
+    return sa;
+}
+} // namespace
+
+TEST_CASE("suffix array of banana") {
+    const auto text = bytes("banana");
+    const auto sa = suffix_array(text);
+    REQUIRE(sa == Vector<std::uint32_t>({5, 3, 1, 0, 4, 2}));
+
+    const auto lcp = lcp_array(text, sa);
+    REQUIRE(lcp == Vector<std::uint32_t>({0, 1, 3, 0, 0, 2}));
+}
+
+TEST_CASE("suffix array of tiny texts") {
+    REQUIRE(suffix_array(Vector<std::uint8_t>()).empty());
+    REQUIRE(suffix_array(bytes("a")) == Vector<std::uint32_t>({0}));
+    REQUIRE(suffix_array(bytes("ba")) == Vector<std::uint32_t>({1, 0}));
+    REQUIRE(suffix_array(bytes("aaaa")) ==
+            Vector<std::uint32_t>({3, 2, 1, 0}));
+}
+
+TEST_CASE("suffix array matches naive sort") {
+    for (unsigned sigma : {2u, 4u, 256u}) {
+        for (std::size_t n : {3, 10, 100, 1000, 5000}) {
+            const auto text = randomText(n, sigma, std::uint32_t(n + sigma));
+            const auto expected = naive(text);
+            REQUIRE(suffix_array(text) == expected);
+
+            Vector<std::uint64_t> sa64;
+            suffix_array(text, sa64);
+            REQUIRE(std::equal(sa64.begin(), sa64.end(), expected.begin(),
+                               expected.end()));
+        }
+    }
+}
+
+TEST_CASE("lcp array matches direct comparison") {
+    const auto text = randomText(2000, 3, 5);
+    const auto sa = suffix_array(text);
+    const auto lcp = lcp_array(text, sa);
+    REQUIRE(lcp[0] == 0);
+    for (std::size_t i = 1; i < sa.size(); ++i) {
+        const auto a = text.begin() + sa[i - 1], b = text.begin() + sa[i];
+        const auto m = std::mismatch(a, text.end(), b, text.end());
+        REQUIRE(lcp[i] == std::uint32_t(m.first - a));
+    }
+
+    REQUIRE_THROWS_AS(lcp_array(text, Vector<std::uint32_t>()),
+                      std::invalid_argument);
+}
+
+TEST_CASE("parallel prefix doubling") {
+    ThreadPool pool(4);
+
+    REQUIRE(suffix_array_parallel(Vector<std::uint8_t>(), pool).empty());
+    REQUIRE(suffix_array_parallel(bytes("banana"), pool) ==
+            Vector<std::uint32_t>({5, 3, 1, 0, 4, 2}));
+
+    for (unsigned sigma : {2u, 256u}) {
+        const auto text = randomText(200000, sigma, sigma);
+        REQUIRE(suffix_array_parallel(text, pool) == suffix_array(text));
+    }
+
+    // Periodic input needs many doubling rounds.
+    Vector<std::uint8_t> periodic(100000);
+    for (std::size_t i = 0; i < periodic.size(); ++i) {
+        periodic[i] = "abcab"[i % 5];
+    }
+    REQUIRE(suffix_array_parallel<std::uint64_t>(periodic, pool) ==
+            suffix_array<std::uint64_t>(periodic));
+}
@@ -0,0 +1,104 @@
+#define CATCH_CONFIG_MAIN
+#include "thread_pool.hpp"
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace algo;
+
+TEST_CASE("submit") {
+    ThreadPool pool(3);
+    REQUIRE(pool.size() == 3);
+
+    std::vector<std::future<int>> futs;
+    for (int i = 0; i < 100; ++i) {
+        futs.push_back(pool.submit([i] { return i * i; }));
+    }
+    for (int i = 0; i < 100; ++i) {
+        REQUIRE(futs[i].get() == i * i);
+    }
+
+    auto fut = pool.submit([]() -> int { throw std::runtime_error("boom"); });
+    REQUIRE_THROWS_AS(fut.get(), std::runtime_error);
+}
+
+TEST_CASE("parallel for") {
+    ThreadPool pool(4);
+    std::vector<int> v(10007, 1);
+    std::atomic<int> calls{0};
+    pool.parallel_for(0, v.size(), [&](std::size_t lo, std::size_t hi) {
+        ++calls;
+        for (std::size_t i = lo; i < hi; ++i) {
+            v[i] += int(i);
+        }
+    });
+    REQUIRE(calls <= 4);
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        REQUIRE(v[i] == int(i) + 1);
+    }
+
+    calls = 0;
+    pool.parallel_for(0, 10, [&](std::size_t, std::size_t) { ++calls; },
+                      100);
+    REQUIRE(calls == 1);
+
+    REQUIRE_THROWS_AS(pool.parallel_for(0, 100,
+                                        [](std::size_t lo, std::size_t) {
+                                            if (lo > 0) {
+                                                throw std::logic_error("x");
+                                            }
+                                        }),
+                      std::logic_error);
+}
+
+TEST_CASE("parallel for static") {
+    ThreadPool pool(4);
+    // Records the thread of every chunk, by its first index.
+    std::mutex mutex;
+    std::vector<std::pair<std::size_t, std::thread::id>> seen;
+    auto record = [&](std::size_t lo, std::size_t) {
+        std::lock_guard<std::mutex> lock(mutex);
+        seen.emplace_back(lo, std::this_thread::get_id());
+    };
+    pool.parallel_for_static(0, 1000, record);
+    std::sort(seen.begin(), seen.end());
+    const auto first = seen;
+    REQUIRE(first.size() == 4);
+    for (std::size_t i = 0; i < first.size(); ++i) {
+        REQUIRE(first[i].first == 250 * i);
+        REQUIRE(first[i].second != std::this_thread::get_id());
+        for (std::size_t j = 0; j < i; ++j) {
+            REQUIRE(first[i].second != first[j].second);
+        }
+    }
+
+    // Each chunk goes back to the same worker, even with shared tasks queued.
+    for (int round = 0; round < 20; ++round) {
+        for (int i = 0; i < 8; ++i) {
+            pool.submit([] { std::this_thread::yield(); });
+        }
+        seen.clear();
+        pool.parallel_for_static(0, 1000, record);
+        std::sort(seen.begin(), seen.end());
+        REQUIRE(seen == first);
+    }
+
+    seen.clear();
+    pool.parallel_for_static(5, 7, record);
+    REQUIRE(seen.size() == 2);
+    pool.parallel_for_static(7, 7, record);
+    REQUIRE(seen.size() == 2);
+
+    auto fail = [](std::size_t lo, std::size_t) {
+        if (lo > 0) {
+            throw std::logic_error("x");
+        }
+    };
+    REQUIRE_THROWS_AS(pool.parallel_for_static(0, 100, fail),
+                      std::logic_error);
+}
@@ -0,0 +1,102 @@
+#define CATCH_CONFIG_MAIN
+#include "vector.hpp"
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+
+using namespace algo;
+
+#if defined(__cpp_lib_constexpr_dynamic_alloc)
+namespace {
+constexpr Vector<std::uint32_t> crcTable() {
+    Vector<std::uint32_t> table;
+    for (std::uint32_t i = 0; i < 256; ++i) {
+        std::uint32_t c = i;
+        for (int k = 0; k < 8; ++k) {
+            c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        table.push_back(c);
+    }
+    return table;
+}
+
+constexpr auto crc_table = to_array<crcTable>();
+static_assert(crc_table.size() == 256);
+static_assert(crc_table[1] == 0x77073096u);
+static_assert(crc_table[255] == 0x2D02EF8Du);
+
+// Inserts and erases in the middle, grows past the capacity and walks the
+// elements, for trivial and non-trivial element types.
+constexpr int edit() {
+    Vector<int> v = {1, 2, 3};
+    v.insert(v.begin() + 1, 10);
+    v.insert(v.begin(), 2, 7);
+    v.insert(v.end() - 1, {4, 5});
+    v.erase(v.begin() + 2);
+    v.erase(v.begin(), v.begin() + 1);
+    v.emplace_back(6);
+    v.pop_back();
+    v.resize(v.size() + 1);
+    v.back() = 9;
+    Vector<int> copy = v;
+    copy.assign(3, 0);
+    v.swap(copy);
+    v = copy;
+
+    int sum = 0;
+    for (int x : v) {
+        sum = sum * 10 + x;
+    }
+    return sum + int(copy.size()) * 100000000;
+}
+static_assert(edit() == 708024539);
+
+constexpr std::size_t nested() {
+    Vector<Vector<int>> rows;
+    for (int i = 0; i < 20; ++i) {
+        rows.push_back(Vector<int>(std::size_t(i), i));
+    }
+    rows.erase(rows.begin() + 3, rows.begin() + 5);
+    rows.insert(rows.begin(), Vector<int>{1, 2});
+    std::size_t total = 0;
+    for (const Vector<int>& row : rows) {
+        total += row.size();
+    }
+    return total;
+}
+static_assert(nested() == 190 - 3 - 4 + 2);
+
+constexpr auto makePrimes = [] {
+    Vector<int> v;
+    for (int n = 2; n < 100; ++n) {
+        if (std::none_of(v.begin(), v.end(),
+                         [n](int p) { return n % p == 0; })) {
+            v.push_back(n);
+        }
+    }
+    return v;
+};
+constexpr auto primes = to_array<makePrimes>();
+static_assert(primes.size() == 25);
+static_assert(primes.back() == 97);
+} // namespace
+
+TEST_CASE("constexpr Vector matches run time") {
+    const Vector<std::uint32_t> table = crcTable();
+    REQUIRE(std::equal(table.begin(), table.end(), crc_table.begin(),
+                       crc_table.end()));
+    REQUIRE(edit() == 708024539);
+    REQUIRE(nested() == 185);
+}
+#endif
+
+TEST_CASE("to_array copies a Vector") {
+    const Vector<int> v = {3, 1, 4};
+    const std::array<int, 3> a = to_array<3>(v);
+    REQUIRE(a == std::array<int, 3>{3, 1, 4});
+    REQUIRE(to_array<0>(Vector<int>()).empty());
+    REQUIRE_THROWS_AS(to_array<2>(v), std::length_error);
+}
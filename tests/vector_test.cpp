@@ -860,3 +860,36 @@ TEST_CASE("Vectors can be sized and resized") {
         REQUIRE(v.capacity() >= 5);
     }
 }
+
+TEST_CASE("resize_and_overwrite") {
+    Vector<int> v = {1, 2};
+    v.resize_and_overwrite(5, [](int* p, std::size_t n) {
+        REQUIRE(n == 5);
+        p[0] = 7;
+        p[2] = 3;
+        return std::size_t(3);
+    });
+    REQUIRE(v == (Vector<int>{7, 2, 3}));
+    REQUIRE(v.capacity() >= 5);
+
+    // Growth is geometric, so appending one at a time reallocates rarely.
+    std::size_t reallocations = 0;
+    for (int i = 0; i < 1000; ++i) {
+        const int* old = v.data();
+        v.resize_and_overwrite(v.size() + 1, [i](int* p, std::size_t n) {
+            p[n - 1] = i;
+            return n;
+        });
+        reallocations += v.data() != old;
+    }
+    REQUIRE(v.size() == 1003);
+    REQUIRE(v.back() == 999);
+    REQUIRE(reallocations < 30);
+
+    REQUIRE_THROWS_AS(v.resize_and_overwrite(
+                          2000, [](int*, std::size_t) -> std::size_t {
+                              throw std::runtime_error("read failed");
+                          }),
+                      std::runtime_error);
+    REQUIRE(v.size() == 1003);
+}